@@ -119,6 +119,15 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
                 printf("  thread_num = %2d, elapse = %6.3fs, VPS = %.3f\n", thread_num, t_diff, nq_ / t_diff);
                 std::fflush(stdout);
             }
+            // all the queries in one request, spread over the search pool in groups traversed in lockstep
+            auto ds_ptr = knowhere::GenDataSet(nq_, dim_, xq_);
+            for (auto group_size : QUERY_GROUP_SIZEs_) {
+                conf[knowhere::indexparam::QUERY_GROUP_SIZE] = group_size;
+                CALC_TIME_SPAN(index_.Search(*ds_ptr, conf, nullptr));
+                printf("  query_group_size = %2d, elapse = %6.3fs, VPS = %.3f\n", group_size, t_diff, nq_ / t_diff);
+                std::fflush(stdout);
+            }
+            conf.erase(knowhere::indexparam::QUERY_GROUP_SIZE);
             printf("================================================================================\n");
             printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
         }
@@ -191,6 +200,7 @@ class Benchmark_float_qps : public Benchmark_knowhere, public ::testing::Test {
     // HNSW index params
     const std::vector<int32_t> HNSW_Ms_ = {16};
     const std::vector<int32_t> EFCONs_ = {100};
+    const std::vector<int32_t> QUERY_GROUP_SIZEs_ = {1, 4, 8, 16};
 };
 
 TEST_F(Benchmark_float_qps, TEST_IVF_FLAT) {
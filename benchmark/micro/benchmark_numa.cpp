@@ -0,0 +1,133 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/thread_pool.h"
+#include "simd/hook.h"
+
+// Brute force scan throughput of vectors placed on one NUMA node, scanned by a pool pinned to the same node (local)
+// and by pools pinned to the other nodes (remote), and of vectors interleaved over all the nodes.
+class Benchmark_numa : public Benchmark_base, public ::testing::Test {
+ public:
+    // the seconds one pool takes to scan all the vectors for every query, the queries split between its threads
+    double
+    test_scan(const std::vector<float>& xb, int node) {
+        auto pool = std::make_shared<knowhere::ThreadPool>(threads_per_node_, node);
+        const size_t nb = xb.size() / dim_;
+        std::vector<float> sums(nq_);
+        CALC_TIME_SPAN({
+            std::vector<folly::Future<folly::Unit>> futs;
+            for (int32_t q = 0; q < nq_; q++) {
+                futs.emplace_back(pool->push([&, q] {
+                    const float* query = xq_.data() + (q % kQueryPool) * dim_;
+                    float sum = 0;
+                    for (size_t i = 0; i < nb; i++) {
+                        sum += faiss::fvec_L2sqr(query, xb.data() + i * dim_, dim_);
+                    }
+                    sums[q] = sum;
+                }));
+            }
+            for (auto& fut : futs) {
+                fut.wait();
+            }
+        });
+        EXPECT_GT(sums[0] + 1, 0);
+        return t_diff;
+    }
+
+    void
+    report(const char* name, size_t nb, double t) {
+        const double gb = static_cast<double>(nb) * dim_ * sizeof(float) * nq_ / (1 << 30);
+        printf("  %-28s : %10.3f ms/query, %8.2f GB/s\n", name, t * 1e3 / nq_ * threads_per_node_, gb / t);
+    }
+
+    void
+    test_all(size_t nb) {
+        const auto& nodes = knowhere::Numa::Nodes();
+        std::vector<float> xb(nb * dim_);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> distrib(0, 1);
+        for (auto& v : xb) {
+            v = distrib(rng);
+        }
+
+        printf("\n[%0.3f s] nb = %ld, dim = %d, nq = %d, nodes = %ld, threads per node = %d\n", get_time_diff(), nb,
+               dim_, nq_, nodes.size(), threads_per_node_);
+        printf("================================================================================\n");
+        if (nodes.size() < 2) {
+            printf("  single NUMA node, only the local placement can be measured\n");
+            report("local", nb, test_scan(xb, nodes.empty() ? -1 : nodes[0]));
+            printf("================================================================================\n");
+            std::fflush(stdout);
+            return;
+        }
+        knowhere::Numa::SetPolicy(knowhere::Numa::LOCAL);
+        for (int mem_node : nodes) {
+            ASSERT_TRUE(knowhere::Numa::PlaceMemory(xb.data(), xb.size() * sizeof(float), mem_node));
+            for (int cpu_node : nodes) {
+                const std::string name = std::string(mem_node == cpu_node ? "local " : "remote") +
+                                         " (memory " + std::to_string(mem_node) + ", cpus " +
+                                         std::to_string(cpu_node) + ")";
+                report(name.c_str(), nb, test_scan(xb, cpu_node));
+            }
+        }
+        knowhere::Numa::SetPolicy(knowhere::Numa::INTERLEAVE);
+        ASSERT_TRUE(knowhere::Numa::PlaceMemory(xb.data(), xb.size() * sizeof(float), -1));
+        for (int cpu_node : nodes) {
+            const std::string name = "interleaved (cpus " + std::to_string(cpu_node) + ")";
+            report(name.c_str(), nb, test_scan(xb, cpu_node));
+        }
+        knowhere::Numa::SetPolicy(knowhere::Numa::OFF);
+        printf("================================================================================\n");
+        std::fflush(stdout);
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+        const auto& nodes = knowhere::Numa::Nodes();
+        threads_per_node_ = nodes.empty() ? 1 : std::max<int32_t>(1, knowhere::Numa::NodeCpus(nodes[0]).size());
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> distrib(0, 1);
+        xq_.resize(kQueryPool * dim_);
+        for (auto& v : xq_) {
+            v = distrib(rng);
+        }
+    }
+
+ protected:
+    static constexpr int32_t kQueryPool = 64;
+    const int32_t dim_ = 128;
+    const int32_t nq_ = 256;
+    int32_t threads_per_node_ = 1;
+    std::vector<float> xq_;
+};
+
+TEST_F(Benchmark_numa, TEST_1M) {
+    test_all(1000000);
+}
+
+TEST_F(Benchmark_numa, TEST_10M) {
+    test_all(10000000);
+}
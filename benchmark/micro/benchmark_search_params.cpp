@@ -0,0 +1,96 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/factory.h"
+
+// Per-call overhead of turning the search json into a config, measured with nq = 1 searches on a tiny HNSW index
+// so that the search itself costs as little as possible.
+class Benchmark_search_params : public Benchmark_base, public ::testing::Test {
+ public:
+    void
+    test_hnsw(const knowhere::Json& search_json) {
+        auto index = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        knowhere::Json build_json = search_json;
+        build_json[knowhere::indexparam::HNSW_M] = 16;
+        build_json[knowhere::indexparam::EFCONSTRUCTION] = 100;
+        ASSERT_EQ(index.Build(*knowhere::GenDataSet(nb_, dim_, xb_.data()), build_json), knowhere::Status::success);
+
+        std::vector<knowhere::DataSetPtr> queries;
+        for (int32_t i = 0; i < nq_; i++) {
+            queries.push_back(knowhere::GenDataSet(1, dim_, xb_.data() + (i % nb_) * dim_));
+        }
+
+        printf("\n[%0.3f s] nb = %d, dim = %d, nq = 1, calls = %d\n", get_time_diff(), nb_, dim_, nq_);
+        printf("================================================================================\n");
+        // what every Search(json) call did before: create, format, load and check a fresh config
+        int64_t failed = 0;
+        CALC_TIME_SPAN(for (auto& query : queries) {
+            auto params = index.CompileSearchParams(search_json);
+            failed += !index.Search(*query, *params.value(), nullptr).has_value();
+        });
+        auto t_compile = t_diff;
+        printf("  compile per call    : %10.3f us/call\n", t_compile * 1e6 / nq_);
+        {
+            CALC_TIME_SPAN(for (auto& query : queries) {
+                failed += !index.Search(*query, search_json, nullptr).has_value();
+            });
+            printf("  json, cached params : %10.3f us/call\n", t_diff * 1e6 / nq_);
+        }
+        {
+            auto params = index.CompileSearchParams(search_json);
+            CALC_TIME_SPAN(for (auto& query : queries) {
+                failed += !index.Search(*query, *params.value(), nullptr).has_value();
+            });
+            printf("  precompiled params  : %10.3f us/call\n", t_diff * 1e6 / nq_);
+        }
+        printf("================================================================================\n");
+        std::fflush(stdout);
+        EXPECT_EQ(failed, 0);
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+        xb_.resize(nb_ * dim_);
+        for (auto& v : xb_) {
+            v = distrib(rng);
+        }
+    }
+
+ protected:
+    const int32_t nb_ = 1000;
+    const int32_t dim_ = 16;
+    const int32_t nq_ = 100000;
+    std::vector<float> xb_;
+};
+
+TEST_F(Benchmark_search_params, TEST_HNSW) {
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim_;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = 10;
+    json[knowhere::indexparam::EF] = 16;
+    test_hnsw(json);
+}
@@ -0,0 +1,99 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "hnswlib/visited_list_pool.h"
+
+// Per-query cost of the HNSW visited set, measured on the access pattern of one level-0 search: every
+// expanded node tests and marks all of its M0 neighbors.
+class Benchmark_visited_list : public Benchmark_base, public ::testing::Test {
+ public:
+    // the std::vector<bool> + std::fill scheme used before the epoch tagged pool
+    double
+    test_fill_vector(size_t nb, const std::vector<uint32_t>& visits) {
+        std::vector<bool> visited(nb, false);
+        size_t hit = 0;
+        CALC_TIME_SPAN(for (int32_t q = 0; q < nq_; q++) {
+            std::fill(visited.begin(), visited.end(), false);
+            for (auto v : visits) {
+                hit += visited[v];
+                visited[v] = true;
+            }
+        });
+        EXPECT_GT(hit + 1, 0);
+        return t_diff;
+    }
+
+    double
+    test_pool(size_t nb, const std::vector<uint32_t>& visits, size_t expected_visits) {
+        hnswlib::VisitedListPool pool(nb);
+        size_t hit = 0;
+        CALC_TIME_SPAN(for (int32_t q = 0; q < nq_; q++) {
+            auto visited_handle = pool.getFreeVisitedList(expected_visits);
+            auto& visited = *visited_handle;
+            for (auto v : visits) {
+                hit += visited.get(v);
+                visited.set(v);
+            }
+        });
+        EXPECT_GT(hit + 1, 0);
+        return t_diff;
+    }
+
+    void
+    test_all(size_t nb) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> distrib(0, nb - 1);
+        std::vector<uint32_t> visits(ef_ * M0_);
+        for (auto& v : visits) {
+            v = distrib(rng);
+        }
+
+        printf("\n[%0.3f s] nb = %ld, ef = %d, M0 = %d, nq = %d\n", get_time_diff(), nb, ef_, M0_, nq_);
+        printf("================================================================================\n");
+        auto t_fill = test_fill_vector(nb, visits);
+        printf("  vector<bool> + fill : %10.3f us/query\n", t_fill * 1e6 / nq_);
+        auto t_dense = test_pool(nb, visits, nb);
+        printf("  epoch tags (dense)  : %10.3f us/query\n", t_dense * 1e6 / nq_);
+        auto t_sparse = test_pool(nb, visits, visits.size());
+        printf("  hash set (sparse)   : %10.3f us/query\n", t_sparse * 1e6 / nq_);
+        printf("================================================================================\n");
+        std::fflush(stdout);
+    }
+
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+    }
+
+ protected:
+    const int32_t nq_ = 1000;
+    const int32_t ef_ = 64;
+    const int32_t M0_ = 32;
+};
+
+TEST_F(Benchmark_visited_list, TEST_1M) {
+    test_all(1000000);
+}
+
+TEST_F(Benchmark_visited_list, TEST_10M) {
+    test_all(10000000);
+}
+
+TEST_F(Benchmark_visited_list, TEST_50M) {
+    test_all(50000000);
+}
@@ -19,6 +19,7 @@ set(DISKANN_SOURCES
     thirdparty/DiskANN/src/partition_and_pq.cpp
     thirdparty/DiskANN/src/pq_flash_index.cpp
     thirdparty/DiskANN/src/logger.cpp
+    thirdparty/DiskANN/src/uring_aligned_file_reader.cpp
     thirdparty/DiskANN/src/utils.cpp)
 
 add_library(diskann STATIC ${DISKANN_SOURCES})
@@ -13,10 +13,28 @@
 #define BITSET_H
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <utility>
 
 namespace knowhere {
+
+// What is worth computing once per request over a bitset rather than once per query, filled lazily by the first
+// search that asks for it and shared by every copy of the views that point to it (see PreparedBitset)
+class BitsetViewCache {
+ public:
+    virtual ~BitsetViewCache() = default;
+
+    virtual size_t
+    count() const = 0;
+
+    // sorted ids of the bits that are not set, nullptr if the bitset keeps too many of them for a list to pay off
+    virtual const int64_t*
+    id_list() const = 0;
+};
+
 class BitsetView {
  public:
     BitsetView() = default;
@@ -25,6 +43,11 @@ class BitsetView {
     BitsetView(const uint8_t* data, size_t num_bits) : bits_(data), num_bits_(num_bits) {
     }
 
+    // a view whose count() and id list come from a cache that must outlive the view
+    BitsetView(const uint8_t* data, size_t num_bits, const BitsetViewCache* cache)
+        : bits_(data), num_bits_(num_bits), cache_(cache) {
+    }
+
     BitsetView(const std::nullptr_t) : BitsetView() {
     }
 
@@ -53,8 +76,35 @@ class BitsetView {
         return bits_[index >> 3] & (0x1 << (index & 0x7));
     }
 
+    // whether count() and the id list are computed at most once, by the first caller
+    bool
+    has_cache() const {
+        return cache_ != nullptr;
+    }
+
+    // builds the id list on the first call if the bitset is selective enough, so only to be asked by the searches
+    // that visit the listed ids
+    bool
+    has_id_list() const {
+        return id_list() != nullptr;
+    }
+
+    // ids of the bits that are not set in ascending order, nullptr if there is no id list
+    const int64_t*
+    id_list() const {
+        return cache_ != nullptr ? cache_->id_list() : nullptr;
+    }
+
+    size_t
+    id_list_size() const {
+        return num_bits_ - count();
+    }
+
     size_t
     count() const {
+        if (cache_ != nullptr) {
+            return cache_->count();
+        }
         size_t ret = 0;
         auto len_uint8 = byte_size();
         auto len_uint64 = len_uint8 >> 3;
@@ -82,6 +132,26 @@ class BitsetView {
         return ret;
     }
 
+    // calls f(id) for every set bit in ascending order
+    template <typename F>
+    void
+    for_each_set(F&& f) const {
+        for_each_word(0, std::forward<F>(f));
+    }
+
+    // calls f(id) for every bit that is not set in ascending order
+    template <typename F>
+    void
+    for_each_unset(F&& f) const {
+        if (auto ids = id_list(); ids != nullptr) {
+            for (size_t i = 0, n = id_list_size(); i < n; i++) {
+                f(ids[i]);
+            }
+            return;
+        }
+        for_each_word(~uint64_t(0), std::forward<F>(f));
+    }
+
     std::string
     to_string(size_t from, size_t to) const {
         if (empty()) {
@@ -96,8 +166,28 @@ class BitsetView {
     }
 
  private:
+    // scans the bitset one 64-bit word at a time, the words are xor-ed with flip before their bits are visited
+    template <typename F>
+    void
+    for_each_word(uint64_t flip, F&& f) const {
+        for (size_t base = 0; base < num_bits_; base += 64) {
+            uint64_t word = 0;
+            const size_t rest = num_bits_ - base;
+            memcpy(&word, bits_ + (base >> 3), rest >= 64 ? 8 : (rest + 7) >> 3);
+            word ^= flip;
+            if (rest < 64) {
+                word &= (uint64_t(1) << rest) - 1;
+            }
+            while (word != 0) {
+                f(static_cast<int64_t>(base + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
     const uint8_t* bits_ = nullptr;
     size_t num_bits_ = 0;
+    const BitsetViewCache* cache_ = nullptr;
 };
 }  // namespace knowhere
 
@@ -25,11 +25,18 @@ constexpr const char* INDEX_FAISS_BIN_IDMAP = "BIN_FLAT";
 constexpr const char* INDEX_FAISS_BIN_IVFFLAT = "BIN_IVF_FLAT";
 
 constexpr const char* INDEX_FAISS_IDMAP = "FLAT";
+constexpr const char* INDEX_FAISS_IDMAP_FP16 = "FLAT_FP16";
+constexpr const char* INDEX_FAISS_IDMAP_BF16 = "FLAT_BF16";
 constexpr const char* INDEX_FAISS_IVFFLAT = "IVF_FLAT";
 constexpr const char* INDEX_FAISS_IVFFLAT_CC = "IVF_FLAT_CC";
 constexpr const char* INDEX_FAISS_IVFPQ = "IVF_PQ";
 constexpr const char* INDEX_FAISS_SCANN = "SCANN";
+constexpr const char* INDEX_FAISS_IVFPQ_FASTSCAN = "IVF_PQ_FS";
 constexpr const char* INDEX_FAISS_IVFSQ8 = "IVF_SQ8";
+constexpr const char* INDEX_FAISS_IVFSQ4 = "IVF_SQ4";
+constexpr const char* INDEX_FAISS_IVFSQ6 = "IVF_SQ6";
+constexpr const char* INDEX_FAISS_IVFFP16 = "IVF_FP16";
+constexpr const char* INDEX_FAISS_IVFBF16 = "IVF_BF16";
 
 constexpr const char* INDEX_FAISS_GPU_IDMAP = "GPU_FAISS_FLAT";
 constexpr const char* INDEX_FAISS_GPU_IVFFLAT = "GPU_FAISS_IVF_FLAT";
@@ -41,6 +48,9 @@ constexpr const char* INDEX_RAFT_IVFPQ = "GPU_RAFT_IVF_PQ";
 constexpr const char* INDEX_RAFT_CAGRA = "GPU_RAFT_CAGRA";
 
 constexpr const char* INDEX_HNSW = "HNSW";
+constexpr const char* INDEX_HNSW_FP16 = "HNSW_FP16";
+constexpr const char* INDEX_HNSW_BF16 = "HNSW_BF16";
+constexpr const char* INDEX_HNSW_SQ8 = "HNSW_SQ8";
 constexpr const char* INDEX_DISKANN = "DISKANN";
 
 }  // namespace IndexEnum
@@ -74,12 +84,17 @@ constexpr const char* NBITS = "nbits";  // PQ/SQ
 constexpr const char* M = "m";          // PQ param for IVFPQ
 constexpr const char* SSIZE = "ssize";
 constexpr const char* REORDER_K = "reorder_k";
+constexpr const char* REFINE_TYPE = "refine_type";  // NONE, SQ8, FP16 or FLAT, the rerank codec of IVF_PQ_FS
+constexpr const char* QUANTIZER_PATH = "quantizer_path";  // file of a trained IVF index whose quantizer is reused
 
 // HNSW Params
 constexpr const char* EFCONSTRUCTION = "efConstruction";
 constexpr const char* HNSW_M = "M";
 constexpr const char* EF = "ef";
 constexpr const char* OVERVIEW_LEVELS = "overview_levels";
+constexpr const char* OPTIMIZE_LAYOUT = "optimize_layout";
+constexpr const char* ENTRY_CACHE_SIZE = "entry_cache_size";
+constexpr const char* QUERY_GROUP_SIZE = "query_group_size";
 }  // namespace indexparam
 
 using MetricType = std::string;
@@ -74,6 +74,44 @@ class KnowhereConfig {
     static void
     SetClusteringType(const ClusteringType clustering_type);
 
+    /**
+     * set the fraction of search calls [0, 1] that record a per stage latency breakdown and work counters (hops,
+     * distance computations, lists scanned, disk reads) into the prometheus histograms. 0 disables the sampling, the
+     * default is 0.01.
+     */
+    static void
+    SetSearchStatsSampleRate(const double sample_rate);
+
+    static double
+    GetSearchStatsSampleRate();
+
+    /**
+     * set NUMA placement of the in-memory indexes
+     */
+    enum NumaPolicy {
+        NUMA_OFF = 0,     // no placement, all searches on the global search thread pool (default)
+        NUMA_LOCAL,       // each loaded index is moved to one node and searched by a thread pool pinned to it, see
+                          // SetNumaSearchThreads
+        NUMA_INTERLEAVE,  // index memory is interleaved over the nodes, searches on the global search thread pool
+    };
+
+    static void
+    SetNumaPolicy(const NumaPolicy numa_policy);
+
+    static NumaPolicy
+    GetNumaPolicy();
+
+    /**
+     * set the number of search threads pinned to the NUMA nodes, which the indexes placed under NUMA_LOCAL search on.
+     * They are split between the nodes in proportion to their cpus and come on top of the global search thread pool.
+     * 0, the default, keeps every search on the global search thread pool.
+     */
+    static void
+    SetNumaSearchThreads(const uint32_t num_threads);
+
+    static uint32_t
+    GetNumaSearchThreads();
+
     /**
      * The numebr of maximum parallel disk reads per thread.
      * On Linux, the default limit of `aio-max-nr` is 65536, so the product of `num_threads` and `max_events` (default
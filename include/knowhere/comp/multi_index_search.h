@@ -0,0 +1,45 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef MULTI_INDEX_SEARCH_H
+#define MULTI_INDEX_SEARCH_H
+
+#include <vector>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/dataset.h"
+#include "knowhere/index.h"
+
+namespace knowhere {
+
+// Top-k search over a set of indexes (the segments of a collection) as if they were a single one.
+//
+// The search json is compiled once per index type and every bitset is prepared once, then the (index, query block)
+// pairs are searched as independent tasks of the global search thread pool, each one running its index search in
+// place instead of fanning it out again. The results of a task are merged into per-query heaps as soon as it is
+// done, and the merge of a query stops at the first result of a segment that cannot beat the current k-th one.
+//
+// The id of a result is its id in its index plus the number of rows (Count()) of the indexes before it in the list.
+class MultiIndexSearch {
+ public:
+    // bitsets is either empty (no filtering) or holds one bitset per index, an empty one for an unfiltered index
+    static expected<DataSetPtr>
+    Search(const std::vector<Index<IndexNode>>& indexes, const DataSet& dataset, const Json& json,
+           const std::vector<BitsetView>& bitsets);
+
+    static Status
+    SearchWithBuf(const std::vector<Index<IndexNode>>& indexes, const DataSet& dataset, const Json& json,
+                  const std::vector<BitsetView>& bitsets, int64_t* ids, float* distances);
+};
+
+}  // namespace knowhere
+
+#endif /* MULTI_INDEX_SEARCH_H */
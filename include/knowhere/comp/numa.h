@@ -0,0 +1,63 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace knowhere {
+
+// NUMA topology and memory placement, read from sysfs and applied with the mbind(2) family of syscalls so that no
+// libnuma is needed at build or run time. On a machine (or a cgroup) with a single usable node, or off Linux, every
+// call degrades to a no-op and the indexes keep using the global search pool.
+class Numa {
+ public:
+    enum Policy {
+        OFF = 0,     // memory stays where it was allocated, searches run on the global search pool
+        LOCAL,       // each index is moved to one node, round robin, and searched by the pool pinned to that node
+        INTERLEAVE,  // index memory is interleaved over all the nodes, searches run on the global search pool
+    };
+
+    static void
+    SetPolicy(Policy policy);
+
+    static Policy
+    GetPolicy();
+
+    // the online nodes that have at least one cpu this process may run on
+    static const std::vector<int>&
+    Nodes();
+
+    // the cpus of a node this process may run on, empty for an unknown node
+    static const std::vector<int>&
+    NodeCpus(int node);
+
+    // The node the next index should live on under the LOCAL policy, -1 under the other policies or on a single node
+    // machine.
+    static int
+    ChooseNode();
+
+    // Applies the policy to the pages of [addr, addr + size): prefers the given node when it is not -1, interleaves
+    // them under INTERLEAVE. Pages already touched are migrated. Returns false if the kernel refused.
+    static bool
+    PlaceMemory(void* addr, size_t size, int node);
+
+    // the node of the page holding addr, -1 if it is unknown
+    static int
+    NodeOfAddress(const void* addr);
+
+    // restricts the calling thread to the cpus of a node
+    static bool
+    PinCurrentThread(int node);
+};
+
+}  // namespace knowhere
@@ -0,0 +1,157 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace knowhere {
+
+// Per stage breakdown of one sampled Search or RangeSearch call. Index nodes capture SearchStats::Active() on the
+// calling thread before handing queries to the search pool, keep their counters in locals while a task runs and merge
+// them once at the end of the task, so unsampled calls pay a single null check per task.
+class SearchStats {
+ public:
+    enum Stage {
+        PARSE = 0,  // config parsing and validation
+        BITSET,     // bitset preparation
+        QUANTIZE,   // coarse quantization (IVF)
+        SCAN,       // list scans, graph traversal or brute force distance computations
+        IO,         // disk reads (DiskANN)
+        TOTAL,      // the whole node search
+        NUM_STAGES,
+    };
+
+    enum Counter {
+        HOPS = 0,               // graph nodes expanded
+        DISTANCE_COMPUTATIONS,  // full or quantized distances computed
+        LISTS_SCANNED,          // inverted lists visited
+        DISK_READS,             // sectors read from disk
+        CACHE_HITS,             // nodes served from the DiskANN node cache
+        NUM_COUNTERS,
+    };
+
+    static const char*
+    StageName(Stage stage);
+
+    static const char*
+    CounterName(Counter counter);
+
+    // the stats of the sampled search running on this thread, nullptr when the current call is not sampled
+    static SearchStats*
+    Active();
+
+    // fraction of the search calls that are sampled, in [0, 1]
+    static void
+    SetSampleRate(double rate);
+
+    static double
+    GetSampleRate();
+
+    void
+    AddTime(Stage stage, std::chrono::nanoseconds span) {
+        stage_ns_[stage].fetch_add(span.count(), std::memory_order_relaxed);
+    }
+
+    void
+    Add(Counter counter, uint64_t value) {
+        counters_[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void
+    SetIndexType(std::string index_type) {
+        index_type_ = std::move(index_type);
+    }
+
+    const std::string&
+    IndexType() const {
+        return index_type_;
+    }
+
+    void
+    SetQueries(int64_t nq) {
+        nq_ = nq;
+    }
+
+    int64_t
+    Queries() const {
+        return nq_;
+    }
+
+    // summed over the threads that worked on the call, so it can exceed the wall time
+    double
+    StageMicros(Stage stage) const {
+        return stage_ns_[stage].load(std::memory_order_relaxed) * 0.001;
+    }
+
+    uint64_t
+    Count(Counter counter) const {
+        return counters_[counter].load(std::memory_order_relaxed);
+    }
+
+ private:
+    std::array<std::atomic<int64_t>, NUM_STAGES> stage_ns_{};
+    std::array<std::atomic<uint64_t>, NUM_COUNTERS> counters_{};
+    std::string index_type_;
+    int64_t nq_ = 0;
+};
+
+// Decides whether a search call is sampled and makes its stats active on the calling thread. Scopes nest: the
+// outermost one takes the sampling decision and publishes the per query averages to prometheus when it closes.
+class SearchStatsScope {
+ public:
+    explicit SearchStatsScope(bool range_search);
+    ~SearchStatsScope();
+
+    SearchStatsScope(const SearchStatsScope&) = delete;
+    SearchStatsScope&
+    operator=(const SearchStatsScope&) = delete;
+
+    SearchStats*
+    Get() const {
+        return SearchStats::Active();
+    }
+
+ private:
+    std::unique_ptr<SearchStats> stats_;
+    bool range_search_;
+};
+
+// Adds the time from construction to destruction to a stage, does nothing without stats.
+class SearchStageTimer {
+    using clock = std::chrono::steady_clock;
+
+ public:
+    SearchStageTimer(SearchStats* stats, SearchStats::Stage stage) : stats_(stats), stage_(stage) {
+        if (stats_ != nullptr) {
+            start_ = clock::now();
+        }
+    }
+
+    ~SearchStageTimer() {
+        if (stats_ != nullptr) {
+            stats_->AddTime(stage_, clock::now() - start_);
+        }
+    }
+
+ private:
+    SearchStats* stats_;
+    SearchStats::Stage stage_;
+    clock::time_point start_;
+};
+
+}  // namespace knowhere
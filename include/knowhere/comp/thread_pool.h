@@ -13,11 +13,20 @@
 
 #include <omp.h>
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
 
 #include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/executors/InlineExecutor.h"
+#include "folly/executors/thread_factory/InitThreadFactory.h"
+#include "folly/executors/thread_factory/NamedThreadFactory.h"
 #include "folly/futures/Future.h"
+#include "knowhere/comp/numa.h"
 #include "knowhere/log.h"
 
 namespace knowhere {
@@ -32,6 +41,22 @@ class ThreadPool {
                   num_threads * kTaskQueueFactor))) {
     }
 
+    // a pool whose threads only run on the cpus of a NUMA node
+    ThreadPool(uint32_t num_threads, int numa_node)
+        : pool_(folly::CPUThreadPoolExecutor(
+              num_threads,
+              std::make_unique<
+                  folly::LifoSemMPMCQueue<folly::CPUThreadPoolExecutor::CPUTask, folly::QueueBehaviorIfFull::BLOCK>>(
+                  num_threads * kTaskQueueFactor),
+              std::make_shared<folly::InitThreadFactory>(
+                  std::make_shared<folly::NamedThreadFactory>("KnowhereNuma" + std::to_string(numa_node) + "-"),
+                  [numa_node] {
+                      if (!Numa::PinCurrentThread(numa_node)) {
+                          LOG_KNOWHERE_WARNING_ << "failed to pin a search thread to NUMA node " << numa_node;
+                      }
+                  }))) {
+    }
+
     ThreadPool(const ThreadPool&) = delete;
 
     ThreadPool&
@@ -45,8 +70,13 @@ class ThreadPool {
     template <typename Func, typename... Args>
     auto
     push(Func&& func, Args&&... args) {
-        return folly::makeSemiFuture().via(&pool_).then(
-            [func = std::forward<Func>(func), &args...](auto&&) mutable { return func(std::forward<Args>(args)...); });
+        auto task = [func = std::forward<Func>(func), &args...](auto&&) mutable {
+            return func(std::forward<Args>(args)...);
+        };
+        if (run_inline_) {
+            return folly::makeSemiFuture().via(&folly::InlineExecutor::instance()).then(std::move(task));
+        }
+        return folly::makeSemiFuture().via(&pool_).then(std::move(task));
     }
 
     [[nodiscard]] int32_t
@@ -122,6 +152,74 @@ class ThreadPool {
         return pool;
     }
 
+    /**
+     * @brief Set the threads number of the search thread pools pinned to the NUMA nodes, which the indexes placed
+     * under the LOCAL policy search on. They come on top of the global search thread pool and are split between the
+     * nodes in proportion to their cpus. The pools already created are resized. 0, the default, keeps every index on
+     * the global search thread pool.
+     *
+     * @param num_threads
+     */
+    static void
+    InitNumaSearchThreadPools(uint32_t num_threads) {
+        std::lock_guard<std::mutex> lock(global_thread_pool_mutex_);
+        numa_search_thread_pool_size_ = num_threads;
+        for (auto& [node, pool] : numa_search_thread_pools_) {
+            const uint32_t node_threads = NumaNodeThreads(node);
+            LOG_KNOWHERE_INFO_ << "Resize search ThreadPool of NUMA node " << node << " to threads num: "
+                               << node_threads;
+            pool->pool_.setNumThreads(node_threads);
+        }
+    }
+
+    static uint32_t
+    GetNumaSearchThreadPoolsSize() {
+        std::lock_guard<std::mutex> lock(global_thread_pool_mutex_);
+        return numa_search_thread_pool_size_;
+    }
+
+    /**
+     * @brief Get the search thread pool pinned to a NUMA node, for the indexes whose memory lives on that node. The
+     * global search thread pool is returned while no threads are set aside for the node pools (see
+     * InitNumaSearchThreadPools), and for node -1, the value Numa::ChooseNode() gives when the placement is off or
+     * pointless.
+     */
+    static std::shared_ptr<ThreadPool>
+    GetSearchThreadPool(int numa_node) {
+        if (numa_node < 0 || Numa::NodeCpus(numa_node).empty()) {
+            return GetGlobalSearchThreadPool();
+        }
+        {
+            std::lock_guard<std::mutex> lock(global_thread_pool_mutex_);
+            if (numa_search_thread_pool_size_ > 0) {
+                auto& pool = numa_search_thread_pools_[numa_node];
+                if (pool == nullptr) {
+                    const uint32_t node_threads = NumaNodeThreads(numa_node);
+                    LOG_KNOWHERE_INFO_ << "Init search ThreadPool of NUMA node " << numa_node
+                                       << " with threads num: " << node_threads;
+                    pool = std::make_shared<ThreadPool>(node_threads, numa_node);
+                }
+                return pool;
+            }
+        }
+        return GetGlobalSearchThreadPool();
+    }
+
+    // Runs the tasks that the current thread pushes to any pool in place, before push returns, for the lifetime of
+    // the scope. A task that searches an index from a pool thread sets it, as the search would otherwise queue its
+    // own tasks behind the ones that wait for them.
+    class ScopedInline {
+        bool inline_before;
+
+     public:
+        ScopedInline() : inline_before(run_inline_) {
+            run_inline_ = true;
+        }
+        ~ScopedInline() {
+            run_inline_ = inline_before;
+        }
+    };
+
     class ScopedOmpSetter {
         int omp_before;
 
@@ -135,10 +233,24 @@ class ThreadPool {
     };
 
  private:
+    // the share of the NUMA search threads a node gets, at least one
+    static uint32_t
+    NumaNodeThreads(int numa_node) {
+        size_t total_cpus = 0;
+        for (int node : Numa::Nodes()) {
+            total_cpus += Numa::NodeCpus(node).size();
+        }
+        return std::max<uint32_t>(
+            1, static_cast<uint64_t>(numa_search_thread_pool_size_) * Numa::NodeCpus(numa_node).size() / total_cpus);
+    }
+
     folly::CPUThreadPoolExecutor pool_;
     inline static uint32_t global_build_thread_pool_size_ = 0;
     inline static uint32_t global_search_thread_pool_size_ = 0;
     inline static std::mutex global_thread_pool_mutex_;
+    inline static uint32_t numa_search_thread_pool_size_ = 0;
+    inline static std::map<int, std::shared_ptr<ThreadPool>> numa_search_thread_pools_;
+    inline static thread_local bool run_inline_ = false;
     constexpr static size_t kTaskQueueFactor = 16;
 };
 }  // namespace knowhere
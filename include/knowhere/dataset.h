@@ -13,6 +13,7 @@
 #define DATASET_H
 
 #include <any>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -29,71 +30,44 @@ class DataSet {
     typedef std::variant<const float*, const size_t*, const int64_t*, const void*, int64_t, std::string, std::any> Var;
     DataSet() = default;
     ~DataSet() {
-        if (!is_owner) {
+        // buffers handed over with an owner are released by it
+        if (!is_owner || buffer_owner_ != nullptr) {
             return;
         }
-        for (auto&& x : this->data_) {
-            {
-                auto ptr = std::get_if<0>(&x.second);
-                if (ptr != nullptr) {
-                    delete[] * ptr;
-                }
-            }
-            {
-                auto ptr = std::get_if<1>(&x.second);
-                if (ptr != nullptr) {
-                    delete[] * ptr;
-                }
-            }
-            {
-                auto ptr = std::get_if<2>(&x.second);
-                if (ptr != nullptr) {
-                    delete[] * ptr;
-                }
-            }
-            {
-                auto ptr = std::get_if<3>(&x.second);
-                if (ptr != nullptr) {
-                    delete[](char*)(*ptr);
-                }
-            }
-        }
+        delete[] distance_.load();
+        delete[] lims_.load();
+        delete[] ids_.load();
+        delete[](char*)(tensor_.load());
     }
 
     void
     SetDistance(const float* dis) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::DISTANCE] = Var(std::in_place_index<0>, dis);
+        distance_.store(dis, std::memory_order_release);
     }
 
     void
     SetLims(const size_t* lims) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::LIMS] = Var(std::in_place_index<1>, lims);
+        lims_.store(lims, std::memory_order_release);
     }
 
     void
     SetIds(const int64_t* ids) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::IDS] = Var(std::in_place_index<2>, ids);
+        ids_.store(ids, std::memory_order_release);
     }
 
     void
     SetTensor(const void* tensor) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::TENSOR] = Var(std::in_place_index<3>, tensor);
+        tensor_.store(tensor, std::memory_order_release);
     }
 
     void
     SetRows(const int64_t rows) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::ROWS] = Var(std::in_place_index<4>, rows);
+        rows_.store(rows, std::memory_order_release);
     }
 
     void
     SetDim(const int64_t dim) {
-        std::unique_lock lock(mutex_);
-        this->data_[meta::DIM] = Var(std::in_place_index<4>, dim);
+        dim_.store(dim, std::memory_order_release);
     }
 
     void
@@ -110,68 +84,32 @@ class DataSet {
 
     const float*
     GetDistance() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::DISTANCE);
-        if (it != this->data_.end()) {
-            const float* res = *std::get_if<0>(&it->second);
-            return res;
-        }
-        return nullptr;
+        return distance_.load(std::memory_order_acquire);
     }
 
     const size_t*
     GetLims() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::LIMS);
-        if (it != this->data_.end()) {
-            const size_t* res = *std::get_if<1>(&it->second);
-            return res;
-        }
-        return nullptr;
+        return lims_.load(std::memory_order_acquire);
     }
 
     const int64_t*
     GetIds() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::IDS);
-        if (it != this->data_.end()) {
-            const int64_t* res = *std::get_if<2>(&it->second);
-            return res;
-        }
-        return nullptr;
+        return ids_.load(std::memory_order_acquire);
     }
 
     const void*
     GetTensor() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::TENSOR);
-        if (it != this->data_.end()) {
-            const void* res = *std::get_if<3>(&it->second);
-            return res;
-        }
-        return nullptr;
+        return tensor_.load(std::memory_order_acquire);
     }
 
     int64_t
     GetRows() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::ROWS);
-        if (it != this->data_.end()) {
-            int64_t res = *std::get_if<4>(&it->second);
-            return res;
-        }
-        return 0;
+        return rows_.load(std::memory_order_acquire);
     }
 
     int64_t
     GetDim() const {
-        std::shared_lock lock(mutex_);
-        auto it = this->data_.find(meta::DIM);
-        if (it != this->data_.end()) {
-            int64_t res = *std::get_if<4>(&it->second);
-            return res;
-        }
-        return 0;
+        return dim_.load(std::memory_order_acquire);
     }
 
     std::string
@@ -202,6 +140,14 @@ class DataSet {
         this->is_owner = is_owner;
     }
 
+    // Keeps externally allocated buffers (a caller's pool or a search arena) alive as long as the dataset, which then
+    // never frees the ids, distances, lims or tensor itself.
+    void
+    SetBufferOwner(std::shared_ptr<void> owner) {
+        std::unique_lock lock(mutex_);
+        buffer_owner_ = std::move(owner);
+    }
+
     // deprecated API
     template <typename T>
     void
@@ -222,8 +168,16 @@ class DataSet {
     }
 
  private:
+    // the fields read on every search result are typed, the map only holds the json info and the deprecated values
+    std::atomic<const float*> distance_{nullptr};
+    std::atomic<const size_t*> lims_{nullptr};
+    std::atomic<const int64_t*> ids_{nullptr};
+    std::atomic<const void*> tensor_{nullptr};
+    std::atomic<int64_t> rows_{0};
+    std::atomic<int64_t> dim_{0};
     mutable std::shared_mutex mutex_;
     std::map<std::string, Var> data_;
+    std::shared_ptr<void> buffer_owner_;
     bool is_owner = true;
 };
 using DataSetPtr = std::shared_ptr<DataSet>;
@@ -281,6 +235,19 @@ GenResultDataSet(const int64_t nq, const int64_t* ids, const float* distance, co
     return ret_ds;
 }
 
+// range search result whose buffers live in owner
+inline DataSetPtr
+GenResultDataSet(const int64_t nq, const int64_t* ids, const float* distance, const size_t* lims,
+                 std::shared_ptr<void> owner) {
+    auto ret_ds = std::make_shared<DataSet>();
+    ret_ds->SetRows(nq);
+    ret_ds->SetIds(ids);
+    ret_ds->SetDistance(distance);
+    ret_ds->SetLims(lims);
+    ret_ds->SetBufferOwner(std::move(owner));
+    return ret_ds;
+}
+
 inline DataSetPtr
 GenResultDataSet(const std::string& json_info, const std::string& json_id_set) {
     auto ret_ds = std::make_shared<DataSet>();
@@ -39,6 +39,7 @@ enum class Status {
     arithmetic_overflow = 17,
     raft_inner_error = 18,
     invalid_binary_set = 19,
+    build_cancelled = 20,
 };
 
 template <typename T>
@@ -17,9 +17,16 @@
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #include "knowhere/index_node.h"
+#include "knowhere/search_params.h"
 
 namespace knowhere {
 
+// LRU of compiled search params keyed by the search json, shared by all the handles of one index
+class SearchParamsCache;
+
+std::shared_ptr<SearchParamsCache>
+CreateSearchParamsCache();
+
 template <typename T1>
 class Index {
  public:
@@ -42,6 +49,7 @@ class Index {
         }
         idx.node->IncRef();
         node = idx.node;
+        params_cache = idx.params_cache;
     }
 
     Index(Index<T1>&& idx) {
@@ -51,6 +59,7 @@ class Index {
         }
         node = idx.node;
         idx.node = nullptr;
+        params_cache = std::move(idx.params_cache);
     }
 
     template <typename T2>
@@ -62,6 +71,7 @@ class Index {
         }
         idx.node->IncRef();
         node = idx.node;
+        params_cache = idx.params_cache;
     }
 
     template <typename T2>
@@ -73,6 +83,7 @@ class Index {
         }
         node = idx.node;
         idx.node = nullptr;
+        params_cache = std::move(idx.params_cache);
     }
 
     template <typename T2>
@@ -86,10 +97,12 @@ class Index {
         }
         if (idx.node == nullptr) {
             node = nullptr;
+            params_cache = nullptr;
             return *this;
         }
         node = idx.node;
         node->IncRef();
+        params_cache = idx.params_cache;
         return *this;
     }
 
@@ -104,6 +117,7 @@ class Index {
         }
         node = idx.node;
         idx.node = nullptr;
+        params_cache = std::move(idx.params_cache);
         return *this;
     }
 
@@ -124,12 +138,35 @@ class Index {
     Status
     Add(const DataSet& dataset, const Json& json);
 
+    void
+    SetBuildProgressCallback(BuildProgressCallback callback);
+
     expected<DataSetPtr>
     Search(const DataSet& dataset, const Json& json, const BitsetView& bitset) const;
 
     expected<DataSetPtr>
     RangeSearch(const DataSet& dataset, const Json& json, const BitsetView& bitset) const;
 
+    // Parses and checks a search (param_type SEARCH) or range search (RANGE_SEARCH) json once, so that the returned
+    // params can be passed to Search / RangeSearch on the hot path without any json processing.
+    expected<SearchParamsPtr>
+    CompileSearchParams(const Json& json, PARAM_TYPE param_type = PARAM_TYPE::SEARCH) const;
+
+    expected<DataSetPtr>
+    Search(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset) const;
+
+    expected<DataSetPtr>
+    RangeSearch(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset) const;
+
+    // Search into caller provided (e.g. pooled) buffers of nq * k ids and distances instead of a new result dataset.
+    Status
+    SearchWithBuf(const DataSet& dataset, const Json& json, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const;
+
+    Status
+    SearchWithBuf(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const;
+
     expected<DataSetPtr>
     GetVectorByIds(const DataSet& dataset) const;
 
@@ -160,6 +197,9 @@ class Index {
     std::string
     Type() const;
 
+    std::string
+    QuantizerId() const;
+
     ~Index() {
         if (node == nullptr)
             return;
@@ -169,11 +209,15 @@ class Index {
     }
 
  private:
-    Index(T1* node) : node(node) {
+    Index(T1* node) : node(node), params_cache(CreateSearchParamsCache()) {
         static_assert(std::is_base_of<IndexNode, T1>::value);
     }
 
+    expected<SearchParamsPtr>
+    GetSearchParams(const Json& json, PARAM_TYPE param_type) const;
+
     T1* node;
+    std::shared_ptr<SearchParamsCache> params_cache;
 };
 
 }  // namespace knowhere
@@ -12,6 +12,10 @@
 #ifndef INDEX_NODE_H
 #define INDEX_NODE_H
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
 #include "knowhere/binaryset.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/config.h"
@@ -21,6 +25,10 @@
 
 namespace knowhere {
 
+// Called during a build with the fraction of the work done so far. Returning false cancels the build, which then
+// fails with Status::build_cancelled. It may be called from any of the build threads, but never concurrently.
+using BuildProgressCallback = std::function<bool(float)>;
+
 class IndexNode : public Object {
  public:
     virtual Status
@@ -32,12 +40,33 @@ class IndexNode : public Object {
     virtual Status
     Train(const DataSet& dataset, const Config& cfg) = 0;
 
+    // only used by the indexes whose build reports progress (HNSW), the others ignore it
+    void
+    SetBuildProgressCallback(BuildProgressCallback callback) {
+        build_progress_callback_ = std::move(callback);
+    }
+
     virtual Status
     Add(const DataSet& dataset, const Config& cfg) = 0;
 
     virtual expected<DataSetPtr>
     Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const = 0;
 
+    // Writes the nq * k results into caller provided buffers, row major like BruteForce::SearchWithBuf. The default
+    // copies the result of Search, the nodes that can search straight into the buffers override it.
+    virtual Status
+    SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const {
+        auto res = Search(dataset, cfg, bitset);
+        if (!res.has_value()) {
+            return res.error();
+        }
+        const auto len = res.value()->GetRows() * res.value()->GetDim();
+        std::copy_n(res.value()->GetIds(), len, ids);
+        std::copy_n(res.value()->GetDistance(), len, distances);
+        return Status::success;
+    }
+
     virtual expected<DataSetPtr>
     RangeSearch(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const = 0;
 
@@ -74,8 +103,18 @@ class IndexNode : public Object {
     virtual std::string
     Type() const = 0;
 
+    // Identifies the coarse quantizer of an IVF index. Indexes with the same non-empty id, e.g. the segments built
+    // from one shared quantizer, assign every vector to the same lists. Empty for the other indexes.
+    virtual std::string
+    QuantizerId() const {
+        return "";
+    }
+
     virtual ~IndexNode() {
     }
+
+ protected:
+    BuildProgressCallback build_progress_callback_;
 };
 
 }  // namespace knowhere
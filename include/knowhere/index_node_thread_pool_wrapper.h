@@ -36,6 +36,10 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
     expected<DataSetPtr>
     Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override;
 
+    Status
+    SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
+
     expected<DataSetPtr>
     RangeSearch(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override;
 
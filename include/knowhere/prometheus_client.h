@@ -70,9 +70,16 @@ extern const std::unique_ptr<PrometheusClient> prometheusClient;
         prometheus::BuildHistogram().Name(#name).Help(desc).Register(knowhere::prometheusClient->GetRegistry()); \
     prometheus::Histogram& name = name##_family.Add({}, knowhere::buckets);
 
+// labeled histograms, the metrics are added to name##_family with their labels where they are observed
+#define DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(name, desc)         \
+    prometheus::Family<prometheus::Histogram>& name##_family = \
+        prometheus::BuildHistogram().Name(#name).Help(desc).Register(knowhere::prometheusClient->GetRegistry());
+
 #define DECLARE_PROMETHEUS_GAUGE(name_gauge) extern prometheus::Gauge& name_gauge;
 #define DECLARE_PROMETHEUS_COUNTER(name_counter) extern prometheus::Counter& name_counter;
 #define DECLARE_PROMETHEUS_HISTOGRAM(name_histogram) extern prometheus::Histogram& name_histogram;
+#define DECLARE_PROMETHEUS_HISTOGRAM_FAMILY(name_histogram) \
+    extern prometheus::Family<prometheus::Histogram>& name_histogram##_family;
 
 DECLARE_PROMETHEUS_COUNTER(knowhere_build_count);
 DECLARE_PROMETHEUS_COUNTER(knowhere_search_count);
@@ -80,4 +87,10 @@ DECLARE_PROMETHEUS_COUNTER(knowhere_range_search_count);
 DECLARE_PROMETHEUS_HISTOGRAM(knowhere_search_topk);
 DECLARE_PROMETHEUS_HISTOGRAM(knowhere_search_latency);
 DECLARE_PROMETHEUS_HISTOGRAM(knowhere_range_search_latency);
+DECLARE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_hit_count);
+DECLARE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_miss_count);
+DECLARE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_contention_count);
+DECLARE_PROMETHEUS_HISTOGRAM_FAMILY(knowhere_search_stage_latency);
+DECLARE_PROMETHEUS_HISTOGRAM_FAMILY(knowhere_search_work);
+DECLARE_PROMETHEUS_COUNTER(knowhere_search_stats_sampled_count);
 }  // namespace knowhere
@@ -0,0 +1,55 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SEARCH_PARAMS_H
+#define SEARCH_PARAMS_H
+
+#include <memory>
+#include <string>
+
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+// A search or range search config that has been formatted, loaded and checked once. It is immutable, so it can be
+// shared by any number of concurrent searches on indexes of the type it was compiled for.
+class SearchParams {
+ public:
+    SearchParams(std::unique_ptr<BaseConfig> cfg, PARAM_TYPE param_type, std::string index_type)
+        : cfg_(std::move(cfg)), param_type_(param_type), index_type_(std::move(index_type)) {
+    }
+
+    const BaseConfig&
+    GetConfig() const {
+        return *cfg_;
+    }
+
+    PARAM_TYPE
+    GetParamType() const {
+        return param_type_;
+    }
+
+    const std::string&
+    GetIndexType() const {
+        return index_type_;
+    }
+
+ private:
+    std::unique_ptr<const BaseConfig> cfg_;
+    PARAM_TYPE param_type_;
+    std::string index_type_;
+};
+
+using SearchParamsPtr = std::shared_ptr<const SearchParams>;
+
+}  // namespace knowhere
+
+#endif /* SEARCH_PARAMS_H */
@@ -38,6 +38,16 @@ Normalize(const DataSet& dataset);
 std::unique_ptr<float[]>
 CopyAndNormalizeFloatVec(const float* x, int32_t dim);
 
+std::unique_ptr<float[]>
+CopyAndNormalizeFloatVecs(const float* x, size_t rows, int32_t dim);
+
+// the same over fp16 or bf16 (is_bf16) components, normalized in float and rounded back
+extern void
+NormalizeHalfVec(uint16_t* x, int32_t d, bool is_bf16);
+
+std::unique_ptr<uint16_t[]>
+CopyAndNormalizeHalfVecs(const uint16_t* x, size_t rows, int32_t dim, bool is_bf16);
+
 constexpr inline uint64_t seed = 0xc70f6907UL;
 
 inline uint64_t
@@ -0,0 +1,247 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace knowhere {
+
+struct clock_cache_stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // lookups that found their slot being written and puts dropped because another thread was writing the slot
+    uint64_t contended = 0;
+};
+
+/**
+ * @brief Fixed-capacity, lock-free approximate LRU for small trivially copyable keys and values.
+ *
+ * The entries live in sets of kWays slots picked by the key hash. Every slot is guarded by its own sequence lock:
+ * a lookup never writes the slot and retries nothing, it just misses if the slot is being written; a put that finds
+ * its slot taken by another writer is dropped. Eviction within a set follows CLOCK, a hit only sets the slot's
+ * reference bit. The slots are allocated by the first put, so that an index which is never searched does not pay for
+ * them, and nothing is allocated after that.
+ *
+ * Being a cache, it is allowed to lose puts and, under races, to hold the same key twice.
+ */
+template <typename key_t, typename value_t>
+class clock_cache {
+    static_assert(std::is_trivially_copyable_v<key_t> && std::is_trivially_copyable_v<value_t>);
+    static_assert(std::atomic<key_t>::is_always_lock_free && std::atomic<value_t>::is_always_lock_free);
+
+ public:
+    explicit clock_cache(size_t cap = kDefaultSize) {
+        reset(cap);
+    }
+
+    ~clock_cache() {
+        delete[] sets_.load(std::memory_order_relaxed);
+    }
+
+    clock_cache(const clock_cache&) = delete;
+    clock_cache&
+    operator=(const clock_cache&) = delete;
+
+    // drops all the entries and resizes the cache, capacity 0 disables it; not safe against concurrent use
+    void
+    reset(size_t cap) {
+        num_sets_ = (cap + kWays - 1) / kWays;
+        delete[] sets_.exchange(nullptr, std::memory_order_relaxed);
+    }
+
+    size_t
+    capacity() const {
+        return num_sets_ * kWays;
+    }
+
+    void
+    put(const key_t& key, const value_t& value) {
+        if (num_sets_ == 0) {
+            return;
+        }
+        const size_t set_no = set_of(key);
+        auto& set = allocated_sets()[set_no];
+
+        // overwrite the key if it is cached, otherwise take a free slot or the CLOCK victim
+        int way = -1;
+        for (int i = 0; i < kWays; ++i) {
+            const auto seq = set.slots[i].seq.load(std::memory_order_relaxed);
+            if (seq == 0) {
+                way = way < 0 ? i : way;
+            } else if (set.slots[i].key.load(std::memory_order_relaxed) == key) {
+                way = i;
+                break;
+            }
+        }
+        if (way < 0) {
+            way = evict(set);
+        }
+
+        auto& slot = set.slots[way];
+        auto seq = slot.seq.load(std::memory_order_relaxed);
+        if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+            stats_[set_no % kStatStripes].contended.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.seq.store(seq + 2, std::memory_order_release);
+        set.refs.fetch_or(uint8_t(1) << way, std::memory_order_relaxed);
+    }
+
+    bool
+    try_get(const key_t& key, value_t& val) const {
+        if (num_sets_ == 0) {
+            return false;
+        }
+        const size_t set_no = set_of(key);
+        auto& stats = stats_[set_no % kStatStripes];
+        const Set* sets = sets_.load(std::memory_order_acquire);
+        if (sets == nullptr) {
+            stats.misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto& set = sets[set_no];
+        for (int i = 0; i < kWays; ++i) {
+            const auto& slot = set.slots[i];
+            const auto seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == 0) {
+                continue;
+            }
+            if (seq & 1) {
+                stats.contended.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (slot.key.load(std::memory_order_relaxed) != key) {
+                continue;
+            }
+            const value_t v = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) {
+                stats.contended.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            // only dirty the line when the bit actually changes
+            const uint8_t bit = uint8_t(1) << i;
+            if (!(set.refs.load(std::memory_order_relaxed) & bit)) {
+                set.refs.fetch_or(bit, std::memory_order_relaxed);
+            }
+            val = v;
+            stats.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        stats.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // not safe against concurrent put
+    void
+    clear() {
+        Set* sets = sets_.load(std::memory_order_relaxed);
+        if (sets == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < num_sets_; ++i) {
+            for (auto& slot : sets[i].slots) {
+                slot.seq.store(0, std::memory_order_relaxed);
+            }
+            sets[i].refs.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // returns the counters accumulated since the previous call
+    clock_cache_stats
+    take_stats() const {
+        clock_cache_stats res;
+        for (auto& stats : stats_) {
+            res.hits += stats.hits.exchange(0, std::memory_order_relaxed);
+            res.misses += stats.misses.exchange(0, std::memory_order_relaxed);
+            res.contended += stats.contended.exchange(0, std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+ private:
+    constexpr static int kWays = 8;
+    constexpr static int kStatStripes = 16;
+    constexpr static size_t kDefaultSize = 10000;
+
+    struct Slot {
+        // even when stable, odd while written, 0 when never written
+        std::atomic<uint32_t> seq{0};
+        std::atomic<value_t> value{};
+        std::atomic<key_t> key{};
+    };
+
+    struct alignas(64) Set {
+        Slot slots[kWays];
+        // a hit sets its bit from the const lookup path
+        mutable std::atomic<uint8_t> refs{0};
+        std::atomic<uint8_t> hand{0};
+    };
+
+    struct alignas(64) Stats {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> contended{0};
+    };
+
+    size_t
+    set_of(const key_t& key) const {
+        uint64_t h = 0;
+        memcpy(&h, &key, std::min(sizeof(key), sizeof(h)));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        // multiply-shift range reduction, the set count needs no rounding
+        return (size_t)(((h >> 32) * num_sets_) >> 32);
+    }
+
+    // the first put allocates the sets, a thread that loses the race drops its own copy
+    Set*
+    allocated_sets() {
+        Set* sets = sets_.load(std::memory_order_acquire);
+        if (sets != nullptr) {
+            return sets;
+        }
+        Set* fresh = new Set[num_sets_];
+        if (sets_.compare_exchange_strong(sets, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return sets;
+    }
+
+    // second chance: clears the reference bits under the hand until it finds a slot without one
+    static int
+    evict(Set& set) {
+        for (int step = 0; step <= kWays; ++step) {
+            const int way = set.hand.fetch_add(1, std::memory_order_relaxed) % kWays;
+            const uint8_t bit = uint8_t(1) << way;
+            if (!(set.refs.fetch_and(~bit, std::memory_order_relaxed) & bit)) {
+                return way;
+            }
+        }
+        return set.hand.load(std::memory_order_relaxed) % kWays;
+    }
+
+    size_t num_sets_ = 0;
+    std::atomic<Set*> sets_{nullptr};
+    mutable Stats stats_[kStatStripes];
+};
+
+}  // namespace knowhere
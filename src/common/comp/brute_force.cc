@@ -15,6 +15,7 @@
 
 #include "common/metric.h"
 #include "common/range_util.h"
+#include "common/tiled_knn.h"
 #include "faiss/MetricType.h"
 #include "faiss/utils/binary_distances.h"
 #include "faiss/utils/distances.h"
@@ -30,6 +31,28 @@ namespace knowhere {
 
 class BruteForceConfig : public BaseConfig {};
 
+namespace {
+
+inline bool
+IsTiledKnnMetric(faiss::MetricType metric_type) {
+    return metric_type == faiss::METRIC_L2 || metric_type == faiss::METRIC_INNER_PRODUCT;
+}
+
+// float top-k for a whole batch, queries are normalized once here instead of once per task
+Status
+TiledSearch(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+            faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* ids, float* distances,
+            const std::shared_ptr<ThreadPool>& pool) {
+    std::unique_ptr<float[]> copied_queries = nullptr;
+    if (is_cosine) {
+        copied_queries = CopyAndNormalizeFloatVecs(xq, nq, dim);
+        xq = copied_queries.get();
+    }
+    return TiledKnnSearch(xq, nq, xb, nb, dim, k, metric_type, is_cosine, bitset, ids, distances, pool);
+}
+
+}  // namespace
+
 expected<DataSetPtr>
 BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
                    const BitsetView& bitset) {
@@ -60,6 +83,16 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
     auto distances = new float[nq * topk];
 
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    if (nq >= kTiledKnnMinNq && IsTiledKnnMetric(faiss_metric_type)) {
+        auto status = TiledSearch((const float*)xq, nq, (const float*)xb, nb, dim, topk, faiss_metric_type, is_cosine,
+                                  bitset, labels, distances, pool);
+        if (status != Status::success) {
+            std::unique_ptr<int64_t[]> auto_delete_ids(labels);
+            std::unique_ptr<float[]> auto_delete_dis(distances);
+            return expected<DataSetPtr>::Err(status, "failed to brute force search");
+        }
+        return GenResultDataSet(nq, cfg.k.value(), labels, distances);
+    }
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
     for (int i = 0; i < nq; ++i) {
@@ -154,6 +187,10 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
     auto distances = dis;
 
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    if (nq >= kTiledKnnMinNq && IsTiledKnnMetric(faiss_metric_type)) {
+        return TiledSearch((const float*)xq, nq, (const float*)xb, nb, dim, topk, faiss_metric_type, is_cosine, bitset,
+                           labels, distances, pool);
+    }
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
     for (int i = 0; i < nq; ++i) {
@@ -248,15 +285,12 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     bool is_cosine = IsMetricType(metric_str, metric::COSINE);
 
     auto radius = cfg.radius.value();
-    bool is_ip = false;
+    bool is_ip = (faiss_metric_type == faiss::METRIC_INNER_PRODUCT);
     float range_filter = cfg.range_filter.value();
 
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
 
-    std::vector<std::vector<int64_t>> result_id_array(nq);
-    std::vector<std::vector<float>> result_dist_array(nq);
-    std::vector<size_t> result_size(nq);
-    std::vector<size_t> result_lims(nq + 1);
+    RangeSearchResultArena arena(nq, is_ip, radius, range_filter);
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
     for (int i = 0; i < nq; ++i) {
@@ -270,7 +304,6 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                     break;
                 }
                 case faiss::METRIC_INNER_PRODUCT: {
-                    is_ip = true;
                     auto cur_query = (const float*)xq + dim * index;
                     if (is_cosine) {
                         auto copied_query = CopyAndNormalizeFloatVec(cur_query, dim);
@@ -300,18 +333,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                     return Status::invalid_metric_type;
                 }
             }
-            auto elem_cnt = res.lims[1];
-            result_dist_array[index].resize(elem_cnt);
-            result_id_array[index].resize(elem_cnt);
-            result_size[index] = elem_cnt;
-            for (size_t j = 0; j < elem_cnt; j++) {
-                result_dist_array[index][j] = res.distances[j];
-                result_id_array[index][j] = res.labels[j];
-            }
-            if (cfg.range_filter.value() != defaultRangeFilter) {
-                FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
-                                                range_filter);
-            }
+            RangeSearchResultArena::Writer(arena, index).Add(res.labels, res.distances, res.lims[1]);
             return Status::success;
         }));
     }
@@ -323,10 +345,6 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
         }
     }
 
-    int64_t* ids = nullptr;
-    float* distances = nullptr;
-    size_t* lims = nullptr;
-    GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter, distances, ids, lims);
-    return GenResultDataSet(nq, ids, distances, lims);
+    return arena.GenResultDataSet();
 }
 }  // namespace knowhere
@@ -18,6 +18,9 @@
 #endif
 #include "faiss/Clustering.h"
 #include "faiss/utils/distances.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/search_stats.h"
+#include "knowhere/comp/thread_pool.h"
 #include "knowhere/log.h"
 #ifdef KNOWHERE_WITH_GPU
 #include "index/gpu/gpu_res_mgr.h"
@@ -124,6 +127,57 @@ KnowhereConfig::SetClusteringType(const ClusteringType clustering_type) {
     }
 }
 
+void
+KnowhereConfig::SetSearchStatsSampleRate(const double sample_rate) {
+    LOG_KNOWHERE_INFO_ << "Set search stats sample rate to " << sample_rate;
+    SearchStats::SetSampleRate(sample_rate);
+}
+
+double
+KnowhereConfig::GetSearchStatsSampleRate() {
+    return SearchStats::GetSampleRate();
+}
+
+void
+KnowhereConfig::SetNumaPolicy(const NumaPolicy numa_policy) {
+    LOG_KNOWHERE_INFO_ << "Set NUMA policy to " << numa_policy;
+    switch (numa_policy) {
+        case NumaPolicy::NUMA_OFF:
+        default:
+            Numa::SetPolicy(Numa::OFF);
+            break;
+        case NumaPolicy::NUMA_LOCAL:
+            Numa::SetPolicy(Numa::LOCAL);
+            break;
+        case NumaPolicy::NUMA_INTERLEAVE:
+            Numa::SetPolicy(Numa::INTERLEAVE);
+            break;
+    }
+}
+
+KnowhereConfig::NumaPolicy
+KnowhereConfig::GetNumaPolicy() {
+    switch (Numa::GetPolicy()) {
+        case Numa::LOCAL:
+            return NumaPolicy::NUMA_LOCAL;
+        case Numa::INTERLEAVE:
+            return NumaPolicy::NUMA_INTERLEAVE;
+        default:
+            return NumaPolicy::NUMA_OFF;
+    }
+}
+
+void
+KnowhereConfig::SetNumaSearchThreads(const uint32_t num_threads) {
+    LOG_KNOWHERE_INFO_ << "Set NUMA search threads to " << num_threads;
+    ThreadPool::InitNumaSearchThreadPools(num_threads);
+}
+
+uint32_t
+KnowhereConfig::GetNumaSearchThreads() {
+    return ThreadPool::GetNumaSearchThreadPoolsSize();
+}
+
 bool
 KnowhereConfig::SetAioContextPool(size_t num_ctx) {
 #ifdef KNOWHERE_WITH_DISKANN
@@ -0,0 +1,240 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/multi_index_search.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/prepared_bitset.h"
+#include "faiss/utils/Heap.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/log.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+namespace {
+
+// queries searched by one task; a block of a small segment is cheap, so a few queries are enough to amortize the task
+constexpr int64_t kQueryBlockSize = 16;
+
+// bytes of one query vector, binary for the binary metrics and 16-bit for the indexes of fp16 and bf16 vectors; the
+// fp16 and bf16 IVF indexes only store their codes that way and take float vectors
+size_t
+QueryRowBytes(const std::string& index_type, const std::string& metric_type, int64_t dim) {
+    if (IsMetricType(metric_type, metric::HAMMING) || IsMetricType(metric_type, metric::JACCARD) ||
+        IsMetricType(metric_type, metric::SUBSTRUCTURE) || IsMetricType(metric_type, metric::SUPERSTRUCTURE)) {
+        return (dim + 7) / 8;
+    }
+    if (index_type == IndexEnum::INDEX_FAISS_IDMAP_FP16 || index_type == IndexEnum::INDEX_FAISS_IDMAP_BF16 ||
+        index_type == IndexEnum::INDEX_HNSW_FP16 || index_type == IndexEnum::INDEX_HNSW_BF16) {
+        return dim * sizeof(uint16_t);
+    }
+    return dim * sizeof(float);
+}
+
+// Adds the sorted top-k lists of a segment to the heaps of the same queries. As a list is sorted, the rest of it is
+// skipped at the first result that does not beat the k-th one of the heap.
+template <class C>
+void
+MergeIntoHeaps(int64_t nq, int64_t k, const int64_t* seg_ids, const float* seg_distances, int64_t id_offset,
+               int64_t* heap_ids, float* heap_distances) {
+    for (int64_t i = 0; i < nq; i++) {
+        float* val = heap_distances + i * k;
+        int64_t* ids = heap_ids + i * k;
+        for (int64_t j = i * k; j < (i + 1) * k; j++) {
+            if (seg_ids[j] < 0 || !C::cmp(val[0], seg_distances[j])) {
+                break;
+            }
+            faiss::heap_replace_top<C>(k, val, ids, seg_distances[j], seg_ids[j] + id_offset);
+        }
+    }
+}
+
+// what a request needs besides the queries: the json is compiled once per index type and the bitsets are prepared
+// once for all the query blocks
+struct SearchPlan {
+    std::map<std::string, SearchParamsPtr> compiled;
+    // nullptr for a segment that cannot return any row, which is not searched at all
+    std::vector<const SearchParams*> params;
+    std::vector<std::unique_ptr<PreparedBitset>> filters;
+    std::vector<int64_t> id_offsets;
+    int64_t k = 0;
+    bool is_ip = false;
+    size_t row_bytes = 0;
+};
+
+Status
+MakeSearchPlan(const std::vector<Index<IndexNode>>& indexes, const DataSet& dataset, const Json& json,
+               const std::vector<BitsetView>& bitsets, SearchPlan& plan) {
+    if (indexes.empty()) {
+        LOG_KNOWHERE_ERROR_ << "multi index search without any index";
+        return Status::invalid_args;
+    }
+    if (!bitsets.empty() && bitsets.size() != indexes.size()) {
+        LOG_KNOWHERE_ERROR_ << "multi index search with " << bitsets.size() << " bitsets for " << indexes.size()
+                            << " indexes";
+        return Status::invalid_args;
+    }
+
+    plan.params.assign(indexes.size(), nullptr);
+    plan.filters.resize(indexes.size());
+    plan.id_offsets.resize(indexes.size());
+    int64_t total_rows = 0;
+    for (size_t s = 0; s < indexes.size(); s++) {
+        const auto& index = indexes[s];
+        plan.id_offsets[s] = total_rows;
+        total_rows += index.Count();
+
+        auto& index_params = plan.compiled[index.Type()];
+        if (index_params == nullptr) {
+            auto res = index.CompileSearchParams(json, knowhere::SEARCH);
+            if (!res.has_value()) {
+                LOG_KNOWHERE_ERROR_ << "multi index search on " << index.Type() << ": " << res.what();
+                return res.error();
+            }
+            index_params = res.value();
+        }
+        plan.filters[s] = std::make_unique<PreparedBitset>(bitsets.empty() ? BitsetView() : bitsets[s]);
+        const auto& filter = plan.filters[s]->view();
+        if (index.Count() == 0 || (!filter.empty() && filter.count() == filter.size())) {
+            continue;
+        }
+        if (index.Dim() != dataset.GetDim()) {
+            LOG_KNOWHERE_ERROR_ << "multi index search of " << dataset.GetDim() << "-dim queries on a "
+                                << index.Dim() << "-dim index";
+            return Status::invalid_args;
+        }
+        plan.params[s] = index_params.get();
+    }
+
+    const auto& cfg = plan.compiled.begin()->second->GetConfig();
+    const auto& metric_type = cfg.metric_type.value();
+    plan.k = cfg.k.value();
+    plan.is_ip = IsMetricType(metric_type, metric::IP) || IsMetricType(metric_type, metric::COSINE);
+    // the queries are a single tensor, so every index has to take them as the same data type
+    plan.row_bytes = QueryRowBytes(indexes[0].Type(), metric_type, dataset.GetDim());
+    for (const auto& index : indexes) {
+        if (QueryRowBytes(index.Type(), metric_type, dataset.GetDim()) != plan.row_bytes) {
+            LOG_KNOWHERE_ERROR_ << "multi index search on " << indexes[0].Type() << " and " << index.Type()
+                                << ", which take queries of different data types";
+            return Status::invalid_args;
+        }
+    }
+    return Status::success;
+}
+
+// Searches every (segment, query block) pair in a task of the search pool and merges its results into the heaps of
+// its queries, which live in the output buffers, as soon as it is done.
+template <class C>
+Status
+SearchAndMerge(const std::vector<Index<IndexNode>>& indexes, const SearchPlan& plan, const DataSet& dataset,
+               int64_t* ids, float* distances) {
+    const int64_t nq = dataset.GetRows();
+    const int64_t dim = dataset.GetDim();
+    const int64_t k = plan.k;
+    const auto xq = static_cast<const char*>(dataset.GetTensor());
+    const int64_t nblock = (nq + kQueryBlockSize - 1) / kQueryBlockSize;
+
+    for (int64_t i = 0; i < nq; i++) {
+        faiss::heap_heapify<C>(k, distances + i * k, ids + i * k);
+    }
+    std::vector<std::mutex> block_mutexes(nblock);
+
+    auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    std::vector<folly::Future<Status>> futs;
+    for (size_t s = 0; s < indexes.size(); s++) {
+        if (plan.params[s] == nullptr) {
+            continue;
+        }
+        for (int64_t b = 0; b < nblock; b++) {
+            futs.emplace_back(pool->push([&, s, b] {
+                // the search of the segment runs in this task instead of waiting for tasks of the same pool
+                ThreadPool::ScopedInline inline_tasks;
+                ThreadPool::ScopedOmpSetter setter(1);
+                const int64_t q0 = b * kQueryBlockSize;
+                const int64_t bnq = std::min(kQueryBlockSize, nq - q0);
+                thread_local std::vector<int64_t> seg_ids;
+                thread_local std::vector<float> seg_distances;
+                seg_ids.resize(bnq * k);
+                seg_distances.resize(bnq * k);
+                auto block = GenDataSet(bnq, dim, xq + q0 * plan.row_bytes);
+                auto res = indexes[s].SearchWithBuf(*block, *plan.params[s], plan.filters[s]->view(), seg_ids.data(),
+                                                    seg_distances.data());
+                if (res != Status::success) {
+                    return res;
+                }
+                std::lock_guard<std::mutex> lock(block_mutexes[b]);
+                MergeIntoHeaps<C>(bnq, k, seg_ids.data(), seg_distances.data(), plan.id_offsets[s], ids + q0 * k,
+                                  distances + q0 * k);
+                return Status::success;
+            }));
+        }
+    }
+    // every task refers to this frame, so all of them are waited for before an error or exception is passed on
+    for (auto& fut : futs) {
+        fut.wait();
+    }
+    for (auto& fut : futs) {
+        auto ret = fut.result().value();
+        if (ret != Status::success) {
+            return ret;
+        }
+    }
+    for (int64_t i = 0; i < nq; i++) {
+        faiss::heap_reorder<C>(k, distances + i * k, ids + i * k);
+    }
+    return Status::success;
+}
+
+Status
+RunSearchPlan(const std::vector<Index<IndexNode>>& indexes, const SearchPlan& plan, const DataSet& dataset,
+              int64_t* ids, float* distances) {
+    if (plan.is_ip) {
+        return SearchAndMerge<faiss::CMin<float, int64_t>>(indexes, plan, dataset, ids, distances);
+    }
+    return SearchAndMerge<faiss::CMax<float, int64_t>>(indexes, plan, dataset, ids, distances);
+}
+
+}  // namespace
+
+Status
+MultiIndexSearch::SearchWithBuf(const std::vector<Index<IndexNode>>& indexes, const DataSet& dataset, const Json& json,
+                                const std::vector<BitsetView>& bitsets, int64_t* ids, float* distances) {
+    SearchPlan plan;
+    RETURN_IF_ERROR(MakeSearchPlan(indexes, dataset, json, bitsets, plan));
+    return RunSearchPlan(indexes, plan, dataset, ids, distances);
+}
+
+expected<DataSetPtr>
+MultiIndexSearch::Search(const std::vector<Index<IndexNode>>& indexes, const DataSet& dataset, const Json& json,
+                         const std::vector<BitsetView>& bitsets) {
+    SearchPlan plan;
+    auto status = MakeSearchPlan(indexes, dataset, json, bitsets, plan);
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, "invalid multi index search");
+    }
+    const int64_t nq = dataset.GetRows();
+    std::unique_ptr<int64_t[]> ids(new int64_t[nq * plan.k]);
+    std::unique_ptr<float[]> distances(new float[nq * plan.k]);
+    status = RunSearchPlan(indexes, plan, dataset, ids.get(), distances.get());
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, "failed to search multiple indexes");
+    }
+    return GenResultDataSet(nq, plan.k, ids.release(), distances.release());
+}
+
+}  // namespace knowhere
@@ -0,0 +1,225 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/numa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "knowhere/log.h"
+
+namespace knowhere {
+
+namespace {
+
+// the largest node id the placement syscalls are given masks for
+constexpr int kMaxNodes = 1024;
+constexpr size_t kMaskBits = 8 * sizeof(unsigned long);
+constexpr size_t kMaskWords = kMaxNodes / kMaskBits;
+
+std::atomic<int> numa_policy{Numa::OFF};
+std::atomic<uint32_t> next_node{0};
+
+// parses the sysfs list format, e.g. "0-3,8,10-11"
+std::vector<int>
+ParseList(const std::string& list) {
+    std::vector<int> ids;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash = range.find('-');
+        try {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        } catch (std::exception&) {
+            return {};
+        }
+    }
+    return ids;
+}
+
+std::vector<int>
+ReadList(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line)) {
+        return {};
+    }
+    return ParseList(line);
+}
+
+struct Topology {
+    std::vector<int> nodes;
+    std::map<int, std::vector<int>> cpus;
+
+    Topology() {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return;
+        }
+        for (int node : ReadList("/sys/devices/system/node/online")) {
+            if (node >= kMaxNodes) {
+                continue;
+            }
+            std::vector<int> node_cpus;
+            for (int cpu : ReadList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                    node_cpus.push_back(cpu);
+                }
+            }
+            // memory only nodes and nodes outside of the cpuset get neither indexes nor pools
+            if (!node_cpus.empty()) {
+                nodes.push_back(node);
+                cpus.emplace(node, std::move(node_cpus));
+            }
+        }
+#endif
+    }
+};
+
+const Topology&
+GetTopology() {
+    static const Topology topology;
+    return topology;
+}
+
+#ifdef __linux__
+bool
+Mbind(void* addr, size_t size, int mode, const unsigned long* mask) {
+    if (size == 0) {
+        return true;
+    }
+    // mbind works on whole pages, the partial pages at both ends are shared with the neighbouring allocations
+    const auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(addr) & ~(page - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + size + page - 1) & ~(page - 1);
+    return syscall(SYS_mbind, begin, end - begin, mode, mask, kMaxNodes + 1, MPOL_MF_MOVE) == 0;
+}
+#endif
+
+}  // namespace
+
+void
+Numa::SetPolicy(Policy policy) {
+    if (policy != OFF && Nodes().size() < 2) {
+        LOG_KNOWHERE_INFO_ << "Only " << Nodes().size() << " usable NUMA node, NUMA placement has no effect";
+    }
+    numa_policy.store(policy, std::memory_order_relaxed);
+}
+
+Numa::Policy
+Numa::GetPolicy() {
+    return static_cast<Policy>(numa_policy.load(std::memory_order_relaxed));
+}
+
+const std::vector<int>&
+Numa::Nodes() {
+    return GetTopology().nodes;
+}
+
+const std::vector<int>&
+Numa::NodeCpus(int node) {
+    static const std::vector<int> none;
+    const auto& cpus = GetTopology().cpus;
+    auto it = cpus.find(node);
+    return it == cpus.end() ? none : it->second;
+}
+
+int
+Numa::ChooseNode() {
+    const auto& nodes = Nodes();
+    if (GetPolicy() != LOCAL || nodes.size() < 2) {
+        return -1;
+    }
+    return nodes[next_node.fetch_add(1, std::memory_order_relaxed) % nodes.size()];
+}
+
+bool
+Numa::PlaceMemory(void* addr, size_t size, int node) {
+#ifdef __linux__
+    const auto& nodes = Nodes();
+    if (addr == nullptr || nodes.size() < 2) {
+        return true;
+    }
+    unsigned long mask[kMaskWords] = {};
+    auto set = [&mask](int id) { mask[id / kMaskBits] |= 1UL << (id % kMaskBits); };
+    int mode;
+    if (node >= 0 && node < kMaxNodes) {
+        set(node);
+        // preferred rather than bound, a full node falls back to the others instead of failing the allocation
+        mode = MPOL_PREFERRED;
+    } else if (GetPolicy() == INTERLEAVE) {
+        for (int id : nodes) {
+            set(id);
+        }
+        mode = MPOL_INTERLEAVE;
+    } else {
+        return true;
+    }
+    if (!Mbind(addr, size, mode, mask)) {
+        LOG_KNOWHERE_WARNING_ << "mbind of " << size << " bytes failed, errno " << errno;
+        return false;
+    }
+#endif
+    return true;
+}
+
+int
+Numa::NodeOfAddress(const void* addr) {
+#ifdef __linux__
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return node;
+    }
+#endif
+    return -1;
+}
+
+bool
+Numa::PinCurrentThread(int node) {
+#ifdef __linux__
+    const auto& node_cpus = NodeCpus(node);
+    if (node_cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : node_cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+}  // namespace knowhere
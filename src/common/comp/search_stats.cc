@@ -0,0 +1,161 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/search_stats.h"
+
+#include <algorithm>
+#include <random>
+
+#ifdef NOT_COMPILE_FOR_SWIG
+#include "knowhere/prometheus_client.h"
+#endif
+
+namespace knowhere {
+
+namespace {
+
+// sample rate scaled to 2^32, compared against a per thread random number
+constexpr uint64_t kSampleScale = uint64_t(1) << 32;
+std::atomic<uint64_t> sample_threshold{kSampleScale / 100};
+
+struct ThreadState {
+    SearchStats* active = nullptr;
+    int depth = 0;
+    uint64_t rng = std::random_device{}() | 1;
+};
+
+ThreadState&
+GetThreadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+bool
+ShouldSample(ThreadState& state) {
+    const uint64_t threshold = sample_threshold.load(std::memory_order_relaxed);
+    if (threshold == 0) {
+        return false;
+    }
+    // xorshift64, good enough to spread the samples and free of shared state
+    state.rng ^= state.rng << 13;
+    state.rng ^= state.rng >> 7;
+    state.rng ^= state.rng << 17;
+    return (state.rng & (kSampleScale - 1)) < threshold;
+}
+
+#ifdef NOT_COMPILE_FOR_SWIG
+void
+Report(bool range_search, const SearchStats& stats) {
+    const std::string& index_type = stats.IndexType();
+    const double nq = std::max<int64_t>(stats.Queries(), 1);
+    const std::string method = range_search ? "range_search" : "search";
+    for (int s = 0; s < SearchStats::NUM_STAGES; ++s) {
+        const auto stage = static_cast<SearchStats::Stage>(s);
+        const double us = stats.StageMicros(stage);
+        // stages an index does not have stay out of the histograms
+        if (us > 0) {
+            knowhere_search_stage_latency_family
+                .Add({{"index_type", index_type}, {"method", method}, {"stage", SearchStats::StageName(stage)}},
+                     knowhere::buckets)
+                .Observe(us / nq);
+        }
+    }
+    for (int c = 0; c < SearchStats::NUM_COUNTERS; ++c) {
+        const auto counter = static_cast<SearchStats::Counter>(c);
+        const uint64_t value = stats.Count(counter);
+        if (value > 0) {
+            knowhere_search_work_family
+                .Add({{"index_type", index_type}, {"method", method}, {"counter", SearchStats::CounterName(counter)}},
+                     knowhere::buckets)
+                .Observe(value / nq);
+        }
+    }
+    knowhere_search_stats_sampled_count.Increment();
+}
+#endif
+
+}  // namespace
+
+const char*
+SearchStats::StageName(Stage stage) {
+    switch (stage) {
+        case PARSE:
+            return "parse";
+        case BITSET:
+            return "bitset";
+        case QUANTIZE:
+            return "quantize";
+        case SCAN:
+            return "scan";
+        case IO:
+            return "io";
+        case TOTAL:
+            return "total";
+        default:
+            return "unknown";
+    }
+}
+
+const char*
+SearchStats::CounterName(Counter counter) {
+    switch (counter) {
+        case HOPS:
+            return "hops";
+        case DISTANCE_COMPUTATIONS:
+            return "distance_computations";
+        case LISTS_SCANNED:
+            return "lists_scanned";
+        case DISK_READS:
+            return "disk_reads";
+        case CACHE_HITS:
+            return "cache_hits";
+        default:
+            return "unknown";
+    }
+}
+
+SearchStats*
+SearchStats::Active() {
+    return GetThreadState().active;
+}
+
+void
+SearchStats::SetSampleRate(double rate) {
+    rate = std::clamp(rate, 0.0, 1.0);
+    sample_threshold.store(static_cast<uint64_t>(rate * kSampleScale), std::memory_order_relaxed);
+}
+
+double
+SearchStats::GetSampleRate() {
+    return static_cast<double>(sample_threshold.load(std::memory_order_relaxed)) / kSampleScale;
+}
+
+SearchStatsScope::SearchStatsScope(bool range_search) : range_search_(range_search) {
+    auto& state = GetThreadState();
+    if (state.depth++ == 0 && ShouldSample(state)) {
+        stats_ = std::make_unique<SearchStats>();
+        state.active = stats_.get();
+    }
+}
+
+SearchStatsScope::~SearchStatsScope() {
+    auto& state = GetThreadState();
+    --state.depth;
+    if (stats_ == nullptr) {
+        return;
+    }
+    state.active = nullptr;
+#ifdef NOT_COMPILE_FOR_SWIG
+    Report(range_search_, *stats_);
+#endif
+}
+
+}  // namespace knowhere
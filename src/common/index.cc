@@ -11,6 +11,11 @@
 
 #include "knowhere/index.h"
 
+#include <vector>
+
+#include "common/lru_cache.h"
+#include "common/prepared_bitset.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -32,6 +37,46 @@ LoadConfig(BaseConfig* cfg, const Json& json, knowhere::PARAM_TYPE param_type, c
     return Config::Load(*cfg, json_, param_type, msg);
 }
 
+class SearchParamsCache {
+ public:
+    struct Entry {
+        Json json;
+        SearchParamsPtr params;
+    };
+
+    // distinct search configs are few in practice (one per collection and query shape)
+    static constexpr size_t kCapacity = 64;
+
+    SearchParamsPtr
+    Get(const Json& json, PARAM_TYPE param_type) {
+        std::shared_ptr<const Entry> entry;
+        // a hash collision must not return the params of another json
+        if (!cache_.try_get(Key(json, param_type), entry) || entry->params->GetParamType() != param_type ||
+            entry->json != json) {
+            return nullptr;
+        }
+        return entry->params;
+    }
+
+    void
+    Put(const Json& json, const SearchParamsPtr& params) {
+        cache_.put(Key(json, params->GetParamType()), std::make_shared<const Entry>(Entry{json, params}));
+    }
+
+ private:
+    static uint64_t
+    Key(const Json& json, PARAM_TYPE param_type) {
+        return std::hash<Json>{}(json) ^ (static_cast<uint64_t>(param_type) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    lru_cache<uint64_t, std::shared_ptr<const Entry>> cache_{kCapacity};
+};
+
+std::shared_ptr<SearchParamsCache>
+CreateSearchParamsCache() {
+    return std::make_shared<SearchParamsCache>();
+}
+
 template <typename T>
 inline Status
 Index<T>::Build(const DataSet& dataset, const Json& json) {
@@ -62,29 +107,97 @@ Index<T>::Add(const DataSet& dataset, const Json& json) {
 }
 
 template <typename T>
-inline expected<DataSetPtr>
-Index<T>::Search(const DataSet& dataset, const Json& json, const BitsetView& bitset) const {
+inline void
+Index<T>::SetBuildProgressCallback(BuildProgressCallback callback) {
+    this->node->SetBuildProgressCallback(std::move(callback));
+}
+
+template <typename T>
+inline expected<SearchParamsPtr>
+Index<T>::CompileSearchParams(const Json& json, PARAM_TYPE param_type) const {
     auto cfg = this->node->CreateConfig();
     std::string msg;
-    const Status load_status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
-    if (load_status != Status::success) {
-        return expected<DataSetPtr>::Err(load_status, msg);
+    if (param_type == knowhere::SEARCH) {
+        const Status load_status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+        if (load_status != Status::success) {
+            return expected<SearchParamsPtr>::Err(load_status, msg);
+        }
+        const Status search_status = cfg->CheckAndAdjustForSearch(&msg);
+        if (search_status != Status::success) {
+            return expected<SearchParamsPtr>::Err(search_status, msg);
+        }
+    } else if (param_type == knowhere::RANGE_SEARCH) {
+        auto status = LoadConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
+        if (status != Status::success) {
+            return expected<SearchParamsPtr>::Err(status, std::move(msg));
+        }
+        status = cfg->CheckAndAdjustForRangeSearch();
+        if (status != Status::success) {
+            return expected<SearchParamsPtr>::Err(status, "invalid params for range search");
+        }
+    } else {
+        return expected<SearchParamsPtr>::Err(Status::invalid_args, "only search params can be compiled");
+    }
+    return SearchParamsPtr(std::make_shared<const SearchParams>(std::move(cfg), param_type, this->node->Type()));
+}
+
+template <typename T>
+inline expected<SearchParamsPtr>
+Index<T>::GetSearchParams(const Json& json, PARAM_TYPE param_type) const {
+    if (params_cache != nullptr) {
+        if (auto params = params_cache->Get(json, param_type)) {
+            return params;
+        }
+    }
+    auto res = CompileSearchParams(json, param_type);
+    if (res.has_value() && params_cache != nullptr) {
+        params_cache->Put(json, res.value());
+    }
+    return res;
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const DataSet& dataset, const Json& json, const BitsetView& bitset) const {
+    SearchStatsScope stats_scope(false);
+    auto params = [&] {
+        SearchStageTimer timer(stats_scope.Get(), SearchStats::PARSE);
+        return GetSearchParams(json, knowhere::SEARCH);
+    }();
+    if (!params.has_value()) {
+        return expected<DataSetPtr>::Err(params.error(), params.what());
+    }
+    return Search(dataset, *params.value(), bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset) const {
+    if (params.GetParamType() != knowhere::SEARCH || params.GetIndexType() != this->node->Type()) {
+        return expected<DataSetPtr>::Err(Status::invalid_args, "search params compiled for another index or method");
     }
-    const Status search_status = cfg->CheckAndAdjustForSearch(&msg);
-    if (search_status != Status::success) {
-        return expected<DataSetPtr>::Err(search_status, msg);
+    const auto& cfg = params.GetConfig();
+    SearchStatsScope stats_scope(false);
+    auto stats = stats_scope.Get();
+    if (stats != nullptr) {
+        stats->SetIndexType(this->node->Type());
+        stats->SetQueries(dataset.GetRows());
     }
+    const PreparedBitset filter(bitset, stats);
 
 #ifdef NOT_COMPILE_FOR_SWIG
     TimeRecorder rc("Search");
-    auto res = this->node->Search(dataset, *cfg, bitset);
+#endif
+    auto res = [&] {
+        SearchStageTimer timer(stats, SearchStats::TOTAL);
+        return this->node->Search(dataset, cfg, filter.view());
+    }();
+#ifdef NOT_COMPILE_FOR_SWIG
     auto span = rc.ElapseFromBegin("done");
     span *= 0.001;  // convert to ms
     knowhere_search_latency.Observe(span);
     knowhere_search_count.Increment();
-    knowhere_search_topk.Observe(cfg->k.value());
-#else
-    auto res = this->node->Search(dataset, *cfg, bitset);
+    knowhere_search_topk.Observe(cfg.k.value());
 #endif
     return res;
 }
@@ -92,30 +205,99 @@ Index<T>::Search(const DataSet& dataset, const Json& json, const BitsetView& bit
 template <typename T>
 inline expected<DataSetPtr>
 Index<T>::RangeSearch(const DataSet& dataset, const Json& json, const BitsetView& bitset) const {
-    auto cfg = this->node->CreateConfig();
-    std::string msg;
-    auto status = LoadConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
-    if (status != Status::success) {
-        return expected<DataSetPtr>::Err(status, std::move(msg));
+    SearchStatsScope stats_scope(true);
+    auto params = [&] {
+        SearchStageTimer timer(stats_scope.Get(), SearchStats::PARSE);
+        return GetSearchParams(json, knowhere::RANGE_SEARCH);
+    }();
+    if (!params.has_value()) {
+        return expected<DataSetPtr>::Err(params.error(), params.what());
     }
-    status = cfg->CheckAndAdjustForRangeSearch();
-    if (status != Status::success) {
-        return expected<DataSetPtr>::Err(status, "invalid params for range search");
+    return RangeSearch(dataset, *params.value(), bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::RangeSearch(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset) const {
+    if (params.GetParamType() != knowhere::RANGE_SEARCH || params.GetIndexType() != this->node->Type()) {
+        return expected<DataSetPtr>::Err(Status::invalid_args,
+                                         "range search params compiled for another index or method");
+    }
+    const auto& cfg = params.GetConfig();
+    SearchStatsScope stats_scope(true);
+    auto stats = stats_scope.Get();
+    if (stats != nullptr) {
+        stats->SetIndexType(this->node->Type());
+        stats->SetQueries(dataset.GetRows());
     }
+    const PreparedBitset filter(bitset, stats);
 
 #ifdef NOT_COMPILE_FOR_SWIG
     TimeRecorder rc("Range Search");
-    auto res = this->node->RangeSearch(dataset, *cfg, bitset);
+#endif
+    auto res = [&] {
+        SearchStageTimer timer(stats, SearchStats::TOTAL);
+        return this->node->RangeSearch(dataset, cfg, filter.view());
+    }();
+#ifdef NOT_COMPILE_FOR_SWIG
     auto span = rc.ElapseFromBegin("done");
     span *= 0.001;  // convert to ms
     knowhere_range_search_latency.Observe(span);
     knowhere_range_search_count.Increment();
-#else
-    auto res = this->node->RangeSearch(dataset, *cfg, bitset);
 #endif
     return res;
 }
 
+template <typename T>
+inline Status
+Index<T>::SearchWithBuf(const DataSet& dataset, const Json& json, const BitsetView& bitset, int64_t* ids,
+                        float* distances) const {
+    SearchStatsScope stats_scope(false);
+    auto params = [&] {
+        SearchStageTimer timer(stats_scope.Get(), SearchStats::PARSE);
+        return GetSearchParams(json, knowhere::SEARCH);
+    }();
+    if (!params.has_value()) {
+        LOG_KNOWHERE_ERROR_ << "search with buffer: " << params.what();
+        return params.error();
+    }
+    return SearchWithBuf(dataset, *params.value(), bitset, ids, distances);
+}
+
+template <typename T>
+inline Status
+Index<T>::SearchWithBuf(const DataSet& dataset, const SearchParams& params, const BitsetView& bitset, int64_t* ids,
+                        float* distances) const {
+    if (params.GetParamType() != knowhere::SEARCH || params.GetIndexType() != this->node->Type()) {
+        LOG_KNOWHERE_ERROR_ << "search params compiled for another index or method";
+        return Status::invalid_args;
+    }
+    const auto& cfg = params.GetConfig();
+    SearchStatsScope stats_scope(false);
+    auto stats = stats_scope.Get();
+    if (stats != nullptr) {
+        stats->SetIndexType(this->node->Type());
+        stats->SetQueries(dataset.GetRows());
+    }
+    const PreparedBitset filter(bitset, stats);
+
+#ifdef NOT_COMPILE_FOR_SWIG
+    TimeRecorder rc("Search");
+#endif
+    auto status = [&] {
+        SearchStageTimer timer(stats, SearchStats::TOTAL);
+        return this->node->SearchWithBuf(dataset, cfg, filter.view(), ids, distances);
+    }();
+#ifdef NOT_COMPILE_FOR_SWIG
+    auto span = rc.ElapseFromBegin("done");
+    span *= 0.001;  // convert to ms
+    knowhere_search_latency.Observe(span);
+    knowhere_search_count.Increment();
+    knowhere_search_topk.Observe(cfg.k.value());
+#endif
+    return status;
+}
+
 template <typename T>
 inline expected<DataSetPtr>
 Index<T>::GetVectorByIds(const DataSet& dataset) const {
@@ -208,6 +390,12 @@ Index<T>::Type() const {
     return this->node->Type();
 }
 
+template <typename T>
+inline std::string
+Index<T>::QuantizerId() const {
+    return this->node->QuantizerId();
+}
+
 template class Index<IndexNode>;
 
 }  // namespace knowhere
@@ -40,6 +40,14 @@ IndexNodeThreadPoolWrapper::Search(const DataSet& dataset, const Config& cfg, co
     return thread_pool_->push([&]() { return this->index_node_->Search(dataset, cfg, bitset); }).get();
 }
 
+Status
+IndexNodeThreadPoolWrapper::SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset,
+                                          int64_t* ids, float* distances) const {
+    return thread_pool_
+        ->push([&]() { return this->index_node_->SearchWithBuf(dataset, cfg, bitset, ids, distances); })
+        .get();
+}
+
 expected<DataSetPtr>
 IndexNodeThreadPoolWrapper::RangeSearch(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const {
     return thread_pool_->push([&]() { return this->index_node_->RangeSearch(dataset, cfg, bitset); }).get();
@@ -58,6 +58,13 @@ class lru_cache {
         }
     }
 
+    void
+    clear() {
+        std::unique_lock lk(mtx);
+        map.clear();
+        list.clear();
+    }
+
  private:
     std::list<key_value_pair_t> list;
     std::unordered_map<key_t, list_iterator_t> map;
@@ -44,6 +44,27 @@ Str2FaissMetricType(std::string metric) {
     return it->second;
 }
 
+// COSINE is stored as METRIC_INNER_PRODUCT, so it maps back to IP
+inline std::string
+FaissMetricType2Str(faiss::MetricType metric) {
+    switch (metric) {
+        case faiss::MetricType::METRIC_L2:
+            return metric::L2;
+        case faiss::MetricType::METRIC_INNER_PRODUCT:
+            return metric::IP;
+        case faiss::MetricType::METRIC_Hamming:
+            return metric::HAMMING;
+        case faiss::MetricType::METRIC_Jaccard:
+            return metric::JACCARD;
+        case faiss::MetricType::METRIC_Substructure:
+            return metric::SUBSTRUCTURE;
+        case faiss::MetricType::METRIC_Superstructure:
+            return metric::SUPERSTRUCTURE;
+        default:
+            return std::to_string(metric);
+    }
+}
+
 }  // namespace knowhere
 
 #endif /* METRIC_H */
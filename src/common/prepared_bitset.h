@@ -0,0 +1,79 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/comp/search_stats.h"
+#include "simd/hook.h"
+
+namespace knowhere {
+
+// Counts the filtered out rows at most once per request instead of once per query, and only if a search asks for the
+// count. A filter that keeps at most 1 / kIdListRatio of the rows is also listed as the sorted ids it keeps, on the
+// first request of the searches that visit those ids instead of testing every bit. A view that already has a cache
+// is passed through as it is. The time spent on either is accounted to the BITSET stage of stats.
+class PreparedBitset : public BitsetViewCache {
+ public:
+    static constexpr size_t kIdListRatio = 16;
+
+    explicit PreparedBitset(const BitsetView& bitset, SearchStats* stats = nullptr) : view_(bitset), stats_(stats) {
+        if (!bitset.empty() && !bitset.has_cache()) {
+            view_ = BitsetView(bitset.data(), bitset.size(), this);
+        }
+    }
+
+    PreparedBitset(const PreparedBitset&) = delete;
+
+    PreparedBitset&
+    operator=(const PreparedBitset&) = delete;
+
+    const BitsetView&
+    view() const {
+        return view_;
+    }
+
+    size_t
+    count() const override {
+        std::call_once(count_once_, [this] {
+            SearchStageTimer timer(stats_, SearchStats::BITSET);
+            filtered_out_ = faiss::bitset_popcount(view_.data(), view_.size());
+        });
+        return filtered_out_;
+    }
+
+    const int64_t*
+    id_list() const override {
+        std::call_once(id_list_once_, [this] {
+            const size_t kept = view_.size() - count();
+            if (kept == 0 || kept * kIdListRatio > view_.size()) {
+                return;
+            }
+            SearchStageTimer timer(stats_, SearchStats::BITSET);
+            id_list_.resize(kept);
+            faiss::bitset_to_ids(view_.data(), view_.size(), false, id_list_.data());
+        });
+        return id_list_.empty() ? nullptr : id_list_.data();
+    }
+
+ private:
+    BitsetView view_;
+    SearchStats* stats_;
+    mutable std::once_flag count_once_;
+    mutable size_t filtered_out_ = 0;
+    mutable std::once_flag id_list_once_;
+    mutable std::vector<int64_t> id_list_;
+};
+
+}  // namespace knowhere
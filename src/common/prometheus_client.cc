@@ -31,5 +31,14 @@ DEFINE_PROMETHEUS_COUNTER(knowhere_range_search_count, "knowhere range search co
 DEFINE_PROMETHEUS_HISTOGRAM(knowhere_search_topk, "knowhere search topk")
 DEFINE_PROMETHEUS_HISTOGRAM(knowhere_search_latency, "search latency in knowhere (ms)")
 DEFINE_PROMETHEUS_HISTOGRAM(knowhere_range_search_latency, "range search latency in knowhere (ms)")
+DEFINE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_hit_count, "hnsw entry point cache hit count")
+DEFINE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_miss_count, "hnsw entry point cache miss count")
+DEFINE_PROMETHEUS_COUNTER(knowhere_hnsw_entry_cache_contention_count,
+                          "hnsw entry point cache lookups and puts that hit a slot being written")
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(knowhere_search_stage_latency,
+                                   "per query time of a search stage in knowhere (us), sampled")
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(knowhere_search_work,
+                                   "per query hops, distances, lists and reads in knowhere, sampled")
+DEFINE_PROMETHEUS_COUNTER(knowhere_search_stats_sampled_count, "knowhere search calls sampled for stage stats")
 
 }  // namespace knowhere
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <cinttypes>
 
+#include "knowhere/config.h"
 #include "knowhere/log.h"
 namespace knowhere {
 
@@ -126,4 +127,84 @@ GetRangeSearchResult(const std::vector<std::vector<float>>& result_distances,
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// RangeSearchResultArena
+RangeSearchResultArena::RangeSearchResultArena(const int64_t nq, const bool is_ip, const float radius,
+                                               const float range_filter)
+    : nq_(nq),
+      is_ip_(is_ip),
+      radius_(radius),
+      range_filter_(range_filter),
+      filter_(range_filter != defaultRangeFilter),
+      spans_(nq) {
+}
+
+RangeSearchResultArena::Block*
+RangeSearchResultArena::Acquire() {
+    std::lock_guard lock(mutex_);
+    if (free_blocks_.empty()) {
+        blocks_.push_back(std::make_unique<Block>());
+        return blocks_.back().get();
+    }
+    auto block = free_blocks_.back();
+    free_blocks_.pop_back();
+    return block;
+}
+
+void
+RangeSearchResultArena::Release(Block* block) {
+    std::lock_guard lock(mutex_);
+    free_blocks_.push_back(block);
+}
+
+RangeSearchResultArena::Writer::Writer(RangeSearchResultArena& arena, const int64_t query)
+    : arena_(arena), query_(query), block_(arena.Acquire()), begin_(block_->ids.size()) {
+}
+
+RangeSearchResultArena::Writer::~Writer() {
+    arena_.spans_[query_] = Span{block_, begin_, block_->ids.size() - begin_};
+    arena_.Release(block_);
+}
+
+DataSetPtr
+RangeSearchResultArena::GenResultDataSet() {
+    std::vector<size_t> lims(nq_ + 1);
+    bool in_order = blocks_.size() == 1;
+    for (int64_t i = 0; i < nq_; i++) {
+        const auto& span = spans_[i];
+        in_order = in_order && (span.size == 0 || (span.block == blocks_[0].get() && span.begin == lims[i]));
+        lims[i + 1] = lims[i] + span.size;
+    }
+    const size_t total = lims[nq_];
+    LOG_KNOWHERE_DEBUG_ << "Range search: is_ip " << (is_ip_ ? "True" : "False") << ", radius " << radius_
+                        << ", range_filter " << range_filter_ << ", total result num " << total;
+
+    if (in_order && total > 0 && blocks_[0]->ids.size() == total) {
+        // a single block already holds the results in query order, the dataset takes it over
+        struct Result {
+            std::unique_ptr<Block> block;
+            std::vector<size_t> lims;
+        };
+        auto result = std::make_shared<Result>(Result{std::move(blocks_[0]), std::move(lims)});
+        blocks_.clear();
+        free_blocks_.clear();
+        return knowhere::GenResultDataSet(nq_, result->block->ids.data(), result->block->distances.data(),
+                                          result->lims.data(), result);
+    }
+
+    auto ids = new int64_t[total];
+    auto distances = new float[total];
+    auto p_lims = new size_t[nq_ + 1];
+    std::copy_n(lims.data(), nq_ + 1, p_lims);
+    for (int64_t i = 0; i < nq_; i++) {
+        const auto& span = spans_[i];
+        if (span.size == 0) {
+            continue;
+        }
+        std::copy_n(span.block->ids.data() + span.begin, span.size, ids + lims[i]);
+        std::copy_n(span.block->distances.data() + span.begin, span.size, distances + lims[i]);
+    }
+    return knowhere::GenResultDataSet(nq_, ids, distances, p_lims);
+}
+
 }  // namespace knowhere
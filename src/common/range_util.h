@@ -13,9 +13,12 @@
 
 #include <faiss/impl/AuxIndexStructures.h>
 
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "knowhere/bitsetview.h"
+#include "knowhere/dataset.h"
 
 namespace knowhere {
 
@@ -38,4 +41,79 @@ GetRangeSearchResult(const std::vector<std::vector<float>>& result_distances,
                      const std::vector<std::vector<int64_t>>& result_labels, const bool is_ip, const int64_t nq,
                      const float radius, const float range_filter, float*& distances, int64_t*& labels, size_t*& lims);
 
+// Collects the hits of one range search call without a vector pair per query. A search task appends the in range hits
+// of its query to a block it holds while it runs, and the blocks are handed from task to task, so there are about as
+// many blocks as pool threads and they grow to the thread's share of the results. GenResultDataSet() stitches the
+// blocks together with a single copy, or adopts the only block as is when every query landed in it in order.
+class RangeSearchResultArena {
+    struct Block {
+        std::vector<int64_t> ids;
+        std::vector<float> distances;
+    };
+
+    struct Span {
+        Block* block = nullptr;
+        size_t begin = 0;
+        size_t size = 0;
+    };
+
+ public:
+    // hits outside [range_filter, radius) (or (radius, range_filter] for ip) are dropped unless range_filter is the
+    // default, i.e. when the index already returns only the hits within radius
+    RangeSearchResultArena(int64_t nq, bool is_ip, float radius, float range_filter);
+
+    // Appends the hits of one query, one writer per query and from a single task.
+    class Writer {
+     public:
+        Writer(RangeSearchResultArena& arena, int64_t query);
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer&
+        operator=(const Writer&) = delete;
+
+        void
+        Add(int64_t id, float dis) {
+            if (!arena_.filter_ || distance_in_range(dis, arena_.radius_, arena_.range_filter_, arena_.is_ip_)) {
+                block_->ids.push_back(id);
+                block_->distances.push_back(dis);
+            }
+        }
+
+        void
+        Add(const int64_t* ids, const float* distances, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                Add(ids[i], distances[i]);
+            }
+        }
+
+     private:
+        RangeSearchResultArena& arena_;
+        int64_t query_;
+        Block* block_;
+        size_t begin_;
+    };
+
+    // only once every writer is gone
+    DataSetPtr
+    GenResultDataSet();
+
+ private:
+    Block*
+    Acquire();
+
+    void
+    Release(Block* block);
+
+    const int64_t nq_;
+    const bool is_ip_;
+    const float radius_;
+    const float range_filter_;
+    const bool filter_;
+    std::vector<Span> spans_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::vector<Block*> free_blocks_;
+};
+
 }  // namespace knowhere
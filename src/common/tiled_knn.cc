@@ -0,0 +1,276 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "common/tiled_knn.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "faiss/utils/Heap.h"
+#include "knowhere/log.h"
+#include "simd/hook.h"
+
+namespace knowhere {
+
+namespace {
+
+template <typename T>
+inline int64_t
+TileRows(int64_t dim) {
+    return std::max<int64_t>(1, kTiledKnnTileBytes / (dim * sizeof(T)));
+}
+
+// distances of a query to every row of a tile, float rows go through the batched kernels
+template <bool is_ip>
+struct FloatTileDistance {
+    void
+    operator()(float* dis, const float* query, const float* tile, int64_t dim, int64_t rows) const {
+        if constexpr (is_ip) {
+            faiss::fvec_inner_products_ny(dis, query, tile, dim, rows);
+        } else {
+            faiss::fvec_L2sqr_ny(dis, query, tile, dim, rows);
+        }
+    }
+};
+
+// half precision rows have no batched kernel, the tile still stays in cache for the whole query block
+struct HalfTileDistance {
+    float (*distance)(const uint16_t*, const uint16_t*, size_t);
+
+    void
+    operator()(float* dis, const uint16_t* query, const uint16_t* tile, int64_t dim, int64_t rows) const {
+        for (int64_t j = 0; j < rows; ++j) {
+            dis[j] = distance(query, tile + j * dim, dim);
+        }
+    }
+};
+
+// Scan base rows [b_begin, b_end) tile by tile for queries [q_begin, q_end), the heaps of the query block are
+// stored contiguously starting at heap_ids / heap_dis and are left unsorted.
+template <class C, typename T, class TileDistance>
+void
+SearchUnit(const T* xq, int64_t q_begin, int64_t q_end, const T* xb, int64_t b_begin, int64_t b_end, int64_t dim,
+           int64_t k, bool is_cosine, const BitsetView& bitset, const TileDistance& tile_distance, int64_t* heap_ids,
+           float* heap_dis) {
+    const int64_t tile_rows = TileRows<T>(dim);
+    std::vector<float> dis_buf(tile_rows);
+    std::vector<float> norm_buf(is_cosine ? tile_rows : 0);
+
+    for (int64_t q = q_begin; q < q_end; ++q) {
+        faiss::heap_heapify<C>(k, heap_dis + (q - q_begin) * k, heap_ids + (q - q_begin) * k);
+    }
+
+    for (int64_t t_begin = b_begin; t_begin < b_end; t_begin += tile_rows) {
+        const int64_t t_rows = std::min(b_end, t_begin + tile_rows) - t_begin;
+        const T* tile = xb + t_begin * dim;
+        if constexpr (std::is_same<T, float>::value) {
+            if (is_cosine) {
+                for (int64_t j = 0; j < t_rows; ++j) {
+                    norm_buf[j] = std::sqrt(faiss::fvec_norm_L2sqr(tile + j * dim, dim));
+                }
+            }
+        }
+        for (int64_t q = q_begin; q < q_end; ++q) {
+            tile_distance(dis_buf.data(), xq + q * dim, tile, dim, t_rows);
+            auto cur_dis = heap_dis + (q - q_begin) * k;
+            auto cur_ids = heap_ids + (q - q_begin) * k;
+            for (int64_t j = 0; j < t_rows; ++j) {
+                const int64_t id = t_begin + j;
+                if (!bitset.empty() && bitset.test(id)) {
+                    continue;
+                }
+                float dis = is_cosine ? dis_buf[j] / norm_buf[j] : dis_buf[j];
+                if (C::cmp(cur_dis[0], dis)) {
+                    faiss::heap_replace_top<C>(k, cur_dis, cur_ids, dis, id);
+                }
+            }
+        }
+    }
+}
+
+template <class C, typename T, class TileDistance>
+Status
+TiledKnnSearchImpl(const T* xq, int64_t nq, const T* xb, int64_t nb, int64_t dim, int64_t k, bool is_cosine,
+                   const BitsetView& bitset, const TileDistance& tile_distance, int64_t* ids, float* distances,
+                   const std::shared_ptr<ThreadPool>& pool) {
+    const int64_t n_qblocks = (nq + kTiledKnnQueryBlock - 1) / kTiledKnnQueryBlock;
+    const int64_t tile_rows = TileRows<T>(dim);
+    const int64_t n_tiles = (nb + tile_rows - 1) / tile_rows;
+
+    // split the base vectors only when there are not enough query blocks to keep every worker busy
+    int64_t n_parts =
+        std::clamp<int64_t>((pool->size() + n_qblocks - 1) / n_qblocks, 1, std::max<int64_t>(1, n_tiles));
+    const int64_t part_rows = std::max<int64_t>(1, (n_tiles + n_parts - 1) / n_parts) * tile_rows;
+    n_parts = std::max<int64_t>(1, (nb + part_rows - 1) / part_rows);
+
+    // part 0 writes straight into the output buffers, the others into scratch heaps merged afterwards
+    std::vector<int64_t> part_ids((n_parts - 1) * nq * k);
+    std::vector<float> part_dis((n_parts - 1) * nq * k);
+    auto heap_ids_of = [&](int64_t part, int64_t q) {
+        return part == 0 ? ids + q * k : part_ids.data() + ((part - 1) * nq + q) * k;
+    };
+    auto heap_dis_of = [&](int64_t part, int64_t q) {
+        return part == 0 ? distances + q * k : part_dis.data() + ((part - 1) * nq + q) * k;
+    };
+
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(n_qblocks * n_parts);
+    for (int64_t qb = 0; qb < n_qblocks; ++qb) {
+        for (int64_t part = 0; part < n_parts; ++part) {
+            futs.emplace_back(pool->push([&, qb, part] {
+                ThreadPool::ScopedOmpSetter setter(1);
+                const int64_t q_begin = qb * kTiledKnnQueryBlock;
+                const int64_t q_end = std::min(nq, q_begin + kTiledKnnQueryBlock);
+                const int64_t b_begin = part * part_rows;
+                const int64_t b_end = std::min(nb, b_begin + part_rows);
+                SearchUnit<C>(xq, q_begin, q_end, xb, b_begin, b_end, dim, k, is_cosine, bitset, tile_distance,
+                              heap_ids_of(part, q_begin), heap_dis_of(part, q_begin));
+            }));
+        }
+    }
+    for (auto& fut : futs) {
+        fut.wait();
+    }
+
+    futs.clear();
+    for (int64_t qb = 0; qb < n_qblocks; ++qb) {
+        futs.emplace_back(pool->push([&, qb] {
+            ThreadPool::ScopedOmpSetter setter(1);
+            const int64_t q_begin = qb * kTiledKnnQueryBlock;
+            const int64_t q_end = std::min(nq, q_begin + kTiledKnnQueryBlock);
+            for (int64_t q = q_begin; q < q_end; ++q) {
+                auto cur_ids = heap_ids_of(0, q);
+                auto cur_dis = heap_dis_of(0, q);
+                for (int64_t part = 1; part < n_parts; ++part) {
+                    auto src_ids = heap_ids_of(part, q);
+                    auto src_dis = heap_dis_of(part, q);
+                    for (int64_t j = 0; j < k; ++j) {
+                        if (src_ids[j] != -1 && C::cmp(cur_dis[0], src_dis[j])) {
+                            faiss::heap_replace_top<C>(k, cur_dis, cur_ids, src_dis[j], src_ids[j]);
+                        }
+                    }
+                }
+                faiss::heap_reorder<C>(k, cur_dis, cur_ids);
+            }
+        }));
+    }
+    for (auto& fut : futs) {
+        fut.wait();
+    }
+    return Status::success;
+}
+
+template <class C>
+Status
+IdListKnnSearchImpl(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+                    bool is_cosine, const BitsetView& bitset, int64_t* ids, float* distances,
+                    const std::shared_ptr<ThreadPool>& pool) {
+    constexpr bool is_ip = std::is_same<C, faiss::CMin<float, int64_t>>::value;
+    const int64_t* id_list = bitset.id_list();
+    const int64_t n_ids = bitset.id_list_size();
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(nq);
+    for (int64_t q = 0; q < nq; ++q) {
+        futs.emplace_back(pool->push([&, q] {
+            ThreadPool::ScopedOmpSetter setter(1);
+            const float* cur_query = xq + q * dim;
+            auto cur_ids = ids + q * k;
+            auto cur_dis = distances + q * k;
+            faiss::heap_heapify<C>(k, cur_dis, cur_ids);
+            for (int64_t i = 0; i < n_ids; ++i) {
+                const int64_t id = id_list[i];
+                if (id >= nb) {
+                    break;
+                }
+                const float* y = xb + id * dim;
+                float dis;
+                if constexpr (is_ip) {
+                    dis = faiss::fvec_inner_product(cur_query, y, dim);
+                    if (is_cosine) {
+                        dis /= std::sqrt(faiss::fvec_norm_L2sqr(y, dim));
+                    }
+                } else {
+                    dis = faiss::fvec_L2sqr(cur_query, y, dim);
+                }
+                if (C::cmp(cur_dis[0], dis)) {
+                    faiss::heap_replace_top<C>(k, cur_dis, cur_ids, dis, id);
+                }
+            }
+            faiss::heap_reorder<C>(k, cur_dis, cur_ids);
+        }));
+    }
+    for (auto& fut : futs) {
+        fut.wait();
+    }
+    return Status::success;
+}
+
+}  // namespace
+
+Status
+TiledKnnSearch(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+               faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* ids,
+               float* distances, const std::shared_ptr<ThreadPool>& pool) {
+    switch (metric_type) {
+        case faiss::METRIC_L2:
+            return TiledKnnSearchImpl<faiss::CMax<float, int64_t>>(xq, nq, xb, nb, dim, k, false, bitset,
+                                                                   FloatTileDistance<false>(), ids, distances, pool);
+        case faiss::METRIC_INNER_PRODUCT:
+            return TiledKnnSearchImpl<faiss::CMin<float, int64_t>>(xq, nq, xb, nb, dim, k, is_cosine, bitset,
+                                                                   FloatTileDistance<true>(), ids, distances, pool);
+        default:
+            LOG_KNOWHERE_ERROR_ << "Invalid metric type for tiled knn search: " << metric_type;
+            return Status::invalid_metric_type;
+    }
+}
+
+Status
+TiledKnnSearch(const uint16_t* xq, int64_t nq, const uint16_t* xb, int64_t nb, int64_t dim, int64_t k,
+               faiss::MetricType metric_type, bool is_bf16, const BitsetView& bitset, int64_t* ids, float* distances,
+               const std::shared_ptr<ThreadPool>& pool) {
+    switch (metric_type) {
+        case faiss::METRIC_L2: {
+            const HalfTileDistance tile_distance{is_bf16 ? faiss::bf16_vec_L2sqr : faiss::fp16_vec_L2sqr};
+            return TiledKnnSearchImpl<faiss::CMax<float, int64_t>>(xq, nq, xb, nb, dim, k, false, bitset,
+                                                                   tile_distance, ids, distances, pool);
+        }
+        case faiss::METRIC_INNER_PRODUCT: {
+            const HalfTileDistance tile_distance{is_bf16 ? faiss::bf16_vec_inner_product
+                                                         : faiss::fp16_vec_inner_product};
+            return TiledKnnSearchImpl<faiss::CMin<float, int64_t>>(xq, nq, xb, nb, dim, k, false, bitset,
+                                                                   tile_distance, ids, distances, pool);
+        }
+        default:
+            LOG_KNOWHERE_ERROR_ << "Invalid metric type for tiled knn search: " << metric_type;
+            return Status::invalid_metric_type;
+    }
+}
+
+Status
+IdListKnnSearch(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+                faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* ids,
+                float* distances, const std::shared_ptr<ThreadPool>& pool) {
+    switch (metric_type) {
+        case faiss::METRIC_L2:
+            return IdListKnnSearchImpl<faiss::CMax<float, int64_t>>(xq, nq, xb, nb, dim, k, false, bitset, ids,
+                                                                    distances, pool);
+        case faiss::METRIC_INNER_PRODUCT:
+            return IdListKnnSearchImpl<faiss::CMin<float, int64_t>>(xq, nq, xb, nb, dim, k, is_cosine, bitset, ids,
+                                                                    distances, pool);
+        default:
+            LOG_KNOWHERE_ERROR_ << "Invalid metric type for id list knn search: " << metric_type;
+            return Status::invalid_metric_type;
+    }
+}
+
+}  // namespace knowhere
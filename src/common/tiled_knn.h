@@ -0,0 +1,68 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <faiss/MetricType.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/expected.h"
+
+namespace knowhere {
+
+// batches with fewer queries keep the one-task-per-query path, it is already latency optimal there
+constexpr int64_t kTiledKnnMinNq = 16;
+// number of queries that share one pass over a base tile
+constexpr int64_t kTiledKnnQueryBlock = 32;
+// bytes of base vectors per tile, sized to stay resident in L2 together with a query block
+constexpr int64_t kTiledKnnTileBytes = 256 * 1024;
+
+/**
+ * @brief Exhaustive float top-k search that splits queries into blocks and the base vectors into cache sized
+ * tiles, so that every base tile is streamed once per query block instead of once per query. Each pool task
+ * owns one (query block x base range) unit and feeds its own per-query heaps, the partial heaps are merged
+ * when the base range had to be split across tasks to keep the pool busy.
+ *
+ * @param xq queries, already normalized by the caller for COSINE
+ * @param is_cosine divide inner products by the base vector norms (base vectors are not normalized)
+ * @param ids output ids, size nq * k
+ * @param distances output distances, size nq * k
+ */
+Status
+TiledKnnSearch(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+               faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* ids,
+               float* distances, const std::shared_ptr<ThreadPool>& pool);
+
+/**
+ * @brief TiledKnnSearch over fp16 or bf16 vectors, the queries already normalized by the caller for COSINE and
+ * compared to the stored (normalized) vectors by inner product.
+ */
+Status
+TiledKnnSearch(const uint16_t* xq, int64_t nq, const uint16_t* xb, int64_t nb, int64_t dim, int64_t k,
+               faiss::MetricType metric_type, bool is_bf16, const BitsetView& bitset, int64_t* ids, float* distances,
+               const std::shared_ptr<ThreadPool>& pool);
+
+/**
+ * @brief Exhaustive float top-k search over the ids kept by a very selective filter only, the filter must carry its
+ * id list (BitsetView::has_id_list()). Used instead of a full scan that would test and skip almost every row.
+ *
+ * The parameters are those of TiledKnnSearch.
+ */
+Status
+IdListKnnSearch(const float* xq, int64_t nq, const float* xb, int64_t nb, int64_t dim, int64_t k,
+                faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* ids,
+                float* distances, const std::shared_ptr<ThreadPool>& pool);
+
+}  // namespace knowhere
@@ -16,6 +16,7 @@
 #include <cstdint>
 
 #include "knowhere/log.h"
+#include "simd/fp16.h"
 #include "simd/hook.h"
 
 namespace knowhere {
@@ -66,4 +67,34 @@ CopyAndNormalizeFloatVec(const float* x, int32_t dim) {
     return x_norm;
 }
 
+std::unique_ptr<float[]>
+CopyAndNormalizeFloatVecs(const float* x, size_t rows, int32_t dim) {
+    auto x_norm = std::make_unique<float[]>(rows * dim);
+    std::copy_n(x, rows * dim, x_norm.get());
+    NormalizeVecs(x_norm.get(), rows, dim);
+    return x_norm;
+}
+
+void
+NormalizeHalfVec(uint16_t* x, int32_t d, bool is_bf16) {
+    float norm_l2_sqr = is_bf16 ? faiss::bf16_vec_norm_L2sqr(x, d) : faiss::fp16_vec_norm_L2sqr(x, d);
+    if (norm_l2_sqr > 0 && std::abs(1.0f - norm_l2_sqr) > FloatAccuracy) {
+        float norm_l2 = std::sqrt(norm_l2_sqr);
+        for (int32_t i = 0; i < d; i++) {
+            x[i] = is_bf16 ? faiss::fp32_to_bf16(faiss::bf16_to_fp32(x[i]) / norm_l2)
+                           : faiss::fp32_to_fp16(faiss::fp16_to_fp32(x[i]) / norm_l2);
+        }
+    }
+}
+
+std::unique_ptr<uint16_t[]>
+CopyAndNormalizeHalfVecs(const uint16_t* x, size_t rows, int32_t dim, bool is_bf16) {
+    auto x_norm = std::make_unique<uint16_t[]>(rows * dim);
+    std::copy_n(x, rows * dim, x_norm.get());
+    for (size_t i = 0; i < rows; i++) {
+        NormalizeHalfVec(x_norm.get() + i * dim, dim, is_bf16);
+    }
+    return x_norm;
+}
+
 }  // namespace knowhere
@@ -19,11 +19,13 @@
 #include "fmt/core.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #ifndef _WINDOWS
 #include "diskann/linux_aligned_file_reader.h"
+#include "diskann/uring_aligned_file_reader.h"
 #else
 #include "diskann/windows_aligned_file_reader.h"
 #endif
@@ -166,6 +168,8 @@ class DiskANNIndexNode : public IndexNode {
     std::atomic_int64_t dim_;
     std::atomic_int64_t count_;
     std::shared_ptr<ThreadPool> search_pool_;
+    // number of queries one search task keeps in flight, 1 unless the reader supports pipelined reads
+    uint64_t pipeline_width_ = 1;
 };
 
 }  // namespace knowhere
@@ -251,6 +255,45 @@ CheckMetric(const std::string& diskann_metric) {
         return true;
     }
 }
+
+// Adds the QueryStats of the queries a task ran to a sampled search, the time of the task outside of disk reads is
+// accounted as graph traversal.
+class ScopedDiskSearchStats {
+    using clock = std::chrono::steady_clock;
+
+ public:
+    explicit ScopedDiskSearchStats(SearchStats* stats) : stats_(stats) {
+        if (stats_ != nullptr) {
+            start_ = clock::now();
+        }
+    }
+
+    ~ScopedDiskSearchStats() {
+        if (stats_ == nullptr) {
+            return;
+        }
+        const auto task = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_);
+        const auto io = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::micro>(query_stats_.io_us));
+        stats_->AddTime(SearchStats::IO, io);
+        stats_->AddTime(SearchStats::SCAN, std::max(task - io, std::chrono::nanoseconds(0)));
+        stats_->Add(SearchStats::HOPS, query_stats_.n_hops);
+        stats_->Add(SearchStats::DISTANCE_COMPUTATIONS, query_stats_.n_cmps);
+        stats_->Add(SearchStats::DISK_READS, query_stats_.n_ios);
+        stats_->Add(SearchStats::CACHE_HITS, query_stats_.n_cache_hits);
+    }
+
+    // where the search fills its counters, nullptr when the call is not sampled
+    diskann::QueryStats*
+    Get() {
+        return stats_ != nullptr ? &query_stats_ : nullptr;
+    }
+
+ private:
+    SearchStats* stats_;
+    diskann::QueryStats query_stats_;
+    clock::time_point start_;
+};
 }  // namespace
 
 template <typename T>
@@ -303,7 +346,8 @@ DiskANNIndexNode<T>::Build(const DataSet& dataset, const Config& cfg) {
                                                        static_cast<uint32_t>(build_conf.disk_pq_dims.value()),
                                                        false,
                                                        build_conf.accelerate_build.value(),
-                                                       static_cast<uint32_t>(num_nodes_to_cache)};
+                                                       static_cast<uint32_t>(num_nodes_to_cache),
+                                                       build_conf.reorder_disk_layout.value()};
     RETURN_IF_ERROR(TryDiskANNCall([&]() {
         int res = diskann::build_disk_index<T>(diskann_internal_build_config);
         if (res != 0)
@@ -379,11 +423,21 @@ DiskANNIndexNode<T>::Deserialize(const BinarySet& binset, const Config& cfg) {
     // load diskann pq code and meta info
     std::shared_ptr<AlignedFileReader> reader = nullptr;
 
-    reader.reset(new LinuxAlignedFileReader());
+    pipeline_width_ = 1;
+    if (prep_conf.use_io_uring.value() && UringAlignedFileReader::is_supported()) {
+        reader.reset(new UringAlignedFileReader());
+        pipeline_width_ = prep_conf.search_pipeline_width.value();
+    } else {
+        if (prep_conf.use_io_uring.value()) {
+            LOG_KNOWHERE_WARNING_ << "io_uring is not supported, fall back to libaio.";
+        }
+        reader.reset(new LinuxAlignedFileReader());
+    }
 
     pq_flash_index_ = std::make_unique<diskann::PQFlashIndex<T>>(reader, diskann_metric);
     auto disk_ann_call = [&]() {
-        int res = pq_flash_index_->load(search_pool_->size(), index_prefix_.c_str());
+        // every query in flight owns one search scratch
+        int res = pq_flash_index_->load(search_pool_->size() * pipeline_width_, index_prefix_.c_str());
         if (res != 0) {
             throw diskann::ANNException("pq_flash_index_->load returned non-zero value: " + std::to_string(res), -1);
         }
@@ -544,14 +598,31 @@ DiskANNIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const Bit
     auto p_dist = new float[k * nq];
 
     bool all_searches_are_good = true;
+    auto stats = SearchStats::Active();
     std::vector<folly::Future<folly::Unit>> futures;
-    futures.reserve(nq);
-    for (int64_t row = 0; row < nq; ++row) {
-        futures.emplace_back(search_pool_->push([&, index = row]() {
-            pq_flash_index_->cached_beam_search(xq + (index * dim), k, lsearch, p_id + (index * k),
-                                                p_dist + (index * k), beamwidth, false, nullptr, feder_result, bitset,
-                                                filter_ratio, for_tuning);
-        }));
+    if (pipeline_width_ > 1 && nq > 1 && feder_result == nullptr) {
+        // spread the queries evenly so that every task keeps the same number of queries in flight
+        auto batch_size = std::max<int64_t>(1, std::min<int64_t>(pipeline_width_, nq / search_pool_->size()));
+        futures.reserve((nq + batch_size - 1) / batch_size);
+        for (int64_t row = 0; row < nq; row += batch_size) {
+            futures.emplace_back(search_pool_->push([&, begin = row, end = std::min(nq, row + batch_size)]() {
+                // the pipelined search does not fill QueryStats, its whole time counts as traversal
+                SearchStageTimer timer(stats, SearchStats::SCAN);
+                pq_flash_index_->pipelined_beam_search(xq + (begin * dim), end - begin, dim, k, lsearch,
+                                                       p_id + (begin * k), p_dist + (begin * k), beamwidth,
+                                                       pipeline_width_, bitset, filter_ratio, for_tuning);
+            }));
+        }
+    } else {
+        futures.reserve(nq);
+        for (int64_t row = 0; row < nq; ++row) {
+            futures.emplace_back(search_pool_->push([&, index = row]() {
+                ScopedDiskSearchStats disk_stats(stats);
+                pq_flash_index_->cached_beam_search(xq + (index * dim), k, lsearch, p_id + (index * k),
+                                                    p_dist + (index * k), beamwidth, false, disk_stats.Get(),
+                                                    feder_result, bitset, filter_ratio, for_tuning);
+            }));
+        }
     }
     for (auto& future : futures) {
         if (TryDiskANNCall([&]() { future.wait(); }) != Status::success) {
@@ -607,27 +678,21 @@ DiskANNIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, cons
     auto nq = dataset.GetRows();
     auto xq = static_cast<const T*>(dataset.GetTensor());
 
-    int64_t* p_id = nullptr;
-    float* p_dist = nullptr;
-    size_t* p_lims = nullptr;
-
-    std::vector<std::vector<int64_t>> result_id_array(nq);
-    std::vector<std::vector<float>> result_dist_array(nq);
+    RangeSearchResultArena arena(nq, is_ip, radius, range_filter);
 
+    auto stats = SearchStats::Active();
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(nq);
     bool all_searches_are_good = true;
     for (int64_t row = 0; row < nq; ++row) {
         futures.emplace_back(search_pool_->push([&, index = row]() {
-            std::vector<int64_t> indices;
-            std::vector<float> distances;
-            pq_flash_index_->range_search(xq + (index * dim), radius, min_k, max_k, result_id_array[index],
-                                          result_dist_array[index], beamwidth, search_list_and_k_ratio, bitset);
-            // filter range search result
-            if (search_conf.range_filter.value() != defaultRangeFilter) {
-                FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
-                                                range_filter);
-            }
+            ScopedDiskSearchStats disk_stats(stats);
+            // the candidate lists are resized for every query, reusing them keeps their capacity across queries
+            thread_local std::vector<int64_t> indices;
+            thread_local std::vector<float> distances;
+            pq_flash_index_->range_search(xq + (index * dim), radius, min_k, max_k, indices, distances, beamwidth,
+                                          search_list_and_k_ratio, bitset, disk_stats.Get());
+            RangeSearchResultArena::Writer(arena, index).Add(indices.data(), distances.data(), indices.size());
         }));
     }
     for (auto& future : futures) {
@@ -639,9 +704,7 @@ DiskANNIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, cons
         return expected<DataSetPtr>::Err(Status::diskann_inner_error, "some search failed");
     }
 
-    GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, search_conf.range_filter.value(),
-                         p_dist, p_id, p_lims);
-    return GenResultDataSet(nq, p_id, p_dist, p_lims);
+    return arena.GenResultDataSet();
 }
 
 /*
@@ -53,6 +53,9 @@ class DiskANNConfig : public BaseConfig {
     // This is the flag to enable fast build, in which we will not build vamana graph by full 2 round. This can
     // accelerate index build ~30% with an ~1% recall regression.
     CFG_BOOL accelerate_build;
+    // Reorder the nodes on disk so that graph neighbors share sectors, which cuts the number of sector reads per query.
+    // Build needs the whole graph in memory once more and the id -> sector map is loaded with the index.
+    CFG_BOOL reorder_disk_layout;
     // While serving the index, the entire graph is stored on SSD. For faster search performance, you can cache a few
     // frequently accessed nodes in memory.
     CFG_FLOAT search_cache_budget_gb;
@@ -78,6 +81,12 @@ class DiskANNConfig : public BaseConfig {
     // value should be in range of [0.0, 1.0] which means when greater or equal to x% of the bits are set,
     // use PQ + Refine. Default to -1.0f, negative vlaues will use dynamic threshold calculator given topk.
     CFG_FLOAT filter_threshold;
+    // Read the index through io_uring instead of libaio. Falls back to libaio when the kernel does not support it.
+    CFG_BOOL use_io_uring;
+    // With io_uring, the number of queries a search thread keeps in flight at the same time. Each of them owns its
+    // own search scratch, so the scratch memory of the index grows linearly with this value. Use 1 to search the
+    // queries one by one.
+    CFG_INT search_pipeline_width;
     KNOHWERE_DECLARE_CONFIG(DiskANNConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(metric_type)
             .set_default("L2")
@@ -116,6 +125,10 @@ class DiskANNConfig : public BaseConfig {
             .description("a flag to enbale fast build.")
             .set_default(false)
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(reorder_disk_layout)
+            .description("pack graph neighbors into the same disk sectors.")
+            .set_default(false)
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(search_cache_budget_gb)
             .description("the size of cached nodes in GB.")
             .set_default(0)
@@ -156,6 +169,15 @@ class DiskANNConfig : public BaseConfig {
             .set_default(-1.0f)
             .set_range(-1.0f, 1.0f)
             .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(use_io_uring)
+            .description("read the index through io_uring instead of libaio.")
+            .set_default(false)
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_pipeline_width)
+            .description("the number of queries a search thread keeps in flight with io_uring.")
+            .set_default(1)
+            .set_range(1, 16)
+            .for_deserialize();
     }
 
     inline Status
@@ -11,23 +11,33 @@
 
 #include "common/metric.h"
 #include "common/range_util.h"
+#include "common/tiled_knn.h"
 #include "faiss/IndexBinaryFlat.h"
 #include "faiss/IndexFlat.h"
+#include "faiss/IndexScalarQuantizer.h"
 #include "faiss/index_io.h"
+#include "faiss/utils/Heap.h"
 #include "index/flat/flat_config.h"
 #include "io/FaissIO.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/factory.h"
 #include "knowhere/log.h"
 #include "knowhere/utils.h"
+#include "simd/hook.h"
 
 namespace knowhere {
 
+// FlatIndexNode<faiss::IndexScalarQuantizer> is the FLAT index over fp16 or bf16 vectors: the tensors it takes and
+// returns hold uint16 components of that type, the scalar quantizer codes are these components as they are, and
+// the distances are computed on them by the half precision kernels without decoding the base.
 template <typename T>
 class FlatIndexNode : public IndexNode {
  public:
-    FlatIndexNode(const Object&) : index_(nullptr) {
-        static_assert(std::is_same<T, faiss::IndexFlat>::value || std::is_same<T, faiss::IndexBinaryFlat>::value,
+    FlatIndexNode(const Object&, faiss::QuantizerType qtype = faiss::QuantizerType::QT_fp16)
+        : index_(nullptr), qtype_(qtype) {
+        static_assert(std::is_same<T, faiss::IndexFlat>::value || std::is_same<T, faiss::IndexBinaryFlat>::value ||
+                          std::is_same<T, faiss::IndexScalarQuantizer>::value,
                       "not support");
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
     }
@@ -36,9 +46,11 @@ class FlatIndexNode : public IndexNode {
     Train(const DataSet& dataset, const Config& cfg) override {
         const FlatConfig& f_cfg = static_cast<const FlatConfig&>(cfg);
 
-        // do normalize for COSINE metric type
-        if (IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE)) {
-            Normalize(dataset);
+        // do normalize for COSINE metric type, the half precision vectors are normalized by Add
+        if constexpr (!std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            if (IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE)) {
+                Normalize(dataset);
+            }
         }
 
         auto metric = Str2FaissMetricType(f_cfg.metric_type.value());
@@ -46,7 +58,15 @@ class FlatIndexNode : public IndexNode {
             LOG_KNOWHERE_WARNING_ << "please check metric type: " << f_cfg.metric_type.value();
             return metric.error();
         }
-        index_ = std::make_unique<T>(dataset.GetDim(), metric.value());
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            if (metric.value() != faiss::METRIC_L2 && metric.value() != faiss::METRIC_INNER_PRODUCT) {
+                LOG_KNOWHERE_WARNING_ << "metric type not support in " << Type() << ": " << f_cfg.metric_type.value();
+                return Status::invalid_metric_type;
+            }
+            index_ = std::make_unique<T>(dataset.GetDim(), qtype_, metric.value());
+        } else {
+            index_ = std::make_unique<T>(dataset.GetDim(), metric.value());
+        }
         return Status::success;
     }
 
@@ -60,17 +80,43 @@ class FlatIndexNode : public IndexNode {
         if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
             index_->add(n, (const uint8_t*)x);
         }
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            const FlatConfig& f_cfg = static_cast<const FlatConfig&>(cfg);
+            const size_t offset = index_->codes.size();
+            index_->codes.insert(index_->codes.end(), (const uint8_t*)x, (const uint8_t*)x + n * index_->code_size);
+            if (IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE)) {
+                auto added = (uint16_t*)(index_->codes.data() + offset);
+                for (int64_t i = 0; i < n; ++i) {
+                    NormalizeHalfVec(added + i * index_->d, index_->d, qtype_ == faiss::QuantizerType::QT_bf16);
+                }
+            }
+            index_->ntotal += n;
+        }
         return Status::success;
     }
 
     expected<DataSetPtr>
     Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override {
+        auto k = static_cast<const FlatConfig&>(cfg).k.value();
+        auto nq = dataset.GetRows();
+        auto len = k * nq;
+        std::unique_ptr<int64_t[]> ids(new int64_t[len]);
+        std::unique_ptr<float[]> distances(new float[len]);
+        auto status = SearchWithBuf(dataset, cfg, bitset, ids.get(), distances.get());
+        if (status != Status::success) {
+            return expected<DataSetPtr>::Err(status, "failed to search flat index");
+        }
+        return GenResultDataSet(nq, k, ids.release(), distances.release());
+    }
+
+    Status
+    SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override {
         if (!index_) {
             LOG_KNOWHERE_WARNING_ << "search on empty index";
-            expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+            return Status::empty_index;
         }
 
-        DataSetPtr results = std::make_shared<DataSet>();
         const FlatConfig& f_cfg = static_cast<const FlatConfig&>(cfg);
         bool is_cosine = IsMetricType(f_cfg.metric_type.value(), knowhere::metric::COSINE);
 
@@ -79,17 +125,46 @@ class FlatIndexNode : public IndexNode {
         auto x = dataset.GetTensor();
         auto dim = dataset.GetDim();
 
-        auto len = k * nq;
-        int64_t* ids = nullptr;
-        float* distances = nullptr;
+        auto stats = SearchStats::Active();
+        AddScanWork(stats, nq, bitset);
         try {
-            ids = new (std::nothrow) int64_t[len];
-            distances = new (std::nothrow) float[len];
+            if constexpr (std::is_same<T, faiss::IndexFlat>::value) {
+                // large batches share every base tile across a block of queries, a very selective filter only visits
+                // the ids it keeps
+                if (nq >= kTiledKnnMinNq || bitset.has_id_list()) {
+                    SearchStageTimer timer(stats, SearchStats::SCAN);
+                    auto xq = (const float*)x;
+                    std::unique_ptr<float[]> copied_queries = nullptr;
+                    if (is_cosine) {
+                        copied_queries = CopyAndNormalizeFloatVecs(xq, nq, dim);
+                        xq = copied_queries.get();
+                    }
+                    return bitset.has_id_list()
+                               ? IdListKnnSearch(xq, nq, index_->get_xb(), index_->ntotal, dim, k, index_->metric_type,
+                                                 false, bitset, ids, distances, search_pool_)
+                               : TiledKnnSearch(xq, nq, index_->get_xb(), index_->ntotal, dim, k, index_->metric_type,
+                                                false, bitset, ids, distances, search_pool_);
+                }
+            }
+            if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+                if (nq >= kTiledKnnMinNq) {
+                    SearchStageTimer timer(stats, SearchStats::SCAN);
+                    auto xq = (const uint16_t*)x;
+                    std::unique_ptr<uint16_t[]> copied_queries = nullptr;
+                    if (is_cosine) {
+                        copied_queries = CopyAndNormalizeHalfVecs(xq, nq, dim, IsBf16());
+                        xq = copied_queries.get();
+                    }
+                    return TiledKnnSearch(xq, nq, (const uint16_t*)index_->codes.data(), index_->ntotal, dim, k,
+                                          index_->metric_type, IsBf16(), bitset, ids, distances, search_pool_);
+                }
+            }
             std::vector<folly::Future<folly::Unit>> futs;
             futs.reserve(nq);
             for (int i = 0; i < nq; ++i) {
                 futs.emplace_back(search_pool_->push([&, index = i] {
                     ThreadPool::ScopedOmpSetter setter(1);
+                    SearchStageTimer timer(stats, SearchStats::SCAN);
                     auto cur_ids = ids + k * index;
                     auto cur_dis = distances + k * index;
                     if constexpr (std::is_same<T, faiss::IndexFlat>::value) {
@@ -101,6 +176,15 @@ class FlatIndexNode : public IndexNode {
                         }
                         index_->search(1, cur_query, k, cur_dis, cur_ids, bitset);
                     }
+                    if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+                        auto cur_query = (const uint16_t*)x + dim * index;
+                        std::unique_ptr<uint16_t[]> copied_query = nullptr;
+                        if (is_cosine) {
+                            copied_query = CopyAndNormalizeHalfVecs(cur_query, 1, dim, IsBf16());
+                            cur_query = copied_query.get();
+                        }
+                        HalfKnnSearch(cur_query, k, cur_dis, cur_ids, bitset);
+                    }
                     if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
                         auto cur_i_dis = reinterpret_cast<int32_t*>(cur_dis);
                         index_->search(1, (const uint8_t*)x + index * dim / 8, k, cur_i_dis, cur_ids, bitset);
@@ -116,13 +200,10 @@ class FlatIndexNode : public IndexNode {
                 fut.wait();
             }
         } catch (const std::exception& e) {
-            std::unique_ptr<int64_t[]> auto_delete_ids(ids);
-            std::unique_ptr<float[]> auto_delete_dis(distances);
             LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
-            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            return Status::faiss_inner_error;
         }
-
-        return GenResultDataSet(nq, k, ids, distances);
+        return Status::success;
     }
 
     expected<DataSetPtr>
@@ -143,21 +224,17 @@ class FlatIndexNode : public IndexNode {
         float range_filter = f_cfg.range_filter.value();
         bool is_ip = (index_->metric_type == faiss::METRIC_INNER_PRODUCT);
 
-        int64_t* ids = nullptr;
-        float* distances = nullptr;
-        size_t* lims = nullptr;
-
-        std::vector<std::vector<int64_t>> result_id_array(nq);
-        std::vector<std::vector<float>> result_dist_array(nq);
-        std::vector<size_t> result_size(nq);
-        std::vector<size_t> result_lims(nq + 1);
+        RangeSearchResultArena arena(nq, is_ip, radius, range_filter);
 
+        auto stats = SearchStats::Active();
+        AddScanWork(stats, nq, bitset);
         try {
             std::vector<folly::Future<folly::Unit>> futs;
             futs.reserve(nq);
             for (int i = 0; i < nq; ++i) {
                 futs.emplace_back(search_pool_->push([&, index = i] {
                     ThreadPool::ScopedOmpSetter setter(1);
+                    SearchStageTimer timer(stats, SearchStats::SCAN);
                     faiss::RangeSearchResult res(1);
                     if constexpr (std::is_same<T, faiss::IndexFlat>::value) {
                         auto cur_query = (const float*)xq + dim * index;
@@ -168,34 +245,30 @@ class FlatIndexNode : public IndexNode {
                         }
                         index_->range_search(1, cur_query, radius, &res, bitset);
                     }
+                    if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+                        auto cur_query = (const uint16_t*)xq + dim * index;
+                        std::unique_ptr<uint16_t[]> copied_query = nullptr;
+                        if (is_cosine) {
+                            copied_query = CopyAndNormalizeHalfVecs(cur_query, 1, dim, IsBf16());
+                            cur_query = copied_query.get();
+                        }
+                        HalfRangeSearch(cur_query, radius, &res, bitset);
+                    }
                     if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
                         index_->range_search(1, (const uint8_t*)xq + index * dim / 8, radius, &res, bitset);
                     }
-                    auto elem_cnt = res.lims[1];
-                    result_dist_array[index].resize(elem_cnt);
-                    result_id_array[index].resize(elem_cnt);
-                    result_size[index] = elem_cnt;
-                    for (size_t j = 0; j < elem_cnt; j++) {
-                        result_dist_array[index][j] = res.distances[j];
-                        result_id_array[index][j] = res.labels[j];
-                    }
-                    if (f_cfg.range_filter.value() != defaultRangeFilter) {
-                        FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
-                                                        range_filter);
-                    }
+                    RangeSearchResultArena::Writer(arena, index).Add(res.labels, res.distances, res.lims[1]);
                 }));
             }
             for (auto& fut : futs) {
                 fut.wait();
             }
-            GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter, distances, ids,
-                                 lims);
         } catch (const std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
             return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
         }
 
-        return GenResultDataSet(nq, ids, distances, lims);
+        return arena.GenResultDataSet();
     }
 
     expected<DataSetPtr>
@@ -231,11 +304,29 @@ class FlatIndexNode : public IndexNode {
                 return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
             }
         }
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            uint16_t* data = nullptr;
+            try {
+                data = new uint16_t[rows * dim];
+                for (int64_t i = 0; i < rows; i++) {
+                    if (ids[i] < 0 || ids[i] >= index_->ntotal) {
+                        throw std::runtime_error("invalid id " + std::to_string(ids[i]));
+                    }
+                    std::copy_n(index_->codes.data() + ids[i] * index_->code_size, index_->code_size,
+                                (uint8_t*)(data + i * dim));
+                }
+                return GenResultDataSet(rows, dim, data);
+            } catch (const std::exception& e) {
+                std::unique_ptr<uint16_t[]> auto_del(data);
+                LOG_KNOWHERE_WARNING_ << "error inner faiss: " << e.what();
+                return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+            }
+        }
     }
 
     bool
     HasRawData(const std::string& metric_type) const override {
-        if constexpr (std::is_same<T, faiss::IndexFlat>::value) {
+        if constexpr (std::is_same<T, faiss::IndexFlat>::value || std::is_same<T, faiss::IndexScalarQuantizer>::value) {
             return !IsMetricType(metric_type, metric::COSINE);
         }
         if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
@@ -256,7 +347,7 @@ class FlatIndexNode : public IndexNode {
         }
         try {
             MemoryIOWriter writer;
-            if constexpr (std::is_same<T, faiss::IndexFlat>::value) {
+            if constexpr (std::is_same<T, faiss::IndexFlat>::value || std::is_same<T, faiss::IndexScalarQuantizer>::value) {
                 faiss::write_index(index_.get(), &writer);
             }
             if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
@@ -289,6 +380,9 @@ class FlatIndexNode : public IndexNode {
             faiss::Index* index = faiss::read_index(&reader);
             index_.reset(static_cast<T*>(index));
         }
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            return LoadHalfIndex(faiss::read_index(&reader));
+        }
         if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
             faiss::IndexBinary* index = faiss::read_index_binary(&reader);
             index_.reset(static_cast<T*>(index));
@@ -309,6 +403,9 @@ class FlatIndexNode : public IndexNode {
             faiss::Index* index = faiss::read_index(filename.data(), io_flags);
             index_.reset(static_cast<T*>(index));
         }
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            return LoadHalfIndex(faiss::read_index(filename.data(), io_flags));
+        }
         if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
             faiss::IndexBinary* index = faiss::read_index_binary(filename.data(), io_flags);
             index_.reset(static_cast<T*>(index));
@@ -328,6 +425,9 @@ class FlatIndexNode : public IndexNode {
 
     int64_t
     Size() const override {
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            return index_->ntotal * index_->code_size;
+        }
         return index_->ntotal * index_->d * sizeof(float);
     }
 
@@ -344,10 +444,103 @@ class FlatIndexNode : public IndexNode {
         if constexpr (std::is_same<T, faiss::IndexBinaryFlat>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_BIN_IDMAP;
         }
+        if constexpr (std::is_same<T, faiss::IndexScalarQuantizer>::value) {
+            return IsBf16() ? knowhere::IndexEnum::INDEX_FAISS_IDMAP_BF16
+                            : knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16;
+        }
     }
 
  private:
+    bool
+    IsBf16() const {
+        return qtype_ == faiss::QuantizerType::QT_bf16;
+    }
+
+    // a flat search computes one distance per vector the filter keeps
+    void
+    AddScanWork(SearchStats* stats, int64_t nq, const BitsetView& bitset) const {
+        if (stats == nullptr) {
+            return;
+        }
+        const int64_t filtered_out = bitset.empty() ? 0 : static_cast<int64_t>(bitset.count());
+        stats->Add(SearchStats::DISTANCE_COMPUTATIONS, nq * std::max<int64_t>(index_->ntotal - filtered_out, 0));
+    }
+
+    using HalfDistanceFunc = float (*)(const uint16_t*, const uint16_t*, size_t);
+
+    // the kernel comparing a half precision query to the stored vectors, the larger the closer for IP
+    HalfDistanceFunc
+    HalfDistance() const {
+        if (index_->metric_type == faiss::METRIC_INNER_PRODUCT) {
+            return IsBf16() ? faiss::bf16_vec_inner_product : faiss::fp16_vec_inner_product;
+        }
+        return IsBf16() ? faiss::bf16_vec_L2sqr : faiss::fp16_vec_L2sqr;
+    }
+
+    void
+    HalfKnnSearch(const uint16_t* query, int64_t k, float* distances, int64_t* ids, const BitsetView& bitset) const {
+        if (index_->metric_type == faiss::METRIC_INNER_PRODUCT) {
+            HalfKnnSearch<faiss::CMin<float, int64_t>>(query, k, distances, ids, bitset);
+        } else {
+            HalfKnnSearch<faiss::CMax<float, int64_t>>(query, k, distances, ids, bitset);
+        }
+    }
+
+    template <class C>
+    void
+    HalfKnnSearch(const uint16_t* query, int64_t k, float* distances, int64_t* ids, const BitsetView& bitset) const {
+        const auto distance = HalfDistance();
+        const size_t d = index_->d;
+        const auto codes = (const uint16_t*)index_->codes.data();
+        faiss::heap_heapify<C>(k, distances, ids);
+        for (int64_t i = 0; i < index_->ntotal; ++i) {
+            if (!bitset.empty() && bitset.test(i)) {
+                continue;
+            }
+            const float dis = distance(query, codes + i * d, d);
+            if (C::cmp(distances[0], dis)) {
+                faiss::heap_replace_top<C>(k, distances, ids, dis, i);
+            }
+        }
+        faiss::heap_reorder<C>(k, distances, ids);
+    }
+
+    // keeps the vectors closer than radius, as faiss::IndexFlat::range_search
+    void
+    HalfRangeSearch(const uint16_t* query, float radius, faiss::RangeSearchResult* res,
+                    const BitsetView& bitset) const {
+        const bool is_ip = index_->metric_type == faiss::METRIC_INNER_PRODUCT;
+        const auto distance = HalfDistance();
+        const size_t d = index_->d;
+        const auto codes = (const uint16_t*)index_->codes.data();
+        faiss::RangeSearchPartialResult pres(res);
+        auto& qres = pres.new_result(0);
+        for (int64_t i = 0; i < index_->ntotal; ++i) {
+            if (!bitset.empty() && bitset.test(i)) {
+                continue;
+            }
+            const float dis = distance(query, codes + i * d, d);
+            if (is_ip ? dis > radius : dis < radius) {
+                qres.add(dis, i);
+            }
+        }
+        pres.finalize();
+    }
+
+    Status
+    LoadHalfIndex(faiss::Index* index) {
+        auto sq_index = dynamic_cast<faiss::IndexScalarQuantizer*>(index);
+        if (sq_index == nullptr || sq_index->sq.qtype != qtype_) {
+            delete index;
+            LOG_KNOWHERE_ERROR_ << "Invalid binary set for " << Type();
+            return Status::invalid_binary_set;
+        }
+        index_.reset(sq_index);
+        return Status::success;
+    }
+
     std::unique_ptr<T> index_;
+    faiss::QuantizerType qtype_;
     std::shared_ptr<ThreadPool> search_pool_;
 };
 
@@ -359,5 +552,11 @@ KNOWHERE_REGISTER_GLOBAL(BINFLAT, [](const Object& object) {
 KNOWHERE_REGISTER_GLOBAL(BIN_FLAT, [](const Object& object) {
     return Index<FlatIndexNode<faiss::IndexBinaryFlat>>::Create(object);
 });
+KNOWHERE_REGISTER_GLOBAL(FLAT_FP16, [](const Object& object) {
+    return Index<FlatIndexNode<faiss::IndexScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_fp16);
+});
+KNOWHERE_REGISTER_GLOBAL(FLAT_BF16, [](const Object& object) {
+    return Index<FlatIndexNode<faiss::IndexScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_bf16);
+});
 
 }  // namespace knowhere
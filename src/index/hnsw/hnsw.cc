@@ -11,9 +11,10 @@
 
 #include "knowhere/feder/HNSW.h"
 
-#include <omp.h>
-
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <mutex>
 #include <new>
 
 #include "common/range_util.h"
@@ -21,6 +22,8 @@
 #include "hnswlib/hnswlib.h"
 #include "index/hnsw/hnsw_config.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/config.h"
@@ -29,11 +32,89 @@
 #include "knowhere/log.h"
 #include "knowhere/utils.h"
 
+#ifdef NOT_COMPILE_FOR_SWIG
+#include "knowhere/prometheus_client.h"
+#endif
+
 namespace knowhere {
+
+namespace {
+
+// Counts the inserted rows and reports them to the user callback, from one thread at a time.
+class BuildProgress {
+ public:
+    BuildProgress(size_t total, const BuildProgressCallback& callback) : total_(total), callback_(callback) {
+    }
+
+    void
+    Update(size_t inserted) {
+        done_.fetch_add(inserted, std::memory_order_relaxed);
+        // a thread that finds the callback busy skips its report, the next one includes its rows
+        if (callback_ && mutex_.try_lock()) {
+            if (!callback_(static_cast<float>(done_.load(std::memory_order_relaxed)) / total_)) {
+                cancelled_.store(true, std::memory_order_relaxed);
+            }
+            mutex_.unlock();
+        }
+    }
+
+    bool
+    Cancelled() const {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    const size_t total_;
+    const BuildProgressCallback& callback_;
+    std::atomic<size_t> done_{0};
+    std::atomic<bool> cancelled_{false};
+    std::mutex mutex_;
+};
+
+// Publishes the entry point cache counters gathered since the previous call.
+void
+ReportEntryCacheStats(const hnswlib::HierarchicalNSW<float>& index) {
+#ifdef NOT_COMPILE_FOR_SWIG
+    auto stats = index.entry_cache_.take_stats();
+    knowhere_hnsw_entry_cache_hit_count.Increment(stats.hits);
+    knowhere_hnsw_entry_cache_miss_count.Increment(stats.misses);
+    knowhere_hnsw_entry_cache_contention_count.Increment(stats.contended);
+#endif
+}
+
+// Adds the graph work of the task running on this thread to a sampled search.
+class ScopedSearchMetrics {
+ public:
+    explicit ScopedSearchMetrics(SearchStats* stats) : stats_(stats), timer_(stats, SearchStats::SCAN) {
+        if (stats_ != nullptr) {
+            start_ = hnswlib::thread_search_metrics();
+        }
+    }
+
+    ~ScopedSearchMetrics() {
+        if (stats_ != nullptr) {
+            const auto& end = hnswlib::thread_search_metrics();
+            stats_->Add(SearchStats::HOPS, end.hops - start_.hops);
+            stats_->Add(SearchStats::DISTANCE_COMPUTATIONS, end.distance_computations - start_.distance_computations);
+        }
+    }
+
+ private:
+    SearchStats* stats_;
+    SearchStageTimer timer_;
+    hnswlib::SearchMetrics start_;
+};
+
+}  // namespace
+
 class HnswIndexNode : public IndexNode {
  public:
-    HnswIndexNode(const Object& object) : index_(nullptr) {
+    // the vectors of a FP16/BF16 index are given, stored and returned as uint16 components of that type. An SQ8 index
+    // traverses level 0 on 8-bit codes of its float vectors and reranks the candidates with the vectors.
+    HnswIndexNode(const Object& object, hnswlib::DataType data_type = hnswlib::DataType::FLOAT, bool sq8 = false)
+        : index_(nullptr), data_type_(data_type), sq8_(sq8) {
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
+        build_pool_ = ThreadPool::GetGlobalBuildThreadPool();
     }
 
     Status
@@ -42,15 +123,17 @@ class HnswIndexNode : public IndexNode {
         auto dim = dataset.GetDim();
         auto hnsw_cfg = static_cast<const HnswConfig&>(cfg);
         hnswlib::SpaceInterface<float>* space = nullptr;
+        // binary vectors have neither a half precision nor a quantized form
+        const bool supports_binary = data_type_ == hnswlib::DataType::FLOAT && !sq8_;
         if (IsMetricType(hnsw_cfg.metric_type.value(), metric::L2)) {
-            space = new (std::nothrow) hnswlib::L2Space(dim);
+            space = new (std::nothrow) hnswlib::L2Space(dim, data_type_);
         } else if (IsMetricType(hnsw_cfg.metric_type.value(), metric::IP)) {
-            space = new (std::nothrow) hnswlib::InnerProductSpace(dim);
+            space = new (std::nothrow) hnswlib::InnerProductSpace(dim, data_type_);
         } else if (IsMetricType(hnsw_cfg.metric_type.value(), metric::COSINE)) {
-            space = new (std::nothrow) hnswlib::CosineSpace(dim);
-        } else if (IsMetricType(hnsw_cfg.metric_type.value(), metric::HAMMING)) {
+            space = new (std::nothrow) hnswlib::CosineSpace(dim, data_type_);
+        } else if (supports_binary && IsMetricType(hnsw_cfg.metric_type.value(), metric::HAMMING)) {
             space = new (std::nothrow) hnswlib::HammingSpace(dim);
-        } else if (IsMetricType(hnsw_cfg.metric_type.value(), metric::JACCARD)) {
+        } else if (supports_binary && IsMetricType(hnsw_cfg.metric_type.value(), metric::JACCARD)) {
             space = new (std::nothrow) hnswlib::JaccardSpace(dim);
         } else {
             LOG_KNOWHERE_WARNING_ << "metric type not support in hnsw: " << hnsw_cfg.metric_type.value();
@@ -66,7 +149,9 @@ class HnswIndexNode : public IndexNode {
             delete this->index_;
             LOG_KNOWHERE_WARNING_ << "index not empty, deleted old index";
         }
+        index->entry_cache_.reset(hnsw_cfg.entry_cache_size.value());
         this->index_ = index;
+        zero_copy_data_ = nullptr;
         return Status::success;
     }
 
@@ -74,23 +159,75 @@ class HnswIndexNode : public IndexNode {
     Add(const DataSet& dataset, const Config& cfg) override {
         if (!index_) {
             LOG_KNOWHERE_ERROR_ << "Can not add data to empty HNSW index.";
-            expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+            return Status::empty_index;
         }
 
         knowhere::TimeRecorder build_time("Building HNSW cost");
         auto rows = dataset.GetRows();
-        auto tensor = dataset.GetTensor();
+        auto tensor = (const char*)dataset.GetTensor();
         auto hnsw_cfg = static_cast<const HnswConfig&>(cfg);
-        index_->addPoint(tensor, 0);
 
-#pragma omp parallel for
-        for (int i = 1; i < rows; ++i) {
-            index_->addPoint(((const char*)tensor + index_->data_size_ * i), i);
+        // The elements that have upper levels are inserted first, highest level first, so the entry point and the
+        // max level are settled by the very first insert and the hierarchy is complete before level 0 is filled.
+        auto levels = index_->drawLevels(rows);
+        std::vector<int64_t> order;
+        order.reserve(rows);
+        for (int64_t i = 0; i < rows; ++i) {
+            if (levels[i] > 0) {
+                order.push_back(i);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) { return levels[a] > levels[b]; });
+        const size_t upper_end = std::max<size_t>(order.size(), std::min<int64_t>(rows, 1));
+        for (int64_t i = 0; i < rows; ++i) {
+            if (levels[i] == 0) {
+                order.push_back(i);
+            }
+        }
+
+        int num_threads = build_pool_->size();
+        if (hnsw_cfg.num_build_thread.has_value()) {
+            num_threads = std::min<int>(num_threads, hnsw_cfg.num_build_thread.value());
+        }
+        BuildProgress progress(rows, build_progress_callback_);
+        auto status = AddPoints(tensor, levels, order, 0, std::min<int64_t>(rows, 1), 1, progress);
+        if (status == Status::success) {
+            status = AddPoints(tensor, levels, order, std::min<int64_t>(rows, 1), upper_end, num_threads, progress);
+        }
+        if (status == Status::success) {
+            status = AddPoints(tensor, levels, order, upper_end, rows, num_threads, progress);
+        }
+        if (status != Status::success) {
+            LOG_KNOWHERE_WARNING_ << "HNSW build stopped, "
+                                  << (status == Status::build_cancelled ? "cancelled by the callback" : "insert failed");
+            delete index_;
+            index_ = nullptr;
+            return status;
         }
         build_time.RecordSection("");
+        if (hnsw_cfg.optimize_layout.value()) {
+            try {
+                index_->optimizeLayout();
+            } catch (std::exception& e) {
+                LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
+                return Status::hnsw_inner_error;
+            }
+            build_time.RecordSection("optimize layout");
+        }
+        if (sq8_) {
+            try {
+                index_->quantizeLevel0();
+            } catch (std::exception& e) {
+                LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
+                return Status::hnsw_inner_error;
+            }
+            build_time.RecordSection("quantize level 0");
+        }
         LOG_KNOWHERE_INFO_ << "HNSW built with #points num:" << index_->max_elements_ << " #M:" << index_->M_
                            << " #max level:" << index_->maxlevel_ << " #ef_construction:" << index_->ef_construction_
-                           << " #dim:" << *(size_t*)(index_->space_->get_dist_func_param());
+                           << " #dim:" << *(size_t*)(index_->space_->get_dist_func_param())
+                           << " #threads:" << num_threads;
+        PlaceIndex();
         return Status::success;
     }
 
@@ -98,12 +235,11 @@ class HnswIndexNode : public IndexNode {
     Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override {
         if (!index_) {
             LOG_KNOWHERE_WARNING_ << "search on empty index";
-            expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
         }
         auto nq = dataset.GetRows();
-        auto xq = dataset.GetTensor();
 
-        auto hnsw_cfg = static_cast<const HnswConfig&>(cfg);
+        const HnswConfig& hnsw_cfg = static_cast<const HnswConfig&>(cfg);
         auto k = hnsw_cfg.k.value();
 
         feder::hnsw::FederResultUniq feder_result;
@@ -116,34 +252,7 @@ class HnswIndexNode : public IndexNode {
 
         auto p_id = new int64_t[k * nq];
         auto p_dist = new float[k * nq];
-
-        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value(), hnsw_cfg.for_tuning.value()};
-        bool transform =
-            (index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT || index_->metric_type_ == hnswlib::Metric::COSINE);
-
-        std::vector<folly::Future<folly::Unit>> futs;
-        futs.reserve(nq);
-        for (int i = 0; i < nq; ++i) {
-            futs.emplace_back(search_pool_->push([&, idx = i]() {
-                auto single_query = (const char*)xq + idx * index_->data_size_;
-                auto rst = index_->searchKnn(single_query, k, bitset, &param, feder_result);
-                size_t rst_size = rst.size();
-                auto p_single_dis = p_dist + idx * k;
-                auto p_single_id = p_id + idx * k;
-                for (size_t idx = 0; idx < rst_size; ++idx) {
-                    const auto& [dist, id] = rst[idx];
-                    p_single_dis[idx] = transform ? (-dist) : dist;
-                    p_single_id[idx] = id;
-                }
-                for (size_t idx = rst_size; idx < (size_t)k; idx++) {
-                    p_single_dis[idx] = float(1.0 / 0.0);
-                    p_single_id[idx] = -1;
-                }
-            }));
-        }
-        for (auto& fut : futs) {
-            fut.wait();
-        }
+        SearchIntoBuf(dataset, hnsw_cfg, bitset, p_id, p_dist, feder_result);
 
         auto res = GenResultDataSet(nq, k, p_id, p_dist);
 
@@ -158,6 +267,19 @@ class HnswIndexNode : public IndexNode {
         return res;
     }
 
+    Status
+    SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "search on empty index";
+            return Status::empty_index;
+        }
+        // visits are only traced through Search, which has a dataset to return them in
+        feder::hnsw::FederResultUniq feder_result;
+        SearchIntoBuf(dataset, static_cast<const HnswConfig&>(cfg), bitset, ids, distances, feder_result);
+        return Status::success;
+    }
+
     expected<DataSetPtr>
     RangeSearch(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override {
         if (!index_) {
@@ -186,45 +308,28 @@ class HnswIndexNode : public IndexNode {
 
         hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value()};
 
-        int64_t* ids = nullptr;
-        float* dis = nullptr;
-        size_t* lims = nullptr;
-
-        std::vector<std::vector<int64_t>> result_id_array(nq);
-        std::vector<std::vector<float>> result_dist_array(nq);
-        std::vector<size_t> result_size(nq);
-        std::vector<size_t> result_lims(nq + 1);
+        RangeSearchResultArena arena(nq, is_ip, radius_for_filter, range_filter);
 
+        auto stats = SearchStats::Active();
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(nq);
         for (int64_t i = 0; i < nq; ++i) {
             futs.emplace_back(search_pool_->push([&, idx = i]() {
+                ScopedSearchMetrics metrics(stats);
                 auto single_query = (const char*)xq + idx * index_->data_size_;
                 auto rst = index_->searchRange(single_query, radius_for_calc, bitset, &param, feder_result);
-                auto elem_cnt = rst.size();
-                result_dist_array[idx].resize(elem_cnt);
-                result_id_array[idx].resize(elem_cnt);
-                for (size_t j = 0; j < elem_cnt; j++) {
-                    auto& p = rst[j];
-                    result_dist_array[idx][j] = (is_ip ? (-p.first) : p.first);
-                    result_id_array[idx][j] = p.second;
-                }
-                result_size[idx] = rst.size();
-                if (hnsw_cfg.range_filter.value() != defaultRangeFilter) {
-                    FilterRangeSearchResultForOneNq(result_dist_array[idx], result_id_array[idx], is_ip,
-                                                    radius_for_filter, range_filter);
+                RangeSearchResultArena::Writer writer(arena, idx);
+                for (const auto& [dist, id] : rst) {
+                    writer.Add(id, is_ip ? (-dist) : dist);
                 }
             }));
         }
         for (auto& fut : futs) {
             fut.wait();
         }
+        ReportEntryCacheStats(*index_);
 
-        // filter range search result
-        GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius_for_filter, range_filter, dis, ids,
-                             lims);
-
-        auto res = GenResultDataSet(nq, ids, dis, lims);
+        auto res = arena.GenResultDataSet();
 
         // set visit_info json string into result dataset
         if (feder_result != nullptr) {
@@ -253,7 +358,8 @@ class HnswIndexNode : public IndexNode {
             for (int64_t i = 0; i < rows; i++) {
                 int64_t id = ids[i];
                 assert(id >= 0 && id < (int64_t)index_->cur_element_count);
-                std::copy_n(index_->getDataByInternalId(id), index_->data_size_, data + i * index_->data_size_);
+                std::copy_n(index_->getDataByInternalId(index_->getInternalId(id)), index_->data_size_,
+                            data + i * index_->data_size_);
             }
             return GenResultDataSet(rows, dim, data);
         } catch (std::exception& e) {
@@ -278,7 +384,7 @@ class HnswIndexNode : public IndexNode {
         auto hnsw_cfg = static_cast<const HnswConfig&>(cfg);
         auto overview_levels = hnsw_cfg.overview_levels.value();
         feder::hnsw::HNSWMeta meta(index_->ef_construction_, index_->M_, index_->cur_element_count, index_->maxlevel_,
-                                   index_->enterpoint_node_, overview_levels);
+                                   index_->getExternalLabel(index_->enterpoint_node_), overview_levels);
         std::unordered_set<int64_t> id_set;
 
         for (int i = 0; i < overview_levels; i++) {
@@ -331,9 +437,13 @@ class HnswIndexNode : public IndexNode {
             reader.total = binary->size;
             reader.data_ = binary->data.get();
 
+            const HnswConfig& cfg = static_cast<const HnswConfig&>(config);
             hnswlib::SpaceInterface<float>* space = nullptr;
-            index_ = new (std::nothrow) hnswlib::HierarchicalNSW<float>(space);
-            index_->loadIndex(reader);
+            index_ = new (std::nothrow) hnswlib::HierarchicalNSW<float>(space, data_type_, sq8_);
+            index_->loadIndex(reader, 0, cfg.enable_zero_copy.value());
+            index_->entry_cache_.reset(cfg.entry_cache_size.value());
+            zero_copy_data_ = index_->zero_copy_enabled_ ? binary->data : nullptr;
+            PlaceIndex();
             LOG_KNOWHERE_INFO_ << "Loaded HNSW index. #points num:" << index_->max_elements_ << " #M:" << index_->M_
                                << " #max level:" << index_->maxlevel_
                                << " #ef_construction:" << index_->ef_construction_
@@ -352,8 +462,11 @@ class HnswIndexNode : public IndexNode {
         }
         try {
             hnswlib::SpaceInterface<float>* space = nullptr;
-            index_ = new (std::nothrow) hnswlib::HierarchicalNSW<float>(space);
+            index_ = new (std::nothrow) hnswlib::HierarchicalNSW<float>(space, data_type_, sq8_);
             index_->loadIndex(filename, config);
+            index_->entry_cache_.reset(static_cast<const HnswConfig&>(config).entry_cache_size.value());
+            zero_copy_data_ = nullptr;
+            PlaceIndex();
         } catch (std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
             return Status::hnsw_inner_error;
@@ -392,7 +505,14 @@ class HnswIndexNode : public IndexNode {
 
     std::string
     Type() const override {
-        return knowhere::IndexEnum::INDEX_HNSW;
+        switch (data_type_) {
+            case hnswlib::DataType::FP16:
+                return knowhere::IndexEnum::INDEX_HNSW_FP16;
+            case hnswlib::DataType::BF16:
+                return knowhere::IndexEnum::INDEX_HNSW_BF16;
+            default:
+                return sq8_ ? knowhere::IndexEnum::INDEX_HNSW_SQ8 : knowhere::IndexEnum::INDEX_HNSW;
+        }
     }
 
     ~HnswIndexNode() override {
@@ -402,6 +522,110 @@ class HnswIndexNode : public IndexNode {
     }
 
  private:
+    // nq * k results of a top-k search into p_id / p_dist, padded with -1 when fewer than k are found
+    void
+    SearchIntoBuf(const DataSet& dataset, const HnswConfig& hnsw_cfg, const BitsetView& bitset, int64_t* p_id,
+                  float* p_dist, const feder::hnsw::FederResultUniq& feder_result) const {
+        auto nq = dataset.GetRows();
+        auto xq = dataset.GetTensor();
+        auto k = hnsw_cfg.k.value();
+
+        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value(), hnsw_cfg.for_tuning.value()};
+        bool transform =
+            (index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT || index_->metric_type_ == hnswlib::Metric::COSINE);
+
+        auto write_result = [&](int64_t idx, const std::vector<std::pair<float, hnswlib::labeltype>>& rst) {
+            size_t rst_size = rst.size();
+            auto p_single_dis = p_dist + idx * k;
+            auto p_single_id = p_id + idx * k;
+            for (size_t i = 0; i < rst_size; ++i) {
+                const auto& [dist, id] = rst[i];
+                p_single_dis[i] = transform ? (-dist) : dist;
+                p_single_id[i] = id;
+            }
+            for (size_t i = rst_size; i < (size_t)k; i++) {
+                p_single_dis[i] = float(1.0 / 0.0);
+                p_single_id[i] = -1;
+            }
+        };
+
+        auto stats = SearchStats::Active();
+        std::vector<folly::Future<folly::Unit>> futs;
+        const int64_t group_size = feder_result == nullptr ? hnsw_cfg.query_group_size.value() : 1;
+        if (group_size > 1) {
+            futs.reserve((nq + group_size - 1) / group_size);
+            for (int64_t i = 0; i < nq; i += group_size) {
+                futs.emplace_back(search_pool_->push([&, begin = i]() {
+                    ScopedSearchMetrics metrics(stats);
+                    auto n = std::min(group_size, nq - begin);
+                    auto group_query = (const char*)xq + begin * index_->data_size_;
+                    auto rsts = index_->searchKnnGroup(group_query, n, k, bitset, &param);
+                    for (int64_t j = 0; j < n; ++j) {
+                        write_result(begin + j, rsts[j]);
+                    }
+                }));
+            }
+        } else {
+            futs.reserve(nq);
+            for (int i = 0; i < nq; ++i) {
+                futs.emplace_back(search_pool_->push([&, idx = i]() {
+                    ScopedSearchMetrics metrics(stats);
+                    auto single_query = (const char*)xq + idx * index_->data_size_;
+                    write_result(idx, index_->searchKnn(single_query, k, bitset, &param, feder_result));
+                }));
+            }
+        }
+        for (auto& fut : futs) {
+            fut.wait();
+        }
+        ReportEntryCacheStats(*index_);
+    }
+
+    // Inserts the rows order[begin, end) with num_threads tasks of the build pool. The tasks take kBuildChunkSize
+    // rows at a time from a shared cursor, so that the fast ones take over the work of the slow ones, and stop
+    // between two chunks once the build is cancelled or has failed.
+    Status
+    AddPoints(const char* tensor, const std::vector<int>& levels, const std::vector<int64_t>& order, size_t begin,
+              size_t end, int num_threads, BuildProgress& progress) {
+        if (begin >= end) {
+            return Status::success;
+        }
+        num_threads = std::min<size_t>(num_threads, (end - begin + kBuildChunkSize - 1) / kBuildChunkSize);
+
+        std::atomic<size_t> cursor{begin};
+        std::atomic<bool> failed{false};
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(num_threads);
+        for (int i = 0; i < num_threads; ++i) {
+            futs.emplace_back(build_pool_->push([&]() {
+                try {
+                    while (!failed.load(std::memory_order_relaxed) && !progress.Cancelled()) {
+                        size_t chunk_begin = cursor.fetch_add(kBuildChunkSize, std::memory_order_relaxed);
+                        if (chunk_begin >= end) {
+                            break;
+                        }
+                        size_t chunk_end = std::min(end, chunk_begin + kBuildChunkSize);
+                        for (size_t j = chunk_begin; j < chunk_end; ++j) {
+                            auto id = order[j];
+                            index_->addPoint(tensor + index_->data_size_ * id, id, levels[id]);
+                        }
+                        progress.Update(chunk_end - chunk_begin);
+                    }
+                } catch (std::exception& e) {
+                    LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }));
+        }
+        for (auto& fut : futs) {
+            fut.wait();
+        }
+        if (failed.load()) {
+            return Status::hnsw_inner_error;
+        }
+        return progress.Cancelled() ? Status::build_cancelled : Status::success;
+    }
+
     void
     UpdateLevelLinkList(int32_t level, feder::hnsw::HNSWMeta& meta, std::unordered_set<int64_t>& id_set) const {
         if (!(level > 0 && level <= index_->maxlevel_)) {
@@ -430,19 +654,57 @@ class HnswIndexNode : public IndexNode {
             std::vector<int64_t> neighbors(size);
             for (int i = 0; i < size; i++) {
                 hnswlib::tableint cand = datal[i];
-                neighbors[i] = cand;
+                neighbors[i] = index_->getExternalLabel(cand);
             }
-            id_set.insert(curr_id);
+            auto curr_label = index_->getExternalLabel(curr_id);
+            id_set.insert(curr_label);
             id_set.insert(neighbors.begin(), neighbors.end());
-            meta.AddNodeInfo(level, curr_id, std::move(neighbors));
+            meta.AddNodeInfo(level, curr_label, std::move(neighbors));
         }
     }
 
  private:
+    // Moves level 0, and the vectors an SQ8 index reranks with, to the NUMA node the policy picks, or interleaves
+    // them, and sends the searches to the pool pinned to that node. The pages of a mmaped or zero-copy index belong
+    // to the page cache or to the caller's binary set, so they are left alone and the index stays on the global
+    // search pool.
+    void
+    PlaceIndex() {
+        int node = -1;
+        if (!index_->mmap_enabled_ && !index_->zero_copy_enabled_) {
+            node = Numa::ChooseNode();
+            bool placed = Numa::PlaceMemory(index_->data_level0_memory_,
+                                            index_->cur_element_count * index_->size_data_per_element_, node);
+            if (index_->raw_data_ != nullptr) {
+                placed &= Numa::PlaceMemory(index_->raw_data_, index_->cur_element_count * index_->data_size_, node);
+            }
+            if (!placed) {
+                node = -1;
+            }
+        }
+        search_pool_ = ThreadPool::GetSearchThreadPool(node);
+    }
+
+    static constexpr size_t kBuildChunkSize = 64;
+
     hnswlib::HierarchicalNSW<float>* index_;
+    hnswlib::DataType data_type_;
+    bool sq8_;
+    // keeps the binary set buffer alive while level 0 of a zero-copy load points into it
+    std::shared_ptr<uint8_t[]> zero_copy_data_;
     std::shared_ptr<ThreadPool> search_pool_;
+    std::shared_ptr<ThreadPool> build_pool_;
 };
 
 KNOWHERE_REGISTER_GLOBAL(HNSW, [](const Object& object) { return Index<HnswIndexNode>::Create(object); });
+KNOWHERE_REGISTER_GLOBAL(HNSW_FP16, [](const Object& object) {
+    return Index<HnswIndexNode>::Create(object, hnswlib::DataType::FP16);
+});
+KNOWHERE_REGISTER_GLOBAL(HNSW_BF16, [](const Object& object) {
+    return Index<HnswIndexNode>::Create(object, hnswlib::DataType::BF16);
+});
+KNOWHERE_REGISTER_GLOBAL(HNSW_SQ8, [](const Object& object) {
+    return Index<HnswIndexNode>::Create(object, hnswlib::DataType::FLOAT, true);
+});
 
 }  // namespace knowhere
@@ -30,6 +30,9 @@ class HnswConfig : public BaseConfig {
     CFG_INT efConstruction;
     CFG_INT ef;
     CFG_INT overview_levels;
+    CFG_BOOL optimize_layout;
+    CFG_INT entry_cache_size;
+    CFG_INT query_group_size;
     KNOHWERE_DECLARE_CONFIG(HnswConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(M).description("hnsw M").set_default(30).set_range(1, 2048).for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(efConstruction)
@@ -37,12 +40,28 @@ class HnswConfig : public BaseConfig {
             .set_default(360)
             .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(optimize_layout)
+            .description("renumber the nodes by graph locality after build")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(entry_cache_size)
+            .description("number of query entry points cached for repeated queries, 0 disables the cache")
+            .set_default(10000)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
         KNOWHERE_CONFIG_DECLARE_FIELD(ef)
             .description("hnsw ef")
             .allow_empty_without_default()
             .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
             .for_search()
             .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(query_group_size)
+            .description("number of queries a search thread traverses in lockstep to overlap their memory stalls")
+            .set_default(1)
+            .set_range(1, 16)
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(overview_levels)
             .description("hnsw overview levels for feder")
             .set_default(3)
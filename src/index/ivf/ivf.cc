@@ -9,19 +9,28 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <sstream>
+#include <string_view>
+
 #include "common/metric.h"
 #include "common/range_util.h"
+#include "common/tiled_knn.h"
 #include "faiss/IndexBinaryFlat.h"
 #include "faiss/IndexBinaryIVF.h"
 #include "faiss/IndexFlat.h"
 #include "faiss/IndexIVFFlat.h"
 #include "faiss/IndexIVFPQ.h"
 #include "faiss/IndexIVFPQFastScan.h"
+#include "faiss/IndexIVFPQFastScanRefine.h"
+#include "faiss/IndexRefine.h"
 #include "faiss/IndexScaNN.h"
 #include "faiss/IndexScalarQuantizer.h"
+#include "faiss/impl/io.h"
 #include "faiss/index_io.h"
 #include "index/ivf/ivf_config.h"
 #include "io/FaissIO.h"
+#include "io/ZeroCopyInvertedLists.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -42,14 +51,53 @@ struct QuantizerT<faiss::IndexBinaryIVF> {
     using type = faiss::IndexBinaryFlat;
 };
 
+namespace {
+
+// Adds the faiss counters of the task running on this thread to a sampled search. faiss times the coarse quantization
+// itself, the rest of the task is accounted as list scanning.
+class ScopedIvfStats {
+    using clock = std::chrono::steady_clock;
+
+ public:
+    explicit ScopedIvfStats(SearchStats* stats) : stats_(stats) {
+        if (stats_ != nullptr) {
+            start_ = faiss::indexIVF_stats;
+            start_time_ = clock::now();
+        }
+    }
+
+    ~ScopedIvfStats() {
+        if (stats_ == nullptr) {
+            return;
+        }
+        const auto& end = faiss::indexIVF_stats;
+        const auto quantize = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::milli>(end.quantization_time - start_.quantization_time));
+        const auto task = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_time_);
+        stats_->AddTime(SearchStats::QUANTIZE, quantize);
+        stats_->AddTime(SearchStats::SCAN, std::max(task - quantize, std::chrono::nanoseconds(0)));
+        stats_->Add(SearchStats::LISTS_SCANNED, end.nlist - start_.nlist);
+        stats_->Add(SearchStats::DISTANCE_COMPUTATIONS, end.ndis - start_.ndis);
+    }
+
+ private:
+    SearchStats* stats_;
+    faiss::IndexIVFStats start_;
+    clock::time_point start_time_;
+};
+
+}  // namespace
+
 template <typename T>
 class IvfIndexNode : public IndexNode {
  public:
-    IvfIndexNode(const Object& object) : index_(nullptr) {
+    IvfIndexNode(const Object& object, faiss::QuantizerType qtype = faiss::QuantizerType::QT_8bit)
+        : index_(nullptr), qtype_(qtype) {
         static_assert(std::is_same<T, faiss::IndexIVFFlat>::value || std::is_same<T, faiss::IndexIVFFlatCC>::value ||
                           std::is_same<T, faiss::IndexIVFPQ>::value ||
                           std::is_same<T, faiss::IndexIVFScalarQuantizer>::value ||
-                          std::is_same<T, faiss::IndexBinaryIVF>::value || std::is_same<T, faiss::IndexScaNN>::value,
+                          std::is_same<T, faiss::IndexBinaryIVF>::value || std::is_same<T, faiss::IndexScaNN>::value ||
+                          std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value,
                       "not support");
         search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
     }
@@ -59,6 +107,9 @@ class IvfIndexNode : public IndexNode {
     Add(const DataSet& dataset, const Config& cfg) override;
     expected<DataSetPtr>
     Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override;
+    Status
+    SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                  float* distances) const override;
     expected<DataSetPtr>
     RangeSearch(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const override;
     expected<DataSetPtr>
@@ -77,6 +128,11 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexScaNN, T>::value) {
             return true;
         }
+        if constexpr (std::is_same<faiss::IndexIVFPQFastScanRefine, T>::value) {
+            // only a float refine keeps the vectors, normalized for COSINE
+            return index_ != nullptr && dynamic_cast<const faiss::IndexFlat*>(index_->refine_index) != nullptr &&
+                   !IsMetricType(metric_type, metric::COSINE);
+        }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, T>::value) {
             return false;
         }
@@ -108,6 +164,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexScaNN, T>::value) {
             return std::make_unique<ScannConfig>();
         }
+        if constexpr (std::is_same<faiss::IndexIVFPQFastScanRefine, T>::value) {
+            return std::make_unique<IvfPqFastScanConfig>();
+        }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, T>::value) {
             return std::make_unique<IvfSqConfig>();
         }
@@ -151,14 +210,17 @@ class IvfIndexNode : public IndexNode {
             auto precomputed_table = nlist * pq.M * pq.ksub * sizeof(float);
             return (capacity + centroid_table + precomputed_table);
         }
-        if constexpr (std::is_same<T, faiss::IndexScaNN>::value) {
+        if constexpr (std::is_same<T, faiss::IndexScaNN>::value ||
+                      std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
             return index_->size();
         }
         if constexpr (std::is_same<T, faiss::IndexIVFScalarQuantizer>::value) {
             auto nb = index_->invlists->compute_ntotal();
             auto code_size = index_->code_size;
             auto nlist = index_->nlist;
-            return (nb * code_size + nb * sizeof(int64_t) + 2 * code_size + nlist * code_size);
+            auto d = index_->d;
+            return (nb * code_size + nb * sizeof(int64_t) + index_->sq.trained.size() * sizeof(float) +
+                    nlist * d * sizeof(float));
         }
         if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
             auto nb = index_->invlists->compute_ntotal();
@@ -188,18 +250,86 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<T, faiss::IndexScaNN>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_SCANN;
         }
+        if constexpr (std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+            return knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN;
+        }
         if constexpr (std::is_same<T, faiss::IndexIVFScalarQuantizer>::value) {
-            return knowhere::IndexEnum::INDEX_FAISS_IVFSQ8;
+            switch (qtype_) {
+                case faiss::QuantizerType::QT_4bit:
+                    return knowhere::IndexEnum::INDEX_FAISS_IVFSQ4;
+                case faiss::QuantizerType::QT_6bit:
+                    return knowhere::IndexEnum::INDEX_FAISS_IVFSQ6;
+                case faiss::QuantizerType::QT_fp16:
+                    return knowhere::IndexEnum::INDEX_FAISS_IVFFP16;
+                case faiss::QuantizerType::QT_bf16:
+                    return knowhere::IndexEnum::INDEX_FAISS_IVFBF16;
+                default:
+                    return knowhere::IndexEnum::INDEX_FAISS_IVFSQ8;
+            }
         }
         if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_BIN_IVFFLAT;
         }
     };
+    std::string
+    QuantizerId() const override {
+        return quantizer_id_;
+    }
 
  private:
+    // temporary solution to fix IVF_FLAT cosine
+    void
+    NormalizeCodesOnce() const {
+        if (!normalized_) {
+            std::lock_guard<std::mutex> lock(normalize_mtx_);
+            if (!normalized_) {
+                faiss::IndexIVFFlat* ivf_index = static_cast<faiss::IndexIVFFlat*>(index_.get());
+                size_t nb = ivf_index->arranged_codes.size() / ivf_index->code_size;
+                NormalizeVecs((float*)(ivf_index->arranged_codes.data()), nb, index_->d);
+                normalized_ = true;
+            }
+        }
+    }
+
+    // true for the indexes whose list scanners are cheap to rebind to another query, so that a list can be scanned
+    // for many queries in a row
+    static constexpr bool kListMajorSearch =
+        std::is_same<T, faiss::IndexIVFFlat>::value || std::is_same<T, faiss::IndexIVFFlatCC>::value ||
+        std::is_same<T, faiss::IndexIVFScalarQuantizer>::value;
+
+    bool
+    SearchByList(const float* xq, int64_t nq, int64_t k, int64_t nprobe, bool is_cosine, const BitsetView& bitset,
+                 int64_t* ids, float* distances) const;
+
+    Status
+    LoadQuantizer(const IvfConfig& cfg, int64_t dim, faiss::MetricType metric, std::unique_ptr<T>& index) const;
+
+    // the fast scan index of SCANN and IVF_PQ_FS, the only ones whose file records whether they are COSINE
+    static const faiss::IndexIVFPQFastScan*
+    FastScanIndex(const T* index) {
+        if constexpr (std::is_same<T, faiss::IndexScaNN>::value) {
+            return dynamic_cast<const faiss::IndexIVFPQFastScan*>(index->base_index);
+        } else if constexpr (std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+            return index->fast_scan_index();
+        } else {
+            return nullptr;
+        }
+    }
+
+    // hashes the metric and the coarse centroids of index_, to be called whenever index_ is replaced
+    void
+    UpdateQuantizerId();
+
+    // keeps the binary set buffer alive while the inverted lists of a zero-copy load point into it, declared before
+    // index_ so that it is released after the index
+    std::shared_ptr<uint8_t[]> zero_copy_data_;
     std::unique_ptr<T> index_;
+    // scalar quantizer codec of the IVF_SQ* indexes, fixed by the registered index type
+    faiss::QuantizerType qtype_;
     std::shared_ptr<ThreadPool> search_pool_;
 
+    std::string quantizer_id_;
+
     // temporary solution to fix IVF_FLAT cosine
     mutable bool normalized_ = false;
     mutable std::mutex normalize_mtx_;
@@ -251,7 +381,9 @@ IvfIndexNode<T>::Train(const DataSet& dataset, const Config& cfg) {
     }
     // do normalize for COSINE metric type
     if (IsMetricType(base_cfg.metric_type.value(), knowhere::metric::COSINE)) {
-        if constexpr (!(std::is_same_v<faiss::IndexIVFFlatCC, T>)&&!(std::is_same_v<faiss::IndexScaNN, T>)) {
+        // the other ones normalize a copy of the data themselves
+        if constexpr (!std::is_same_v<faiss::IndexIVFFlatCC, T> && !std::is_same_v<faiss::IndexScaNN, T> &&
+                      !std::is_same_v<faiss::IndexIVFPQFastScanRefine, T>) {
             Normalize(dataset);
             normalized_ = true;
         }
@@ -267,6 +399,16 @@ IvfIndexNode<T>::Train(const DataSet& dataset, const Config& cfg) {
     auto dim = dataset.GetDim();
     auto data = dataset.GetTensor();
 
+    const IvfConfig& ivf_cfg = static_cast<const IvfConfig&>(cfg);
+    if (ivf_cfg.quantizer_path.has_value() && !ivf_cfg.quantizer_path.value().empty()) {
+        std::unique_ptr<T> index;
+        RETURN_IF_ERROR(LoadQuantizer(ivf_cfg, dim, metric.value(), index));
+        index_ = std::move(index);
+        zero_copy_data_ = nullptr;
+        UpdateQuantizerId();
+        return Status::success;
+    }
+
     typename QuantizerT<T>::type* qzr = nullptr;
     faiss::IndexIVFPQFastScan* base_index = nullptr;
     std::unique_ptr<T> index;
@@ -306,12 +448,37 @@ IvfIndexNode<T>::Train(const DataSet& dataset, const Config& cfg) {
             index = std::make_unique<faiss::IndexScaNN>(base_index, (const float*)data);
             index->train(rows, (const float*)data);
         }
+        if constexpr (std::is_same<faiss::IndexIVFPQFastScanRefine, T>::value) {
+            const IvfPqFastScanConfig& fs_cfg = static_cast<const IvfPqFastScanConfig&>(cfg);
+            auto nlist = MatchNlist(rows, fs_cfg.nlist.value());
+            int64_t m = fs_cfg.m.value() > 0 ? fs_cfg.m.value() : std::max<int64_t>(1, dim / 2);
+            if (dim % m != 0) {
+                LOG_KNOWHERE_ERROR_ << "dim " << dim << " is not a multiple of m " << m;
+                return Status::invalid_args;
+            }
+            bool is_cosine = base_cfg.metric_type.value() == metric::COSINE;
+            qzr = new (std::nothrow) typename QuantizerT<T>::type(dim, metric.value());
+            base_index = new (std::nothrow) faiss::IndexIVFPQFastScan(qzr, dim, nlist, m, 4, is_cosine, metric.value());
+            base_index->own_fields = true;
+            qzr = nullptr;
+            const auto& refine_type = fs_cfg.refine_type.value();
+            faiss::Index* refine_index = nullptr;
+            if (refine_type == "FLAT") {
+                refine_index = new faiss::IndexFlat(dim, metric.value());
+            } else if (refine_type == "SQ8") {
+                refine_index = new faiss::IndexScalarQuantizer(dim, faiss::QuantizerType::QT_8bit, metric.value());
+            } else if (refine_type == "FP16") {
+                refine_index = new faiss::IndexScalarQuantizer(dim, faiss::QuantizerType::QT_fp16, metric.value());
+            }
+            index = std::make_unique<faiss::IndexIVFPQFastScanRefine>(base_index, refine_index);
+            index->own_refine_index = true;
+            index->train(rows, (const float*)data);
+        }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, T>::value) {
             const IvfSqConfig& ivf_sq_cfg = static_cast<const IvfSqConfig&>(cfg);
             auto nlist = MatchNlist(rows, ivf_sq_cfg.nlist.value());
             qzr = new (std::nothrow) typename QuantizerT<T>::type(dim, metric.value());
-            index = std::make_unique<faiss::IndexIVFScalarQuantizer>(qzr, dim, nlist, faiss::QuantizerType::QT_8bit,
-                                                                     metric.value());
+            index = std::make_unique<faiss::IndexIVFScalarQuantizer>(qzr, dim, nlist, qtype_, metric.value());
             index->train(rows, (const float*)data);
         }
         if constexpr (std::is_same<faiss::IndexBinaryIVF, T>::value) {
@@ -333,10 +500,123 @@ IvfIndexNode<T>::Train(const DataSet& dataset, const Config& cfg) {
         return Status::faiss_inner_error;
     }
     index_ = std::move(index);
+    zero_copy_data_ = nullptr;
+    UpdateQuantizerId();
 
     return Status::success;
 }
 
+// Reads the index a shared quantizer was serialized with, the same way Deserialize does. It must be an index of this
+// type, dim and metric that is trained and holds no vector.
+template <typename T>
+Status
+IvfIndexNode<T>::LoadQuantizer(const IvfConfig& cfg, int64_t dim, faiss::MetricType metric,
+                               std::unique_ptr<T>& index) const {
+    using BaseIndex =
+        std::conditional_t<std::is_same<T, faiss::IndexBinaryIVF>::value, faiss::IndexBinary, faiss::Index>;
+    const auto& path = cfg.quantizer_path.value();
+    std::unique_ptr<BaseIndex> loaded;
+    try {
+        faiss::FileIOReader reader(path.c_str());
+        if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
+            loaded.reset(faiss::read_index_binary(&reader));
+        } else if constexpr (std::is_same<T, faiss::IndexIVFFlat>::value) {
+            loaded.reset(faiss::read_index_nm(&reader));
+        } else {
+            loaded.reset(faiss::read_index(&reader));
+        }
+    } catch (const std::exception& e) {
+        LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+        return Status::faiss_inner_error;
+    }
+
+    bool typed = false;
+    if constexpr (std::is_same<T, faiss::IndexScaNN>::value) {
+        // read back as the refine index it is stored as, like in Deserialize
+        auto refine = dynamic_cast<const faiss::IndexRefineFlat*>(loaded.get());
+        typed = refine != nullptr && dynamic_cast<const faiss::IndexIVFPQFastScan*>(refine->base_index) != nullptr;
+    } else {
+        typed = dynamic_cast<const T*>(loaded.get()) != nullptr;
+    }
+    if (!typed) {
+        LOG_KNOWHERE_ERROR_ << "quantizer file " << path << " does not hold a " << Type() << " index";
+        return Status::invalid_args;
+    }
+    if (loaded->d != dim || loaded->metric_type != metric) {
+        LOG_KNOWHERE_ERROR_ << "quantizer file " << path << " holds a " << loaded->d << "-dim index of metric "
+                            << FaissMetricType2Str(loaded->metric_type) << ", expected " << dim << "-dim of metric "
+                            << cfg.metric_type.value();
+        return Status::invalid_args;
+    }
+    // COSINE and IP share the faiss metric, the fast scan indexes tell them apart with a flag of their own
+    bool is_cosine = IsMetricType(cfg.metric_type.value(), metric::COSINE);
+    if (auto fast_scan = FastScanIndex(static_cast<const T*>(loaded.get()));
+        fast_scan != nullptr && fast_scan->is_cosine_ != is_cosine) {
+        LOG_KNOWHERE_ERROR_ << "quantizer file " << path << " holds a " << (fast_scan->is_cosine_ ? "COSINE" : "IP")
+                            << " index, expected " << cfg.metric_type.value();
+        return Status::invalid_args;
+    }
+    if (!loaded->is_trained || loaded->ntotal != 0) {
+        LOG_KNOWHERE_ERROR_ << "quantizer file " << path << " does not hold a trained and empty index";
+        return Status::invalid_args;
+    }
+    if constexpr (std::is_same<T, faiss::IndexIVFScalarQuantizer>::value) {
+        if (static_cast<const T*>(loaded.get())->sq.qtype != qtype_) {
+            LOG_KNOWHERE_ERROR_ << "quantizer file " << path << " holds another scalar quantizer than " << Type();
+            return Status::invalid_args;
+        }
+    }
+    if constexpr (std::is_same<T, faiss::IndexIVFFlatCC>::value) {
+        // the file records neither the segment size nor the cosine flag and is read back with plain inverted lists,
+        // so the index is rebuilt around the loaded centroids with the ones of the config
+        auto loaded_cc = static_cast<T*>(loaded.get());
+        const auto& cc_cfg = static_cast<const IvfFlatCcConfig&>(cfg);
+        index = std::make_unique<T>(loaded_cc->quantizer, dim, loaded_cc->nlist, cc_cfg.ssize.value(), is_cosine,
+                                    metric);
+        index->own_fields = true;
+        loaded_cc->own_fields = false;
+        return Status::success;
+    }
+    index.reset(static_cast<T*>(loaded.release()));
+    return Status::success;
+}
+
+template <typename T>
+void
+IvfIndexNode<T>::UpdateQuantizerId() {
+    quantizer_id_.clear();
+    if (!index_) {
+        return;
+    }
+    std::string_view centroids;
+    if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
+        if (auto qzr = dynamic_cast<const faiss::IndexBinaryFlat*>(index_->quantizer)) {
+            centroids = std::string_view((const char*)qzr->xb.data(), qzr->xb.size());
+        }
+    } else {
+        const faiss::IndexIVF* ivf = nullptr;
+        if constexpr (std::is_same<T, faiss::IndexScaNN>::value ||
+                      std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+            ivf = dynamic_cast<const faiss::IndexIVF*>(index_->base_index);
+        } else {
+            ivf = index_.get();
+        }
+        if (auto qzr = ivf != nullptr ? dynamic_cast<const faiss::IndexFlatCodes*>(ivf->quantizer) : nullptr) {
+            centroids = std::string_view((const char*)qzr->codes.data(), qzr->codes.size());
+        }
+    }
+    if (centroids.empty()) {
+        return;
+    }
+    // only the fast scan indexes record COSINE, for the other ones it is IP over normalized centroids
+    auto fast_scan = FastScanIndex(index_.get());
+    auto metric_type = fast_scan != nullptr && fast_scan->is_cosine_ ? std::string(metric::COSINE)
+                                                                     : FaissMetricType2Str(index_->metric_type);
+    std::stringstream ss;
+    ss << metric_type << "-" << std::hex << std::hash<std::string_view>{}(centroids);
+    quantizer_id_ = ss.str();
+}
+
 template <typename T>
 Status
 IvfIndexNode<T>::Add(const DataSet& dataset, const Config& cfg) {
@@ -370,13 +650,28 @@ IvfIndexNode<T>::Add(const DataSet& dataset, const Config& cfg) {
 template <typename T>
 expected<DataSetPtr>
 IvfIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const BitsetView& bitset) const {
+    auto k = static_cast<const IvfConfig&>(cfg).k.value();
+    auto rows = dataset.GetRows();
+    std::unique_ptr<int64_t[]> ids(new int64_t[rows * k]);
+    std::unique_ptr<float[]> distances(new float[rows * k]);
+    auto status = SearchWithBuf(dataset, cfg, bitset, ids.get(), distances.get());
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, "failed to search ivf index");
+    }
+    return GenResultDataSet(rows, k, ids.release(), distances.release());
+}
+
+template <typename T>
+Status
+IvfIndexNode<T>::SearchWithBuf(const DataSet& dataset, const Config& cfg, const BitsetView& bitset, int64_t* ids,
+                               float* distances) const {
     if (!this->index_) {
         LOG_KNOWHERE_WARNING_ << "search on empty index";
-        expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        return Status::empty_index;
     }
     if (!this->index_->is_trained) {
         LOG_KNOWHERE_WARNING_ << "index not trained";
-        expected<DataSetPtr>::Err(Status::index_not_trained, "index not trained");
+        return Status::index_not_trained;
     }
 
     auto dim = dataset.GetDim();
@@ -389,15 +684,21 @@ IvfIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const BitsetV
     auto k = ivf_cfg.k.value();
     auto nprobe = ivf_cfg.nprobe.value();
 
-    int64_t* ids(new (std::nothrow) int64_t[rows * k]);
-    float* distances(new (std::nothrow) float[rows * k]);
     int32_t* i_distances = reinterpret_cast<int32_t*>(distances);
     try {
+        if constexpr (kListMajorSearch) {
+            if (rows >= kTiledKnnMinNq &&
+                SearchByList((const float*)data, rows, k, nprobe, is_cosine, bitset, ids, distances)) {
+                return Status::success;
+            }
+        }
+        auto stats = SearchStats::Active();
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(rows);
         for (int i = 0; i < rows; ++i) {
             futs.emplace_back(search_pool_->push([&, index = i] {
                 ThreadPool::ScopedOmpSetter setter(1);
+                ScopedIvfStats ivf_stats(stats);
                 auto offset = k * index;
                 std::unique_ptr<float[]> copied_query = nullptr;
                 if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
@@ -414,16 +715,7 @@ IvfIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const BitsetV
                         copied_query = CopyAndNormalizeFloatVec(cur_query, dim);
                         cur_query = copied_query.get();
 
-                        // temporary solution to fix IVF_FLAT cosine
-                        if (!normalized_) {
-                            std::lock_guard<std::mutex> lock(normalize_mtx_);
-                            if (!normalized_) {
-                                faiss::IndexIVFFlat* ivf_index = static_cast<faiss::IndexIVFFlat*>(index_.get());
-                                size_t nb = ivf_index->arranged_codes.size() / ivf_index->code_size;
-                                NormalizeVecs((float*)(ivf_index->arranged_codes.data()), nb, dim);
-                                normalized_ = true;
-                            }
-                        }
+                        NormalizeCodesOnce();
                     }
                     index_->search_without_codes_thread_safe(1, cur_query, k, distances + offset, ids + offset, nprobe,
                                                              0, bitset);
@@ -436,6 +728,15 @@ IvfIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const BitsetV
                     }
                     index_->search_thread_safe(1, cur_query, k, distances + offset, ids + offset, nprobe,
                                                scann_cfg.reorder_k.value(), bitset);
+                } else if constexpr (std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+                    auto cur_query = (const float*)data + index * dim;
+                    const IvfPqFastScanConfig& fs_cfg = static_cast<const IvfPqFastScanConfig&>(cfg);
+                    if (is_cosine) {
+                        copied_query = CopyAndNormalizeFloatVec(cur_query, dim);
+                        cur_query = copied_query.get();
+                    }
+                    index_->search_thread_safe(1, cur_query, k, distances + offset, ids + offset, nprobe,
+                                               fs_cfg.reorder_k.value(), bitset);
                 } else {
                     auto cur_query = (const float*)data + index * dim;
                     if (is_cosine) {
@@ -450,14 +751,77 @@ IvfIndexNode<T>::Search(const DataSet& dataset, const Config& cfg, const BitsetV
             fut.wait();
         }
     } catch (const std::exception& e) {
-        delete[] ids;
-        delete[] distances;
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
-        return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        return Status::faiss_inner_error;
+    }
+    return Status::success;
+}
+
+// Assigns the whole batch to its lists in one tiled scan over the centroids, then splits the queries into one block
+// per search thread and lets faiss visit every list once for all the queries of a block that probe it. Returns false
+// when the coarse quantizer is not a flat float index, the caller then falls back to the per-query path.
+template <typename T>
+bool
+IvfIndexNode<T>::SearchByList(const float* xq, int64_t nq, int64_t k, int64_t nprobe, bool is_cosine,
+                              const BitsetView& bitset, int64_t* ids, float* distances) const {
+    auto quantizer = dynamic_cast<const faiss::IndexFlat*>(index_->quantizer);
+    if (quantizer == nullptr) {
+        return false;
+    }
+    const int64_t dim = index_->d;
+    const int64_t nlist = index_->nlist;
+    nprobe = std::min(nprobe, nlist);
+
+    std::unique_ptr<float[]> copied_queries = nullptr;
+    if (is_cosine) {
+        copied_queries = CopyAndNormalizeFloatVecs(xq, nq, dim);
+        xq = copied_queries.get();
+        if constexpr (std::is_same<T, faiss::IndexIVFFlat>::value) {
+            NormalizeCodesOnce();
+        }
+    }
+
+    auto stats = SearchStats::Active();
+    auto assign = std::make_unique<int64_t[]>(nq * nprobe);
+    auto coarse_dis = std::make_unique<float[]>(nq * nprobe);
+    {
+        SearchStageTimer timer(stats, SearchStats::QUANTIZE);
+        if (TiledKnnSearch(xq, nq, quantizer->get_xb(), nlist, dim, nprobe, quantizer->metric_type, false, nullptr,
+                           assign.get(), coarse_dis.get(), search_pool_) != Status::success) {
+            return false;
+        }
+    }
+    if (stats != nullptr) {
+        stats->Add(SearchStats::LISTS_SCANNED, nq * nprobe);
     }
 
-    auto res = GenResultDataSet(rows, k, ids, distances);
-    return res;
+    const int64_t nblock = std::min<int64_t>(search_pool_->size(), nq);
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(nblock);
+    for (int64_t b = 0; b < nblock; ++b) {
+        const int64_t q0 = nq * b / nblock;
+        const int64_t q1 = nq * (b + 1) / nblock;
+        futs.emplace_back(search_pool_->push([&, q0, q1] {
+            ThreadPool::ScopedOmpSetter setter(1);
+            SearchStageTimer timer(stats, SearchStats::SCAN);
+            if constexpr (std::is_same<T, faiss::IndexIVFFlat>::value) {
+                index_->search_preassigned_by_list_without_codes(
+                    q1 - q0, xq + q0 * dim, k, nprobe, assign.get() + q0 * nprobe, coarse_dis.get() + q0 * nprobe,
+                    distances + q0 * k, ids + q0 * k, bitset);
+            } else {
+                index_->search_preassigned_by_list(q1 - q0, xq + q0 * dim, k, nprobe, assign.get() + q0 * nprobe,
+                                                   coarse_dis.get() + q0 * nprobe, distances + q0 * k, ids + q0 * k,
+                                                   bitset);
+            }
+        }));
+    }
+    for (auto& fut : futs) {
+        fut.wait();
+    }
+    for (auto& fut : futs) {
+        fut.value();  // rethrows the faiss error of a failed block
+    }
+    return true;
 }
 
 template <typename T>
@@ -483,21 +847,16 @@ IvfIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, const Bi
     float range_filter = ivf_cfg.range_filter.value();
     bool is_ip = (index_->metric_type == faiss::METRIC_INNER_PRODUCT);
 
-    int64_t* ids = nullptr;
-    float* distances = nullptr;
-    size_t* lims = nullptr;
-
-    std::vector<std::vector<int64_t>> result_id_array(nq);
-    std::vector<std::vector<float>> result_dist_array(nq);
-    std::vector<size_t> result_size(nq);
-    std::vector<size_t> result_lims(nq + 1);
+    RangeSearchResultArena arena(nq, is_ip, radius, range_filter);
 
     try {
+        auto stats = SearchStats::Active();
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(nq);
         for (int i = 0; i < nq; ++i) {
             futs.emplace_back(search_pool_->push([&, index = i] {
                 ThreadPool::ScopedOmpSetter setter(1);
+                ScopedIvfStats ivf_stats(stats);
                 faiss::RangeSearchResult res(1);
                 std::unique_ptr<float[]> copied_query = nullptr;
                 if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
@@ -509,16 +868,7 @@ IvfIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, const Bi
                         copied_query = CopyAndNormalizeFloatVec(cur_query, dim);
                         cur_query = copied_query.get();
 
-                        // temporary solution to fix IVF_FLAT cosine
-                        if (!normalized_) {
-                            std::lock_guard<std::mutex> lock(normalize_mtx_);
-                            if (!normalized_) {
-                                faiss::IndexIVFFlat* ivf_index = static_cast<faiss::IndexIVFFlat*>(index_.get());
-                                size_t nb = ivf_index->arranged_codes.size() / ivf_index->code_size;
-                                NormalizeVecs((float*)(ivf_index->arranged_codes.data()), nb, dim);
-                                normalized_ = true;
-                            }
-                        }
+                        NormalizeCodesOnce();
                     }
                     index_->range_search_without_codes_thread_safe(1, cur_query, radius, &res, index_->nlist, 0,
                                                                    bitset);
@@ -529,6 +879,14 @@ IvfIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, const Bi
                         cur_query = copied_query.get();
                     }
                     index_->range_search_thread_safe(1, cur_query, radius, &res, bitset);
+                } else if constexpr (std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+                    auto cur_query = (const float*)xq + index * dim;
+                    if (is_cosine) {
+                        copied_query = CopyAndNormalizeFloatVec(cur_query, dim);
+                        cur_query = copied_query.get();
+                    }
+                    index_->range_search_thread_safe(1, cur_query, radius, &res, index_->fast_scan_index()->nlist,
+                                                     bitset);
                 } else {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
@@ -537,30 +895,18 @@ IvfIndexNode<T>::RangeSearch(const DataSet& dataset, const Config& cfg, const Bi
                     }
                     index_->range_search_thread_safe(1, cur_query, radius, &res, index_->nlist, 0, bitset);
                 }
-                auto elem_cnt = res.lims[1];
-                result_dist_array[index].resize(elem_cnt);
-                result_id_array[index].resize(elem_cnt);
-                result_size[index] = elem_cnt;
-                for (size_t j = 0; j < elem_cnt; j++) {
-                    result_dist_array[index][j] = res.distances[j];
-                    result_id_array[index][j] = res.labels[j];
-                }
-                if (range_filter != defaultRangeFilter) {
-                    FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
-                                                    range_filter);
-                }
+                RangeSearchResultArena::Writer(arena, index).Add(res.labels, res.distances, res.lims[1]);
             }));
         }
         for (auto& fut : futs) {
             fut.wait();
         }
-        GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter, distances, ids, lims);
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
     }
 
-    return GenResultDataSet(nq, ids, distances, lims);
+    return arena.GenResultDataSet();
 }
 
 template <typename T>
@@ -637,6 +983,29 @@ IvfIndexNode<T>::GetVectorByIds(const DataSet& dataset) const {
         auto rows = dataset.GetRows();
         auto ids = dataset.GetIds();
 
+        float* data = nullptr;
+        try {
+            data = new float[dim * rows];
+            for (int64_t i = 0; i < rows; i++) {
+                int64_t id = ids[i];
+                assert(id >= 0 && id < index_->ntotal);
+                index_->reconstruct(id, data + i * dim);
+            }
+            return GenResultDataSet(rows, dim, data);
+        } catch (const std::exception& e) {
+            std::unique_ptr<float[]> auto_del(data);
+            LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+            return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
+        }
+    } else if constexpr (std::is_same<T, faiss::IndexIVFPQFastScanRefine>::value) {
+        if (dynamic_cast<const faiss::IndexFlat*>(index_->refine_index) == nullptr ||
+            index_->fast_scan_index()->is_cosine_) {
+            return expected<DataSetPtr>::Err(Status::not_implemented, "GetVectorByIds needs a FLAT refine, not COSINE");
+        }
+        auto dim = Dim();
+        auto rows = dataset.GetRows();
+        auto ids = dataset.GetIds();
+
         float* data = nullptr;
         try {
             data = new float[dim * rows];
@@ -728,19 +1097,28 @@ IvfIndexNode<T>::Deserialize(const BinarySet& binset, const Config& config) {
         return Status::invalid_binary_set;
     }
 
+    const BaseConfig& cfg = static_cast<const BaseConfig&>(config);
+    int io_flags = 0;
+    if (cfg.enable_zero_copy.value()) {
+        ZeroCopyInvertedListsIOHook::Register();
+        io_flags |= kIoFlagZeroCopy;
+    }
+
     MemoryIOReader reader;
     reader.total = binary->size;
     reader.data_ = binary->data.get();
     try {
         if constexpr (std::is_same<T, faiss::IndexBinaryIVF>::value) {
-            index_.reset(static_cast<T*>(faiss::read_index_binary(&reader)));
+            index_.reset(static_cast<T*>(faiss::read_index_binary(&reader, io_flags)));
         } else {
-            index_.reset(static_cast<T*>(faiss::read_index(&reader)));
+            index_.reset(static_cast<T*>(faiss::read_index(&reader, io_flags)));
         }
+        zero_copy_data_ = io_flags != 0 ? binary->data : nullptr;
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
     }
+    UpdateQuantizerId();
     return Status::success;
 }
 
@@ -759,10 +1137,12 @@ IvfIndexNode<T>::DeserializeFromFile(const std::string& filename, const Config&
         } else {
             index_.reset(static_cast<T*>(faiss::read_index(filename.data(), io_flags)));
         }
+        zero_copy_data_ = nullptr;
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
     }
+    UpdateQuantizerId();
     return Status::success;
 }
 
@@ -781,7 +1161,9 @@ IvfIndexNode<faiss::IndexIVFFlat>::Deserialize(const BinarySet& binset, const Co
     reader.total = binary->size;
     reader.data_ = binary->data.get();
     try {
+        // the codes are rebuilt from RAW_DATA in list order below, so there is nothing to load without a copy
         index_.reset(static_cast<faiss::IndexIVFFlat*>(faiss::read_index_nm(&reader)));
+        zero_copy_data_ = nullptr;
 
         // Construct arranged data from original data
         auto binary = binset.GetByName("RAW_DATA");
@@ -795,6 +1177,7 @@ IvfIndexNode<faiss::IndexIVFFlat>::Deserialize(const BinarySet& binset, const Co
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
     }
+    UpdateQuantizerId();
     return Status::success;
 }
 
@@ -818,6 +1201,9 @@ KNOWHERE_REGISTER_GLOBAL(IVF_FLAT_CC, [](const Object& object) {
 });
 KNOWHERE_REGISTER_GLOBAL(SCANN,
                          [](const Object& object) { return Index<IvfIndexNode<faiss::IndexScaNN>>::Create(object); });
+KNOWHERE_REGISTER_GLOBAL(IVF_PQ_FS, [](const Object& object) {
+    return Index<IvfIndexNode<faiss::IndexIVFPQFastScanRefine>>::Create(object);
+});
 KNOWHERE_REGISTER_GLOBAL(IVFPQ,
                          [](const Object& object) { return Index<IvfIndexNode<faiss::IndexIVFPQ>>::Create(object); });
 KNOWHERE_REGISTER_GLOBAL(IVF_PQ,
@@ -829,5 +1215,17 @@ KNOWHERE_REGISTER_GLOBAL(IVFSQ, [](const Object& object) {
 KNOWHERE_REGISTER_GLOBAL(IVF_SQ8, [](const Object& object) {
     return Index<IvfIndexNode<faiss::IndexIVFScalarQuantizer>>::Create(object);
 });
+KNOWHERE_REGISTER_GLOBAL(IVF_SQ4, [](const Object& object) {
+    return Index<IvfIndexNode<faiss::IndexIVFScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_4bit);
+});
+KNOWHERE_REGISTER_GLOBAL(IVF_SQ6, [](const Object& object) {
+    return Index<IvfIndexNode<faiss::IndexIVFScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_6bit);
+});
+KNOWHERE_REGISTER_GLOBAL(IVF_FP16, [](const Object& object) {
+    return Index<IvfIndexNode<faiss::IndexIVFScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_fp16);
+});
+KNOWHERE_REGISTER_GLOBAL(IVF_BF16, [](const Object& object) {
+    return Index<IvfIndexNode<faiss::IndexIVFScalarQuantizer>>::Create(object, faiss::QuantizerType::QT_bf16);
+});
 
 }  // namespace knowhere
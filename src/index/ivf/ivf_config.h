@@ -19,6 +19,10 @@ class IvfConfig : public BaseConfig {
  public:
     CFG_INT nlist;
     CFG_INT nprobe;
+    // File of an index of the same type, dim and metric that was trained and serialized without adding any vector.
+    // Its coarse centroids and PQ/SQ codebooks are reused as they are instead of training new ones, so the segments of
+    // one distribution share a single quantizer; nlist and the codec parameters are then taken from the file.
+    CFG_STRING quantizer_path;
     KNOHWERE_DECLARE_CONFIG(IvfConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(nlist)
             .set_default(128)
@@ -30,6 +34,10 @@ class IvfConfig : public BaseConfig {
             .description("number of probes at query time.")
             .for_search()
             .set_range(1, 65536);
+        KNOWHERE_CONFIG_DECLARE_FIELD(quantizer_path)
+            .description("file of a trained and empty index whose quantizer is reused instead of training one.")
+            .allow_empty_without_default()
+            .for_train();
     }
 };
 
@@ -83,6 +91,54 @@ class ScannConfig : public IvfFlatConfig {
     }
 };
 
+// 4-bit PQ codes scanned with in-register lookup tables, the candidates optionally reranked with a finer codec
+class IvfPqFastScanConfig : public IvfConfig {
+ public:
+    CFG_INT m;
+    CFG_STRING refine_type;
+    CFG_INT reorder_k;
+    KNOHWERE_DECLARE_CONFIG(IvfPqFastScanConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(m)
+            .description("number of 4-bit sub-quantizers, 0 for dim / 2")
+            .set_default(0)
+            .for_train()
+            .set_range(0, 65536);
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("codec of the vectors the candidates are reranked with: NONE, SQ8, FP16 or FLAT")
+            .set_default("NONE")
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(reorder_k)
+            .description("number of candidates reranked when refining")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+    }
+
+    inline Status
+    CheckAndAdjustForBuild() override {
+        const auto& type = refine_type.value();
+        if (type != "NONE" && type != "SQ8" && type != "FP16" && type != "FLAT") {
+            LOG_KNOWHERE_ERROR_ << "invalid refine_type " << type << ", should be NONE, SQ8, FP16 or FLAT";
+            return Status::invalid_value_in_json;
+        }
+        return Status::success;
+    }
+
+    inline Status
+    CheckAndAdjustForSearch(std::string* err_msg) override {
+        if (!reorder_k.has_value()) {
+            reorder_k = k.value();
+        } else if (reorder_k.value() < k.value()) {
+            *err_msg = "reorder_k(" + std::to_string(reorder_k.value()) + ") should be larger than k(" +
+                       std::to_string(k.value()) + ")";
+            LOG_KNOWHERE_ERROR_ << *err_msg;
+            return Status::out_of_range_in_json;
+        }
+
+        return Status::success;
+    }
+};
+
 class IvfSqConfig : public IvfConfig {};
 
 class IvfBinConfig : public IvfConfig {};
@@ -0,0 +1,130 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#include "io/ZeroCopyInvertedLists.h"
+
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/io.h>
+#include <faiss/impl/io_macros.h>
+
+#include <cstring>
+#include <mutex>
+
+#include "io/FaissIO.h"
+
+namespace knowhere {
+
+ZeroCopyInvertedLists::ZeroCopyInvertedLists(size_t nlist, size_t code_size, const uint8_t* data,
+                                             const std::vector<size_t>& sizes)
+    : InvertedLists(nlist, code_size), sizes_(sizes), codes_(nlist), ids_(nlist), copied_ids_(nlist) {
+    for (size_t i = 0; i < nlist; i++) {
+        const size_t n = sizes_[i];
+        codes_[i] = data;
+        data += n * code_size;
+        if (reinterpret_cast<uintptr_t>(data) % alignof(idx_t) == 0) {
+            ids_[i] = reinterpret_cast<const idx_t*>(data);
+        } else {
+            copied_ids_[i].resize(n);
+            memcpy(copied_ids_[i].data(), data, n * sizeof(idx_t));
+            ids_[i] = copied_ids_[i].data();
+        }
+        data += n * sizeof(idx_t);
+    }
+}
+
+size_t
+ZeroCopyInvertedLists::list_size(size_t list_no) const {
+    return sizes_[list_no];
+}
+
+const uint8_t*
+ZeroCopyInvertedLists::get_codes(size_t list_no) const {
+    return codes_[list_no];
+}
+
+const ZeroCopyInvertedLists::idx_t*
+ZeroCopyInvertedLists::get_ids(size_t list_no) const {
+    return ids_[list_no];
+}
+
+size_t
+ZeroCopyInvertedLists::add_entries(size_t, size_t, const idx_t*, const uint8_t*, const float*) {
+    FAISS_THROW_MSG("not implemented for zero-copy inverted lists");
+}
+
+void
+ZeroCopyInvertedLists::update_entries(size_t, size_t, size_t, const idx_t*, const uint8_t*) {
+    FAISS_THROW_MSG("not implemented for zero-copy inverted lists");
+}
+
+void
+ZeroCopyInvertedLists::resize(size_t, size_t) {
+    FAISS_THROW_MSG("not implemented for zero-copy inverted lists");
+}
+
+bool
+ZeroCopyInvertedLists::is_readonly() const {
+    return true;
+}
+
+ZeroCopyInvertedListsIOHook::ZeroCopyInvertedListsIOHook()
+    : InvertedListsIOHook("ilzc", typeid(ZeroCopyInvertedLists).name()) {
+}
+
+void
+ZeroCopyInvertedListsIOHook::write(const faiss::InvertedLists* ils, faiss::IOWriter* f) const {
+    uint32_t h = faiss::fourcc("ilar");
+    WRITE1(h);
+    WRITE1(ils->nlist);
+    WRITE1(ils->code_size);
+    uint32_t list_type = faiss::fourcc("full");
+    WRITE1(list_type);
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i < ils->nlist; i++) {
+        sizes.push_back(ils->list_size(i));
+    }
+    WRITEVECTOR(sizes);
+    for (size_t i = 0; i < ils->nlist; i++) {
+        size_t n = ils->list_size(i);
+        if (n > 0) {
+            WRITEANDCHECK(ils->get_codes(i), n * ils->code_size);
+            WRITEANDCHECK(ils->get_ids(i), n);
+        }
+    }
+}
+
+faiss::InvertedLists*
+ZeroCopyInvertedListsIOHook::read(faiss::IOReader*, int) const {
+    FAISS_THROW_MSG("zero-copy inverted lists are serialized as ilar");
+}
+
+faiss::InvertedLists*
+ZeroCopyInvertedListsIOHook::read_ArrayInvertedLists(faiss::IOReader* f, int, size_t nlist, size_t code_size,
+                                                     const std::vector<size_t>& sizes) const {
+    auto reader = dynamic_cast<MemoryIOReader*>(f);
+    FAISS_THROW_IF_NOT_MSG(reader, "zero-copy load only supported for memory readers");
+    size_t nbytes = 0;
+    for (size_t n : sizes) {
+        nbytes += n * (code_size + sizeof(faiss::InvertedLists::idx_t));
+    }
+    FAISS_THROW_IF_NOT_MSG(reader->rp + nbytes <= reader->total, "truncated inverted lists");
+    auto ils = new ZeroCopyInvertedLists(nlist, code_size, reader->data_ + reader->rp, sizes);
+    reader->rp += nbytes;
+    return ils;
+}
+
+void
+ZeroCopyInvertedListsIOHook::Register() {
+    static std::once_flag flag;
+    std::call_once(flag, [] { faiss::InvertedListsIOHook::add_callback(new ZeroCopyInvertedListsIOHook()); });
+}
+
+}  // namespace knowhere
@@ -0,0 +1,83 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License
+
+#pragma once
+
+#include <faiss/index_io.h>
+#include <faiss/invlists/InvertedLists.h>
+#include <faiss/invlists/InvertedListsIOHook.h>
+
+#include <vector>
+
+namespace knowhere {
+
+// faiss::read_index flag that makes the array inverted lists read through a MemoryIOReader point into the reader
+// buffer instead of being copied, the high 16 bits select ZeroCopyInvertedListsIOHook ("ilzc")
+constexpr int kIoFlagZeroCopy = faiss::IO_FLAG_SKIP_IVF_DATA | 0x637a0000;
+
+/**
+ * @brief Read-only inverted lists over the serialized form of an ArrayInvertedLists, where every list is stored as
+ * its codes followed by its ids. The codes are used in place; the ids are used in place too unless the codes before
+ * them leave them misaligned, in which case that list's ids are copied. The buffer is owned by the caller and must
+ * outlive the lists.
+ */
+struct ZeroCopyInvertedLists : faiss::InvertedLists {
+    ZeroCopyInvertedLists(size_t nlist, size_t code_size, const uint8_t* data, const std::vector<size_t>& sizes);
+
+    size_t
+    list_size(size_t list_no) const override;
+
+    const uint8_t*
+    get_codes(size_t list_no) const override;
+
+    const idx_t*
+    get_ids(size_t list_no) const override;
+
+    size_t
+    add_entries(size_t list_no, size_t n_entry, const idx_t* ids, const uint8_t* code,
+                const float* code_norm = nullptr) override;
+
+    void
+    update_entries(size_t list_no, size_t offset, size_t n_entry, const idx_t* ids, const uint8_t* code) override;
+
+    void
+    resize(size_t list_no, size_t new_size) override;
+
+    bool
+    is_readonly() const override;
+
+ private:
+    std::vector<size_t> sizes_;
+    std::vector<const uint8_t*> codes_;
+    std::vector<const idx_t*> ids_;
+    std::vector<std::vector<idx_t>> copied_ids_;
+};
+
+struct ZeroCopyInvertedListsIOHook : faiss::InvertedListsIOHook {
+    ZeroCopyInvertedListsIOHook();
+
+    // written back as a plain ArrayInvertedLists, so a zero-copy load does not change the serialized format
+    void
+    write(const faiss::InvertedLists* ils, faiss::IOWriter* f) const override;
+
+    faiss::InvertedLists*
+    read(faiss::IOReader* f, int io_flags) const override;
+
+    faiss::InvertedLists*
+    read_ArrayInvertedLists(faiss::IOReader* f, int io_flags, size_t nlist, size_t code_size,
+                            const std::vector<size_t>& sizes) const override;
+
+    // registers the hook with faiss, safe to call any number of times
+    static void
+    Register();
+};
+
+}  // namespace knowhere
@@ -16,6 +16,9 @@
 #include <immintrin.h>
 
 #include <cassert>
+#include <cstring>
+
+#include "distances_sse.h"
 
 namespace faiss {
 
@@ -195,5 +198,651 @@ fvec_Linf_avx(const float* x, const float* y, size_t d) {
     return _mm_cvtss_f32(msum2);
 }
 
+float
+fvec_norm_L2sqr_avx(const float* x, size_t d) {
+    __m256 msum0 = _mm256_setzero_ps();
+    __m256 msum1 = _mm256_setzero_ps();
+
+    while (d >= 16) {
+        __m256 mx0 = _mm256_loadu_ps(x);
+        __m256 mx1 = _mm256_loadu_ps(x + 8);
+        x += 16;
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(mx0, mx0));
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(mx1, mx1));
+        d -= 16;
+    }
+    msum0 = _mm256_add_ps(msum0, msum1);
+
+    if (d >= 8) {
+        __m256 mx = _mm256_loadu_ps(x);
+        x += 8;
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(mx, mx));
+        d -= 8;
+    }
+
+    __m128 msum2 = _mm256_extractf128_ps(msum0, 1);
+    msum2 = _mm_add_ps(msum2, _mm256_extractf128_ps(msum0, 0));
+
+    if (d >= 4) {
+        __m128 mx = _mm_loadu_ps(x);
+        x += 4;
+        msum2 = _mm_add_ps(msum2, _mm_mul_ps(mx, mx));
+        d -= 4;
+    }
+
+    if (d > 0) {
+        __m128 mx = masked_read(d, x);
+        msum2 = _mm_add_ps(msum2, _mm_mul_ps(mx, mx));
+    }
+
+    msum2 = _mm_hadd_ps(msum2, msum2);
+    msum2 = _mm_hadd_ps(msum2, msum2);
+    return _mm_cvtss_f32(msum2);
+}
+
+namespace {
+
+struct ElementOpL2 {
+    static float
+    op(float x, float y) {
+        float tmp = x - y;
+        return tmp * tmp;
+    }
+
+    static __m256
+    op(__m256 x, __m256 y) {
+        __m256 tmp = _mm256_sub_ps(x, y);
+        return _mm256_mul_ps(tmp, tmp);
+    }
+
+    static float
+    distance(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr_avx(x, y, d);
+    }
+};
+
+struct ElementOpIP {
+    static float
+    op(float x, float y) {
+        return x * y;
+    }
+
+    static __m256
+    op(__m256 x, __m256 y) {
+        return _mm256_mul_ps(x, y);
+    }
+
+    static float
+    distance(const float* x, const float* y, size_t d) {
+        return fvec_inner_product_avx(x, y, d);
+    }
+};
+
+// lane i of the result is the horizontal sum of acc<i>
+inline __m128
+horizontal_add4(__m256 acc0, __m256 acc1, __m256 acc2, __m256 acc3) {
+    __m256 sum01 = _mm256_hadd_ps(acc0, acc1);
+    __m256 sum23 = _mm256_hadd_ps(acc2, acc3);
+    __m256 sum = _mm256_hadd_ps(sum01, sum23);
+    return _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+}
+
+// Compares x with 4 vectors of y per pass, so every load of x is shared by 4 of them and the 4 accumulators hide
+// the latency of the adds. DIM is a compile time dimension that lets the compiler unroll the inner loop, 0 means d.
+template <class ElementOp, size_t DIM>
+void
+fvec_op_ny_blocked(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    const size_t dim = DIM > 0 ? DIM : d;
+    const size_t dim8 = dim & ~size_t(7);
+
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const float* y0 = y + i * dim;
+        const float* y1 = y0 + dim;
+        const float* y2 = y1 + dim;
+        const float* y3 = y2 + dim;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        for (size_t j = 0; j < dim8; j += 8) {
+            const __m256 mx = _mm256_loadu_ps(x + j);
+            acc0 = _mm256_add_ps(acc0, ElementOp::op(mx, _mm256_loadu_ps(y0 + j)));
+            acc1 = _mm256_add_ps(acc1, ElementOp::op(mx, _mm256_loadu_ps(y1 + j)));
+            acc2 = _mm256_add_ps(acc2, ElementOp::op(mx, _mm256_loadu_ps(y2 + j)));
+            acc3 = _mm256_add_ps(acc3, ElementOp::op(mx, _mm256_loadu_ps(y3 + j)));
+        }
+        _mm_storeu_ps(dis + i, horizontal_add4(acc0, acc1, acc2, acc3));
+        for (size_t j = dim8; j < dim; j++) {
+            dis[i] += ElementOp::op(x[j], y0[j]);
+            dis[i + 1] += ElementOp::op(x[j], y1[j]);
+            dis[i + 2] += ElementOp::op(x[j], y2[j]);
+            dis[i + 3] += ElementOp::op(x[j], y3[j]);
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = ElementOp::distance(x, y + i * dim, dim);
+    }
+}
+
+}  // anonymous namespace
+
+void
+fvec_L2sqr_ny_avx(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+#define DISPATCH(dval)                                           \
+    case dval:                                                   \
+        fvec_op_ny_blocked<ElementOpL2, dval>(dis, x, y, d, ny); \
+        return;
+
+    switch (d) {
+        DISPATCH(96)
+        DISPATCH(128)
+        DISPATCH(256)
+        DISPATCH(384)
+        DISPATCH(768)
+        DISPATCH(1024)
+        // the sse kernels have special cases for the tiny dimensions of pq sub-quantizers
+        case 1:
+        case 2:
+        case 4:
+        case 12:
+            fvec_L2sqr_ny_sse(dis, x, y, d, ny);
+            return;
+        default:
+            fvec_op_ny_blocked<ElementOpL2, 0>(dis, x, y, d, ny);
+            return;
+    }
+#undef DISPATCH
+}
+
+void
+fvec_inner_products_ny_avx(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+#define DISPATCH(dval)                                           \
+    case dval:                                                   \
+        fvec_op_ny_blocked<ElementOpIP, dval>(dis, x, y, d, ny); \
+        return;
+
+    switch (d) {
+        DISPATCH(96)
+        DISPATCH(128)
+        DISPATCH(256)
+        DISPATCH(384)
+        DISPATCH(768)
+        DISPATCH(1024)
+        case 1:
+        case 2:
+        case 4:
+        case 12:
+            fvec_inner_products_ny_sse(dis, x, y, d, ny);
+            return;
+        default:
+            fvec_op_ny_blocked<ElementOpIP, 0>(dis, x, y, d, ny);
+            return;
+    }
+#undef DISPATCH
+}
+
+// unlike the sse versions, these do not need aligned inputs or n % 4 == 0
+void
+fvec_madd_avx(size_t n, const float* a, float bf, const float* b, float* c) {
+    const __m256 bf8 = _mm256_set1_ps(bf);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vc8 = _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_mul_ps(bf8, _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(c + i, vc8);
+    }
+    for (; i < n; i++) {
+        c[i] = a[i] + bf * b[i];
+    }
+}
+
+int
+fvec_madd_and_argmin_avx(size_t n, const float* a, float bf, const float* b, float* c) {
+    const __m256 bf8 = _mm256_set1_ps(bf);
+    __m256 vmin8 = _mm256_set1_ps(1e20);
+    __m256i imin8 = _mm256_set1_epi32(-1);
+    __m256i idx8 = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i inc8 = _mm256_set1_epi32(8);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vc8 = _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_mul_ps(bf8, _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(c + i, vc8);
+        // strict comparison, each lane keeps its first minimum
+        __m256 mask = _mm256_cmp_ps(vc8, vmin8, _CMP_LT_OQ);
+        imin8 = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(imin8), _mm256_castsi256_ps(idx8), mask));
+        vmin8 = _mm256_blendv_ps(vmin8, vc8, mask);
+        idx8 = _mm256_add_epi32(idx8, inc8);
+    }
+
+    ALIGNED(32) float vmins[8];
+    ALIGNED(32) int imins[8];
+    _mm256_store_ps(vmins, vmin8);
+    _mm256_store_si256((__m256i*)imins, imin8);
+    float vmin = 1e20;
+    int imin = -1;
+    for (int j = 0; j < 8; j++) {
+        if (imins[j] >= 0 && (vmins[j] < vmin || (vmins[j] == vmin && imins[j] < imin))) {
+            vmin = vmins[j];
+            imin = imins[j];
+        }
+    }
+    for (; i < n; i++) {
+        c[i] = a[i] + bf * b[i];
+        if (c[i] < vmin) {
+            vmin = c[i];
+            imin = i;
+        }
+    }
+    return imin;
+}
+
+// popcount of every byte with a nibble lookup table, summed into 4 64-bit lanes (Mula et al.)
+size_t
+bitset_popcount_avx(const uint8_t* data, size_t num_bits) {
+    const size_t nblock = num_bits / 256;
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < nblock; i++) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(data + i * 32));
+        const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+        const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    size_t ret = _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) + _mm256_extract_epi64(acc, 2) +
+                 _mm256_extract_epi64(acc, 3);
+    return ret + bitset_popcount_sse(data + nblock * 32, num_bits - nblock * 256);
+}
+
+// blocks of 256 bits without any match are skipped with a single test, which is what makes very selective
+// bitsets cheap to list
+size_t
+bitset_to_ids_avx(const uint8_t* data, size_t num_bits, bool value, int64_t* ids) {
+    const size_t nblock = num_bits / 256;
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    size_t n = 0;
+    for (size_t i = 0; i < nblock; i++) {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(data + i * 32));
+        if (value ? _mm256_testz_si256(v, v) : _mm256_testc_si256(v, ones)) {
+            continue;
+        }
+        for (size_t w = 0; w < 4; w++) {
+            uint64_t word;
+            memcpy(&word, data + i * 32 + w * 8, 8);
+            if (!value) {
+                word = ~word;
+            }
+            while (word != 0) {
+                ids[n++] = i * 256 + w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+        }
+    }
+    const size_t tail = bitset_to_ids_sse(data + nblock * 32, num_bits - nblock * 256, value, ids + n);
+    for (size_t j = n; j < n + tail; j++) {
+        ids[j] += nblock * 256;
+    }
+    return n + tail;
+}
+
+namespace {
+
+// fp16 and bf16 components widened to 8 floats
+struct Fp16Avx {
+    static __m256
+    load8(const uint16_t* x) {
+        return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)x));
+    }
+};
+
+struct Bf16Avx {
+    static __m256
+    load8(const uint16_t* x) {
+        __m256i xi = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)x));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(xi, 16));
+    }
+};
+
+// the last 0 < d < 8 components, zero padded
+template <class Half>
+inline __m256
+half_masked_read(size_t d, const uint16_t* x) {
+    ALIGNED(16) uint16_t buf[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    memcpy(buf, x, d * sizeof(uint16_t));
+    return Half::load8(buf);
+}
+
+inline float
+horizontal_add(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_hadd_ps(s, s);
+    s = _mm_hadd_ps(s, s);
+    return _mm_cvtss_f32(s);
+}
+
+template <class Half>
+float
+half_L2sqr(const uint16_t* x, const uint16_t* y, size_t d) {
+    __m256 msum0 = _mm256_setzero_ps();
+    __m256 msum1 = _mm256_setzero_ps();
+    while (d >= 16) {
+        __m256 diff0 = _mm256_sub_ps(Half::load8(x), Half::load8(y));
+        __m256 diff1 = _mm256_sub_ps(Half::load8(x + 8), Half::load8(y + 8));
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(diff0, diff0));
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(diff1, diff1));
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    if (d >= 8) {
+        __m256 diff = _mm256_sub_ps(Half::load8(x), Half::load8(y));
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(diff, diff));
+        x += 8;
+        y += 8;
+        d -= 8;
+    }
+    if (d > 0) {
+        __m256 diff = _mm256_sub_ps(half_masked_read<Half>(d, x), half_masked_read<Half>(d, y));
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(diff, diff));
+    }
+    return horizontal_add(_mm256_add_ps(msum0, msum1));
+}
+
+template <class Half>
+float
+half_inner_product(const uint16_t* x, const uint16_t* y, size_t d) {
+    __m256 msum0 = _mm256_setzero_ps();
+    __m256 msum1 = _mm256_setzero_ps();
+    while (d >= 16) {
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(Half::load8(x), Half::load8(y)));
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(Half::load8(x + 8), Half::load8(y + 8)));
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    if (d >= 8) {
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(Half::load8(x), Half::load8(y)));
+        x += 8;
+        y += 8;
+        d -= 8;
+    }
+    if (d > 0) {
+        __m256 mx = half_masked_read<Half>(d, x);
+        __m256 my = half_masked_read<Half>(d, y);
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(mx, my));
+    }
+    return horizontal_add(_mm256_add_ps(msum0, msum1));
+}
+
+template <class Half>
+float
+half_norm_L2sqr(const uint16_t* x, size_t d) {
+    __m256 msum0 = _mm256_setzero_ps();
+    __m256 msum1 = _mm256_setzero_ps();
+    while (d >= 16) {
+        __m256 mx0 = Half::load8(x);
+        __m256 mx1 = Half::load8(x + 8);
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(mx0, mx0));
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(mx1, mx1));
+        x += 16;
+        d -= 16;
+    }
+    if (d >= 8) {
+        __m256 mx = Half::load8(x);
+        msum0 = _mm256_add_ps(msum0, _mm256_mul_ps(mx, mx));
+        x += 8;
+        d -= 8;
+    }
+    if (d > 0) {
+        __m256 mx = half_masked_read<Half>(d, x);
+        msum1 = _mm256_add_ps(msum1, _mm256_mul_ps(mx, mx));
+    }
+    return horizontal_add(_mm256_add_ps(msum0, msum1));
+}
+
+}  // namespace
+
+float
+fp16_vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<Fp16Avx>(x, y, d);
+}
+
+float
+fp16_vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<Fp16Avx>(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<Fp16Avx>(x, d);
+}
+
+float
+bf16_vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<Bf16Avx>(x, y, d);
+}
+
+float
+bf16_vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<Bf16Avx>(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<Bf16Avx>(x, d);
+}
+
+// The codes are widened to 16 bits, where vpmaddwd multiplies pairs of them and adds the products into 32-bit lanes
+// without overflow. vpmaddubsw would take 32 codes at once but saturates its 16-bit sums for unsigned codes.
+int32_t
+u8_vec_L2sqr_avx(const uint8_t* x, const uint8_t* y, size_t d) {
+    __m256i msum0 = _mm256_setzero_si256();
+    __m256i msum1 = _mm256_setzero_si256();
+    while (d >= 32) {
+        __m256i diff0 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)x)),
+                                         _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)y)));
+        __m256i diff1 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(x + 16))),
+                                         _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + 16))));
+        msum0 = _mm256_add_epi32(msum0, _mm256_madd_epi16(diff0, diff0));
+        msum1 = _mm256_add_epi32(msum1, _mm256_madd_epi16(diff1, diff1));
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d >= 16) {
+        __m256i diff = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)x)),
+                                        _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)y)));
+        msum0 = _mm256_add_epi32(msum0, _mm256_madd_epi16(diff, diff));
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    __m128i msum = _mm_add_epi32(_mm256_castsi256_si128(_mm256_add_epi32(msum0, msum1)),
+                                 _mm256_extracti128_si256(_mm256_add_epi32(msum0, msum1), 1));
+    msum = _mm_hadd_epi32(msum, msum);
+    msum = _mm_hadd_epi32(msum, msum);
+    int32_t res = _mm_cvtsi128_si32(msum);
+    for (size_t i = 0; i < d; i++) {
+        const int32_t tmp = int32_t(x[i]) - int32_t(y[i]);
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+int32_t
+u8_vec_inner_product_avx(const uint8_t* x, const uint8_t* y, size_t d) {
+    __m256i msum0 = _mm256_setzero_si256();
+    __m256i msum1 = _mm256_setzero_si256();
+    while (d >= 32) {
+        msum0 = _mm256_add_epi32(msum0, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)x)),
+                                                          _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)y))));
+        msum1 = _mm256_add_epi32(
+            msum1, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(x + 16))),
+                                     _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + 16)))));
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d >= 16) {
+        msum0 = _mm256_add_epi32(msum0, _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)x)),
+                                                          _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)y))));
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    __m128i msum = _mm_add_epi32(_mm256_castsi256_si128(_mm256_add_epi32(msum0, msum1)),
+                                 _mm256_extracti128_si256(_mm256_add_epi32(msum0, msum1), 1));
+    msum = _mm_hadd_epi32(msum, msum);
+    msum = _mm_hadd_epi32(msum, msum);
+    int32_t res = _mm_cvtsi128_si32(msum);
+    for (size_t i = 0; i < d; i++) {
+        res += int32_t(x[i]) * int32_t(y[i]);
+    }
+    return res;
+}
+
+namespace {
+
+// bit count of each 64-bit lane, same nibble lookup as bitset_popcount_avx
+inline __m256i
+popcount_epi64(__m256i v) {
+    const __m256i lookup =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+    const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+inline int64_t
+reduce_add_epi64(__m256i v) {
+    return _mm256_extract_epi64(v, 0) + _mm256_extract_epi64(v, 1) + _mm256_extract_epi64(v, 2) +
+           _mm256_extract_epi64(v, 3);
+}
+
+// lane k of the result is the sum of the 4 64-bit lanes of v[k]
+inline __m256i
+reduce_add4_epi64(const __m256i* v) {
+    const __m256i pair0 = _mm256_add_epi64(_mm256_unpacklo_epi64(v[0], v[1]), _mm256_unpackhi_epi64(v[0], v[1]));
+    const __m256i pair1 = _mm256_add_epi64(_mm256_unpacklo_epi64(v[2], v[3]), _mm256_unpackhi_epi64(v[2], v[3]));
+    return _mm256_add_epi64(_mm256_permute2x128_si256(pair0, pair1, 0x20),
+                            _mm256_permute2x128_si256(pair0, pair1, 0x31));
+}
+
+inline int32_t
+bin_hamming(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        const __m256i vy = _mm256_loadu_si256((const __m256i*)(y + i));
+        acc = _mm256_add_epi64(acc, popcount_epi64(_mm256_xor_si256(vx, vy)));
+    }
+    return reduce_add_epi64(acc) + bin_vec_hamming_sse(x + i, y + i, code_size - i);
+}
+
+inline float
+bin_jaccard(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i acc_num = _mm256_setzero_si256();
+    __m256i acc_den = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const __m256i vx = _mm256_loadu_si256((const __m256i*)(x + i));
+        const __m256i vy = _mm256_loadu_si256((const __m256i*)(y + i));
+        acc_num = _mm256_add_epi64(acc_num, popcount_epi64(_mm256_and_si256(vx, vy)));
+        acc_den = _mm256_add_epi64(acc_den, popcount_epi64(_mm256_or_si256(vx, vy)));
+    }
+    int64_t num = reduce_add_epi64(acc_num);
+    int64_t den = reduce_add_epi64(acc_den);
+    for (; i < code_size; i++) {
+        num += _mm_popcnt_u32(x[i] & y[i]);
+        den += _mm_popcnt_u32(x[i] | y[i]);
+    }
+    return den == 0 ? 1.0f : float(den - num) / float(den);
+}
+
+}  // namespace
+
+int32_t
+bin_vec_hamming_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_hamming(x, y, code_size);
+}
+
+float
+bin_vec_jaccard_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_jaccard(x, y, code_size);
+}
+
+// one query against 4 codes at a time, every 32 bytes of the query are loaded once for 4 independent counts
+void
+bin_vec_hamming_ny_avx(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        __m256i acc[4];
+        for (size_t k = 0; k < 4; k++) {
+            acc[k] = _mm256_setzero_si256();
+        }
+        size_t j = 0;
+        for (; j + 32 <= code_size; j += 32) {
+            const __m256i vx = _mm256_loadu_si256((const __m256i*)(x + j));
+            for (size_t k = 0; k < 4; k++) {
+                const __m256i vy = _mm256_loadu_si256((const __m256i*)(yi + k * code_size + j));
+                acc[k] = _mm256_add_epi64(acc[k], popcount_epi64(_mm256_xor_si256(vx, vy)));
+            }
+        }
+        alignas(32) int64_t res[4];
+        _mm256_store_si256((__m256i*)res, reduce_add4_epi64(acc));
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = j < code_size ? res[k] + bin_vec_hamming_sse(x + j, yi + k * code_size + j, code_size - j)
+                                       : res[k];
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_hamming(x, y + i * code_size, code_size);
+    }
+}
+
+void
+bin_vec_jaccard_ny_avx(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        __m256i acc_num[4];
+        __m256i acc_den[4];
+        for (size_t k = 0; k < 4; k++) {
+            acc_num[k] = _mm256_setzero_si256();
+            acc_den[k] = _mm256_setzero_si256();
+        }
+        size_t j = 0;
+        for (; j + 32 <= code_size; j += 32) {
+            const __m256i vx = _mm256_loadu_si256((const __m256i*)(x + j));
+            for (size_t k = 0; k < 4; k++) {
+                const __m256i vy = _mm256_loadu_si256((const __m256i*)(yi + k * code_size + j));
+                acc_num[k] = _mm256_add_epi64(acc_num[k], popcount_epi64(_mm256_and_si256(vx, vy)));
+                acc_den[k] = _mm256_add_epi64(acc_den[k], popcount_epi64(_mm256_or_si256(vx, vy)));
+            }
+        }
+        alignas(32) int64_t num[4];
+        alignas(32) int64_t den[4];
+        _mm256_store_si256((__m256i*)num, reduce_add4_epi64(acc_num));
+        _mm256_store_si256((__m256i*)den, reduce_add4_epi64(acc_den));
+        for (; j < code_size; j++) {
+            for (size_t k = 0; k < 4; k++) {
+                num[k] += _mm_popcnt_u32(x[j] & yi[k * code_size + j]);
+                den[k] += _mm_popcnt_u32(x[j] | yi[k * code_size + j]);
+            }
+        }
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = den[k] == 0 ? 1.0f : float(den[k] - num[k]) / float(den[k]);
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_jaccard(x, y + i * code_size, code_size);
+    }
+}
+
 }  // namespace faiss
 #endif
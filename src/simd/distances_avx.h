@@ -33,6 +33,63 @@ fvec_L1_avx(const float* x, const float* y, size_t d);
 float
 fvec_Linf_avx(const float* x, const float* y, size_t d);
 
+float
+fvec_norm_L2sqr_avx(const float* x, size_t d);
+
+void
+fvec_L2sqr_ny_avx(float* dis, const float* x, const float* y, size_t d, size_t ny);
+
+void
+fvec_inner_products_ny_avx(float* ip, const float* x, const float* y, size_t d, size_t ny);
+
+void
+fvec_madd_avx(size_t n, const float* a, float bf, const float* b, float* c);
+
+int
+fvec_madd_and_argmin_avx(size_t n, const float* a, float bf, const float* b, float* c);
+
+size_t
+bitset_popcount_avx(const uint8_t* data, size_t num_bits);
+
+size_t
+bitset_to_ids_avx(const uint8_t* data, size_t num_bits, bool value, int64_t* ids);
+
+float
+fp16_vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+fp16_vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_avx(const uint16_t* x, size_t d);
+
+float
+bf16_vec_L2sqr_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+bf16_vec_inner_product_avx(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_avx(const uint16_t* x, size_t d);
+
+int32_t
+u8_vec_L2sqr_avx(const uint8_t* x, const uint8_t* y, size_t d);
+
+int32_t
+u8_vec_inner_product_avx(const uint8_t* x, const uint8_t* y, size_t d);
+
+int32_t
+bin_vec_hamming_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+float
+bin_vec_jaccard_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+void
+bin_vec_hamming_ny_avx(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
+void
+bin_vec_jaccard_ny_avx(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_AVX_H */
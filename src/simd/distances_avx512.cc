@@ -14,10 +14,14 @@
 
 #include <immintrin.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <string>
 
+#include "distances_sse.h"
+
 namespace faiss {
 
 // reads 0 <= d < 4 floats as __m128
@@ -249,6 +253,729 @@ fvec_Linf_avx512(const float* x, const float* y, size_t d) {
     return _mm_cvtss_f32(msum2);
 }
 
+float
+fvec_norm_L2sqr_avx512(const float* x, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+
+    while (d >= 32) {
+        __m512 mx0 = _mm512_loadu_ps(x);
+        __m512 mx1 = _mm512_loadu_ps(x + 16);
+        x += 32;
+        msum0 = _mm512_fmadd_ps(mx0, mx0, msum0);
+        msum1 = _mm512_fmadd_ps(mx1, mx1, msum1);
+        d -= 32;
+    }
+    msum0 += msum1;
+
+    while (d >= 16) {
+        __m512 mx = _mm512_loadu_ps(x);
+        x += 16;
+        msum0 = _mm512_fmadd_ps(mx, mx, msum0);
+        d -= 16;
+    }
+
+    if (d > 0) {
+        __m512 mx = _mm512_maskz_loadu_ps((1 << d) - 1, x);
+        msum0 = _mm512_fmadd_ps(mx, mx, msum0);
+    }
+
+    return _mm512_reduce_add_ps(msum0);
+}
+
+namespace {
+
+struct ElementOpL2 {
+    static __m512
+    op(__m512 x, __m512 y, __m512 acc) {
+        __m512 tmp = x - y;
+        return _mm512_fmadd_ps(tmp, tmp, acc);
+    }
+};
+
+struct ElementOpIP {
+    static __m512
+    op(__m512 x, __m512 y, __m512 acc) {
+        return _mm512_fmadd_ps(x, y, acc);
+    }
+};
+
+// lane i of the result is the horizontal sum of acc[i]
+inline __m256
+horizontal_add8(const __m512* acc) {
+    __m256 h[8];
+    for (int k = 0; k < 8; k++) {
+        h[k] = _mm512_castps512_ps256(acc[k]) + _mm512_extractf32x8_ps(acc[k], 1);
+    }
+    __m256 sum0123 = _mm256_hadd_ps(_mm256_hadd_ps(h[0], h[1]), _mm256_hadd_ps(h[2], h[3]));
+    __m256 sum4567 = _mm256_hadd_ps(_mm256_hadd_ps(h[4], h[5]), _mm256_hadd_ps(h[6], h[7]));
+    return _mm256_permute2f128_ps(sum0123, sum4567, 0x20) + _mm256_permute2f128_ps(sum0123, sum4567, 0x31);
+}
+
+// Compares x with BLOCK vectors of y per pass, so every load of x is shared by all of them, and the remainder of
+// the dimension is done with masked loads. DIM is a compile time dimension that lets the compiler unroll the inner
+// loop, 0 means d.
+template <class ElementOp, size_t DIM, size_t BLOCK>
+inline void
+fvec_op_ny_block(float* dis, const float* x, const float* y, size_t d) {
+    const size_t dim = DIM > 0 ? DIM : d;
+    const size_t dim16 = dim & ~size_t(15);
+
+    __m512 acc[8];
+    for (size_t k = 0; k < 8; k++) {
+        acc[k] = _mm512_setzero_ps();
+    }
+    for (size_t j = 0; j < dim16; j += 16) {
+        const __m512 mx = _mm512_loadu_ps(x + j);
+        for (size_t k = 0; k < BLOCK; k++) {
+            acc[k] = ElementOp::op(mx, _mm512_loadu_ps(y + k * dim + j), acc[k]);
+        }
+    }
+    if (dim16 < dim) {
+        const __mmask16 mask = (1 << (dim - dim16)) - 1;
+        const __m512 mx = _mm512_maskz_loadu_ps(mask, x + dim16);
+        for (size_t k = 0; k < BLOCK; k++) {
+            acc[k] = ElementOp::op(mx, _mm512_maskz_loadu_ps(mask, y + k * dim + dim16), acc[k]);
+        }
+    }
+    if (BLOCK == 8) {
+        _mm256_storeu_ps(dis, horizontal_add8(acc));
+    } else {
+        for (size_t k = 0; k < BLOCK; k++) {
+            dis[k] = _mm512_reduce_add_ps(acc[k]);
+        }
+    }
+}
+
+template <class ElementOp, size_t DIM>
+void
+fvec_op_ny_blocked(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    const size_t dim = DIM > 0 ? DIM : d;
+    size_t i = 0;
+    for (; i + 8 <= ny; i += 8) {
+        fvec_op_ny_block<ElementOp, DIM, 8>(dis + i, x, y + i * dim, d);
+    }
+    for (; i < ny; i++) {
+        fvec_op_ny_block<ElementOp, DIM, 1>(dis + i, x, y + i * dim, d);
+    }
+}
+
+}  // anonymous namespace
+
+void
+fvec_L2sqr_ny_avx512(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+#define DISPATCH(dval)                                           \
+    case dval:                                                   \
+        fvec_op_ny_blocked<ElementOpL2, dval>(dis, x, y, d, ny); \
+        return;
+
+    switch (d) {
+        DISPATCH(96)
+        DISPATCH(128)
+        DISPATCH(256)
+        DISPATCH(384)
+        DISPATCH(768)
+        DISPATCH(1024)
+        // the sse kernels have special cases for the tiny dimensions of pq sub-quantizers
+        case 1:
+        case 2:
+        case 4:
+        case 12:
+            fvec_L2sqr_ny_sse(dis, x, y, d, ny);
+            return;
+        default:
+            fvec_op_ny_blocked<ElementOpL2, 0>(dis, x, y, d, ny);
+            return;
+    }
+#undef DISPATCH
+}
+
+void
+fvec_inner_products_ny_avx512(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+#define DISPATCH(dval)                                           \
+    case dval:                                                   \
+        fvec_op_ny_blocked<ElementOpIP, dval>(dis, x, y, d, ny); \
+        return;
+
+    switch (d) {
+        DISPATCH(96)
+        DISPATCH(128)
+        DISPATCH(256)
+        DISPATCH(384)
+        DISPATCH(768)
+        DISPATCH(1024)
+        case 1:
+        case 2:
+        case 4:
+        case 12:
+            fvec_inner_products_ny_sse(dis, x, y, d, ny);
+            return;
+        default:
+            fvec_op_ny_blocked<ElementOpIP, 0>(dis, x, y, d, ny);
+            return;
+    }
+#undef DISPATCH
+}
+
+// unlike the sse versions, these do not need aligned inputs or n % 4 == 0
+void
+fvec_madd_avx512(size_t n, const float* a, float bf, const float* b, float* c) {
+    const __m512 bf16 = _mm512_set1_ps(bf);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(c + i, _mm512_fmadd_ps(bf16, _mm512_loadu_ps(b + i), _mm512_loadu_ps(a + i)));
+    }
+    if (i < n) {
+        const __mmask16 mask = (1 << (n - i)) - 1;
+        __m512 vc16 = _mm512_fmadd_ps(bf16, _mm512_maskz_loadu_ps(mask, b + i), _mm512_maskz_loadu_ps(mask, a + i));
+        _mm512_mask_storeu_ps(c + i, mask, vc16);
+    }
+}
+
+int
+fvec_madd_and_argmin_avx512(size_t n, const float* a, float bf, const float* b, float* c) {
+    const __m512 bf16 = _mm512_set1_ps(bf);
+    __m512 vmin16 = _mm512_set1_ps(1e20);
+    __m512i imin16 = _mm512_set1_epi32(-1);
+    __m512i idx16 = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i inc16 = _mm512_set1_epi32(16);
+
+    for (size_t i = 0; i < n; i += 16) {
+        const __mmask16 mask = n - i >= 16 ? 0xffff : (1 << (n - i)) - 1;
+        __m512 vc16 = _mm512_fmadd_ps(bf16, _mm512_maskz_loadu_ps(mask, b + i), _mm512_maskz_loadu_ps(mask, a + i));
+        _mm512_mask_storeu_ps(c + i, mask, vc16);
+        // strict comparison, each lane keeps its first minimum
+        const __mmask16 lt = _mm512_mask_cmp_ps_mask(mask, vc16, vmin16, _CMP_LT_OQ);
+        imin16 = _mm512_mask_blend_epi32(lt, imin16, idx16);
+        vmin16 = _mm512_mask_blend_ps(lt, vmin16, vc16);
+        idx16 = _mm512_add_epi32(idx16, inc16);
+    }
+
+    __attribute__((__aligned__(64))) float vmins[16];
+    __attribute__((__aligned__(64))) int imins[16];
+    _mm512_store_ps(vmins, vmin16);
+    _mm512_store_si512(imins, imin16);
+    float vmin = 1e20;
+    int imin = -1;
+    for (int j = 0; j < 16; j++) {
+        if (imins[j] >= 0 && (vmins[j] < vmin || (vmins[j] == vmin && imins[j] < imin))) {
+            vmin = vmins[j];
+            imin = imins[j];
+        }
+    }
+    return imin;
+}
+
+// VPOPCNTQ needs AVX512_VPOPCNTDQ, which is not part of the baseline, so the nibble lookup of the AVX2 kernel is
+// widened to 512 bits with AVX512BW
+size_t
+bitset_popcount_avx512(const uint8_t* data, size_t num_bits) {
+    const size_t nblock = num_bits / 512;
+    const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < nblock; i++) {
+        const __m512i v = _mm512_loadu_si512((const void*)(data + i * 64));
+        const __m512i lo = _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, low_mask));
+        const __m512i hi = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask));
+        acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512()));
+    }
+    return _mm512_reduce_add_epi64(acc) + bitset_popcount_sse(data + nblock * 64, num_bits - nblock * 512);
+}
+
+size_t
+bitset_to_ids_avx512(const uint8_t* data, size_t num_bits, bool value, int64_t* ids) {
+    const size_t nblock = num_bits / 512;
+    const __m512i ones = _mm512_set1_epi64(-1);
+    size_t n = 0;
+    for (size_t i = 0; i < nblock; i++) {
+        const __m512i v = _mm512_loadu_si512((const void*)(data + i * 64));
+        // one mask bit per 64-bit word that holds at least one match
+        __mmask8 words = value ? _mm512_test_epi64_mask(v, v) : _mm512_cmpneq_epi64_mask(v, ones);
+        while (words != 0) {
+            const size_t w = __builtin_ctz(words);
+            words &= words - 1;
+            uint64_t word;
+            memcpy(&word, data + i * 64 + w * 8, 8);
+            if (!value) {
+                word = ~word;
+            }
+            while (word != 0) {
+                ids[n++] = i * 512 + w * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+            }
+        }
+    }
+    const size_t tail = bitset_to_ids_sse(data + nblock * 64, num_bits - nblock * 512, value, ids + n);
+    for (size_t j = n; j < n + tail; j++) {
+        ids[j] += nblock * 512;
+    }
+    return n + tail;
+}
+
+namespace {
+
+// fp16 and bf16 components widened to 16 floats, the masked loads zero the components past the mask
+struct Fp16Avx512 {
+    static __m512
+    load16(const uint16_t* x) {
+        return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)x));
+    }
+
+    static __m512
+    load16(const uint16_t* x, __mmask32 mask) {
+        return _mm512_cvtph_ps(_mm512_castsi512_si256(_mm512_maskz_loadu_epi16(mask, x)));
+    }
+};
+
+struct Bf16Avx512 {
+    static __m512
+    load16(const uint16_t* x) {
+        return widen(_mm256_loadu_si256((const __m256i*)x));
+    }
+
+    static __m512
+    load16(const uint16_t* x, __mmask32 mask) {
+        return widen(_mm512_castsi512_si256(_mm512_maskz_loadu_epi16(mask, x)));
+    }
+
+    static __m512
+    widen(__m256i x) {
+        return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(x), 16));
+    }
+};
+
+template <class Half>
+float
+half_L2sqr(const uint16_t* x, const uint16_t* y, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+    while (d >= 32) {
+        __m512 diff0 = _mm512_sub_ps(Half::load16(x), Half::load16(y));
+        __m512 diff1 = _mm512_sub_ps(Half::load16(x + 16), Half::load16(y + 16));
+        msum0 = _mm512_fmadd_ps(diff0, diff0, msum0);
+        msum1 = _mm512_fmadd_ps(diff1, diff1, msum1);
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d >= 16) {
+        __m512 diff = _mm512_sub_ps(Half::load16(x), Half::load16(y));
+        msum0 = _mm512_fmadd_ps(diff, diff, msum0);
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    if (d > 0) {
+        const __mmask32 mask = (1U << d) - 1U;
+        __m512 diff = _mm512_sub_ps(Half::load16(x, mask), Half::load16(y, mask));
+        msum1 = _mm512_fmadd_ps(diff, diff, msum1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(msum0, msum1));
+}
+
+template <class Half>
+float
+half_inner_product(const uint16_t* x, const uint16_t* y, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+    while (d >= 32) {
+        msum0 = _mm512_fmadd_ps(Half::load16(x), Half::load16(y), msum0);
+        msum1 = _mm512_fmadd_ps(Half::load16(x + 16), Half::load16(y + 16), msum1);
+        x += 32;
+        y += 32;
+        d -= 32;
+    }
+    if (d >= 16) {
+        msum0 = _mm512_fmadd_ps(Half::load16(x), Half::load16(y), msum0);
+        x += 16;
+        y += 16;
+        d -= 16;
+    }
+    if (d > 0) {
+        const __mmask32 mask = (1U << d) - 1U;
+        msum1 = _mm512_fmadd_ps(Half::load16(x, mask), Half::load16(y, mask), msum1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(msum0, msum1));
+}
+
+template <class Half>
+float
+half_norm_L2sqr(const uint16_t* x, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+    while (d >= 32) {
+        __m512 mx0 = Half::load16(x);
+        __m512 mx1 = Half::load16(x + 16);
+        msum0 = _mm512_fmadd_ps(mx0, mx0, msum0);
+        msum1 = _mm512_fmadd_ps(mx1, mx1, msum1);
+        x += 32;
+        d -= 32;
+    }
+    if (d >= 16) {
+        __m512 mx = Half::load16(x);
+        msum0 = _mm512_fmadd_ps(mx, mx, msum0);
+        x += 16;
+        d -= 16;
+    }
+    if (d > 0) {
+        __m512 mx = Half::load16(x, (1U << d) - 1U);
+        msum1 = _mm512_fmadd_ps(mx, mx, msum1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(msum0, msum1));
+}
+
+}  // namespace
+
+float
+fp16_vec_L2sqr_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<Fp16Avx512>(x, y, d);
+}
+
+float
+fp16_vec_inner_product_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<Fp16Avx512>(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx512(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<Fp16Avx512>(x, d);
+}
+
+float
+bf16_vec_L2sqr_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<Bf16Avx512>(x, y, d);
+}
+
+float
+bf16_vec_inner_product_avx512(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<Bf16Avx512>(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx512(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<Bf16Avx512>(x, d);
+}
+
+// vdpbf16ps multiplies pairs of bf16 components exactly and adds them to float lanes, 32 components per
+// instruction without widening. The file is not built for AVX512_BF16, so only these functions target it.
+__attribute__((target("avx512bf16"))) float
+bf16_vec_inner_product_avx512bf16(const uint16_t* x, const uint16_t* y, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+    while (d >= 64) {
+        msum0 = _mm512_dpbf16_ps(msum0, (__m512bh)_mm512_loadu_si512(x), (__m512bh)_mm512_loadu_si512(y));
+        msum1 = _mm512_dpbf16_ps(msum1, (__m512bh)_mm512_loadu_si512(x + 32), (__m512bh)_mm512_loadu_si512(y + 32));
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    while (d > 0) {
+        const __mmask32 mask = d >= 32 ? ~__mmask32(0) : (1U << d) - 1U;
+        msum0 = _mm512_dpbf16_ps(msum0, (__m512bh)_mm512_maskz_loadu_epi16(mask, x),
+                                 (__m512bh)_mm512_maskz_loadu_epi16(mask, y));
+        x += 32;
+        y += 32;
+        d -= std::min<size_t>(d, 32);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(msum0, msum1));
+}
+
+__attribute__((target("avx512bf16"))) float
+bf16_vec_norm_L2sqr_avx512bf16(const uint16_t* x, size_t d) {
+    __m512 msum0 = _mm512_setzero_ps();
+    __m512 msum1 = _mm512_setzero_ps();
+    while (d >= 64) {
+        __m512bh mx0 = (__m512bh)_mm512_loadu_si512(x);
+        __m512bh mx1 = (__m512bh)_mm512_loadu_si512(x + 32);
+        msum0 = _mm512_dpbf16_ps(msum0, mx0, mx0);
+        msum1 = _mm512_dpbf16_ps(msum1, mx1, mx1);
+        x += 64;
+        d -= 64;
+    }
+    while (d > 0) {
+        const __mmask32 mask = d >= 32 ? ~__mmask32(0) : (1U << d) - 1U;
+        __m512bh mx = (__m512bh)_mm512_maskz_loadu_epi16(mask, x);
+        msum0 = _mm512_dpbf16_ps(msum0, mx, mx);
+        x += 32;
+        d -= std::min<size_t>(d, 32);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(msum0, msum1));
+}
+
+namespace {
+
+// 32 codes widened to 16 bits, the missing ones of the tail read as 0
+inline __m512i
+u8_load32(const uint8_t* x, size_t d) {
+    const __mmask64 mask = d >= 32 ? __mmask64(0xffffffff) : (__mmask64(1) << d) - 1;
+    return _mm512_cvtepu8_epi16(_mm512_castsi512_si256(_mm512_maskz_loadu_epi8(mask, x)));
+}
+
+// Sums the products of pairs of 16-bit components into 32-bit lanes: vpmaddwd and an add, or a single vpdpwssd.
+// vpdpbusd would take 64 codes at once but multiplies unsigned by signed bytes, which uint8 codes are not.
+struct MaddAvx512 {
+    static __m512i
+    madd(__m512i acc, __m512i x, __m512i y) {
+        return _mm512_add_epi32(acc, _mm512_madd_epi16(x, y));
+    }
+};
+
+struct MaddAvx512Vnni {
+    __attribute__((target("avx512vnni"))) static __m512i
+    madd(__m512i acc, __m512i x, __m512i y) {
+        return _mm512_dpwssd_epi32(acc, x, y);
+    }
+};
+
+template <class Madd>
+inline int32_t
+u8_L2sqr(const uint8_t* x, const uint8_t* y, size_t d) {
+    __m512i msum0 = _mm512_setzero_si512();
+    __m512i msum1 = _mm512_setzero_si512();
+    while (d >= 64) {
+        __m512i diff0 = _mm512_sub_epi16(u8_load32(x, 32), u8_load32(y, 32));
+        __m512i diff1 = _mm512_sub_epi16(u8_load32(x + 32, 32), u8_load32(y + 32, 32));
+        msum0 = Madd::madd(msum0, diff0, diff0);
+        msum1 = Madd::madd(msum1, diff1, diff1);
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    while (d > 0) {
+        __m512i diff = _mm512_sub_epi16(u8_load32(x, d), u8_load32(y, d));
+        msum0 = Madd::madd(msum0, diff, diff);
+        x += 32;
+        y += 32;
+        d -= std::min<size_t>(d, 32);
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(msum0, msum1));
+}
+
+template <class Madd>
+inline int32_t
+u8_inner_product(const uint8_t* x, const uint8_t* y, size_t d) {
+    __m512i msum0 = _mm512_setzero_si512();
+    __m512i msum1 = _mm512_setzero_si512();
+    while (d >= 64) {
+        msum0 = Madd::madd(msum0, u8_load32(x, 32), u8_load32(y, 32));
+        msum1 = Madd::madd(msum1, u8_load32(x + 32, 32), u8_load32(y + 32, 32));
+        x += 64;
+        y += 64;
+        d -= 64;
+    }
+    while (d > 0) {
+        msum0 = Madd::madd(msum0, u8_load32(x, d), u8_load32(y, d));
+        x += 32;
+        y += 32;
+        d -= std::min<size_t>(d, 32);
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(msum0, msum1));
+}
+
+}  // namespace
+
+int32_t
+u8_vec_L2sqr_avx512(const uint8_t* x, const uint8_t* y, size_t d) {
+    return u8_L2sqr<MaddAvx512>(x, y, d);
+}
+
+int32_t
+u8_vec_inner_product_avx512(const uint8_t* x, const uint8_t* y, size_t d) {
+    return u8_inner_product<MaddAvx512>(x, y, d);
+}
+
+// flatten pulls the kernel and Madd::madd into this function, the one compiled with avx512vnni; on its own the
+// template is built for the plain avx512 target, which cannot inline madd and would call it for every 32 codes.
+__attribute__((target("avx512vnni"), flatten)) int32_t
+u8_vec_L2sqr_avx512vnni(const uint8_t* x, const uint8_t* y, size_t d) {
+    return u8_L2sqr<MaddAvx512Vnni>(x, y, d);
+}
+
+__attribute__((target("avx512vnni"), flatten)) int32_t
+u8_vec_inner_product_avx512vnni(const uint8_t* x, const uint8_t* y, size_t d) {
+    return u8_inner_product<MaddAvx512Vnni>(x, y, d);
+}
+
+namespace {
+
+// 64 bytes of a binary code, the missing ones of the tail read as 0
+inline __m512i
+bin_load64(const uint8_t* x, size_t code_size) {
+    const __mmask64 mask = code_size >= 64 ? ~__mmask64(0) : (__mmask64(1) << code_size) - 1;
+    return _mm512_maskz_loadu_epi8(mask, x);
+}
+
+// Counts the set bits of each 64-bit lane: a nibble lookup with vpshufb and vpsadbw, or a single vpopcntq.
+struct PopcntAvx512 {
+    static __m512i
+    popcount(__m512i v) {
+        const __m512i lookup = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+        const __m512i low_mask = _mm512_set1_epi8(0x0f);
+        const __m512i lo = _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, low_mask));
+        const __m512i hi = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask));
+        return _mm512_sad_epu8(_mm512_add_epi8(lo, hi), _mm512_setzero_si512());
+    }
+};
+
+struct PopcntAvx512Vpopcntdq {
+    __attribute__((target("avx512vpopcntdq"))) static __m512i
+    popcount(__m512i v) {
+        return _mm512_popcnt_epi64(v);
+    }
+};
+
+template <class Popcnt>
+inline int32_t
+bin_hamming(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i acc = _mm512_setzero_si512();
+    while (code_size > 0) {
+        const __m512i v = _mm512_xor_si512(bin_load64(x, code_size), bin_load64(y, code_size));
+        acc = _mm512_add_epi64(acc, Popcnt::popcount(v));
+        x += 64;
+        y += 64;
+        code_size -= std::min<size_t>(code_size, 64);
+    }
+    return _mm512_reduce_add_epi64(acc);
+}
+
+template <class Popcnt>
+inline float
+bin_jaccard(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i acc_num = _mm512_setzero_si512();
+    __m512i acc_den = _mm512_setzero_si512();
+    while (code_size > 0) {
+        const __m512i vx = bin_load64(x, code_size);
+        const __m512i vy = bin_load64(y, code_size);
+        acc_num = _mm512_add_epi64(acc_num, Popcnt::popcount(_mm512_and_si512(vx, vy)));
+        acc_den = _mm512_add_epi64(acc_den, Popcnt::popcount(_mm512_or_si512(vx, vy)));
+        x += 64;
+        y += 64;
+        code_size -= std::min<size_t>(code_size, 64);
+    }
+    const int64_t num = _mm512_reduce_add_epi64(acc_num);
+    const int64_t den = _mm512_reduce_add_epi64(acc_den);
+    return den == 0 ? 1.0f : float(den - num) / float(den);
+}
+
+// Lane k of the result is the sum of the 8 64-bit lanes of v[k].
+inline __m512i
+reduce_add8_epi64(const __m512i* v) {
+    __m512i pairs[4];
+    for (size_t k = 0; k < 4; k++) {
+        // each 128-bit lane holds the partial sums of v[2k] and v[2k + 1] over it
+        pairs[k] = _mm512_add_epi64(_mm512_unpacklo_epi64(v[2 * k], v[2 * k + 1]),
+                                    _mm512_unpackhi_epi64(v[2 * k], v[2 * k + 1]));
+    }
+    const __m512i quads0 = _mm512_add_epi64(_mm512_shuffle_i64x2(pairs[0], pairs[1], 0x88),
+                                            _mm512_shuffle_i64x2(pairs[0], pairs[1], 0xdd));
+    const __m512i quads1 = _mm512_add_epi64(_mm512_shuffle_i64x2(pairs[2], pairs[3], 0x88),
+                                            _mm512_shuffle_i64x2(pairs[2], pairs[3], 0xdd));
+    return _mm512_add_epi64(_mm512_shuffle_i64x2(quads0, quads1, 0x88), _mm512_shuffle_i64x2(quads0, quads1, 0xdd));
+}
+
+// One query against 8 codes at a time: every 64-byte block of the query is loaded once for the 8 codes, whose
+// counts are 8 independent chains, and the 8 distances are reduced and stored together.
+template <class Popcnt>
+inline void
+bin_hamming_ny(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 8 <= ny; i += 8) {
+        const uint8_t* yi = y + i * code_size;
+        __m512i acc[8];
+        for (size_t k = 0; k < 8; k++) {
+            acc[k] = _mm512_setzero_si512();
+        }
+        for (size_t j = 0; j < code_size; j += 64) {
+            const __m512i vx = bin_load64(x + j, code_size - j);
+            for (size_t k = 0; k < 8; k++) {
+                const __m512i vy = bin_load64(yi + k * code_size + j, code_size - j);
+                acc[k] = _mm512_add_epi64(acc[k], Popcnt::popcount(_mm512_xor_si512(vx, vy)));
+            }
+        }
+        _mm256_storeu_si256((__m256i*)(dis + i), _mm512_cvtepi64_epi32(reduce_add8_epi64(acc)));
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_hamming<Popcnt>(x, y + i * code_size, code_size);
+    }
+}
+
+template <class Popcnt>
+inline void
+bin_jaccard_ny(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 8 <= ny; i += 8) {
+        const uint8_t* yi = y + i * code_size;
+        __m512i acc_num[8];
+        __m512i acc_den[8];
+        for (size_t k = 0; k < 8; k++) {
+            acc_num[k] = _mm512_setzero_si512();
+            acc_den[k] = _mm512_setzero_si512();
+        }
+        for (size_t j = 0; j < code_size; j += 64) {
+            const __m512i vx = bin_load64(x + j, code_size - j);
+            for (size_t k = 0; k < 8; k++) {
+                const __m512i vy = bin_load64(yi + k * code_size + j, code_size - j);
+                acc_num[k] = _mm512_add_epi64(acc_num[k], Popcnt::popcount(_mm512_and_si512(vx, vy)));
+                acc_den[k] = _mm512_add_epi64(acc_den[k], Popcnt::popcount(_mm512_or_si512(vx, vy)));
+            }
+        }
+        const __m512i num = reduce_add8_epi64(acc_num);
+        const __m512i den = reduce_add8_epi64(acc_den);
+        const __m256 fden = _mm512_cvtepi64_ps(den);
+        const __m256 res = _mm256_div_ps(_mm512_cvtepi64_ps(_mm512_sub_epi64(den, num)), fden);
+        // a pair with no set bit at all is at distance 1, as in bin_jaccard
+        const __m256 empty = _mm256_cmp_ps(fden, _mm256_setzero_ps(), _CMP_EQ_OQ);
+        _mm256_storeu_ps(dis + i, _mm256_blendv_ps(res, _mm256_set1_ps(1.0f), empty));
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_jaccard<Popcnt>(x, y + i * code_size, code_size);
+    }
+}
+
+}  // namespace
+
+int32_t
+bin_vec_hamming_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_hamming<PopcntAvx512>(x, y, code_size);
+}
+
+float
+bin_vec_jaccard_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_jaccard<PopcntAvx512>(x, y, code_size);
+}
+
+void
+bin_vec_hamming_ny_avx512(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    bin_hamming_ny<PopcntAvx512>(dis, x, y, code_size, ny);
+}
+
+void
+bin_vec_jaccard_ny_avx512(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    bin_jaccard_ny<PopcntAvx512>(dis, x, y, code_size, ny);
+}
+
+// flatten for the same reason as the VNNI kernels: vpopcntq is only inlined where the target allows it
+__attribute__((target("avx512vpopcntdq"), flatten)) int32_t
+bin_vec_hamming_avx512vpopcntdq(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_hamming<PopcntAvx512Vpopcntdq>(x, y, code_size);
+}
+
+__attribute__((target("avx512vpopcntdq"), flatten)) float
+bin_vec_jaccard_avx512vpopcntdq(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bin_jaccard<PopcntAvx512Vpopcntdq>(x, y, code_size);
+}
+
+__attribute__((target("avx512vpopcntdq"), flatten)) void
+bin_vec_hamming_ny_avx512vpopcntdq(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    bin_hamming_ny<PopcntAvx512Vpopcntdq>(dis, x, y, code_size, ny);
+}
+
+__attribute__((target("avx512vpopcntdq"), flatten)) void
+bin_vec_jaccard_ny_avx512vpopcntdq(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    bin_jaccard_ny<PopcntAvx512Vpopcntdq>(dis, x, y, code_size, ny);
+}
+
 }  // namespace faiss
 
 #endif
@@ -10,6 +10,9 @@
 #include "distances_ref.h"
 
 #include <cmath>
+#include <cstring>
+
+#include "fp16.h"
 namespace faiss {
 
 float
@@ -96,4 +99,225 @@ fvec_madd_and_argmin_ref(size_t n, const float* a, float bf, const float* b, flo
     return imin;
 }
 
+namespace {
+
+// 64-bit word w of the bitset, the bits past num_bits are cleared
+inline uint64_t
+bitset_word(const uint8_t* data, size_t num_bits, size_t w) {
+    uint64_t word = 0;
+    const size_t rest = num_bits - w * 64;
+    if (rest >= 64) {
+        memcpy(&word, data + w * 8, 8);
+        return word;
+    }
+    memcpy(&word, data + w * 8, (rest + 7) / 8);
+    return word & ((uint64_t(1) << rest) - 1);
+}
+
+}  // namespace
+
+size_t
+bitset_popcount_ref(const uint8_t* data, size_t num_bits) {
+    size_t ret = 0;
+    for (size_t w = 0; w * 64 < num_bits; w++) {
+        ret += __builtin_popcountll(bitset_word(data, num_bits, w));
+    }
+    return ret;
+}
+
+size_t
+bitset_to_ids_ref(const uint8_t* data, size_t num_bits, bool value, int64_t* ids) {
+    size_t n = 0;
+    for (size_t i = 0; i < num_bits; i++) {
+        if (((data[i >> 3] >> (i & 7)) & 1) == value) {
+            ids[n++] = i;
+        }
+    }
+    return n;
+}
+
+namespace {
+
+template <float (*to_fp32)(uint16_t)>
+inline float
+half_L2sqr(const uint16_t* x, const uint16_t* y, size_t d) {
+    float res = 0;
+    for (size_t i = 0; i < d; i++) {
+        const float tmp = to_fp32(x[i]) - to_fp32(y[i]);
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+template <float (*to_fp32)(uint16_t)>
+inline float
+half_inner_product(const uint16_t* x, const uint16_t* y, size_t d) {
+    float res = 0;
+    for (size_t i = 0; i < d; i++) {
+        res += to_fp32(x[i]) * to_fp32(y[i]);
+    }
+    return res;
+}
+
+template <float (*to_fp32)(uint16_t)>
+inline float
+half_norm_L2sqr(const uint16_t* x, size_t d) {
+    float res = 0;
+    for (size_t i = 0; i < d; i++) {
+        const float v = to_fp32(x[i]);
+        res += v * v;
+    }
+    return res;
+}
+
+}  // namespace
+
+float
+fp16_vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<fp16_to_fp32>(x, y, d);
+}
+
+float
+fp16_vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<fp16_to_fp32>(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_ref(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<fp16_to_fp32>(x, d);
+}
+
+float
+bf16_vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_L2sqr<bf16_to_fp32>(x, y, d);
+}
+
+float
+bf16_vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d) {
+    return half_inner_product<bf16_to_fp32>(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_ref(const uint16_t* x, size_t d) {
+    return half_norm_L2sqr<bf16_to_fp32>(x, d);
+}
+
+int32_t
+u8_vec_L2sqr_ref(const uint8_t* x, const uint8_t* y, size_t d) {
+    int32_t res = 0;
+    for (size_t i = 0; i < d; i++) {
+        const int32_t tmp = int32_t(x[i]) - int32_t(y[i]);
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+int32_t
+u8_vec_inner_product_ref(const uint8_t* x, const uint8_t* y, size_t d) {
+    int32_t res = 0;
+    for (size_t i = 0; i < d; i++) {
+        res += int32_t(x[i]) * int32_t(y[i]);
+    }
+    return res;
+}
+
+namespace {
+
+inline uint64_t
+load_word(const uint8_t* x) {
+    uint64_t word;
+    memcpy(&word, x, 8);
+    return word;
+}
+
+}  // namespace
+
+int32_t
+bin_vec_hamming_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int32_t res = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        res += __builtin_popcountll(load_word(x + i) ^ load_word(y + i));
+    }
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+float
+bin_vec_jaccard_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int32_t num = 0;
+    int32_t den = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        num += __builtin_popcountll(load_word(x + i) & load_word(y + i));
+        den += __builtin_popcountll(load_word(x + i) | load_word(y + i));
+    }
+    for (; i < code_size; i++) {
+        num += __builtin_popcount(x[i] & y[i]);
+        den += __builtin_popcount(x[i] | y[i]);
+    }
+    return den == 0 ? 1.0f : float(den - num) / float(den);
+}
+
+// one query against 4 codes at a time, every word of the query is loaded once for 4 independent counts
+void
+bin_vec_hamming_ny_ref(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        int64_t res[4] = {0, 0, 0, 0};
+        size_t j = 0;
+        for (; j + 8 <= code_size; j += 8) {
+            const uint64_t wx = load_word(x + j);
+            for (size_t k = 0; k < 4; k++) {
+                res[k] += __builtin_popcountll(wx ^ load_word(yi + k * code_size + j));
+            }
+        }
+        for (; j < code_size; j++) {
+            for (size_t k = 0; k < 4; k++) {
+                res[k] += __builtin_popcount(x[j] ^ yi[k * code_size + j]);
+            }
+        }
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = res[k];
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_vec_hamming_ref(x, y + i * code_size, code_size);
+    }
+}
+
+void
+bin_vec_jaccard_ny_ref(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        int64_t num[4] = {0, 0, 0, 0};
+        int64_t den[4] = {0, 0, 0, 0};
+        size_t j = 0;
+        for (; j + 8 <= code_size; j += 8) {
+            const uint64_t wx = load_word(x + j);
+            for (size_t k = 0; k < 4; k++) {
+                const uint64_t wy = load_word(yi + k * code_size + j);
+                num[k] += __builtin_popcountll(wx & wy);
+                den[k] += __builtin_popcountll(wx | wy);
+            }
+        }
+        for (; j < code_size; j++) {
+            for (size_t k = 0; k < 4; k++) {
+                num[k] += __builtin_popcount(x[j] & yi[k * code_size + j]);
+                den[k] += __builtin_popcount(x[j] | yi[k * code_size + j]);
+            }
+        }
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = den[k] == 0 ? 1.0f : float(den[k] - num[k]) / float(den[k]);
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_vec_jaccard_ref(x, y + i * code_size, code_size);
+    }
+}
+
 }  // namespace faiss
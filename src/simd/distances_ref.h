@@ -1,6 +1,8 @@
 #ifndef DISTANCES_REF_H
 #define DISTANCES_REF_H
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 
 namespace faiss {
@@ -39,6 +41,56 @@ fvec_madd_ref(size_t n, const float* a, float bf, const float* b, float* c);
 int
 fvec_madd_and_argmin_ref(size_t n, const float* a, float bf, const float* b, float* c);
 
+/// number of set bits among the first num_bits bits
+size_t
+bitset_popcount_ref(const uint8_t* data, size_t num_bits);
+
+/// write the positions of the bits equal to value among the first num_bits bits in ascending order, returns their
+/// number
+size_t
+bitset_to_ids_ref(const uint8_t* data, size_t num_bits, bool value, int64_t* ids);
+
+/// the same distances over IEEE half (fp16) and bfloat16 (bf16) components, accumulated in float
+float
+fp16_vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+fp16_vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_ref(const uint16_t* x, size_t d);
+
+float
+bf16_vec_L2sqr_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+bf16_vec_inner_product_ref(const uint16_t* x, const uint16_t* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_ref(const uint16_t* x, size_t d);
+
+/// squared L2 distance and inner product of two vectors of uint8 codes, exact in 32-bit integers up to d = 33025
+int32_t
+u8_vec_L2sqr_ref(const uint8_t* x, const uint8_t* y, size_t d);
+
+int32_t
+u8_vec_inner_product_ref(const uint8_t* x, const uint8_t* y, size_t d);
+
+/// hamming distance of two binary codes of code_size bytes, the number of bits that differ
+int32_t
+bin_vec_hamming_ref(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+/// jaccard distance of two binary codes, 1 - |x & y| / |x | y|, 1 when both codes are empty
+float
+bin_vec_jaccard_ref(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+/// the same from the code x to the ny codes stored one after the other in y
+void
+bin_vec_hamming_ny_ref(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
+void
+bin_vec_jaccard_ny_ref(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_REF_H */
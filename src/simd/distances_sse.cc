@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
 #include "distances_ref.h"
 
@@ -377,5 +378,150 @@ fvec_madd_and_argmin_sse(size_t n, const float* a, float bf, const float* b, flo
     return _mm_cvtsi128_si32(imin4);
 }
 
+namespace {
+
+// 64-bit word w of the bitset, the bits past num_bits are cleared
+inline uint64_t
+bitset_word(const uint8_t* data, size_t num_bits, size_t w) {
+    uint64_t word = 0;
+    const size_t rest = num_bits - w * 64;
+    if (rest >= 64) {
+        memcpy(&word, data + w * 8, 8);
+        return word;
+    }
+    memcpy(&word, data + w * 8, (rest + 7) / 8);
+    return word & ((uint64_t(1) << rest) - 1);
+}
+
+}  // anonymous namespace
+
+size_t
+bitset_popcount_sse(const uint8_t* data, size_t num_bits) {
+    size_t ret = 0;
+    for (size_t w = 0; w * 64 < num_bits; w++) {
+        ret += _mm_popcnt_u64(bitset_word(data, num_bits, w));
+    }
+    return ret;
+}
+
+size_t
+bitset_to_ids_sse(const uint8_t* data, size_t num_bits, bool value, int64_t* ids) {
+    size_t n = 0;
+    for (size_t w = 0; w * 64 < num_bits; w++) {
+        uint64_t word = bitset_word(data, num_bits, w);
+        if (!value) {
+            word = ~word;
+            if (num_bits - w * 64 < 64) {
+                word &= (uint64_t(1) << (num_bits - w * 64)) - 1;
+            }
+        }
+        while (word != 0) {
+            ids[n++] = w * 64 + __builtin_ctzll(word);
+            word &= word - 1;
+        }
+    }
+    return n;
+}
+
+namespace {
+
+inline uint64_t
+load_word(const uint8_t* x) {
+    uint64_t word;
+    memcpy(&word, x, 8);
+    return word;
+}
+
+}  // anonymous namespace
+
+// hardware popcnt on 64-bit words
+int32_t
+bin_vec_hamming_sse(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int64_t res = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        res += _mm_popcnt_u64(load_word(x + i) ^ load_word(y + i));
+    }
+    for (; i < code_size; i++) {
+        res += _mm_popcnt_u32(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+float
+bin_vec_jaccard_sse(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    int64_t num = 0;
+    int64_t den = 0;
+    size_t i = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        num += _mm_popcnt_u64(load_word(x + i) & load_word(y + i));
+        den += _mm_popcnt_u64(load_word(x + i) | load_word(y + i));
+    }
+    for (; i < code_size; i++) {
+        num += _mm_popcnt_u32(x[i] & y[i]);
+        den += _mm_popcnt_u32(x[i] | y[i]);
+    }
+    return den == 0 ? 1.0f : float(den - num) / float(den);
+}
+
+// one query against 4 codes at a time, every word of the query is loaded once for 4 independent counts
+void
+bin_vec_hamming_ny_sse(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        int64_t res[4] = {0, 0, 0, 0};
+        size_t j = 0;
+        for (; j + 8 <= code_size; j += 8) {
+            const uint64_t wx = load_word(x + j);
+            for (size_t k = 0; k < 4; k++) {
+                res[k] += _mm_popcnt_u64(wx ^ load_word(yi + k * code_size + j));
+            }
+        }
+        for (; j < code_size; j++) {
+            for (size_t k = 0; k < 4; k++) {
+                res[k] += _mm_popcnt_u32(x[j] ^ yi[k * code_size + j]);
+            }
+        }
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = res[k];
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_vec_hamming_sse(x, y + i * code_size, code_size);
+    }
+}
+
+void
+bin_vec_jaccard_ny_sse(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const uint8_t* yi = y + i * code_size;
+        int64_t num[4] = {0, 0, 0, 0};
+        int64_t den[4] = {0, 0, 0, 0};
+        size_t j = 0;
+        for (; j + 8 <= code_size; j += 8) {
+            const uint64_t wx = load_word(x + j);
+            for (size_t k = 0; k < 4; k++) {
+                const uint64_t wy = load_word(yi + k * code_size + j);
+                num[k] += _mm_popcnt_u64(wx & wy);
+                den[k] += _mm_popcnt_u64(wx | wy);
+            }
+        }
+        for (; j < code_size; j++) {
+            for (size_t k = 0; k < 4; k++) {
+                num[k] += _mm_popcnt_u32(x[j] & yi[k * code_size + j]);
+                den[k] += _mm_popcnt_u32(x[j] | yi[k * code_size + j]);
+            }
+        }
+        for (size_t k = 0; k < 4; k++) {
+            dis[i + k] = den[k] == 0 ? 1.0f : float(den[k] - num[k]) / float(den[k]);
+        }
+    }
+    for (; i < ny; i++) {
+        dis[i] = bin_vec_jaccard_sse(x, y + i * code_size, code_size);
+    }
+}
+
 }  // namespace faiss
 #endif
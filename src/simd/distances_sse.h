@@ -12,6 +12,8 @@
 #ifndef DISTANCES_SSE_H
 #define DISTANCES_SSE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 namespace faiss {
 
@@ -46,6 +48,24 @@ fvec_madd_sse(size_t n, const float* a, float bf, const float* b, float* c);
 int
 fvec_madd_and_argmin_sse(size_t n, const float* a, float bf, const float* b, float* c);
 
+size_t
+bitset_popcount_sse(const uint8_t* data, size_t num_bits);
+
+size_t
+bitset_to_ids_sse(const uint8_t* data, size_t num_bits, bool value, int64_t* ids);
+
+int32_t
+bin_vec_hamming_sse(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+float
+bin_vec_jaccard_sse(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+void
+bin_vec_hamming_ny_sse(int32_t* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
+void
+bin_vec_jaccard_ny_sse(float* dis, const uint8_t* x, const uint8_t* y, size_t code_size, size_t ny);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_SSE_H */
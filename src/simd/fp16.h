@@ -0,0 +1,94 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef FP16_H
+#define FP16_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace faiss {
+
+/// IEEE half to float, exact
+inline float
+fp16_to_fp32(uint16_t h) {
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t em = h & 0x7fff;
+    uint32_t bits;
+    if (em >= 0x7c00) {
+        // inf and nan
+        bits = sign | 0x7f800000 | ((em & 0x3ff) << 13);
+    } else if (em >= 0x0400) {
+        // normal, rebias the exponent from 15 to 127
+        bits = sign | ((em + 0x1c000) << 13);
+    } else {
+        // subnormal, em units of 2^-24
+        float f = (float)em * 5.9604644775390625e-8f;
+        memcpy(&bits, &f, sizeof(bits));
+        bits |= sign;
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/// float to IEEE half, rounded to nearest even, overflows to inf
+inline uint16_t
+fp32_to_fp16(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    const uint16_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+    if (x >= 0x7f800000) {
+        return sign | 0x7c00 | (x > 0x7f800000 ? 0x200 : 0);
+    }
+    if (x >= 0x477ff000) {
+        // at least 65520, rounds up to inf
+        return sign | 0x7c00;
+    }
+    if (x < 0x38800000) {
+        // below 2^-14, adding 0.5 rounds the value to a multiple of 2^-24 in the low mantissa bits
+        float v;
+        memcpy(&v, &x, sizeof(v));
+        v += 0.5f;
+        uint32_t r;
+        memcpy(&r, &v, sizeof(r));
+        return sign | (uint16_t)(r - 0x3f000000);
+    }
+    // rebias the exponent and round the 13 dropped mantissa bits
+    x += 0xc8000fffu + ((x >> 13) & 1);
+    return sign | (uint16_t)(x >> 13);
+}
+
+/// bfloat16 to float, exact
+inline float
+bf16_to_fp32(uint16_t h) {
+    uint32_t bits = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+/// float to bfloat16, rounded to nearest even, nan stays a quiet nan
+inline uint16_t
+fp32_to_bf16(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    if ((x & 0x7fffffff) > 0x7f800000) {
+        return (x >> 16) | 0x40;
+    }
+    x += 0x7fff + ((x >> 16) & 1);
+    return x >> 16;
+}
+
+}  // namespace faiss
+
+#endif /* FP16_H */
@@ -44,6 +44,20 @@ decltype(fvec_L2sqr_ny) fvec_L2sqr_ny = fvec_L2sqr_ny_ref;
 decltype(fvec_inner_products_ny) fvec_inner_products_ny = fvec_inner_products_ny_ref;
 decltype(fvec_madd) fvec_madd = fvec_madd_ref;
 decltype(fvec_madd_and_argmin) fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
+decltype(bitset_popcount) bitset_popcount = bitset_popcount_ref;
+decltype(bitset_to_ids) bitset_to_ids = bitset_to_ids_ref;
+decltype(fp16_vec_L2sqr) fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+decltype(fp16_vec_inner_product) fp16_vec_inner_product = fp16_vec_inner_product_ref;
+decltype(fp16_vec_norm_L2sqr) fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+decltype(bf16_vec_L2sqr) bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+decltype(bf16_vec_inner_product) bf16_vec_inner_product = bf16_vec_inner_product_ref;
+decltype(bf16_vec_norm_L2sqr) bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+decltype(u8_vec_L2sqr) u8_vec_L2sqr = u8_vec_L2sqr_ref;
+decltype(u8_vec_inner_product) u8_vec_inner_product = u8_vec_inner_product_ref;
+decltype(bin_vec_hamming) bin_vec_hamming = bin_vec_hamming_ref;
+decltype(bin_vec_jaccard) bin_vec_jaccard = bin_vec_jaccard_ref;
+decltype(bin_vec_hamming_ny) bin_vec_hamming_ny = bin_vec_hamming_ny_ref;
+decltype(bin_vec_jaccard_ny) bin_vec_jaccard_ny = bin_vec_jaccard_ny_ref;
 
 #if defined(__x86_64__)
 bool
@@ -52,6 +66,24 @@ cpu_support_avx512() {
     return (instruction_set_inst.AVX512F() && instruction_set_inst.AVX512DQ() && instruction_set_inst.AVX512BW());
 }
 
+bool
+cpu_support_avx512_bf16() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return cpu_support_avx512() && instruction_set_inst.AVX512_BF16();
+}
+
+bool
+cpu_support_avx512_vnni() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return cpu_support_avx512() && instruction_set_inst.AVX512_VNNI();
+}
+
+bool
+cpu_support_avx512_vpopcntdq() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return cpu_support_avx512() && instruction_set_inst.AVX512_VPOPCNTDQ();
+}
+
 bool
 cpu_support_avx2() {
     InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
@@ -76,11 +108,41 @@ fvec_hook(std::string& simd_type) {
         fvec_L1 = fvec_L1_avx512;
         fvec_Linf = fvec_Linf_avx512;
 
-        fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
-        fvec_inner_products_ny = fvec_inner_products_ny_sse;
-        fvec_madd = fvec_madd_sse;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+        fvec_norm_L2sqr = fvec_norm_L2sqr_avx512;
+        fvec_L2sqr_ny = fvec_L2sqr_ny_avx512;
+        fvec_inner_products_ny = fvec_inner_products_ny_avx512;
+        fvec_madd = fvec_madd_avx512;
+        fvec_madd_and_argmin = fvec_madd_and_argmin_avx512;
+
+        bitset_popcount = bitset_popcount_avx512;
+        bitset_to_ids = bitset_to_ids_avx512;
+
+        fp16_vec_L2sqr = fp16_vec_L2sqr_avx512;
+        fp16_vec_inner_product = fp16_vec_inner_product_avx512;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx512;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_avx512;
+        bf16_vec_inner_product = bf16_vec_inner_product_avx512;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx512;
+        if (cpu_support_avx512_bf16()) {
+            bf16_vec_inner_product = bf16_vec_inner_product_avx512bf16;
+            bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx512bf16;
+        }
+        u8_vec_L2sqr = u8_vec_L2sqr_avx512;
+        u8_vec_inner_product = u8_vec_inner_product_avx512;
+        if (cpu_support_avx512_vnni()) {
+            u8_vec_L2sqr = u8_vec_L2sqr_avx512vnni;
+            u8_vec_inner_product = u8_vec_inner_product_avx512vnni;
+        }
+        bin_vec_hamming = bin_vec_hamming_avx512;
+        bin_vec_jaccard = bin_vec_jaccard_avx512;
+        bin_vec_hamming_ny = bin_vec_hamming_ny_avx512;
+        bin_vec_jaccard_ny = bin_vec_jaccard_ny_avx512;
+        if (cpu_support_avx512_vpopcntdq()) {
+            bin_vec_hamming = bin_vec_hamming_avx512vpopcntdq;
+            bin_vec_jaccard = bin_vec_jaccard_avx512vpopcntdq;
+            bin_vec_hamming_ny = bin_vec_hamming_ny_avx512vpopcntdq;
+            bin_vec_jaccard_ny = bin_vec_jaccard_ny_avx512vpopcntdq;
+        }
 
         simd_type = "AVX512";
     } else if (use_avx2 && cpu_support_avx2()) {
@@ -89,11 +151,27 @@ fvec_hook(std::string& simd_type) {
         fvec_L1 = fvec_L1_avx;
         fvec_Linf = fvec_Linf_avx;
 
-        fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
-        fvec_inner_products_ny = fvec_inner_products_ny_sse;
-        fvec_madd = fvec_madd_sse;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+        fvec_norm_L2sqr = fvec_norm_L2sqr_avx;
+        fvec_L2sqr_ny = fvec_L2sqr_ny_avx;
+        fvec_inner_products_ny = fvec_inner_products_ny_avx;
+        fvec_madd = fvec_madd_avx;
+        fvec_madd_and_argmin = fvec_madd_and_argmin_avx;
+
+        bitset_popcount = bitset_popcount_avx;
+        bitset_to_ids = bitset_to_ids_avx;
+
+        fp16_vec_L2sqr = fp16_vec_L2sqr_avx;
+        fp16_vec_inner_product = fp16_vec_inner_product_avx;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_avx;
+        bf16_vec_inner_product = bf16_vec_inner_product_avx;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx;
+        u8_vec_L2sqr = u8_vec_L2sqr_avx;
+        u8_vec_inner_product = u8_vec_inner_product_avx;
+        bin_vec_hamming = bin_vec_hamming_avx;
+        bin_vec_jaccard = bin_vec_jaccard_avx;
+        bin_vec_hamming_ny = bin_vec_hamming_ny_avx;
+        bin_vec_jaccard_ny = bin_vec_jaccard_ny_avx;
 
         simd_type = "AVX2";
     } else if (use_sse4_2 && cpu_support_sse4_2()) {
@@ -108,6 +186,22 @@ fvec_hook(std::string& simd_type) {
         fvec_madd = fvec_madd_sse;
         fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
 
+        bitset_popcount = bitset_popcount_sse;
+        bitset_to_ids = bitset_to_ids_sse;
+
+        fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+        fp16_vec_inner_product = fp16_vec_inner_product_ref;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+        bf16_vec_inner_product = bf16_vec_inner_product_ref;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+        u8_vec_L2sqr = u8_vec_L2sqr_ref;
+        u8_vec_inner_product = u8_vec_inner_product_ref;
+        bin_vec_hamming = bin_vec_hamming_sse;
+        bin_vec_jaccard = bin_vec_jaccard_sse;
+        bin_vec_hamming_ny = bin_vec_hamming_ny_sse;
+        bin_vec_jaccard_ny = bin_vec_jaccard_ny_sse;
+
         simd_type = "SSE4_2";
     } else {
         fvec_inner_product = fvec_inner_product_ref;
@@ -121,9 +215,27 @@ fvec_hook(std::string& simd_type) {
         fvec_madd = fvec_madd_ref;
         fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
 
+        bitset_popcount = bitset_popcount_ref;
+        bitset_to_ids = bitset_to_ids_ref;
+
+        fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+        fp16_vec_inner_product = fp16_vec_inner_product_ref;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+        bf16_vec_inner_product = bf16_vec_inner_product_ref;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+        u8_vec_L2sqr = u8_vec_L2sqr_ref;
+        u8_vec_inner_product = u8_vec_inner_product_ref;
+        bin_vec_hamming = bin_vec_hamming_ref;
+        bin_vec_jaccard = bin_vec_jaccard_ref;
+        bin_vec_hamming_ny = bin_vec_hamming_ny_ref;
+        bin_vec_jaccard_ny = bin_vec_jaccard_ny_ref;
+
         simd_type = "GENERIC";
     }
 #endif
+    // follows the simd type, unlike the SQ hooks
+    faiss::pq4_hook();
 }
 
 static int init_hook_ = []() {
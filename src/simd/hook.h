@@ -12,6 +12,7 @@
 #ifndef HOOK_H
 #define HOOK_H
 
+#include <cstdint>
 #include <string>
 namespace faiss {
 
@@ -25,6 +26,30 @@ extern void (*fvec_inner_products_ny)(float*, const float*, const float*, size_t
 extern void (*fvec_madd)(size_t, const float*, float, const float*, float*);
 extern int (*fvec_madd_and_argmin)(size_t, const float*, float, const float*, float*);
 
+/// number of set bits among the first num_bits bits of a bitset
+extern size_t (*bitset_popcount)(const uint8_t*, size_t);
+/// positions of the bits equal to the given value in ascending order, returns their number
+extern size_t (*bitset_to_ids)(const uint8_t*, size_t, bool, int64_t*);
+
+/// distances over vectors stored as IEEE half (fp16) or bfloat16 (bf16) components
+extern float (*fp16_vec_L2sqr)(const uint16_t*, const uint16_t*, size_t);
+extern float (*fp16_vec_inner_product)(const uint16_t*, const uint16_t*, size_t);
+extern float (*fp16_vec_norm_L2sqr)(const uint16_t*, size_t);
+extern float (*bf16_vec_L2sqr)(const uint16_t*, const uint16_t*, size_t);
+extern float (*bf16_vec_inner_product)(const uint16_t*, const uint16_t*, size_t);
+extern float (*bf16_vec_norm_L2sqr)(const uint16_t*, size_t);
+
+/// exact squared L2 distance and inner product of two vectors of uint8 scalar quantizer codes
+extern int32_t (*u8_vec_L2sqr)(const uint8_t*, const uint8_t*, size_t);
+extern int32_t (*u8_vec_inner_product)(const uint8_t*, const uint8_t*, size_t);
+
+/// hamming distance and jaccard distance (1 - |x & y| / |x | y|) of binary codes of code_size bytes, and the
+/// distances of one code x to ny consecutive codes y
+extern int32_t (*bin_vec_hamming)(const uint8_t*, const uint8_t*, size_t);
+extern float (*bin_vec_jaccard)(const uint8_t*, const uint8_t*, size_t);
+extern void (*bin_vec_hamming_ny)(int32_t*, const uint8_t*, const uint8_t*, size_t, size_t);
+extern void (*bin_vec_jaccard_ny)(float*, const uint8_t*, const uint8_t*, size_t, size_t);
+
 #if defined(__x86_64__)
 extern bool use_avx512;
 extern bool use_avx2;
@@ -35,6 +60,12 @@ extern bool use_sse4_2;
 bool
 cpu_support_avx512();
 bool
+cpu_support_avx512_bf16();
+bool
+cpu_support_avx512_vnni();
+bool
+cpu_support_avx512_vpopcntdq();
+bool
 cpu_support_avx2();
 bool
 cpu_support_sse4_2();
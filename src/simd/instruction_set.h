@@ -41,6 +41,7 @@ class InstructionSet {
           f_1_EDX_{0},
           f_7_EBX_{0},
           f_7_ECX_{0},
+          f_7_1_EAX_{0},
           f_81_ECX_{0},
           f_81_EDX_{0},
           data_{},
@@ -80,6 +81,12 @@ class InstructionSet {
         if (nIds_ >= 7) {
             f_7_EBX_ = data_[7][1];
             f_7_ECX_ = data_[7][2];
+
+            // subleaf 1 exists when subleaf 0 reports it in EAX
+            if (data_[7][0] >= 1) {
+                __cpuid_count(7, 1, cpui[0], cpui[1], cpui[2], cpui[3]);
+                f_7_1_EAX_ = cpui[0];
+            }
         }
 
         // Calling __cpuid with 0x80000000 as the function_id argument
@@ -301,6 +308,21 @@ class InstructionSet {
         return f_7_ECX_[0];
     }
 
+    bool
+    AVX512_VNNI() {
+        return f_7_ECX_[11];
+    }
+
+    bool
+    AVX512_VPOPCNTDQ() {
+        return f_7_ECX_[14];
+    }
+
+    bool
+    AVX512_BF16() {
+        return f_7_1_EAX_[5];
+    }
+
     bool
     LAHF() {
         return f_81_ECX_[0];
@@ -358,6 +380,7 @@ class InstructionSet {
     std::bitset<32> f_1_EDX_;
     std::bitset<32> f_7_EBX_;
     std::bitset<32> f_7_ECX_;
+    std::bitset<32> f_7_1_EAX_;
     std::bitset<32> f_81_ECX_;
     std::bitset<32> f_81_EDX_;
     std::vector<std::array<int, 4>> data_;
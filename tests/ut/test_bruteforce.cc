@@ -12,9 +12,12 @@
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "common/tiled_knn.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/factory.h"
 #include "knowhere/utils.h"
+#include "simd/fp16.h"
 #include "utils.h"
 
 TEST_CASE("Test Brute Force", "[float vector]") {
@@ -85,6 +88,106 @@ TEST_CASE("Test Brute Force", "[float vector]") {
             }
         }
     }
+
+    SECTION("Test Search Batched") {
+        // large batches go through the tiled path, small ones through the per-query path
+        const int64_t batch_nq = 100;
+        const auto batch_query_ds = CopyDataSet(train_ds, batch_nq);
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto res = knowhere::BruteForce::Search(train_ds, batch_query_ds, conf, bitset);
+        REQUIRE(res.has_value());
+        auto dist = res.value()->GetDistance();
+        for (int64_t i = 0; i < batch_nq; i += nq) {
+            auto xq = (const float*)batch_query_ds->GetTensor() + i * dim;
+            auto small_res = knowhere::BruteForce::Search(train_ds, knowhere::GenDataSet(nq, dim, xq), conf, bitset);
+            REQUIRE(small_res.has_value());
+            auto small_dist = small_res.value()->GetDistance();
+            for (int64_t j = 0; j < nq * k; j++) {
+                REQUIRE(dist[i * k + j] == Approx(small_dist[j]).epsilon(0.0001));
+            }
+        }
+    }
+}
+
+TEST_CASE("Test Tiled Knn Search", "[float vector]") {
+    using Catch::Approx;
+
+    const int64_t dim = 32;
+    const int64_t k = 10;
+    // the base spans several tiles with a partial last one, the queries several blocks with a partial last one
+    const int64_t tile_rows = knowhere::kTiledKnnTileBytes / (dim * sizeof(float));
+    const int64_t nb = tile_rows * 5 + tile_rows / 3;
+    const int64_t nq = knowhere::kTiledKnnQueryBlock * 3 + 7;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+    auto filtered = GENERATE(false, true);
+    // BruteForce and FLAT scan float tiles, FLAT_FP16 and FLAT_BF16 half precision ones
+    auto name = GENERATE(as<std::string>{}, "", knowhere::IndexEnum::INDEX_FAISS_IDMAP,
+                         knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16, knowhere::IndexEnum::INDEX_FAISS_IDMAP_BF16);
+    const bool is_bf16 = name == knowhere::IndexEnum::INDEX_FAISS_IDMAP_BF16;
+    const bool is_half = is_bf16 || name == knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16;
+    REQUIRE(nq >= knowhere::kTiledKnnMinNq);
+
+    // real valued components, so that no two distances tie and both paths return the ids in the same order
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distrib(0.0f, 1.0f);
+    auto gen_vectors = [&](int64_t rows) {
+        auto ds = knowhere::GenDataSet(rows, dim, nullptr);
+        if (is_half) {
+            auto xs = new uint16_t[rows * dim];
+            for (int64_t i = 0; i < rows * dim; i++) {
+                xs[i] = is_bf16 ? faiss::fp32_to_bf16(distrib(rng)) : faiss::fp32_to_fp16(distrib(rng));
+            }
+            ds->SetTensor(xs);
+        } else {
+            auto xs = new float[rows * dim];
+            for (int64_t i = 0; i < rows * dim; i++) {
+                xs[i] = distrib(rng);
+            }
+            ds->SetTensor(xs);
+        }
+        ds->SetIsOwner(true);
+        return ds;
+    };
+    const auto train_ds = gen_vectors(nb);
+    const auto query_ds = gen_vectors(nq);
+    const size_t row_bytes = dim * (is_half ? sizeof(uint16_t) : sizeof(float));
+
+    const knowhere::Json conf = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, k},
+    };
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+    knowhere::BitsetView bitset = filtered ? knowhere::BitsetView(bitset_data.data(), nb) : knowhere::BitsetView();
+
+    knowhere::Index<knowhere::IndexNode> idx;
+    if (!name.empty()) {
+        idx = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(idx.Build(*train_ds, conf) == knowhere::Status::success);
+    }
+    auto search = [&](const knowhere::DataSetPtr& queries) {
+        auto res = name.empty() ? knowhere::BruteForce::Search(train_ds, queries, conf, bitset)
+                                : idx.Search(*queries, conf, bitset);
+        REQUIRE(res.has_value());
+        return res.value();
+    };
+
+    CAPTURE(name, metric, filtered);
+    auto res = search(query_ds);
+    // a single query takes the per-query path
+    for (int64_t i = 0; i < nq; i++) {
+        auto xq = static_cast<const uint8_t*>(query_ds->GetTensor()) + i * row_bytes;
+        auto single_res = search(knowhere::GenDataSet(1, dim, xq));
+        for (int64_t j = 0; j < k; j++) {
+            REQUIRE(res->GetIds()[i * k + j] == single_res->GetIds()[j]);
+            REQUIRE(res->GetDistance()[i * k + j] == Approx(single_res->GetDistance()[j]).epsilon(0.0001));
+            if (filtered) {
+                REQUIRE(!bitset.test(res->GetIds()[i * k + j]));
+            }
+        }
+    }
 }
 
 TEST_CASE("Test Brute Force", "[binary vector]") {
@@ -14,10 +14,13 @@
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "diskann/partition_and_pq.h"
 #include "index/diskann/diskann.cc"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/knowhere_config.h"
 #include "knowhere/comp/local_file_manager.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/expected.h"
 #include "knowhere/factory.h"
 #include "utils.h"
@@ -275,6 +278,42 @@ TEST_CASE("Test DiskANNIndexNode.", "[diskann]") {
                 REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) == knn_recall);
             }
 
+            // knn search through io_uring with several queries in flight per thread, the index would silently
+            // fall back to libaio where io_uring is not available
+            if (!UringAlignedFileReader::is_supported()) {
+                WARN("io_uring is not available, skip the io_uring knn search");
+            } else {
+                // the reads a failed search cancels never complete into a later one
+                {
+                    UringAlignedFileReader reader;
+                    reader.open(diskann::get_disk_index_filename(std::string(build_gen()["index_prefix"])));
+                    const size_t n_reads = 64;
+                    char* buf = nullptr;
+                    diskann::alloc_aligned((void**)&buf, (n_reads + 1) * SECTOR_LEN, SECTOR_LEN);
+                    std::vector<AlignedRead> reqs;
+                    for (size_t i = 0; i < n_reads; i++) {
+                        reqs.emplace_back(0, SECTOR_LEN, buf + i * SECTOR_LEN);
+                    }
+                    reader.submit_tagged(reqs, 1);
+                    reader.cancel_tagged();
+                    std::vector<AlignedRead> last = {AlignedRead(0, SECTOR_LEN, buf + n_reads * SECTOR_LEN)};
+                    reader.submit_tagged(last, 2);
+                    std::vector<uint64_t> tags;
+                    reader.reap_tagged(tags);
+                    REQUIRE(tags == std::vector<uint64_t>{2});
+                    reader.close();
+                    diskann::aligned_free(buf);
+                }
+                knowhere::Json uring_json = deserialize_json;
+                uring_json["use_io_uring"] = true;
+                uring_json["search_pipeline_width"] = 4;
+                auto diskann_uring = knowhere::IndexFactory::Instance().Create("DISKANN", diskann_index_pack);
+                diskann_uring.Deserialize(binset, uring_json);
+                auto res = diskann_uring.Search(*query_ds, knn_json, nullptr);
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) > kKnnRecall);
+            }
+
             // knn search with bitset
             std::vector<std::function<std::vector<uint8_t>(size_t, size_t)>> gen_bitset_funcs = {
                 GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet};
@@ -314,6 +353,8 @@ TEST_CASE("Test DiskANNIndexNode.", "[diskann]") {
 
 // This test case only check L2
 TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
+    // ids go through the id -> sector map when the disk layout is reordered
+    auto reorder_disk_layout = GENERATE(as<bool>{}, false, true);
     for (const uint32_t dim : {kDim, kLargeDim}) {
         fs::remove_all(kDir);
         fs::remove(kDir);
@@ -335,6 +376,7 @@ TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
             json["search_list_size"] = kK;
             json["pq_code_budget_gb"] = sizeof(float) * dim * kNumRows * 0.03125 / (1024 * 1024 * 1024);
             json["build_dram_budget_gb"] = 32.0;
+            json["reorder_disk_layout"] = reorder_disk_layout;
             return json;
         };
 
@@ -368,7 +410,7 @@ TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
                 std::vector<double> ids_sizes = {1, kNumRows * 0.2, kNumRows * 0.7, kNumRows};
                 for (const auto ids_size : ids_sizes) {
                     std::cout << "Testing dim = " << dim << ", cache_size = " << cache_size
-                              << ", ids_size = " << ids_size << std::endl;
+                              << ", ids_size = " << ids_size << ", reorder = " << reorder_disk_layout << std::endl;
                     auto ids_ds = GenIdsDataSet(ids_size, ids_size);
                     auto results = index.GetVectorByIds(*ids_ds);
                     REQUIRE(results.has_value());
@@ -387,3 +429,179 @@ TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
     fs::remove_all(kDir);
     fs::remove(kDir);
 }
+
+// This test case only check L2
+TEST_CASE("Test DiskANN Reordered Disk Layout", "[diskann]") {
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+
+    knowhere::Json base_json;
+    base_json["dim"] = kDim;
+    base_json["metric_type"] = knowhere::metric::L2;
+    base_json["k"] = kK;
+    knowhere::Json build_json = base_json;
+    build_json["index_prefix"] = kL2IndexPrefix;
+    build_json["data_path"] = kRawDataPath;
+    build_json["max_degree"] = 56;
+    build_json["search_list_size"] = 128;
+    build_json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+    build_json["build_dram_budget_gb"] = 32.0;
+    knowhere::Json deserialize_json = base_json;
+    deserialize_json["index_prefix"] = kL2IndexPrefix;
+    deserialize_json["search_cache_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+    knowhere::Json knn_json = base_json;
+    knn_json["index_prefix"] = kL2IndexPrefix;
+    knn_json["search_list_size"] = 36;
+    knn_json["beamwidth"] = 8;
+
+    auto query_ds = GenDataSet(kNumQueries, kDim, 42);
+    auto base_ds = GenDataSet(kNumRows, kDim, 30);
+    WriteRawDataToDisk(kRawDataPath, static_cast<const float*>(base_ds->GetTensor()), kNumRows, kDim);
+    auto gt = knowhere::BruteForce::Search(base_ds, query_ds, base_json, nullptr);
+    REQUIRE(gt.has_value());
+
+    std::shared_ptr<knowhere::FileManager> file_manager = std::make_shared<knowhere::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    {
+        knowhere::DataSet* ds_ptr = nullptr;
+        auto diskann = knowhere::IndexFactory::Instance().Create("DISKANN", diskann_index_pack);
+        REQUIRE(diskann.Build(*ds_ptr, build_json) == knowhere::Status::success);
+    }
+    // every search is sampled, so that the sectors it read are counted
+    const double default_rate = knowhere::KnowhereConfig::GetSearchStatsSampleRate();
+    knowhere::KnowhereConfig::SetSearchStatsSampleRate(1.0);
+    auto search = [&](uint64_t& disk_reads) {
+        knowhere::BinarySet binset;
+        auto diskann = knowhere::IndexFactory::Instance().Create("DISKANN", diskann_index_pack);
+        REQUIRE(diskann.Deserialize(binset, deserialize_json) == knowhere::Status::success);
+        knowhere::SearchStatsScope stats_scope(false);
+        auto res = diskann.Search(*query_ds, knn_json, nullptr);
+        REQUIRE(res.has_value());
+        disk_reads = stats_scope.Get()->Count(knowhere::SearchStats::DISK_READS);
+        return res.value();
+    };
+    uint64_t id_order_reads = 0;
+    auto id_order = search(id_order_reads);
+    REQUIRE(id_order_reads > 0);
+    REQUIRE(GetKNNRecall(*gt.value(), *id_order) > kKnnRecall);
+
+    // lay the same graph out again with reordering on, so that only the placement of the nodes differs
+    const auto disk_index_path = diskann::get_disk_index_filename(kL2IndexPrefix);
+    const auto mem_index_path = kDir + "/mem_index";
+    {
+        std::ifstream reader(disk_index_path, std::ios::binary);
+        std::vector<uint64_t> meta(SECTOR_LEN / sizeof(uint64_t));
+        reader.read((char*)meta.data(), SECTOR_LEN);
+        const uint64_t npts = meta[1], medoid = meta[2], max_node_len = meta[3], nnodes_per_sector = meta[4];
+        REQUIRE(npts == kNumRows);
+        REQUIRE(nnodes_per_sector > 1);
+        // no id -> slot table, the nodes are in id order
+        REQUIRE(meta[11] == 0);
+
+        std::vector<char> sector(SECTOR_LEN);
+        std::string graph;
+        for (uint64_t id = 0; id < npts; id++) {
+            if (id % nnodes_per_sector == 0) {
+                reader.read(sector.data(), SECTOR_LEN);
+            }
+            const char* nhood = sector.data() + (id % nnodes_per_sector) * max_node_len + kDim * sizeof(float);
+            graph.append(nhood, (1 + *(const uint32_t*)nhood) * sizeof(uint32_t));
+        }
+        const uint64_t file_size = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t) + graph.size();
+        const uint32_t width = (max_node_len - kDim * sizeof(float)) / sizeof(uint32_t) - 1;
+        const uint32_t medoid_u32 = medoid;
+        std::ofstream writer(mem_index_path, std::ios::binary);
+        writer.write((const char*)&file_size, sizeof(file_size));
+        writer.write((const char*)&width, sizeof(width));
+        writer.write((const char*)&medoid_u32, sizeof(medoid_u32));
+        writer.write((const char*)&meta[5], sizeof(uint64_t));
+        writer.write(graph.data(), graph.size());
+    }
+    // a budget this small gathers the vectors of a single sector per pass over the base file
+    REQUIRE_NOTHROW(
+        diskann::create_disk_layout<float>(kRawDataPath, mem_index_path, disk_index_path, std::string(""), true, 1e-9));
+    {
+        std::ifstream reader(disk_index_path, std::ios::binary);
+        std::vector<uint64_t> meta(SECTOR_LEN / sizeof(uint64_t));
+        reader.read((char*)meta.data(), SECTOR_LEN);
+        REQUIRE(meta[11] != 0);
+    }
+
+    uint64_t reordered_reads = 0;
+    auto reordered = search(reordered_reads);
+    knowhere::KnowhereConfig::SetSearchStatsSampleRate(default_rate);
+    for (uint32_t i = 0; i < kNumQueries * kK; i++) {
+        REQUIRE(reordered->GetIds()[i] == id_order->GetIds()[i]);
+        REQUIRE(reordered->GetDistance()[i] == id_order->GetDistance()[i]);
+    }
+    // the same nodes are expanded, but more of them come from a sector the query already read
+    REQUIRE(reordered_reads < id_order_reads);
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
+
+TEST_CASE("Test DiskANN Build In Blocks", "[diskann]") {
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directory(kDir));
+
+    SECTION("Test sampling reads the sampled rows") {
+        // several read runs of the base file
+        const uint32_t num_rows = 6000;
+        auto base_ds = GenDataSet(num_rows, kLargeDim, 30);
+        auto base_ptr = static_cast<const float*>(base_ds->GetTensor());
+        WriteRawDataToDisk(kRawDataPath, base_ptr, num_rows, kLargeDim);
+
+        // a sample of every row is the base itself, read in dense runs
+        float* sampled = nullptr;
+        size_t sampled_rows = 0, sampled_dim = 0;
+        gen_random_slice<float>(kRawDataPath, 1.0, sampled, sampled_rows, sampled_dim);
+        std::unique_ptr<float[]> all(sampled);
+        REQUIRE(sampled_rows == num_rows);
+        REQUIRE(sampled_dim == kLargeDim);
+        REQUIRE(memcmp(all.get(), base_ptr, sizeof(float) * num_rows * kLargeDim) == 0);
+
+        // a small sample is read row by row, the rows come in base order
+        gen_random_slice<float>(kRawDataPath, 0.05, sampled, sampled_rows, sampled_dim);
+        std::unique_ptr<float[]> some(sampled);
+        REQUIRE(sampled_rows > 0);
+        REQUIRE(sampled_rows < num_rows);
+        size_t next = 0;
+        for (size_t i = 0; i < sampled_rows; i++) {
+            const auto row = some.get() + i * kLargeDim;
+            while (next < num_rows && memcmp(row, base_ptr + next * kLargeDim, sizeof(float) * kLargeDim) != 0) {
+                next++;
+            }
+            REQUIRE(next < num_rows);
+            next++;
+        }
+    }
+
+    SECTION("Test PQ encoding in blocks matches a single block") {
+        const uint32_t num_chunks = 16;
+        auto base_ds = GenDataSet(kNumRows, kDim, 30);
+        auto base_ptr = static_cast<const float*>(base_ds->GetTensor());
+        WriteRawDataToDisk(kRawDataPath, base_ptr, kNumRows, kDim);
+        const std::string pivots_path = kDir + "/pq_pivots.bin";
+        REQUIRE(generate_pq_pivots(base_ptr, kNumRows, kDim, 256, num_chunks, 5, pivots_path, true) == 0);
+
+        const std::string single_path = kDir + "/pq_single.bin";
+        const std::string blocks_path = kDir + "/pq_blocks.bin";
+        REQUIRE(generate_pq_data_from_pivots<float>(kRawDataPath, 256, num_chunks, pivots_path,
+                                                             single_path) == 0);
+        // blocks that do not divide the rows, each one read while the previous one is encoded
+        REQUIRE(generate_pq_data_from_pivots<float>(kRawDataPath, 256, num_chunks, pivots_path, blocks_path,
+                                                             37) == 0);
+
+        auto read_file = [](const std::string& path) {
+            std::ifstream reader(path, std::ios::binary);
+            return std::vector<char>(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
+        };
+        auto single = read_file(single_path);
+        REQUIRE(single.size() == 2 * sizeof(uint32_t) + kNumRows * num_chunks);
+        REQUIRE(single == read_file(blocks_path));
+    }
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
@@ -53,6 +53,36 @@ TEST_CASE("Test Distance Compute", "[distance]") {
         }
     }
 
+    SECTION("Test Batched Distance Compute") {
+        typedef void (*FUNC)(float*, const float*, const float*, size_t, size_t);
+        auto [real_func, gold_func] = GENERATE(table<FUNC, FUNC>({
+            make_tuple(faiss::fvec_L2sqr_ny, faiss::fvec_L2sqr_ny_ref),
+            make_tuple(faiss::fvec_inner_products_ny, faiss::fvec_inner_products_ny_ref),
+        }));
+        // the dimensions with a fast path, their neighbors and the tiny ones of pq sub-quantizers
+        auto dim = GENERATE(as<size_t>{}, 1, 2, 4, 7, 12, 17, 95, 96, 128, 256, 384, 768, 1024, 1025);
+
+        for (size_t ny : {1, 3, 4, 8, 9, 33}) {
+            CAPTURE(dim, ny);
+            std::vector<float> x(dim);
+            std::vector<float> y(dim * ny);
+            for (auto& v : x) {
+                v = fill_distrib(rng);
+            }
+            for (auto& v : y) {
+                v = fill_distrib(rng);
+            }
+
+            std::vector<float> dis(ny);
+            std::vector<float> dis_gold(ny);
+            real_func(dis.data(), x.data(), y.data(), dim, ny);
+            gold_func(dis_gold.data(), x.data(), y.data(), dim, ny);
+            for (size_t i = 0; i < ny; ++i) {
+                REQUIRE_THAT(dis[i], Catch::Matchers::WithinRel(dis_gold[i], 0.001f));
+            }
+        }
+    }
+
     SECTION("Test Madd and Argmin") {
         typedef int (*FUNC)(size_t, const float*, float, const float*, float*);
         auto [real_func, gold_func] = GENERATE(table<FUNC, FUNC>({
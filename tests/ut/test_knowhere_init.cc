@@ -30,6 +30,15 @@ TEST_CASE("Knowhere global config", "[init]") {
     knowhere::KnowhereConfig::SetClusteringType(knowhere::KnowhereConfig::ClusteringType::K_MEANS_PLUS_PLUS);
     knowhere::KnowhereConfig::SetClusteringType(knowhere::KnowhereConfig::ClusteringType::K_MEANS);
 
+    knowhere::KnowhereConfig::SetNumaPolicy(knowhere::KnowhereConfig::NumaPolicy::NUMA_INTERLEAVE);
+    REQUIRE(knowhere::KnowhereConfig::GetNumaPolicy() == knowhere::KnowhereConfig::NumaPolicy::NUMA_INTERLEAVE);
+    knowhere::KnowhereConfig::SetNumaPolicy(knowhere::KnowhereConfig::NumaPolicy::NUMA_OFF);
+    REQUIRE(knowhere::KnowhereConfig::GetNumaPolicy() == knowhere::KnowhereConfig::NumaPolicy::NUMA_OFF);
+    knowhere::KnowhereConfig::SetNumaSearchThreads(4);
+    REQUIRE(knowhere::KnowhereConfig::GetNumaSearchThreads() == 4);
+    knowhere::KnowhereConfig::SetNumaSearchThreads(0);
+    REQUIRE(knowhere::KnowhereConfig::GetNumaSearchThreads() == 0);
+
 #ifdef KNOWHERE_WITH_DISKANN
     REQUIRE_FALSE(knowhere::KnowhereConfig::SetAioContextPool(0));
     REQUIRE(knowhere::KnowhereConfig::SetAioContextPool(16));
@@ -0,0 +1,103 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/multi_index_search.h"
+#include "knowhere/factory.h"
+#include "utils.h"
+
+TEST_CASE("Test Multi Index Search", "[multi index]") {
+    using Catch::Approx;
+
+    const int64_t nb = 1000;
+    // more than one query block
+    const int64_t nq = 20;
+    const int64_t dim = 32;
+    const int64_t k = 10;
+    // segment boundaries are multiples of 8, so that the bitset of a segment is a slice of the global one
+    const std::vector<int64_t> bounds = {0, 304, 704, 1000};
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::COSINE);
+    auto filtered = GENERATE(as<float>{}, 0.0f, 0.3f);
+
+    const knowhere::Json json = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, k},
+    };
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim, kSeed + 1);
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb * filtered);
+    knowhere::BitsetView bitset(bitset_data.data(), nb);
+
+    std::vector<knowhere::Index<knowhere::IndexNode>> indexes;
+    std::vector<knowhere::BitsetView> bitsets;
+    for (size_t s = 0; s + 1 < bounds.size(); s++) {
+        const int64_t rows = bounds[s + 1] - bounds[s];
+        auto segment_ds = knowhere::GenDataSet(rows, dim, (const float*)train_ds->GetTensor() + bounds[s] * dim);
+        auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_FAISS_IDMAP);
+        REQUIRE(idx.Build(*segment_ds, json) == knowhere::Status::success);
+        indexes.push_back(idx);
+        bitsets.emplace_back(bitset_data.data() + bounds[s] / 8, rows);
+    }
+
+    auto check = [&](const int64_t* ids, const float* distances, const knowhere::BitsetView& filter) {
+        auto gt = knowhere::BruteForce::Search(train_ds, query_ds, json, filter);
+        REQUIRE(gt.has_value());
+        for (int64_t i = 0; i < nq * k; i++) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(ids[i] < nb);
+            REQUIRE(!filter.test(ids[i]));
+            REQUIRE(distances[i] == Approx(gt.value()->GetDistance()[i]).epsilon(0.0001));
+        }
+    };
+
+    SECTION("Test Search") {
+        auto res = knowhere::MultiIndexSearch::Search(indexes, *query_ds, json,
+                                                      filtered > 0 ? bitsets : std::vector<knowhere::BitsetView>{});
+        REQUIRE(res.has_value());
+        REQUIRE(res.value()->GetRows() == nq);
+        REQUIRE(res.value()->GetDim() == k);
+        check(res.value()->GetIds(), res.value()->GetDistance(), bitset);
+    }
+
+    SECTION("Test Search With A Fully Filtered Segment") {
+        for (int64_t i = bounds[1]; i < bounds[2]; i++) {
+            bitset_data[i >> 3] |= (0x1 << (i & 0x7));
+        }
+        std::vector<int64_t> ids(nq * k);
+        std::vector<float> distances(nq * k);
+        REQUIRE(knowhere::MultiIndexSearch::SearchWithBuf(indexes, *query_ds, json, bitsets, ids.data(),
+                                                          distances.data()) == knowhere::Status::success);
+        check(ids.data(), distances.data(), bitset);
+    }
+
+    SECTION("Test Invalid Args") {
+        REQUIRE(!knowhere::MultiIndexSearch::Search({}, *query_ds, json, {}).has_value());
+        REQUIRE(!knowhere::MultiIndexSearch::Search(indexes, *query_ds, json, {bitset}).has_value());
+
+        // a FLAT_FP16 segment takes 16-bit queries, which cannot come in the same tensor as the float ones
+        std::vector<uint16_t> half_data(bounds[1] * dim, 0);
+        auto half_ds = knowhere::GenDataSet(bounds[1], dim, half_data.data());
+        auto half_idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16);
+        REQUIRE(half_idx.Build(*half_ds, json) == knowhere::Status::success);
+        auto mixed = indexes;
+        mixed.push_back(half_idx);
+        auto res = knowhere::MultiIndexSearch::Search(mixed, *query_ds, json, {});
+        REQUIRE(!res.has_value());
+        REQUIRE(res.error() == knowhere::Status::invalid_args);
+    }
+}
@@ -13,7 +13,11 @@
 #include <string>
 
 #include "catch2/catch_test_macros.hpp"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/factory.h"
 #include "knowhere/prometheus_client.h"
+#include "utils.h"
 
 TEST_CASE("Test prometheus client", "[prometheus client]") {
     SECTION("check get metrics") {
@@ -22,3 +26,43 @@ TEST_CASE("Test prometheus client", "[prometheus client]") {
         CHECK(str.length() >= 0);
     }
 }
+
+TEST_CASE("Test search stats", "[prometheus client]") {
+    const int64_t nb = 1000, nq = 10, dim = 16;
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+    knowhere::Json json = {
+        {knowhere::meta::DIM, dim},
+        {knowhere::meta::METRIC_TYPE, knowhere::metric::L2},
+        {knowhere::meta::TOPK, 10},
+        {knowhere::meta::RADIUS, 10.0},
+        {knowhere::indexparam::NLIST, 16},
+        {knowhere::indexparam::NPROBE, 4},
+        {knowhere::indexparam::HNSW_M, 16},
+        {knowhere::indexparam::EFCONSTRUCTION, 64},
+        {knowhere::indexparam::EF, 32},
+    };
+
+    const double default_rate = knowhere::KnowhereConfig::GetSearchStatsSampleRate();
+    knowhere::KnowhereConfig::SetSearchStatsSampleRate(1.0);
+    for (const auto& name : {knowhere::IndexEnum::INDEX_FAISS_IDMAP, knowhere::IndexEnum::INDEX_FAISS_IVFSQ8,
+                             knowhere::IndexEnum::INDEX_HNSW}) {
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        REQUIRE(idx.Search(*query_ds, json, nullptr).has_value());
+        REQUIRE(idx.RangeSearch(*query_ds, json, nullptr).has_value());
+    }
+    knowhere::KnowhereConfig::SetSearchStatsSampleRate(default_rate);
+
+    auto str = knowhere::prometheusClient->GetMetrics();
+    for (const auto& series : {
+             R"(counter="distance_computations",index_type="FLAT",method="search")",
+             R"(index_type="IVF_SQ8",method="search",stage="quantize")",
+             R"(counter="lists_scanned",index_type="IVF_SQ8",method="range_search")",
+             R"(counter="hops",index_type="HNSW",method="search")",
+             R"(index_type="HNSW",method="range_search",stage="parse")",
+         }) {
+        CAPTURE(series);
+        CHECK(str.find(series) != std::string::npos);
+    }
+}
@@ -9,6 +9,8 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <thread>
+
 #include "catch2/catch_test_macros.hpp"
 #include "common/range_util.h"
 #include "knowhere/factory.h"
@@ -186,3 +188,61 @@ TEST_CASE("Test GetRangeSearchResult for Faiss", "[range search]") {
         }
     }
 }
+
+TEST_CASE("Test RangeSearchResultArena", "[range search]") {
+    const int64_t nq = 100;
+    const int64_t label_min = 0, label_max = 10000;
+    const float dist_min = 0.0, dist_max = 100.0;
+    std::vector<std::vector<int64_t>> gen_labels;
+    std::vector<std::vector<float>> gen_distances;
+    GenRangeSearchResult(gen_labels, gen_distances, nq, label_min, label_max, dist_min, dist_max);
+
+    auto check = [&](const knowhere::DataSet& result, const float radius, const float range_filter) {
+        auto lims = result.GetLims();
+        auto ids = result.GetIds();
+        auto distances = result.GetDistance();
+        REQUIRE(lims[nq] == CountValidRangeSearchResult(gen_distances, radius, range_filter, false));
+        for (int64_t i = 0; i < nq; i++) {
+            size_t pos = lims[i];
+            for (size_t j = 0; j < gen_labels[i].size(); j++) {
+                if (knowhere::distance_in_range(gen_distances[i][j], radius, range_filter, false)) {
+                    REQUIRE(pos < lims[i + 1]);
+                    REQUIRE(ids[pos] == gen_labels[i][j]);
+                    REQUIRE(distances[pos] == gen_distances[i][j]);
+                    pos++;
+                }
+            }
+            REQUIRE(pos == lims[i + 1]);
+        }
+    };
+
+    const float radius = 50.0, range_filter = 10.0;
+    SECTION("single writer in order") {
+        knowhere::RangeSearchResultArena arena(nq, false, radius, range_filter);
+        for (int64_t i = 0; i < nq; i++) {
+            knowhere::RangeSearchResultArena::Writer(arena, i)
+                .Add(gen_labels[i].data(), gen_distances[i].data(), gen_labels[i].size());
+        }
+        check(*arena.GenResultDataSet(), radius, range_filter);
+    }
+
+    SECTION("concurrent writers out of order") {
+        knowhere::RangeSearchResultArena arena(nq, false, radius, range_filter);
+        std::vector<std::thread> threads;
+        const int64_t num_threads = 4;
+        for (int64_t t = 0; t < num_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int64_t i = nq - 1 - t; i >= 0; i -= num_threads) {
+                    knowhere::RangeSearchResultArena::Writer writer(arena, i);
+                    for (size_t j = 0; j < gen_labels[i].size(); j++) {
+                        writer.Add(gen_labels[i][j], gen_distances[i][j]);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        check(*arena.GenResultDataSet(), radius, range_filter);
+    }
+}
@@ -9,6 +9,11 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <sched.h>
+
+#include <filesystem>
+#include <fstream>
+
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
@@ -18,8 +23,11 @@
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_config.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/thread_pool.h"
 #include "knowhere/factory.h"
 #include "knowhere/log.h"
+#include "simd/fp16.h"
 #include "utils.h"
 
 namespace {
@@ -77,6 +85,19 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto ivfpqfs_refine_gen = [&ivfflat_gen](const std::string& refine_type) {
+        return [&ivfflat_gen, refine_type]() {
+            knowhere::Json json = ivfflat_gen();
+            json[knowhere::indexparam::REFINE_TYPE] = refine_type;
+            json[knowhere::indexparam::REORDER_K] = 100;
+            return json;
+        };
+    };
+    auto ivfpqfs_gen = ivfpqfs_refine_gen("FLAT");
+    auto ivfpqfs_none_gen = ivfpqfs_refine_gen("NONE");
+    auto ivfpqfs_sq8_gen = ivfpqfs_refine_gen("SQ8");
+    auto ivfpqfs_fp16_gen = ivfpqfs_refine_gen("FP16");
+
     auto hnsw_gen = [&base_gen]() {
         knowhere::Json json = base_gen();
         json[knowhere::indexparam::HNSW_M] = 128;
@@ -110,14 +131,25 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
 
     SECTION("Test Search") {
         using std::make_tuple;
-        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
-            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        auto [name, gen, threshold] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>, float>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen, kKnnRecallThreshold),
+            // 16 levels per component blur the small integers of the data set, the recall stays around 0.2-0.3
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4, ivfsq_gen, 0.15f),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ6, ivfsq_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFP16, ivfsq_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFBF16, ivfsq_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_gen, kKnnRecallThreshold),
+            // without a refine the 4-bit codes alone rank the candidates
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_none_gen, 0.5f),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_sq8_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_fp16_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen, kKnnRecallThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen, kKnnRecallThreshold),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create(name);
         auto cfg_json = gen().dump();
@@ -134,7 +166,7 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         REQUIRE(results.has_value());
         float recall = GetKNNRecall(*gt.value(), *results.value());
         if (name != "IVF_PQ") {
-            REQUIRE(recall > kKnnRecallThreshold);
+            REQUIRE(recall > threshold);
         }
     }
 
@@ -145,9 +177,18 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ6, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFP16, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFBF16, ivfsq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_none_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_fp16_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create(name);
         auto cfg_json = gen().dump();
@@ -162,17 +203,86 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         REQUIRE(results.has_value());
         auto ids = results.value()->GetIds();
         auto lims = results.value()->GetLims();
-        if (name != "IVF_PQ" && name != "SCANN") {
+        if (name != "IVF_PQ" && name != "SCANN" && name != "IVF_PQ_FS" && name != "IVF_SQ4") {
             for (int i = 0; i < nq; ++i) {
                 CHECK(ids[lims[i]] == i);
             }
         }
     }
 
+    SECTION("Test Search with Compiled Params") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+
+        auto params = idx.CompileSearchParams(json);
+        REQUIRE(params.has_value());
+        auto results = idx.Search(*query_ds, *params.value(), nullptr);
+        REQUIRE(results.has_value());
+        // the json overload goes through the params cache, the second call hits it
+        for (int i = 0; i < 2; ++i) {
+            auto json_results = idx.Search(*query_ds, json, nullptr);
+            REQUIRE(json_results.has_value());
+            for (int64_t j = 0; j < nq * topk; ++j) {
+                REQUIRE(json_results.value()->GetIds()[j] == results.value()->GetIds()[j]);
+            }
+        }
+
+        auto range_params = idx.CompileSearchParams(json, knowhere::PARAM_TYPE::RANGE_SEARCH);
+        REQUIRE(range_params.has_value());
+        REQUIRE(idx.RangeSearch(*query_ds, *range_params.value(), nullptr).has_value());
+        REQUIRE(idx.Search(*query_ds, *range_params.value(), nullptr).error() == knowhere::Status::invalid_args);
+
+        auto bad_json = json;
+        bad_json[knowhere::meta::TOPK] = -1;
+        REQUIRE_FALSE(idx.CompileSearchParams(bad_json).has_value());
+        REQUIRE_FALSE(idx.Search(*query_ds, bad_json, nullptr).has_value());
+    }
+
+    SECTION("Test Search with Buffer") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+
+        auto results = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        std::vector<int64_t> ids(nq * topk);
+        std::vector<float> distances(nq * topk);
+        REQUIRE(idx.SearchWithBuf(*query_ds, json, nullptr, ids.data(), distances.data()) ==
+                knowhere::Status::success);
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(ids[i] == results.value()->GetIds()[i]);
+            REQUIRE(distances[i] == Approx(results.value()->GetDistance()[i]));
+        }
+
+        auto range_params = idx.CompileSearchParams(json, knowhere::PARAM_TYPE::RANGE_SEARCH);
+        REQUIRE(range_params.has_value());
+        REQUIRE(idx.SearchWithBuf(*query_ds, *range_params.value(), nullptr, ids.data(), distances.data()) ==
+                knowhere::Status::invalid_args);
+    }
+
     SECTION("Test Search with Bitset") {
         using std::make_tuple;
         auto [name, gen, threshold] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>, float>({
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen, hnswlib::kHnswSearchKnnBFThreshold),
+            // no brute force fallback, the refine keeps the recall of a filtered search
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_gen, 1.0f),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create(name);
         auto cfg_json = gen().dump();
@@ -200,6 +310,205 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         }
     }
 
+    SECTION("Test IVF Batched Search") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        if (name == knowhere::IndexEnum::INDEX_FAISS_IVFFLAT) {
+            load_raw_data(idx, *train_ds, json);
+        }
+
+        // a batch scans each list once for all its queries, it must return what the queries get one by one
+        const int64_t batch_nq = 64;
+        const auto batch_ds = GenDataSet(batch_nq, dim, 7);
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto results = idx.Search(*batch_ds, json, bitset);
+        REQUIRE(results.has_value());
+        auto xq = (const float*)batch_ds->GetTensor();
+        for (int64_t i = 0; i < batch_nq; ++i) {
+            auto single = idx.Search(*knowhere::GenDataSet(1, dim, xq + i * dim), json, bitset);
+            REQUIRE(single.has_value());
+            for (int64_t j = 0; j < topk; ++j) {
+                REQUIRE(results.value()->GetIds()[i * topk + j] == single.value()->GetIds()[j]);
+                REQUIRE(results.value()->GetDistance()[i * topk + j] ==
+                        Approx(single.value()->GetDistance()[j]).epsilon(0.0001));
+            }
+        }
+    }
+
+    SECTION("Test HNSW with Optimized Layout") {
+        auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::indexparam::OPTIMIZE_LAYOUT] = true;
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+
+        auto results = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+
+        // the bitset and the returned ids are in terms of the original row ids
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 2);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto filtered = idx.Search(*query_ds, json, bitset);
+        REQUIRE(filtered.has_value());
+        auto filtered_gt = knowhere::BruteForce::Search(train_ds, query_ds, json, bitset);
+        REQUIRE(GetKNNRecall(*filtered_gt.value(), *filtered.value()) > kKnnRecallThreshold);
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            auto id = filtered.value()->GetIds()[i];
+            REQUIRE((id == -1 || !bitset.test(id)));
+        }
+
+        auto ids_ds = GenIdsDataSet(nb, nq);
+        auto vectors = idx.GetVectorByIds(*ids_ds);
+        REQUIRE(vectors.has_value());
+        auto xb = (const float*)train_ds->GetTensor();
+        auto xv = (const float*)vectors.value()->GetTensor();
+        for (int64_t i = 0; i < nq; ++i) {
+            auto id = ids_ds->GetIds()[i];
+            for (int64_t j = 0; j < dim; ++j) {
+                REQUIRE(xv[i * dim + j] == xb[id * dim + j]);
+            }
+        }
+
+        // the renumbering is persisted
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto idx_ = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        REQUIRE(idx_.Deserialize(bs) == knowhere::Status::success);
+        auto loaded_results = idx_.Search(*query_ds, json, nullptr);
+        REQUIRE(loaded_results.has_value());
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(loaded_results.value()->GetIds()[i] == results.value()->GetIds()[i]);
+        }
+
+        // the label map comes after a trailer magic and its flag, other bytes after the link lists are rejected
+        auto binary = bs.GetByName(knowhere::IndexEnum::INDEX_HNSW);
+        const int64_t trailer_size = 2 * sizeof(uint32_t) + sizeof(size_t) + nb * sizeof(uint32_t);
+        REQUIRE(binary->size > trailer_size);
+        std::shared_ptr<uint8_t[]> corrupted(new uint8_t[binary->size]);
+        memcpy(corrupted.get(), binary->data.get(), binary->size);
+        corrupted[binary->size - trailer_size] ^= 0xff;
+        knowhere::BinarySet corrupted_bs;
+        corrupted_bs.Append(knowhere::IndexEnum::INDEX_HNSW, corrupted, binary->size);
+        auto corrupted_idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        REQUIRE(corrupted_idx.Deserialize(corrupted_bs) == knowhere::Status::hnsw_inner_error);
+    }
+
+    SECTION("Test HNSW Query Group") {
+        knowhere::Json json = hnsw_gen();
+        // without the entry point cache both paths start from the same entry point and visit the same nodes
+        json[knowhere::indexparam::ENTRY_CACHE_SIZE] = 0;
+        auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, nb / 4);
+        auto use_bitset = GENERATE(false, true);
+        knowhere::BitsetView bitset = use_bitset ? knowhere::BitsetView(bitset_data.data(), nb) : knowhere::BitsetView();
+        auto results = idx.Search(*query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        for (int group_size : {4, 16}) {
+            json[knowhere::indexparam::QUERY_GROUP_SIZE] = group_size;
+            auto group_results = idx.Search(*query_ds, json, bitset);
+            REQUIRE(group_results.has_value());
+            for (int64_t i = 0; i < nq * topk; ++i) {
+                REQUIRE(group_results.value()->GetIds()[i] == results.value()->GetIds()[i]);
+                REQUIRE(group_results.value()->GetDistance()[i] == results.value()->GetDistance()[i]);
+            }
+        }
+    }
+
+    SECTION("Test HNSW Search On A NUMA Node Pool") {
+        // indexes are only placed on a machine with several usable nodes
+        const auto& nodes = knowhere::Numa::Nodes();
+        if (nodes.size() < 2) {
+            WARN("a single NUMA node, skip the node pool search");
+            return;
+        }
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::indexparam::ENTRY_CACHE_SIZE] = 0;
+        auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        auto results = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+
+        const auto global_size = knowhere::ThreadPool::GetGlobalSearchThreadPool()->size();
+        const auto policy_before = knowhere::KnowhereConfig::GetNumaPolicy();
+        const auto threads_before = knowhere::KnowhereConfig::GetNumaSearchThreads();
+        knowhere::KnowhereConfig::SetNumaPolicy(knowhere::KnowhereConfig::NumaPolicy::NUMA_LOCAL);
+        knowhere::KnowhereConfig::SetNumaSearchThreads(nodes.size());
+
+        // the loaded index lives on a node and its searches go to the pool of that node
+        auto placed = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        REQUIRE(placed.Deserialize(bs, json) == knowhere::Status::success);
+        auto placed_results = placed.Search(*query_ds, json, nullptr);
+
+        const int node = nodes.front();
+        const auto& node_cpus = knowhere::Numa::NodeCpus(node);
+        auto pool = knowhere::ThreadPool::GetSearchThreadPool(node);
+        int cpu = -1;
+        auto fut = pool->push([&]() {
+            // the search runs on the node thread rather than queueing its own tasks behind this one
+            knowhere::ThreadPool::ScopedInline scoped_inline;
+            cpu = sched_getcpu();
+            return idx.Search(*query_ds, json, nullptr);
+        });
+        auto node_results = std::move(fut).get();
+
+        knowhere::KnowhereConfig::SetNumaSearchThreads(threads_before);
+        knowhere::KnowhereConfig::SetNumaPolicy(policy_before);
+
+        // the node pools come on top of the global one
+        REQUIRE(pool != knowhere::ThreadPool::GetGlobalSearchThreadPool());
+        REQUIRE(knowhere::ThreadPool::GetGlobalSearchThreadPool()->size() == global_size);
+        REQUIRE(std::find(node_cpus.begin(), node_cpus.end(), cpu) != node_cpus.end());
+        auto check = [&](const knowhere::expected<knowhere::DataSetPtr>& res) {
+            REQUIRE(res.has_value());
+            for (int64_t i = 0; i < nq * topk; ++i) {
+                REQUIRE(res.value()->GetIds()[i] == results.value()->GetIds()[i]);
+                REQUIRE(res.value()->GetDistance()[i] == results.value()->GetDistance()[i]);
+            }
+        };
+        check(placed_results);
+        check(node_results);
+    }
+
+    SECTION("Test HNSW Build Progress") {
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::meta::NUM_BUILD_THREAD] = 2;
+
+        auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        std::vector<float> reported;
+        idx.SetBuildProgressCallback([&](float done) {
+            reported.push_back(done);
+            return true;
+        });
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        REQUIRE(idx.Count() == nb);
+        REQUIRE_FALSE(reported.empty());
+        REQUIRE(std::is_sorted(reported.begin(), reported.end()));
+        REQUIRE(reported.back() <= 1.0f);
+        auto results = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+
+        auto cancelled = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_HNSW);
+        cancelled.SetBuildProgressCallback([](float) { return false; });
+        REQUIRE(cancelled.Build(*train_ds, json) == knowhere::Status::build_cancelled);
+        REQUIRE(cancelled.Count() == 0);
+        REQUIRE_FALSE(cancelled.Search(*query_ds, json, nullptr).has_value());
+    }
+
     SECTION("Test Serialize/Deserialize") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
@@ -207,7 +516,15 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ6, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFP16, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFBF16, ivfsq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_none_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_fp16_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
         }));
 
@@ -227,6 +544,144 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         }
         auto results = idx_.Search(*query_ds, json, nullptr);
         REQUIRE(results.has_value());
+        if (name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN) {
+            // the refine codec is read back with the fast scan index
+            auto expected = idx.Search(*query_ds, json, nullptr);
+            REQUIRE(expected.has_value());
+            for (int64_t i = 0; i < nq * topk; ++i) {
+                REQUIRE(results.value()->GetIds()[i] == expected.value()->GetIds()[i]);
+            }
+        }
+    }
+
+    SECTION("Test Zero-Copy Deserialize") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto expected = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(expected.has_value());
+
+        auto idx_ = knowhere::IndexFactory::Instance().Create(name);
+        knowhere::Json load_json = {{"enable_zero_copy", true}};
+        REQUIRE(idx_.Deserialize(bs, load_json) == knowhere::Status::success);
+        // the loaded index keeps the buffer alive on its own
+        auto binary = bs.GetByName(name);
+        std::vector<uint8_t> bytes(binary->data.get(), binary->data.get() + binary->size);
+        binary = nullptr;
+        bs.clear();
+        auto results = idx_.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(results.value()->GetIds()[i] == expected.value()->GetIds()[i]);
+            REQUIRE(results.value()->GetDistance()[i] == expected.value()->GetDistance()[i]);
+        }
+
+        // serializing it again gives back the same bytes
+        knowhere::BinarySet bs_;
+        REQUIRE(idx_.Serialize(bs_) == knowhere::Status::success);
+        auto binary_ = bs_.GetByName(name);
+        REQUIRE(binary_->size == (int64_t)bytes.size());
+        REQUIRE(memcmp(binary_->data.get(), bytes.data(), bytes.size()) == 0);
+    }
+
+    SECTION("Test IVF with a Shared Quantizer") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN, ivfpqfs_gen),
+        }));
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+
+        // train once, the trained and empty index is the shared quantizer
+        auto write_quantizer = [&](const std::string& index_type, const knowhere::Json& conf) {
+            auto quantizer = knowhere::IndexFactory::Instance().Create(index_type);
+            REQUIRE(quantizer.Train(*CopyDataSet(train_ds, nb), conf) == knowhere::Status::success);
+            knowhere::BinarySet bs;
+            REQUIRE(quantizer.Serialize(bs) == knowhere::Status::success);
+            auto binary = bs.GetByName(index_type);
+            const auto path = (std::filesystem::temp_directory_path() / ("quantizer_" + index_type)).string();
+            std::ofstream(path, std::ios::binary).write((const char*)binary->data.get(), binary->size);
+            return std::make_pair(quantizer, path);
+        };
+        auto [quantizer, path] = write_quantizer(name, json);
+
+        // trained on its own data, to compare the recall with
+        auto own = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(own.Build(*CopyDataSet(train_ds, nb), json) == knowhere::Status::success);
+        auto own_results = own.Search(*query_ds, json, nullptr);
+        REQUIRE(own_results.has_value());
+
+        json[knowhere::indexparam::QUANTIZER_PATH] = path;
+        // taken from the quantizer
+        json[knowhere::indexparam::NLIST] = 1;
+        auto idx = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(idx.Build(*train_ds, json) == knowhere::Status::success);
+        REQUIRE(idx.Count() == nb);
+        REQUIRE(!idx.QuantizerId().empty());
+        REQUIRE(idx.QuantizerId() == quantizer.QuantizerId());
+        auto segment = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(segment.Build(*CopyDataSet(train_ds, nb / 2), json) == knowhere::Status::success);
+        REQUIRE(segment.QuantizerId() == idx.QuantizerId());
+
+        if (name == knowhere::IndexEnum::INDEX_FAISS_IVFFLAT) {
+            load_raw_data(idx, *train_ds, json);
+            REQUIRE(idx.QuantizerId() == segment.QuantizerId());
+        }
+        auto results = idx.Search(*query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        float recall = GetKNNRecall(*gt.value(), *results.value());
+        // the quantizer was trained on the same data, so the recall is the one of a regular build
+        REQUIRE(recall == Approx(GetKNNRecall(*gt.value(), *own_results.value())).margin(0.05));
+        if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ) {
+            REQUIRE(recall > kKnnRecallThreshold);
+        }
+
+        // the quantizer has to match the data
+        auto other_dim = knowhere::IndexFactory::Instance().Create(name);
+        auto other_dim_json = json;
+        other_dim_json[knowhere::meta::DIM] = dim / 2;
+        REQUIRE(other_dim.Build(*GenDataSet(nb, dim / 2), other_dim_json) == knowhere::Status::invalid_args);
+
+        // and the metric, COSINE and IP are told apart by the fast scan indexes only
+        auto other_metric_json = json;
+        other_metric_json[knowhere::meta::METRIC_TYPE] =
+            metric == knowhere::metric::L2 ? knowhere::metric::COSINE : knowhere::metric::L2;
+        REQUIRE(knowhere::IndexFactory::Instance().Create(name).Build(*train_ds, other_metric_json) ==
+                knowhere::Status::invalid_args);
+        if (metric == knowhere::metric::COSINE && (name == knowhere::IndexEnum::INDEX_FAISS_SCANN ||
+                                                   name == knowhere::IndexEnum::INDEX_FAISS_IVFPQ_FASTSCAN)) {
+            other_metric_json[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+            REQUIRE(knowhere::IndexFactory::Instance().Create(name).Build(*train_ds, other_metric_json) ==
+                    knowhere::Status::invalid_args);
+        }
+
+        // and the index type
+        auto other_type = name == knowhere::IndexEnum::INDEX_FAISS_IVFSQ8 ? knowhere::IndexEnum::INDEX_FAISS_IVFPQ
+                                                                           : knowhere::IndexEnum::INDEX_FAISS_IVFSQ8;
+        auto other_type_path = write_quantizer(other_type, knowhere::Json::parse(ivfpq_gen().dump())).second;
+        auto other_type_json = json;
+        other_type_json[knowhere::indexparam::QUANTIZER_PATH] = other_type_path;
+        REQUIRE(knowhere::IndexFactory::Instance().Create(name).Build(*train_ds, other_type_json) ==
+                knowhere::Status::invalid_args);
+        std::filesystem::remove(other_type_path);
+        std::filesystem::remove(path);
     }
 
     SECTION("Test IVFPQ with invalid params") {
@@ -248,6 +703,123 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
     }
 }
 
+TEST_CASE("Test Mem Index With Half Precision Vector", "[float metrics]") {
+    const int64_t nb = 1000, nq = 10;
+    const int64_t dim = 128;
+    const int64_t topk = 5;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+
+    auto base_gen = [&]() {
+        knowhere::Json json;
+        json[knowhere::meta::DIM] = dim;
+        json[knowhere::meta::METRIC_TYPE] = metric;
+        json[knowhere::meta::TOPK] = topk;
+        json[knowhere::meta::RADIUS] = knowhere::IsMetricType(metric, knowhere::metric::L2) ? 10.0 : 0.99;
+        json[knowhere::meta::RANGE_FILTER] = knowhere::IsMetricType(metric, knowhere::metric::L2) ? 0.0 : 1.01;
+        return json;
+    };
+
+    auto flat_gen = base_gen;
+
+    auto hnsw_gen = [&base_gen]() {
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::HNSW_M] = 32;
+        json[knowhere::indexparam::EFCONSTRUCTION] = 200;
+        json[knowhere::indexparam::EF] = 64;
+        return json;
+    };
+
+    // the generated components are small integers, which fp16 and bf16 hold exactly
+    auto to_half = [](const knowhere::DataSet& ds, bool is_bf16) {
+        auto rows = ds.GetRows();
+        auto dim = ds.GetDim();
+        auto x = (const float*)ds.GetTensor();
+        uint16_t* ts = new uint16_t[rows * dim];
+        for (int64_t i = 0; i < rows * dim; ++i) {
+            ts[i] = is_bf16 ? faiss::fp32_to_bf16(x[i]) : faiss::fp32_to_fp16(x[i]);
+        }
+        auto half_ds = knowhere::GenDataSet(rows, dim, ts);
+        half_ds->SetIsOwner(true);
+        return half_ds;
+    };
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = GenDataSet(nq, dim);
+
+    const knowhere::Json conf = {
+        {knowhere::meta::METRIC_TYPE, metric},
+        {knowhere::meta::TOPK, topk},
+    };
+    auto gt = knowhere::BruteForce::Search(train_ds, query_ds, conf, nullptr);
+
+    using std::make_tuple;
+    auto [name, gen, is_bf16] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>, bool>({
+        make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16, flat_gen, false),
+        make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP_BF16, flat_gen, true),
+        make_tuple(knowhere::IndexEnum::INDEX_HNSW_FP16, hnsw_gen, false),
+        make_tuple(knowhere::IndexEnum::INDEX_HNSW_BF16, hnsw_gen, true),
+    }));
+    const bool is_flat = name == knowhere::IndexEnum::INDEX_FAISS_IDMAP_FP16 ||
+                         name == knowhere::IndexEnum::INDEX_FAISS_IDMAP_BF16;
+    const auto half_train_ds = to_half(*train_ds, is_bf16);
+    const auto half_query_ds = to_half(*query_ds, is_bf16);
+
+    auto idx = knowhere::IndexFactory::Instance().Create(name);
+    auto cfg_json = gen().dump();
+    CAPTURE(name, cfg_json);
+    knowhere::Json json = knowhere::Json::parse(cfg_json);
+    REQUIRE(idx.Type() == name);
+    REQUIRE(idx.Build(*half_train_ds, json) == knowhere::Status::success);
+    REQUIRE(idx.Count() == nb);
+
+    SECTION("Test Search") {
+        REQUIRE(idx.Size() > 0);
+        auto results = idx.Search(*half_query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        float recall = GetKNNRecall(*gt.value(), *results.value());
+        REQUIRE(recall > (is_flat ? kBruteForceRecallThreshold : kKnnRecallThreshold));
+    }
+
+    SECTION("Test Range Search") {
+        if (!is_flat) {
+            return;
+        }
+        auto results = idx.RangeSearch(*half_query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        auto lims = results.value()->GetLims();
+        // the queries are the first base vectors
+        for (int i = 0; i < nq; ++i) {
+            CHECK(std::find(ids + lims[i], ids + lims[i + 1], i) != ids + lims[i + 1]);
+        }
+    }
+
+    SECTION("Test Serialize/Deserialize") {
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+
+        auto idx_ = knowhere::IndexFactory::Instance().Create(name);
+        REQUIRE(idx_.Deserialize(bs) == knowhere::Status::success);
+        auto results = idx_.Search(*half_query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        float recall = GetKNNRecall(*gt.value(), *results.value());
+        REQUIRE(recall > (is_flat ? kBruteForceRecallThreshold : kKnnRecallThreshold));
+
+        if (idx_.HasRawData(metric)) {
+            auto ids_ds = GenIdsDataSet(nb, nq);
+            auto vectors = idx_.GetVectorByIds(*ids_ds);
+            REQUIRE(vectors.has_value());
+            auto ids = ids_ds->GetIds();
+            auto x = (const uint16_t*)half_train_ds->GetTensor();
+            auto y = (const uint16_t*)vectors.value()->GetTensor();
+            for (int64_t i = 0; i < nq; ++i) {
+                REQUIRE(std::equal(y + i * dim, y + (i + 1) * dim, x + ids[i] * dim));
+            }
+        }
+    }
+}
+
 TEST_CASE("Test Mem Index With Binary Vector", "[float metrics]") {
     using Catch::Approx;
 
@@ -12,9 +12,16 @@
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "common/prepared_bitset.h"
 #include "knowhere/comp/brute_force.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_config.h"
+#include "simd/distances_ref.h"
+#if defined(__x86_64__)
+#include "simd/distances_avx512.h"
+#endif
+#include "simd/fp16.h"
+#include "simd/hook.h"
 #include "utils.h"
 
 TEST_CASE("Test BruteForce Search SIMD", "[bf]") {
@@ -60,6 +67,246 @@ TEST_CASE("Test BruteForce Search SIMD", "[bf]") {
     }
 }
 
+TEST_CASE("Test Batched Distance SIMD", "[distance]") {
+    using Catch::Approx;
+
+    const size_t ny = 37;
+    auto dim = GENERATE(as<size_t>{}, 3, 96, 127, 128, 384, 768, 1024);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+    std::vector<float> x(dim), y(dim * ny), a(dim * ny);
+    for (auto& v : x) {
+        v = distrib(rng);
+    }
+    for (auto& v : y) {
+        v = distrib(rng);
+    }
+    for (auto& v : a) {
+        v = distrib(rng);
+    }
+
+    std::vector<float> l2_gold(ny), ip_gold(ny), madd_gold(dim * ny);
+    faiss::fvec_L2sqr_ny_ref(l2_gold.data(), x.data(), y.data(), dim, ny);
+    faiss::fvec_inner_products_ny_ref(ip_gold.data(), x.data(), y.data(), dim, ny);
+    float norm_gold = faiss::fvec_norm_L2sqr_ref(y.data(), dim * ny);
+    int argmin_gold = faiss::fvec_madd_and_argmin_ref(dim * ny, a.data(), -2.0f, y.data(), madd_gold.data());
+
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX512, knowhere::KnowhereConfig::SimdType::AVX2,
+                           knowhere::KnowhereConfig::SimdType::SSE4_2, knowhere::KnowhereConfig::SimdType::GENERIC,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        std::vector<float> dis(ny), madd(dim * ny);
+        faiss::fvec_L2sqr_ny(dis.data(), x.data(), y.data(), dim, ny);
+        for (size_t i = 0; i < ny; i++) {
+            REQUIRE(dis[i] == Approx(l2_gold[i]).epsilon(0.0001));
+        }
+        faiss::fvec_inner_products_ny(dis.data(), x.data(), y.data(), dim, ny);
+        for (size_t i = 0; i < ny; i++) {
+            REQUIRE(dis[i] == Approx(ip_gold[i]).epsilon(0.0001).margin(0.0001));
+        }
+        REQUIRE(faiss::fvec_norm_L2sqr(y.data(), dim * ny) == Approx(norm_gold).epsilon(0.0001));
+        // unaligned inputs and lengths
+        faiss::fvec_madd(dim * ny - 1, a.data() + 1, -2.0f, y.data() + 1, madd.data() + 1);
+        for (size_t i = 1; i < dim * ny; i++) {
+            REQUIRE(madd[i] == Approx(madd_gold[i]).epsilon(0.0001).margin(0.0001));
+        }
+        REQUIRE(faiss::fvec_madd_and_argmin(dim * ny, a.data(), -2.0f, y.data(), madd.data()) == argmin_gold);
+    }
+}
+
+TEST_CASE("Test Half Precision Distance SIMD", "[distance]") {
+    using Catch::Approx;
+
+    auto dim = GENERATE(as<size_t>{}, 1, 7, 31, 33, 96, 127, 128, 768);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+    std::vector<uint16_t> x_fp16(dim), y_fp16(dim), x_bf16(dim), y_bf16(dim);
+    for (size_t i = 0; i < dim; i++) {
+        x_fp16[i] = faiss::fp32_to_fp16(distrib(rng));
+        y_fp16[i] = faiss::fp32_to_fp16(distrib(rng));
+        x_bf16[i] = faiss::fp32_to_bf16(distrib(rng));
+        y_bf16[i] = faiss::fp32_to_bf16(distrib(rng));
+    }
+
+    // the halves widen exactly, so the float kernels over the widened vectors are the reference
+    std::vector<float> x_fp16_f(dim), y_fp16_f(dim), x_bf16_f(dim), y_bf16_f(dim);
+    for (size_t i = 0; i < dim; i++) {
+        x_fp16_f[i] = faiss::fp16_to_fp32(x_fp16[i]);
+        y_fp16_f[i] = faiss::fp16_to_fp32(y_fp16[i]);
+        x_bf16_f[i] = faiss::bf16_to_fp32(x_bf16[i]);
+        y_bf16_f[i] = faiss::bf16_to_fp32(y_bf16[i]);
+    }
+    REQUIRE(faiss::fp16_vec_L2sqr_ref(x_fp16.data(), y_fp16.data(), dim) ==
+            Approx(faiss::fvec_L2sqr_ref(x_fp16_f.data(), y_fp16_f.data(), dim)).epsilon(0.0001));
+    const float bf16_ip_float = faiss::fvec_inner_product_ref(x_bf16_f.data(), y_bf16_f.data(), dim);
+    REQUIRE(faiss::bf16_vec_inner_product_ref(x_bf16.data(), y_bf16.data(), dim) ==
+            Approx(bf16_ip_float).epsilon(0.0001).margin(0.0001));
+
+    const float fp16_l2_gold = faiss::fp16_vec_L2sqr_ref(x_fp16.data(), y_fp16.data(), dim);
+    const float fp16_ip_gold = faiss::fp16_vec_inner_product_ref(x_fp16.data(), y_fp16.data(), dim);
+    const float fp16_norm_gold = faiss::fp16_vec_norm_L2sqr_ref(x_fp16.data(), dim);
+    const float bf16_l2_gold = faiss::bf16_vec_L2sqr_ref(x_bf16.data(), y_bf16.data(), dim);
+    const float bf16_ip_gold = faiss::bf16_vec_inner_product_ref(x_bf16.data(), y_bf16.data(), dim);
+    const float bf16_norm_gold = faiss::bf16_vec_norm_L2sqr_ref(x_bf16.data(), dim);
+
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX512, knowhere::KnowhereConfig::SimdType::AVX2,
+                           knowhere::KnowhereConfig::SimdType::SSE4_2, knowhere::KnowhereConfig::SimdType::GENERIC,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        REQUIRE(faiss::fp16_vec_L2sqr(x_fp16.data(), y_fp16.data(), dim) == Approx(fp16_l2_gold).epsilon(0.0001));
+        REQUIRE(faiss::fp16_vec_inner_product(x_fp16.data(), y_fp16.data(), dim) ==
+                Approx(fp16_ip_gold).epsilon(0.0001).margin(0.0001));
+        REQUIRE(faiss::fp16_vec_norm_L2sqr(x_fp16.data(), dim) == Approx(fp16_norm_gold).epsilon(0.0001));
+        REQUIRE(faiss::bf16_vec_L2sqr(x_bf16.data(), y_bf16.data(), dim) == Approx(bf16_l2_gold).epsilon(0.0001));
+        REQUIRE(faiss::bf16_vec_inner_product(x_bf16.data(), y_bf16.data(), dim) ==
+                Approx(bf16_ip_gold).epsilon(0.0001).margin(0.0001));
+        REQUIRE(faiss::bf16_vec_norm_L2sqr(x_bf16.data(), dim) == Approx(bf16_norm_gold).epsilon(0.0001));
+    }
+}
+
+TEST_CASE("Test SQ8 Code Distance SIMD", "[distance]") {
+    auto dim = GENERATE(as<size_t>{}, 1, 15, 16, 33, 64, 100, 768);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> distrib(0, 255);
+    std::vector<uint8_t> x(dim), y(dim);
+    for (size_t i = 0; i < dim; i++) {
+        x[i] = distrib(rng);
+        y[i] = distrib(rng);
+    }
+    int32_t l2_gold = 0, ip_gold = 0;
+    for (size_t i = 0; i < dim; i++) {
+        l2_gold += (int32_t(x[i]) - y[i]) * (int32_t(x[i]) - y[i]);
+        ip_gold += int32_t(x[i]) * y[i];
+    }
+
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX512, knowhere::KnowhereConfig::SimdType::AVX2,
+                           knowhere::KnowhereConfig::SimdType::SSE4_2, knowhere::KnowhereConfig::SimdType::GENERIC,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        REQUIRE(faiss::u8_vec_L2sqr(x.data(), y.data(), dim) == l2_gold);
+        REQUIRE(faiss::u8_vec_inner_product(x.data(), y.data(), dim) == ip_gold);
+    }
+
+#if defined(__x86_64__)
+    // AUTO picks the VNNI kernels where the CPU has them, which leaves the plain AVX512 ones to be checked directly
+    if (faiss::cpu_support_avx512()) {
+        REQUIRE(faiss::u8_vec_L2sqr_avx512(x.data(), y.data(), dim) == l2_gold);
+        REQUIRE(faiss::u8_vec_inner_product_avx512(x.data(), y.data(), dim) == ip_gold);
+    }
+    if (faiss::cpu_support_avx512_vnni()) {
+        REQUIRE(faiss::u8_vec_L2sqr_avx512vnni(x.data(), y.data(), dim) == l2_gold);
+        REQUIRE(faiss::u8_vec_inner_product_avx512vnni(x.data(), y.data(), dim) == ip_gold);
+    }
+#endif
+}
+
+TEST_CASE("Test Binary Distance SIMD", "[distance]") {
+    auto code_size = GENERATE(as<size_t>{}, 1, 7, 8, 31, 64, 100, 128, 256, 512);
+    const size_t ny = 37;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> distrib(0, 255);
+    std::vector<uint8_t> x(code_size), y(code_size * ny);
+    for (auto& v : x) {
+        v = distrib(rng);
+    }
+    for (auto& v : y) {
+        v = distrib(rng) & distrib(rng);
+    }
+    // all-zero pairs, whose jaccard distance is defined as 1
+    std::vector<uint8_t> zero(code_size * ny, 0);
+    const std::vector<float> jaccard_zero(ny, 1.0f);
+
+    std::vector<int32_t> hamming_gold(ny), hamming(ny);
+    std::vector<float> jaccard_gold(ny), jaccard(ny);
+    faiss::bin_vec_hamming_ny_ref(hamming_gold.data(), x.data(), y.data(), code_size, ny);
+    faiss::bin_vec_jaccard_ny_ref(jaccard_gold.data(), x.data(), y.data(), code_size, ny);
+    REQUIRE(faiss::bin_vec_jaccard_ref(zero.data(), zero.data(), code_size) == 1.0f);
+
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX512, knowhere::KnowhereConfig::SimdType::AVX2,
+                           knowhere::KnowhereConfig::SimdType::SSE4_2, knowhere::KnowhereConfig::SimdType::GENERIC,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        faiss::bin_vec_hamming_ny(hamming.data(), x.data(), y.data(), code_size, ny);
+        faiss::bin_vec_jaccard_ny(jaccard.data(), x.data(), y.data(), code_size, ny);
+        REQUIRE(hamming == hamming_gold);
+        REQUIRE(jaccard == jaccard_gold);
+        for (size_t i = 0; i < ny; i++) {
+            REQUIRE(faiss::bin_vec_hamming(x.data(), y.data() + i * code_size, code_size) == hamming_gold[i]);
+            REQUIRE(faiss::bin_vec_jaccard(x.data(), y.data() + i * code_size, code_size) == jaccard_gold[i]);
+        }
+        REQUIRE(faiss::bin_vec_jaccard(zero.data(), zero.data(), code_size) == 1.0f);
+        faiss::bin_vec_jaccard_ny(jaccard.data(), zero.data(), zero.data(), code_size, ny);
+        REQUIRE(jaccard == jaccard_zero);
+    }
+
+#if defined(__x86_64__)
+    // AUTO picks the VPOPCNTDQ kernels where the CPU has them, so the plain AVX512 ones are checked directly
+    if (faiss::cpu_support_avx512()) {
+        faiss::bin_vec_hamming_ny_avx512(hamming.data(), x.data(), y.data(), code_size, ny);
+        faiss::bin_vec_jaccard_ny_avx512(jaccard.data(), x.data(), y.data(), code_size, ny);
+        REQUIRE(hamming == hamming_gold);
+        REQUIRE(jaccard == jaccard_gold);
+        faiss::bin_vec_jaccard_ny_avx512(jaccard.data(), zero.data(), zero.data(), code_size, ny);
+        REQUIRE(jaccard == jaccard_zero);
+        REQUIRE(faiss::bin_vec_hamming_avx512(x.data(), y.data(), code_size) == hamming_gold[0]);
+        REQUIRE(faiss::bin_vec_jaccard_avx512(x.data(), y.data(), code_size) == jaccard_gold[0]);
+    }
+    if (faiss::cpu_support_avx512_vpopcntdq()) {
+        faiss::bin_vec_hamming_ny_avx512vpopcntdq(hamming.data(), x.data(), y.data(), code_size, ny);
+        faiss::bin_vec_jaccard_ny_avx512vpopcntdq(jaccard.data(), x.data(), y.data(), code_size, ny);
+        REQUIRE(hamming == hamming_gold);
+        REQUIRE(jaccard == jaccard_gold);
+    }
+#endif
+}
+
+TEST_CASE("Test Bitset SIMD", "[bitset]") {
+    auto n = GENERATE(as<size_t>{}, 1, 63, 64, 255, 1000, 4099);
+    auto t = GENERATE(as<float>{}, 0.0f, 0.05f, 0.5f, 0.999f, 1.0f);
+    const size_t num_set = n * t;
+    auto data = GenerateBitsetWithRandomTbitsSet(n, num_set);
+    knowhere::BitsetView bitset(data.data(), n);
+
+    std::vector<int64_t> set_gold, unset_gold;
+    for (size_t i = 0; i < n; i++) {
+        (bitset.test(i) ? set_gold : unset_gold).push_back(i);
+    }
+    REQUIRE(bitset.count() == num_set);
+    std::vector<int64_t> visited;
+    bitset.for_each_set([&](int64_t id) { visited.push_back(id); });
+    REQUIRE(visited == set_gold);
+    visited.clear();
+    bitset.for_each_unset([&](int64_t id) { visited.push_back(id); });
+    REQUIRE(visited == unset_gold);
+
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX512, knowhere::KnowhereConfig::SimdType::AVX2,
+                           knowhere::KnowhereConfig::SimdType::SSE4_2, knowhere::KnowhereConfig::SimdType::GENERIC,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        REQUIRE(faiss::bitset_popcount(data.data(), n) == num_set);
+        std::vector<int64_t> ids(n);
+        ids.resize(faiss::bitset_to_ids(data.data(), n, true, ids.data()));
+        REQUIRE(ids == set_gold);
+        ids.resize(n);
+        ids.resize(faiss::bitset_to_ids(data.data(), n, false, ids.data()));
+        REQUIRE(ids == unset_gold);
+
+        // a prepared view of a selective filter visits the same ids from its id list instead of the bits
+        knowhere::PreparedBitset prepared(bitset);
+        const auto& listed = prepared.view();
+        REQUIRE(listed.has_cache());
+        REQUIRE(listed.count() == num_set);
+        const bool selective =
+            !unset_gold.empty() && unset_gold.size() * knowhere::PreparedBitset::kIdListRatio <= n;
+        REQUIRE(listed.has_id_list() == selective);
+        visited.clear();
+        listed.for_each_unset([&](int64_t id) { visited.push_back(id); });
+        REQUIRE(visited == unset_gold);
+    }
+}
+
 TEST_CASE("Test PQ Search SIMD", "[pq]") {
     using Catch::Approx;
 
@@ -110,3 +357,46 @@ TEST_CASE("Test PQ Search SIMD", "[pq]") {
         }
     }
 }
+
+TEST_CASE("Test SCANN Search SIMD", "[pq]") {
+    const int64_t nb = 2000;
+    const int64_t nq = 20;
+    const int64_t k = 10;
+
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP);
+    // dim / 2 sub-quantizers of 4 bits, with 100 the AVX-512 kernel has a pair left after its steps of 4
+    auto dim = GENERATE(as<int64_t>{}, 128, 100);
+
+    const auto train_ds = GenDataSet(nb, dim);
+    const auto query_ds = CopyDataSet(train_ds, nq);
+
+    knowhere::Json conf = {
+        {knowhere::meta::DIM, dim},        {knowhere::meta::METRIC_TYPE, metric}, {knowhere::meta::TOPK, k},
+        {knowhere::indexparam::NLIST, 16}, {knowhere::indexparam::NPROBE, 8},     {knowhere::indexparam::REORDER_K, 40},
+    };
+
+    knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+    auto idx = knowhere::IndexFactory::Instance().Create(knowhere::IndexEnum::INDEX_FAISS_SCANN);
+    REQUIRE(idx.Build(*train_ds, conf) == knowhere::Status::success);
+
+    // the fast-scan kernels of every simd type return the same neighbors and distances
+    std::vector<int64_t> ids;
+    std::vector<float> dists;
+    for (auto simd_type : {knowhere::KnowhereConfig::SimdType::AVX2, knowhere::KnowhereConfig::SimdType::AVX512,
+                           knowhere::KnowhereConfig::SimdType::AUTO}) {
+        knowhere::KnowhereConfig::SetSimdType(simd_type);
+        auto res = idx.Search(*query_ds, conf, nullptr);
+        REQUIRE(res.has_value());
+        auto res_ids = res.value()->GetIds();
+        auto res_dists = res.value()->GetDistance();
+        if (ids.empty()) {
+            ids.assign(res_ids, res_ids + nq * k);
+            dists.assign(res_dists, res_dists + nq * k);
+            continue;
+        }
+        for (int64_t i = 0; i < nq * k; i++) {
+            REQUIRE(res_ids[i] == ids[i]);
+            REQUIRE(res_dists[i] == dists[i]);
+        }
+    }
+}
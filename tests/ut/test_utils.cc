@@ -9,10 +9,13 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
+#include "common/clock_cache.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/heap.h"
 #include "knowhere/utils.h"
@@ -108,3 +111,80 @@ TEST_CASE("Test Time Recorder") {
     auto span = tr.ElapseFromBegin("done");
     REQUIRE(span > 0);
 }
+
+TEST_CASE("Test Clock Cache", "[utils]") {
+    SECTION("Put and get") {
+        knowhere::clock_cache<uint64_t, uint32_t> cache(1000);
+        for (uint64_t i = 0; i < 500; ++i) {
+            cache.put(i * 7919, i);
+        }
+        uint32_t val = 0;
+        for (uint64_t i = 0; i < 500; ++i) {
+            // far below capacity, nothing is evicted unless a set overflows
+            if (cache.try_get(i * 7919, val)) {
+                REQUIRE(val == i);
+            }
+        }
+        cache.put(7919, 42);
+        REQUIRE(cache.try_get(7919, val));
+        REQUIRE(val == 42);
+        cache.clear();
+        REQUIRE(!cache.try_get(7919, val));
+    }
+
+    SECTION("Disabled") {
+        knowhere::clock_cache<uint64_t, uint32_t> cache(0);
+        cache.put(1, 1);
+        uint32_t val = 0;
+        REQUIRE(cache.capacity() == 0);
+        REQUIRE(!cache.try_get(1, val));
+    }
+
+    SECTION("Allocated by the first put") {
+        knowhere::clock_cache<uint64_t, uint32_t> cache(1000);
+        uint32_t val = 0;
+        // clear and lookups before any put are fine and count as misses
+        cache.clear();
+        REQUIRE(!cache.try_get(1, val));
+        REQUIRE(cache.take_stats().misses == 1);
+        cache.put(1, 2);
+        REQUIRE(cache.try_get(1, val));
+        REQUIRE(val == 2);
+        // a reset drops the entries along with the slots, the next put allocates them again
+        cache.reset(2000);
+        REQUIRE(cache.capacity() >= 2000);
+        REQUIRE(!cache.try_get(1, val));
+        cache.put(1, 3);
+        REQUIRE(cache.try_get(1, val));
+        REQUIRE(val == 3);
+    }
+
+    SECTION("Concurrent") {
+        knowhere::clock_cache<uint64_t, uint32_t> cache(1000);
+        const int num_threads = 8, num_ops = 100000, num_keys = 3000;
+        std::atomic<int> mismatches{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (uint64_t i = 0; i < num_ops; ++i) {
+                    uint64_t key = (i * 31 + t) % num_keys;
+                    uint32_t val = 0;
+                    if (cache.try_get(key, val)) {
+                        mismatches += (val != key * 3);
+                    } else {
+                        cache.put(key, key * 3);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(mismatches == 0);
+        auto stats = cache.take_stats();
+        REQUIRE(stats.hits + stats.misses == (uint64_t)num_threads * num_ops);
+        REQUIRE(stats.hits > 0);
+        stats = cache.take_stats();
+        REQUIRE(stats.hits == 0);
+    }
+}
@@ -0,0 +1,174 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <limits>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "catch2/catch_test_macros.hpp"
+#include "hnswlib/visited_list_pool.h"
+
+TEST_CASE("Test Visited List Dense Epoch Wrap", "[visited list]") {
+    const size_t n = 1000;
+    std::atomic<int64_t> bytes{0};
+    hnswlib::VisitedList list(n, &bytes);
+    list.reset(false);
+    const int64_t memory = list.memory();
+    REQUIRE(memory == int64_t(n * sizeof(hnswlib::vl_type)));
+    REQUIRE(bytes == memory);
+
+    // id 0 is marked in the first epoch only, a stale tag would read as visited again when the epoch wraps to 1
+    list.set(0);
+    REQUIRE(list.get(0));
+    uint32_t prev = 0;
+    size_t stale = 0;
+    for (size_t r = 0; r < 3 * size_t(std::numeric_limits<hnswlib::vl_type>::max()); r++) {
+        list.reset(false);
+        const uint32_t id = 1 + r % (n - 1);
+        stale += list.get(0) + list.get(prev) + list.get(id);
+        list.set(id);
+        stale += !list.get(id);
+        prev = id;
+    }
+    REQUIRE(stale == 0);
+    REQUIRE(list.memory() == memory);
+    REQUIRE(bytes == memory);
+}
+
+TEST_CASE("Test Visited List Sparse Rehash", "[visited list]") {
+    const size_t n = 1 << 20;
+    std::atomic<int64_t> bytes{0};
+    hnswlib::VisitedList list(n, &bytes);
+    list.reset(true);
+    const int64_t initial = list.memory();
+    REQUIRE(initial > 0);
+    REQUIRE(initial < int64_t(n * sizeof(hnswlib::vl_type)));
+
+    // enough ids to grow the table several times, spread over the whole range and with neighbors next to each other
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < 20000; i++) {
+        ids.push_back(i % 2 == 0 ? i * 37 : i * 37 + 1);
+    }
+    for (auto id : ids) {
+        list.set(id);
+        list.set(id);
+    }
+    REQUIRE(list.memory() > initial);
+    REQUIRE(bytes == list.memory());
+    for (auto id : ids) {
+        REQUIRE(list.get(id));
+    }
+    size_t visited = 0;
+    for (uint32_t id = 0; id < n; id++) {
+        visited += list.get(id);
+    }
+    REQUIRE(visited == ids.size());
+
+    // the grown table is kept and cleared
+    const int64_t grown = list.memory();
+    list.reset(true);
+    for (auto id : ids) {
+        REQUIRE(!list.get(id));
+    }
+    REQUIRE(list.memory() == grown);
+    REQUIRE(bytes == grown);
+}
+
+TEST_CASE("Test Visited List Mode Switch", "[visited list]") {
+    const size_t n = 10000;
+    std::atomic<int64_t> bytes{0};
+    hnswlib::VisitedList list(n, &bytes);
+
+    list.reset(false);
+    list.set(1);
+    list.reset(true);
+    REQUIRE(!list.get(1));
+    list.set(2);
+    REQUIRE(list.get(2));
+
+    list.reset(false);
+    REQUIRE(!list.get(1));
+    REQUIRE(!list.get(2));
+    list.set(3);
+    REQUIRE(list.get(3));
+
+    list.reset(true);
+    REQUIRE(!list.get(2));
+    REQUIRE(!list.get(3));
+    list.set(4);
+
+    list.reset(false);
+    for (uint32_t id = 0; id < n; id++) {
+        REQUIRE(!list.get(id));
+    }
+    // both modes keep their storage once allocated
+    REQUIRE(list.memory() > int64_t(n * sizeof(hnswlib::vl_type)));
+    REQUIRE(bytes == list.memory());
+}
+
+TEST_CASE("Test Visited List Pool", "[visited list]") {
+    const size_t n = 1000;
+    const int64_t list_bytes = n * sizeof(hnswlib::vl_type);
+    hnswlib::VisitedListPool pool(n);
+    const int64_t empty_size = pool.size();
+
+    SECTION("Test Reuse") {
+        {
+            auto handle = pool.getFreeVisitedList();
+            (*handle).set(5);
+        }
+        REQUIRE(pool.size() == empty_size + list_bytes);
+        auto handle = pool.getFreeVisitedList();
+        REQUIRE(!(*handle).get(5));
+        REQUIRE(pool.size() == empty_size + list_bytes);
+    }
+
+    SECTION("Test Sparse Checkout") {
+        // few expected visits give a sparse list, which allocates no tag per element
+        const size_t large_n = 1 << 20;
+        hnswlib::VisitedListPool large_pool(large_n);
+        const int64_t large_empty_size = large_pool.size();
+        auto handle = large_pool.getFreeVisitedList(large_n / hnswlib::VisitedListPool::kSparseVisitedRatio - 1);
+        (*handle).set(5);
+        REQUIRE((*handle).get(5));
+        REQUIRE(large_pool.size() - large_empty_size < int64_t(large_n * sizeof(hnswlib::vl_type)));
+    }
+
+    SECTION("Test Exhaustion") {
+        // more lists checked out at once than the pool keeps, every one is a distinct list
+        const size_t checked_out = hnswlib::VisitedListPool::kMaxPooledLists + 44;
+        std::vector<std::unique_ptr<hnswlib::VisitedListPool::Handle>> handles;
+        std::set<hnswlib::VisitedList*> lists;
+        for (size_t i = 0; i < checked_out; i++) {
+            handles.emplace_back(new hnswlib::VisitedListPool::Handle(pool.getFreeVisitedList()));
+            auto& list = **handles.back();
+            REQUIRE(!list.get(uint32_t(i % n)));
+            list.set(uint32_t(i % n));
+            lists.insert(&list);
+        }
+        REQUIRE(lists.size() == checked_out);
+        REQUIRE(pool.size() == empty_size + int64_t(checked_out) * list_bytes);
+
+        // the lists released past the cap are freed, the others come back reset
+        handles.clear();
+        const int64_t pooled = hnswlib::VisitedListPool::kMaxPooledLists;
+        REQUIRE(pool.size() == empty_size + pooled * list_bytes);
+        for (size_t i = 0; i < checked_out; i++) {
+            handles.emplace_back(new hnswlib::VisitedListPool::Handle(pool.getFreeVisitedList()));
+            auto& list = **handles.back();
+            for (uint32_t id = 0; id < checked_out; id++) {
+                REQUIRE(!list.get(id % n));
+            }
+        }
+        REQUIRE(pool.size() == empty_size + int64_t(checked_out) * list_bytes);
+    }
+}
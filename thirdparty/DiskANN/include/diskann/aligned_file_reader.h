@@ -99,4 +99,31 @@ class AlignedFileReader {
   // async reads
   virtual void get_submitted_req(io_context_t &ctx, size_t n_ops) = 0;
   virtual void submit_req( io_context_t &ctx, std::vector<AlignedRead> &read_reqs) = 0;
+
+  // pipelined reads: requests of several searches are in flight at the same
+  // time on the calling thread, every completed request reports the tag it
+  // was submitted with. Only backends that return true here implement them.
+  virtual bool support_pipelined_read() {
+    return false;
+  }
+
+  // non-blocking, the buffers must stay valid until their tags are reaped
+  virtual void submit_tagged(std::vector<AlignedRead> &read_reqs,
+                             uint64_t                  tag) {
+    throw diskann::ANNException("Pipelined read is not supported", -1,
+                                __FUNCSIG__, __FILE__, __LINE__);
+  }
+
+  // blocks until at least one request submitted by this thread completes,
+  // appends one tag per completed request
+  virtual void reap_tagged(std::vector<uint64_t> &tags) {
+    throw diskann::ANNException("Pipelined read is not supported", -1,
+                                __FUNCSIG__, __FILE__, __LINE__);
+  }
+
+  // cancels the requests submitted by this thread and blocks until none of
+  // them is in flight, the tags that were not reaped are dropped. A search
+  // that fails calls it before its buffers are reused.
+  virtual void cancel_tagged() {
+  }
 };
@@ -39,6 +39,8 @@ namespace diskann {
   constexpr size_t   MAX_N_SECTOR_READS = 256;
   const size_t   MAX_PQ_TRAINING_SET_SIZE = 256000;
   const size_t   MAX_SAMPLE_POINTS_FOR_WARMUP = 100000;
+  const size_t   MAX_PQ_ENCODE_BLOCK_SIZE = 1000000;
+  const size_t   MIN_OVERLAPPED_PQ_ENCODE_BLOCK_SIZE = 4096;
   const double   PQ_TRAINING_SET_FRACTION = 0.1;
   const double   SPACE_FOR_CACHED_NODES_IN_GB = 0.25;
   const double   THRESHOLD_FOR_CACHING_IN_GB = 1.0;
@@ -141,6 +143,9 @@ namespace diskann {
     bool accelerate_build = false;
     // the cached nodes number
     uint32_t num_nodes_to_cache = 0;
+    // pack graph neighbors into the same disk sectors instead of laying
+    // nodes out in id order (optional, costs a pass over the graph in memory)
+    bool reorder_layout = false;
   };
 
   template<typename T>
@@ -150,6 +155,7 @@ namespace diskann {
   DISKANN_DLLEXPORT void create_disk_layout(
       const std::string base_file, const std::string mem_index_file,
       const std::string output_file,
-      const std::string reorder_data_file = std::string(""));
+      const std::string reorder_data_file = std::string(""),
+      const bool reorder_layout = false, const double ram_budget = 0);
 
 }  // namespace diskann
@@ -64,8 +64,20 @@ DISKANN_DLLEXPORT int generate_pq_pivots(
     unsigned num_centers, unsigned num_pq_chunks, unsigned max_k_means_reps,
     std::string pq_pivots_path, bool make_zero_mean = false);
 
+// max_block_size bounds the points encoded at once, 0 keeps the default
+// block of a million points
 template<typename T>
 int generate_pq_data_from_pivots(const std::string data_file,
                                  unsigned num_centers, unsigned num_pq_chunks,
                                  std::string pq_pivots_path,
-                                 std::string pq_compressed_vectors_path);
+                                 std::string pq_compressed_vectors_path,
+                                 size_t      max_block_size = 0);
+
+// bytes generate_pq_data_from_pivots holds per point of a block: the two read
+// buffers, the float block and its per chunk copies, the closest centers of
+// the chunks, the 32-bit codes of the block and their 8-bit copy
+template<typename T>
+inline _u64 pq_encoding_ram_per_point(_u64 dim, _u64 num_pq_chunks) {
+  return 2 * dim * sizeof(T) + 2 * dim * sizeof(float) +
+         2 * num_pq_chunks * sizeof(_u32) + num_pq_chunks * sizeof(_u8);
+}
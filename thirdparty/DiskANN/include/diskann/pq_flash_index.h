@@ -2,12 +2,14 @@
 // Licensed under the MIT license.
 
 #pragma once
+#include <algorithm>
 #include <cassert>
 #include <future>
 #include <optional>
 #include <sstream>
 #include <stack>
 #include <string>
+#include <vector>
 #include "common/lru_cache.h"
 #include "tsl/robin_map.h"
 #include "tsl/robin_set.h"
@@ -62,6 +64,74 @@ namespace diskann {
     QueryScratch<T> scratch;
   };
 
+  // The sectors one query has read, kept in its sector scratch. A frontier
+  // node whose sector was read before, earlier in the query or in the same
+  // hop, is expanded from that copy instead of being read again. This is what
+  // makes the reordered layout pay off: the nodes packed next to a visited
+  // node are mostly its graph neighbors, and the search reaches them soon.
+  class SectorScratchCache {
+   public:
+    SectorScratchCache(char *scratch, _u64 n_slots, _u64 read_len)
+        : scratch_(scratch), read_len_(read_len), offsets_(n_slots, 0),
+          hops_(n_slots, 0) {
+      slot_of_.reserve(n_slots);
+    }
+
+    // forgets the sectors of the previous query
+    void reset(char *scratch) {
+      scratch_ = scratch;
+      std::fill(offsets_.begin(), offsets_.end(), 0);
+      std::fill(hops_.begin(), hops_.end(), 0);
+      slot_of_.clear();
+      hop_ = 0;
+      next_ = 0;
+    }
+
+    // the buffers returned from now on are kept until the next hop
+    void next_hop() {
+      ++hop_;
+    }
+
+    // the buffer holding the sector at `offset`, nullptr if it was not read
+    char *find(_u64 offset) {
+      auto it = slot_of_.find(offset);
+      if (it == slot_of_.end()) {
+        return nullptr;
+      }
+      hops_[it->second] = hop_;
+      return scratch_ + it->second * read_len_;
+    }
+
+    // the buffer to read the sector at `offset` into. Buffers are reused round
+    // robin, skipping the ones the current hop uses, of which there are at
+    // most beam width, fewer than the slots.
+    char *assign(_u64 offset) {
+      while (offsets_[next_] != 0 && hops_[next_] == hop_) {
+        next_ = (next_ + 1) % offsets_.size();
+      }
+      const _u64 slot = next_;
+      next_ = (next_ + 1) % offsets_.size();
+      if (offsets_[slot] != 0) {
+        slot_of_.erase(offsets_[slot]);
+      }
+      offsets_[slot] = offset;
+      hops_[slot] = hop_;
+      slot_of_[offset] = slot;
+      return scratch_ + slot * read_len_;
+    }
+
+   private:
+    char *scratch_;
+    _u64  read_len_;
+    // sector offset held by each slot, 0 (the metadata sector) when empty
+    std::vector<_u64> offsets_;
+    // last hop that used each slot
+    std::vector<_u64>          hops_;
+    tsl::robin_map<_u64, _u64> slot_of_;
+    _u64                       hop_ = 0;
+    _u64                       next_ = 0;
+  };
+
   template<typename T>
   class PQFlashIndex {
    public:
@@ -103,6 +173,19 @@ namespace diskann {
         const float                                      filter_ratio = -1.0f,
         const bool                                       for_tuning = false);
 
+    // Searches `nq` queries on the calling thread with up to `pipeline_width`
+    // of them in flight: every query is a state machine that submits the
+    // reads of its next beam and yields, and it resumes once all of them are
+    // reaped, so the PQ distance work of one query overlaps the I/O of the
+    // others. Falls back to one cached_beam_search per query when the reader
+    // does not support pipelined reads or the bitset triggers brute force.
+    DISKANN_DLLEXPORT void pipelined_beam_search(
+        const T *queries, const _u64 nq, const _u64 query_dim,
+        const _u64 k_search, const _u64 l_search, _s64 *res_ids,
+        float *res_dists, const _u64 beam_width, const _u64 pipeline_width,
+        knowhere::BitsetView bitset_view = nullptr,
+        const float filter_ratio = -1.0f, const bool for_tuning = false);
+
     DISKANN_DLLEXPORT _u32 range_search(
         const T *query1, const double range, const _u64 min_l_search,
         const _u64 max_l_search, std::vector<_s64> &indices,
@@ -133,17 +216,25 @@ namespace diskann {
     DISKANN_DLLEXPORT void destroy_thread_data();
 
    private:
+    // slot of node_id in the graph part, equal to node_id unless the layout
+    // was reordered at build time
+    _u64 get_node_location(_u64 node_id) {
+      return node_locations.empty() ? node_id : node_locations[node_id];
+    }
+
     // sector # on disk where node_id is present with in the graph part
     _u64 get_node_sector_offset(_u64 node_id) {
-      return long_node ? (node_id * nsectors_per_node + 1) * SECTOR_LEN
-                       : (node_id / nnodes_per_sector + 1) * SECTOR_LEN;
+      const _u64 loc = get_node_location(node_id);
+      return long_node ? (loc * nsectors_per_node + 1) * SECTOR_LEN
+                       : (loc / nnodes_per_sector + 1) * SECTOR_LEN;
     }
 
     // obtains region of sector containing node
     char *get_offset_to_node(char *sector_buf, _u64 node_id) {
-      return long_node
-                 ? sector_buf
-                 : sector_buf + (node_id % nnodes_per_sector) * max_node_len;
+      return long_node ? sector_buf
+                       : sector_buf + (get_node_location(node_id) %
+                                       nnodes_per_sector) *
+                                          max_node_len;
     }
 
     inline void copy_vec_base_data(T *des, const int64_t des_idx, void *src);
@@ -176,6 +267,10 @@ namespace diskann {
     // nbrs of node `i`: ((unsigned*)buf) + 1
     _u64 max_node_len = 0, nnodes_per_sector = 0, max_degree = 0;
 
+    // node id -> slot in the graph part, empty when nodes are laid out in id
+    // order (see create_disk_layout)
+    std::vector<_u32> node_locations;
+
     // Data used for searching with re-order vectors
     _u64 ndims_reorder_vecs = 0, reorder_data_start_sector = 0,
          nvecs_per_sector = 0;
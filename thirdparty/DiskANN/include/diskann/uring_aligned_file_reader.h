@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+#ifndef _WINDOWS
+
+#include "aligned_file_reader.h"
+
+// AlignedFileReader backed by io_uring. Every search thread owns one ring, so
+// there is no context pool to wait on, and the reads of several queries can be
+// in flight together (see PQFlashIndex::pipelined_beam_search).
+class UringAlignedFileReader : public AlignedFileReader {
+ private:
+  FileHandle file_desc;
+
+ public:
+  UringAlignedFileReader();
+  ~UringAlignedFileReader();
+
+  // false if io_uring is not available (old kernel, seccomp, ...), callers
+  // should fall back to LinuxAlignedFileReader
+  static bool is_supported();
+
+  // the ring is thread local, the context is only kept for interface
+  // compatibility
+  IOContext get_ctx() {
+    return nullptr;
+  }
+
+  void put_ctx(IOContext ctx) {
+  }
+
+  // Open & close ops
+  // Blocking calls
+  void open(const std::string &fname);
+  void close();
+
+  // process batch of aligned requests in parallel
+  // NOTE :: blocking call
+  void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx,
+            bool async = false);
+
+  // async reads
+  void get_submitted_req(io_context_t &ctx, size_t n_ops) override;
+  void submit_req(io_context_t &ctx, std::vector<AlignedRead> &read_reqs);
+
+  // pipelined reads
+  bool support_pipelined_read() override {
+    return true;
+  }
+  void submit_tagged(std::vector<AlignedRead> &read_reqs,
+                     uint64_t                  tag) override;
+  void reap_tagged(std::vector<uint64_t> &tags) override;
+  void cancel_tagged() override;
+};
+
+#endif
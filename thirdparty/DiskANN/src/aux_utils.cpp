@@ -8,6 +8,7 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #if defined(RELEASE_UNUSED_TCMALLOC_MEMORY_AT_CHECKPOINTS) && \
@@ -24,6 +25,7 @@
 #include "diskann/partition_and_pq.h"
 #include "diskann/percentile_stats.h"
 #include "diskann/pq_flash_index.h"
+#include "diskann/timer.h"
 #include "tsl/robin_set.h"
 
 #include "diskann/utils.h"
@@ -865,11 +867,86 @@ namespace diskann {
     return best_bw;
   }
 
+  // Greedy sector packing: each sector is seeded with the first unplaced node
+  // in BFS order from the medoid and then filled with the unplaced node that
+  // has the most edges from the nodes already in the sector, so that a beam
+  // search expanding a node often finds its neighbors in the same read.
+  // Returns the node id stored in every slot.
+  std::vector<_u32> pack_nodes_into_sectors(
+      const std::vector<_u64> &offsets, const std::vector<unsigned> &nbrs,
+      const _u64 medoid, const _u64 nnodes_per_sector) {
+    const _u64 npts = offsets.size() - 1;
+
+    std::vector<_u32> seeds;
+    std::vector<bool> visited(npts, false);
+    seeds.reserve(npts);
+    seeds.push_back(medoid);
+    visited[medoid] = true;
+    // nodes unreachable from the medoid follow in id order, the scan for them
+    // resumes where it stopped
+    _u32 next_unvisited = 0;
+    for (_u64 head = 0; head < npts; ++head) {
+      if (head == seeds.size()) {
+        while (visited[next_unvisited])
+          ++next_unvisited;
+        seeds.push_back(next_unvisited);
+        visited[next_unvisited] = true;
+      }
+      const _u32 u = seeds[head];
+      for (_u64 j = offsets[u]; j < offsets[u + 1]; ++j) {
+        if (!visited[nbrs[j]]) {
+          visited[nbrs[j]] = true;
+          seeds.push_back(nbrs[j]);
+        }
+      }
+    }
+
+    std::vector<_u32>                  slot_to_id;
+    std::vector<bool>                  placed(npts, false);
+    std::unordered_map<_u32, unsigned> edges_into_sector;
+    slot_to_id.reserve(npts);
+    auto place = [&](const _u32 u) {
+      placed[u] = true;
+      slot_to_id.push_back(u);
+      edges_into_sector.erase(u);
+      for (_u64 j = offsets[u]; j < offsets[u + 1]; ++j) {
+        if (!placed[nbrs[j]])
+          ++edges_into_sector[nbrs[j]];
+      }
+    };
+
+    _u64 next_seed = 0;
+    while (slot_to_id.size() < npts) {
+      edges_into_sector.clear();
+      for (_u64 sector_node_id = 0;
+           sector_node_id < nnodes_per_sector && slot_to_id.size() < npts;
+           ++sector_node_id) {
+        _u32     best = 0;
+        unsigned best_edges = 0;
+        for (const auto &[v, edges] : edges_into_sector) {
+          if (edges > best_edges || (edges == best_edges && v < best)) {
+            best = v;
+            best_edges = edges;
+          }
+        }
+        if (best_edges == 0) {
+          while (placed[seeds[next_seed]])
+            ++next_seed;
+          best = seeds[next_seed];
+        }
+        place(best);
+      }
+    }
+    return slot_to_id;
+  }
+
   template<typename T>
   void create_disk_layout(const std::string base_file,
                           const std::string mem_index_file,
                           const std::string output_file,
-                          const std::string reorder_data_file) {
+                          const std::string reorder_data_file,
+                          const bool        reorder_layout,
+                          const double      ram_budget) {
     unsigned npts, ndims;
 
     // amount to read or write in one shot
@@ -984,8 +1061,18 @@ namespace diskann {
       n_reorder_sectors =
           ROUND_UP(npts_64, n_data_nodes_per_sector) / n_data_nodes_per_sector;
     }
+    // the node id -> slot table goes after everything else
+    const bool pack_sectors = reorder_layout && !long_node &&
+                              nnodes_per_sector > 1 && npts_64 > 0;
+    _u64       n_location_sectors = 0;
+    if (pack_sectors) {
+      n_location_sectors =
+          ROUND_UP(npts_64 * sizeof(_u32), SECTOR_LEN) / SECTOR_LEN;
+    } else if (reorder_layout) {
+      LOG_KNOWHERE_INFO_ << "Only one node fits in a sector, keep id order.";
+    }
     _u64 disk_index_file_size =
-        (n_sectors + n_reorder_sectors + 1) * SECTOR_LEN;
+        (n_sectors + n_reorder_sectors + n_location_sectors + 1) * SECTOR_LEN;
 
     // SECTOR_LEN buffer for each sector
     _u64 sector_buf_size =
@@ -1008,6 +1095,10 @@ namespace diskann {
       *(_u64 *) (sector_buf.get() + 10 * sizeof(_u64)) =
           n_data_nodes_per_sector;
     }
+    if (pack_sectors) {
+      *(_u64 *) (sector_buf.get() + 11 * sizeof(_u64)) =
+          n_sectors + n_reorder_sectors + 1;
+    }
 
     diskann_writer.write(sector_buf.get(), SECTOR_LEN);
 
@@ -1037,6 +1128,78 @@ namespace diskann {
       return;
     }
 
+    std::vector<_u32>     slot_to_id;
+    std::vector<_u32>     id_to_slot;
+    std::vector<_u64>     graph_offsets;
+    std::vector<unsigned> graph_nbrs;
+    // the vectors of the slots [block_begin, block_begin + block_nodes),
+    // gathered with one sequential pass over the base file per block
+    const _u64              vec_len = ndims_64 * sizeof(T);
+    _u64                    block_nodes = 0, block_begin = 0;
+    std::unique_ptr<char[]> block_buf;
+    if (pack_sectors) {
+      graph_offsets.reserve(npts_64 + 1);
+      graph_offsets.push_back(0);
+      for (_u64 node_id = 0; node_id < npts_64; ++node_id) {
+        unsigned nnbrs;
+        vamana_reader.read((char *) &nnbrs, sizeof(unsigned));
+        graph_nbrs.resize(graph_offsets.back() + nnbrs);
+        vamana_reader.read((char *) (graph_nbrs.data() + graph_offsets.back()),
+                           nnbrs * sizeof(unsigned));
+        graph_offsets.push_back(graph_nbrs.size());
+      }
+      auto pack_s = std::chrono::high_resolution_clock::now();
+      slot_to_id = pack_nodes_into_sectors(graph_offsets, graph_nbrs, medoid,
+                                           nnodes_per_sector);
+      std::chrono::duration<double> pack_diff =
+          std::chrono::high_resolution_clock::now() - pack_s;
+      LOG_KNOWHERE_INFO_ << "Packing graph neighbors into sectors cost: "
+                         << pack_diff.count() << "s";
+      id_to_slot.resize(npts_64);
+      for (_u64 slot = 0; slot < npts_64; ++slot) {
+        id_to_slot[slot_to_id[slot]] = slot;
+      }
+
+      // the graph stays in memory, the vectors get what is left of the budget
+      block_nodes = npts_64;
+      if (ram_budget > 0) {
+        const double graph_bytes =
+            graph_nbrs.size() * sizeof(unsigned) +
+            graph_offsets.size() * sizeof(_u64) + 2 * npts_64 * sizeof(_u32);
+        const double spare_bytes =
+            ram_budget * 1024 * 1024 * 1024 - graph_bytes - read_blk_size;
+        block_nodes = spare_bytes > 0 ? (_u64) (spare_bytes / vec_len) : 0;
+        block_nodes = std::min(
+            npts_64, std::max(nnodes_per_sector, ROUND_DOWN(block_nodes,
+                                                            nnodes_per_sector)));
+      }
+      LOG_KNOWHERE_INFO_ << "Gathering the reordered vectors in "
+                         << DIV_ROUND_UP(npts_64, block_nodes)
+                         << " pass(es) over the base file";
+      block_buf = std::make_unique<char[]>(block_nodes * vec_len);
+    }
+    auto gather_block = [&]() {
+      const _u64 block_end = std::min(npts_64, block_begin + block_nodes);
+      const _u64 chunk_nodes = std::max<_u64>(1, read_blk_size / vec_len);
+      std::unique_ptr<char[]> chunk_buf =
+          std::make_unique<char[]>(chunk_nodes * vec_len);
+      std::ifstream block_reader;
+      block_reader.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+      block_reader.open(base_file, std::ios::binary);
+      block_reader.seekg(2 * sizeof(uint32_t), block_reader.beg);
+      for (_u64 first_id = 0; first_id < npts_64; first_id += chunk_nodes) {
+        const _u64 n = std::min(chunk_nodes, npts_64 - first_id);
+        block_reader.read(chunk_buf.get(), n * vec_len);
+        for (_u64 i = 0; i < n; ++i) {
+          const _u64 slot = id_to_slot[first_id + i];
+          if (slot >= block_begin && slot < block_end) {
+            memcpy(block_buf.get() + (slot - block_begin) * vec_len,
+                   chunk_buf.get() + i * vec_len, vec_len);
+          }
+        }
+      }
+    };
+
     LOG_KNOWHERE_DEBUG_ << "# sectors: " << n_sectors;
     _u64 cur_node_id = 0;
     for (_u64 sector = 0; sector < n_sectors; sector++) {
@@ -1053,6 +1216,24 @@ namespace diskann {
         char *nhood_buf =
             sector_node_buf + (ndims_64 * sizeof(T)) + sizeof(unsigned);
 
+        if (pack_sectors) {
+          if (cur_node_id == block_begin + block_nodes || cur_node_id == 0) {
+            block_begin = cur_node_id;
+            gather_block();
+          }
+          const _u64 node_id = slot_to_id[cur_node_id];
+          const _u64 nnbrs_u64 =
+              graph_offsets[node_id + 1] - graph_offsets[node_id];
+          *(unsigned *) nnbrs = nnbrs_u64;
+          memcpy(nhood_buf, graph_nbrs.data() + graph_offsets[node_id],
+                 nnbrs_u64 * sizeof(unsigned));
+          memcpy(sector_node_buf,
+                 block_buf.get() + (cur_node_id - block_begin) * vec_len,
+                 vec_len);
+          cur_node_id++;
+          continue;
+        }
+
         // read cur node's nnbrs
         vamana_reader.read(nnbrs, sizeof(unsigned));
 
@@ -1100,9 +1281,40 @@ namespace diskann {
         diskann_writer.write(sector_buf.get(), SECTOR_LEN);
       }
     }
+    if (pack_sectors) {
+      id_to_slot.resize(n_location_sectors * SECTOR_LEN / sizeof(_u32), 0);
+      diskann_writer.write((char *) id_to_slot.data(),
+                           n_location_sectors * SECTOR_LEN);
+    }
     LOG_KNOWHERE_DEBUG_ << "Output file written.";
   }
 
+  namespace {
+    // wall time of the build phases, logged in one line when the build ends
+    class BuildPhaseReport {
+     public:
+      // the time since the previous call (or since construction)
+      void add(const std::string &phase) {
+        add(phase, timer_.elapsed() / 1e6);
+        timer_.reset();
+      }
+
+      void add(const std::string &phase, double seconds) {
+        stream_ << (empty_ ? "" : ", ") << phase << " " << seconds << "s";
+        empty_ = false;
+      }
+
+      std::string str() const {
+        return stream_.str();
+      }
+
+     private:
+      Timer             timer_;
+      std::stringstream stream_;
+      bool              empty_ = true;
+    };
+  }  // namespace
+
   template<typename T>
   int build_disk_index(const BuildConfig &config) {
     if (!std::is_same<T, float>::value &&
@@ -1143,6 +1355,9 @@ namespace diskann {
     // optional, used if build mem usage is enough to generate cached nodes
     std::string cached_nodes_file = get_cached_nodes_file(index_prefix_path);
 
+    Timer            total_timer;
+    BuildPhaseReport phases;
+
     // output a new base file which contains extra dimension with sqrt(1 -
     // ||x||^2/M^2) for every x, M is max norm of all points. Extra space on
     // disk needed!
@@ -1177,6 +1392,7 @@ namespace diskann {
       diskann::save_bin<float>(norm_file, norms_of_base.data(),
                                norms_of_base.size(), 1);
     }
+    phases.add("prepare base");
 
     unsigned R = config.max_degree;
     unsigned L = config.search_list_size;
@@ -1199,8 +1415,6 @@ namespace diskann {
                        << " Indexing ram budget: " << indexing_ram_budget
                        << "(GiB)";
 
-    auto s = std::chrono::high_resolution_clock::now();
-
     size_t points_num, dim;
 
     diskann::get_bin_metadata(data_file_to_use.c_str(), points_num, dim);
@@ -1222,6 +1436,7 @@ namespace diskann {
     // train_size
     gen_random_slice<T>(data_file_to_use.c_str(), p_val, train_data, train_size,
                         train_dim);
+    phases.add("sample");
 
     if (use_disk_pq) {
       if (disk_pq_dims > dim)
@@ -1241,6 +1456,7 @@ namespace diskann {
         generate_pq_data_from_pivots<T>(
             data_file_to_use.c_str(), 256, (uint32_t) disk_pq_dims,
             disk_pq_pivots_path, disk_pq_compressed_vectors_path);
+      phases.add("disk pq");
     }
     LOG_KNOWHERE_DEBUG_ << "Training data loaded of size " << train_size;
 
@@ -1250,17 +1466,10 @@ namespace diskann {
     if (config.compare_metric != diskann::Metric::L2)
       make_zero_mean = false;
 
-    auto pq_s = std::chrono::high_resolution_clock::now();
     generate_pq_pivots(train_data, train_size, (uint32_t) dim, 256,
                        (uint32_t) num_pq_chunks, NUM_KMEANS_REPS,
                        pq_pivots_path, make_zero_mean);
-
-    generate_pq_data_from_pivots<T>(data_file_to_use.c_str(), 256,
-                                    (uint32_t) num_pq_chunks, pq_pivots_path,
-                                    pq_compressed_vectors_path);
-    auto pq_e = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> pq_diff = pq_e - pq_s;
-    LOG_KNOWHERE_INFO_ << "Training PQ codes cost: " << pq_diff.count() << "s";
+    phases.add("pq pivots");
     delete[] train_data;
 
     train_data = nullptr;
@@ -1271,26 +1480,73 @@ namespace diskann {
     MallocExtension::instance()->ReleaseFreeMemory();
 #endif
 
-    auto graph_s = std::chrono::high_resolution_clock::now();
-    auto vamana_index = diskann::build_merged_vamana_index<T>(
-        data_file_to_use.c_str(), ip_prepared, diskann::Metric::L2, L, R,
-        config.accelerate_build, p_val, indexing_ram_budget, mem_index_path,
-        medoids_path, centroids_path);
-    auto graph_e = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> graph_diff = graph_e - graph_s;
-    LOG_KNOWHERE_INFO_ << "Training graph cost: " << graph_diff.count() << "s";
+    // The graph is built from the raw vectors only, so the base is encoded
+    // with the PQ pivots while the graph is built, but only with the RAM that
+    // a one shot graph build leaves in the budget: taking it from the graph
+    // build would split it into shards. Otherwise the two run one after the
+    // other, each with the full budget.
+    const double kGiB = 1024.0 * 1024 * 1024;
+    const double full_graph_ram =
+        estimate_ram_usage(points_num, (_u32) dim, sizeof(T), R);
+    const _u64 encode_ram_per_point =
+        pq_encoding_ram_per_point<T>(dim, num_pq_chunks);
+    const double spare_ram =
+        std::max(0.0, indexing_ram_budget * kGiB - full_graph_ram);
+    const size_t encode_block_size = std::min<size_t>(
+        MAX_PQ_ENCODE_BLOCK_SIZE, (size_t) (spare_ram / encode_ram_per_point));
+    const bool overlap_pq_encoding =
+        encode_block_size >= MIN_OVERLAPPED_PQ_ENCODE_BLOCK_SIZE;
+    auto encode_pq = [&](size_t block_size) {
+      Timer timer;
+      generate_pq_data_from_pivots<T>(data_file_to_use.c_str(), 256,
+                                      (uint32_t) num_pq_chunks, pq_pivots_path,
+                                      pq_compressed_vectors_path, block_size);
+      return timer.elapsed() / 1e6;
+    };
+    std::future<double> pq_encoding;
+    if (overlap_pq_encoding) {
+      pq_encoding =
+          std::async(std::launch::async, encode_pq, encode_block_size);
+    } else {
+      encode_pq(0);
+      phases.add("pq encode");
+    }
+
+    std::unique_ptr<diskann::Index<T>> vamana_index;
+    try {
+      vamana_index = diskann::build_merged_vamana_index<T>(
+          data_file_to_use.c_str(), ip_prepared, diskann::Metric::L2, L, R,
+          config.accelerate_build, p_val, indexing_ram_budget, mem_index_path,
+          medoids_path, centroids_path);
+    } catch (...) {
+      if (pq_encoding.valid())
+        pq_encoding.wait();
+      throw;
+    }
+    phases.add("graph");
+    if (pq_encoding.valid()) {
+      // rethrows an encoding failure
+      phases.add("pq encode (overlapped with graph)", pq_encoding.get());
+      phases.add("pq encode wait");
+    }
+
     if (!use_disk_pq) {
       diskann::create_disk_layout<T>(data_file_to_save.c_str(), mem_index_path,
-                                     disk_index_path);
+                                     disk_index_path, std::string(""),
+                                     config.reorder_layout,
+                                     indexing_ram_budget);
     } else {
       if (!reorder_data)
-        diskann::create_disk_layout<_u8>(disk_pq_compressed_vectors_path,
-                                         mem_index_path, disk_index_path);
+        diskann::create_disk_layout<_u8>(
+            disk_pq_compressed_vectors_path, mem_index_path, disk_index_path,
+            std::string(""), config.reorder_layout, indexing_ram_budget);
       else
-        diskann::create_disk_layout<_u8>(disk_pq_compressed_vectors_path,
-                                         mem_index_path, disk_index_path,
-                                         data_file_to_save.c_str());
+        diskann::create_disk_layout<_u8>(
+            disk_pq_compressed_vectors_path, mem_index_path, disk_index_path,
+            data_file_to_save.c_str(), config.reorder_layout,
+            indexing_ram_budget);
     }
+    phases.add("disk layout");
 
     double ten_percent_points = std::ceil(points_num * 0.1);
     double num_sample_points = ten_percent_points > MAX_SAMPLE_POINTS_FOR_WARMUP
@@ -1299,6 +1555,7 @@ namespace diskann {
     double sample_sampling_rate = num_sample_points / points_num;
     gen_random_slice<T>(base_file.c_str(), sample_data_file,
                         sample_sampling_rate);
+    phases.add("warmup sample");
 
     if (vamana_index != nullptr) {
       auto final_graph = vamana_index->get_graph();
@@ -1317,11 +1574,11 @@ namespace diskann {
             config.num_nodes_to_cache, config.max_degree, config.compare_metric,
             sample_data_file, pq_pivots_path, pq_compressed_vectors_path,
             entry_point, *final_graph, cached_nodes_file);
+        phases.add("cache list");
       }
     }
-    auto                          e = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> diff = e - s;
-    LOG_KNOWHERE_INFO_ << "Indexing time: " << diff.count() << std::endl;
+    phases.add("total", total_timer.elapsed() / 1e6);
+    LOG_KNOWHERE_INFO_ << "DiskANN build phases: " << phases.str();
 
     if (config.compare_metric == diskann::Metric::INNER_PRODUCT) {
       std::remove(data_file_to_use.c_str());
@@ -1334,13 +1591,16 @@ namespace diskann {
 
   template DISKANN_DLLEXPORT void create_disk_layout<int8_t>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool reorder_layout, const double ram_budget);
   template DISKANN_DLLEXPORT void create_disk_layout<uint8_t>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool reorder_layout, const double ram_budget);
   template DISKANN_DLLEXPORT void create_disk_layout<float>(
       const std::string base_file, const std::string mem_index_file,
-      const std::string output_file, const std::string reorder_data_file);
+      const std::string output_file, const std::string reorder_data_file,
+      const bool reorder_layout, const double ram_budget);
 
   template DISKANN_DLLEXPORT int8_t *load_warmup<int8_t>(
       const std::string &cache_warmup_file, uint64_t &warmup_num,
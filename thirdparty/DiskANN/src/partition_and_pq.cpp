@@ -14,6 +14,8 @@
 #include <iomanip>
 #include <iterator>
 #include <map>
+#include <numeric>
+#include <random>
 #include <set>
 #include <sstream>
 #include <string>
@@ -33,6 +35,7 @@
 
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <time.h>
 #include <typeinfo>
 #include <tsl/robin_map.h>
@@ -49,102 +52,154 @@
 
 // #define SAVE_INFLATED_PQ true
 
-template<typename T>
-void gen_random_slice(const std::string base_file,
-                      const std::string output_file, double sampling_rate) {
-  _u64            read_blk_size = 64 * 1024 * 1024;
-  cached_ifstream base_reader(base_file.c_str(), read_blk_size);
-  std::ofstream   sample_writer(output_file.c_str(), std::ios::binary);
-
-  std::random_device
-       rd;  // Will be used to obtain a seed for the random number engine
-  auto x = rd();
-  std::mt19937 generator(
-      x);  // Standard mersenne_twister_engine seeded with rd()
-  std::uniform_real_distribution<float> distribution(0, 1);
-
-  size_t   npts, nd;
-  uint32_t npts_u32, nd_u32;
-  uint32_t num_sampled_pts_u32 = 0;
-
-  base_reader.read((char *) &npts_u32, sizeof(uint32_t));
-  base_reader.read((char *) &nd_u32, sizeof(uint32_t));
-  LOG_KNOWHERE_DEBUG_ << "Loading base " << base_file
-                      << ". #points: " << npts_u32 << ". #dim: " << nd_u32
-                      << ".";
-  sample_writer.write((char *) &num_sampled_pts_u32, sizeof(uint32_t));
-  sample_writer.write((char *) &nd_u32, sizeof(uint32_t));
+namespace {
+  // bytes of the base file covered by one read task of read_rows
+  constexpr _u64 kReadChunkBytes = 8 * 1024 * 1024;
+
+  // Bernoulli sample of [0, npts) keeping every row with probability p_val.
+  // The gaps between kept rows are drawn from a geometric distribution, so the
+  // cost is proportional to the sample and not to npts.
+  std::vector<size_t> sample_row_ids(size_t npts, double p_val) {
+    std::vector<size_t> ids;
+    if (p_val >= 1) {
+      ids.resize(npts);
+      std::iota(ids.begin(), ids.end(), 0);
+      return ids;
+    }
+    if (p_val <= 0)
+      return ids;
+
+    std::random_device rd;
+    std::mt19937       generator((unsigned) rd());
+    std::geometric_distribution<size_t> gap(p_val);
+    ids.reserve((size_t) (npts * p_val * 1.1) + 16);
+    for (size_t id = gap(generator); id < npts; id += gap(generator) + 1)
+      ids.push_back(id);
+    return ids;
+  }
 
-  npts = npts_u32;
-  nd = nd_u32;
-  std::unique_ptr<T[]> cur_row = std::make_unique<T[]>(nd);
+  struct FileDescriptor {
+    explicit FileDescriptor(const std::string &file)
+        : fd(::open(file.c_str(), O_RDONLY)) {
+      if (fd < 0) {
+        throw diskann::ANNException("Failed to open " + file, -1, __FUNCSIG__,
+                                    __FILE__, __LINE__);
+      }
+    }
+    ~FileDescriptor() {
+      ::close(fd);
+    }
+    FileDescriptor(const FileDescriptor &) = delete;
+    FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+    const int fd;
+  };
+
+  void pread_all(int fd, char *buf, _u64 size, _u64 offset,
+                 const std::string &file) {
+    while (size > 0) {
+      auto ret = ::pread(fd, buf, size, offset);
+      if (ret <= 0) {
+        std::stringstream stream;
+        stream << "Failed to read " << size << " bytes at offset " << offset
+               << " of " << file;
+        throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+      }
+      buf += ret;
+      size -= ret;
+      offset += ret;
+    }
+  }
 
-  for (size_t i = 0; i < npts; i++) {
-    base_reader.read((char *) cur_row.get(), sizeof(T) * nd);
-    float sample = distribution(generator);
-    if (sample < sampling_rate) {
-      sample_writer.write((char *) cur_row.get(), sizeof(T) * nd);
-      num_sampled_pts_u32++;
+  // Reads the rows ids (sorted ascending) of a bin file of ndims-dimensional T
+  // vectors into out, converted to OutT. The ids are split into runs covering
+  // kReadChunkBytes of the file that the build pool reads in parallel with
+  // pread: a run whose rows are dense is read with a single pread, a sparse
+  // one row by row, so a small sample never streams the whole file.
+  template<typename T, typename OutT>
+  void read_rows(const std::string &file, size_t ndims,
+                 const std::vector<size_t> &ids, OutT *out) {
+    if (ids.empty())
+      return;
+    FileDescriptor file_fd(file);
+    const int      fd = file_fd.fd;
+    const _u64     row_bytes = ndims * sizeof(T);
+    const _u64 rows_per_chunk = std::max<_u64>(1, kReadChunkBytes / row_bytes);
+
+    auto thread_pool = knowhere::ThreadPool::GetGlobalBuildThreadPool();
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (size_t begin = 0; begin < ids.size();) {
+      const size_t chunk = ids[begin] / rows_per_chunk;
+      size_t       end = begin + 1;
+      while (end < ids.size() && ids[end] / rows_per_chunk == chunk)
+        end++;
+      futures.emplace_back(thread_pool->push([&, begin, end]() {
+        const size_t first = ids[begin];
+        const size_t span = ids[end - 1] - first + 1;
+        const bool   dense = (end - begin) * 4 >= span;
+        std::vector<T> buf((dense ? span : 1) * ndims);
+        if (dense)
+          pread_all(fd, (char *) buf.data(), span * row_bytes,
+                    2 * sizeof(_u32) + first * row_bytes, file);
+        for (size_t i = begin; i < end; i++) {
+          const T *row = buf.data();
+          if (dense)
+            row += (ids[i] - first) * ndims;
+          else
+            pread_all(fd, (char *) buf.data(), row_bytes,
+                      2 * sizeof(_u32) + ids[i] * row_bytes, file);
+          for (size_t d = 0; d < ndims; d++)
+            out[i * ndims + d] = (OutT) row[d];
+        }
+      }));
+      begin = end;
+    }
+    for (auto &future : futures) {
+      future.wait();
+    }
+    for (auto &future : futures) {
+      future.value();  // rethrows the read error of a failed run
     }
   }
-  sample_writer.seekp(0, std::ios::beg);
+}  // namespace
+
+template<typename T>
+void gen_random_slice(const std::string base_file,
+                      const std::string output_file, double sampling_rate) {
+  size_t npts, nd;
+  diskann::get_bin_metadata(base_file, npts, nd);
+  LOG_KNOWHERE_DEBUG_ << "Loading base " << base_file << ". #points: " << npts
+                      << ". #dim: " << nd << ".";
+
+  auto ids = sample_row_ids(npts, sampling_rate);
+  std::unique_ptr<T[]> sampled = std::make_unique<T[]>(ids.size() * nd);
+  read_rows<T, T>(base_file, nd, ids, sampled.get());
+
+  uint32_t       num_sampled_pts_u32 = ids.size();
+  uint32_t       nd_u32 = nd;
+  std::ofstream sample_writer(output_file.c_str(), std::ios::binary);
   sample_writer.write((char *) &num_sampled_pts_u32, sizeof(uint32_t));
+  sample_writer.write((char *) &nd_u32, sizeof(uint32_t));
+  sample_writer.write((char *) sampled.get(), ids.size() * nd * sizeof(T));
   sample_writer.close();
   LOG_KNOWHERE_DEBUG_ << "Wrote " << num_sampled_pts_u32
                       << " points to sample file: " << output_file;
 }
 
-// streams data from the file, and samples each vector with probability p_val
-// and returns a matrix of size slice_size* ndims as floating point type.
-// the slice_size and ndims are set inside the function.
-
-/***********************************
- * Reimplement using gen_random_slice(const T* inputdata,...)
- ************************************/
-
+// samples each vector of the data file with probability p_val and returns a
+// contiguous matrix of size slice_size * ndims as floating point type. The
+// slice_size and ndims are set inside the function.
 template<typename T>
 void gen_random_slice(const std::string data_file, double p_val,
                       float *&sampled_data, size_t &slice_size, size_t &ndims) {
-  size_t                          npts;
-  uint32_t                        npts32, ndims32;
-  std::vector<std::vector<float>> sampled_vectors;
+  size_t npts;
+  diskann::get_bin_metadata(data_file, npts, ndims);
 
-  // amount to read in one shot
-  _u64 read_blk_size = 64 * 1024 * 1024;
-  // create cached reader + writer
-  cached_ifstream base_reader(data_file.c_str(), read_blk_size);
-
-  // metadata: npts, ndims
-  base_reader.read((char *) &npts32, sizeof(unsigned));
-  base_reader.read((char *) &ndims32, sizeof(unsigned));
-  npts = npts32;
-  ndims = ndims32;
-
-  std::unique_ptr<T[]> cur_vector_T = std::make_unique<T[]>(ndims);
-  p_val = p_val < 1 ? p_val : 1;
-
-  std::random_device rd;  // Will be used to obtain a seed for the random number
-  size_t             x = rd();
-  std::mt19937       generator((unsigned) x);
-  std::uniform_real_distribution<float> distribution(0, 1);
-
-  for (size_t i = 0; i < npts; i++) {
-    base_reader.read((char *) cur_vector_T.get(), ndims * sizeof(T));
-    float rnd_val = distribution(generator);
-    if (rnd_val < p_val) {
-      std::vector<float> cur_vector_float;
-      for (size_t d = 0; d < ndims; d++)
-        cur_vector_float.push_back(cur_vector_T[d]);
-      sampled_vectors.push_back(cur_vector_float);
-    }
-  }
-  slice_size = sampled_vectors.size();
+  auto ids = sample_row_ids(npts, p_val);
+  slice_size = ids.size();
   sampled_data = new float[slice_size * ndims];
-  for (size_t i = 0; i < slice_size; i++) {
-    for (size_t j = 0; j < ndims; j++) {
-      sampled_data[i * ndims + j] = sampled_vectors[i][j];
-    }
-  }
+  read_rows<T, float>(data_file, ndims, ids, sampled_data);
 }
 
 // same as above, but samples from the matrix inputdata instead of a file of
@@ -152,34 +207,13 @@ void gen_random_slice(const std::string data_file, double p_val,
 template<typename T>
 void gen_random_slice(const T *inputdata, size_t npts, size_t ndims,
                       double p_val, float *&sampled_data, size_t &slice_size) {
-  std::vector<std::vector<float>> sampled_vectors;
-  const T                        *cur_vector_T;
-
-  p_val = p_val < 1 ? p_val : 1;
-
-  std::random_device
-         rd;  // Will be used to obtain a seed for the random number engine
-  size_t x = rd();
-  std::mt19937 generator(
-      (unsigned) x);  // Standard mersenne_twister_engine seeded with rd()
-  std::uniform_real_distribution<float> distribution(0, 1);
-
-  for (size_t i = 0; i < npts; i++) {
-    cur_vector_T = inputdata + ndims * i;
-    float rnd_val = distribution(generator);
-    if (rnd_val < p_val) {
-      std::vector<float> cur_vector_float;
-      for (size_t d = 0; d < ndims; d++)
-        cur_vector_float.push_back(cur_vector_T[d]);
-      sampled_vectors.push_back(cur_vector_float);
-    }
-  }
-  slice_size = sampled_vectors.size();
+  auto ids = sample_row_ids(npts, p_val);
+  slice_size = ids.size();
   sampled_data = new float[slice_size * ndims];
   for (size_t i = 0; i < slice_size; i++) {
-    for (size_t j = 0; j < ndims; j++) {
-      sampled_data[i * ndims + j] = sampled_vectors[i][j];
-    }
+    const T *cur_vector_T = inputdata + ndims * ids[i];
+    for (size_t d = 0; d < ndims; d++)
+      sampled_data[i * ndims + d] = cur_vector_T[d];
   }
 }
 
@@ -379,13 +413,14 @@ template<typename T>
 int generate_pq_data_from_pivots(const std::string data_file,
                                  unsigned num_centers, unsigned num_pq_chunks,
                                  std::string pq_pivots_path,
-                                 std::string pq_compressed_vectors_path) {
-  _u64            read_blk_size = 64 * 1024 * 1024;
-  cached_ifstream base_reader(data_file, read_blk_size);
-  _u32            npts32;
-  _u32            basedim32;
-  base_reader.read((char *) &npts32, sizeof(uint32_t));
-  base_reader.read((char *) &basedim32, sizeof(uint32_t));
+                                 std::string pq_compressed_vectors_path,
+                                 size_t      max_block_size) {
+  FileDescriptor base_fd(data_file);
+  _u32           npts32;
+  _u32           basedim32;
+  pread_all(base_fd.fd, (char *) &npts32, sizeof(uint32_t), 0, data_file);
+  pread_all(base_fd.fd, (char *) &basedim32, sizeof(uint32_t),
+            sizeof(uint32_t), data_file);
   size_t num_points = npts32;
   size_t dim = basedim32;
 
@@ -464,7 +499,9 @@ int generate_pq_data_from_pivots(const std::string data_file,
   compressed_file_writer.write((char *) &num_points, sizeof(uint32_t));
   compressed_file_writer.write((char *) &num_pq_chunks_u32, sizeof(uint32_t));
 
-  size_t block_size = num_points <= BLOCK_SIZE ? num_points : BLOCK_SIZE;
+  size_t block_size = std::max<size_t>(
+      1, std::min(num_points, max_block_size > 0 ? max_block_size
+                                                 : (size_t) BLOCK_SIZE));
 
 #ifdef SAVE_INFLATED_PQ
   std::ofstream inflated_file_writer(inflated_pq_file, std::ios::binary);
@@ -481,7 +518,10 @@ int generate_pq_data_from_pivots(const std::string data_file,
   std::memset(block_compressed_base.get(), 0,
               block_size * (_u64) num_pq_chunks * sizeof(uint32_t));
 
-  std::unique_ptr<T[]> block_data_T = std::make_unique<T[]>(block_size * dim);
+  // two read buffers, the next block is read while the current one is encoded
+  std::unique_ptr<T[]> block_data_T[2] = {
+      std::make_unique<T[]>(block_size * dim),
+      std::make_unique<T[]>(block_size * dim)};
   std::unique_ptr<float[]> block_data_float =
       std::make_unique<float[]>(block_size * dim);
 
@@ -490,15 +530,27 @@ int generate_pq_data_from_pivots(const std::string data_file,
   std::vector<folly::Future<folly::Unit>> futures;
   futures.reserve(num_pq_chunks);
 
+  auto read_block = [&](size_t block) {
+    size_t start_id = block * block_size;
+    size_t cur_blk_size = (std::min)(block_size, num_points - start_id);
+    pread_all(base_fd.fd, (char *) block_data_T[block % 2].get(),
+              sizeof(T) * cur_blk_size * dim,
+              2 * sizeof(uint32_t) + sizeof(T) * start_id * dim, data_file);
+  };
+  std::future<void> next_read;
+  if (num_blocks > 0)
+    next_read = std::async(std::launch::async, read_block, 0);
+
   for (size_t block = 0; block < num_blocks; block++) {
     size_t start_id = block * block_size;
     size_t end_id = (std::min)((block + 1) * block_size, num_points);
     size_t cur_blk_size = end_id - start_id;
 
-    base_reader.read((char *) (block_data_T.get()),
-                     sizeof(T) * (cur_blk_size * dim));
-    diskann::convert_types<T, float>(block_data_T.get(), block_data_float.get(),
-                                     cur_blk_size, dim);
+    next_read.get();
+    if (block + 1 < num_blocks)
+      next_read = std::async(std::launch::async, read_block, block + 1);
+    diskann::convert_types<T, float>(block_data_T[block % 2].get(),
+                                     block_data_float.get(), cur_blk_size, dim);
 
     LOG_KNOWHERE_DEBUG_ << "Processing points  [" << start_id << ", " << end_id
                         << ")..";
@@ -524,6 +576,9 @@ int generate_pq_data_from_pivots(const std::string data_file,
             }
           }));
     }
+    for (auto &future : futures) {
+      future.wait();
+    }
 
     futures.clear();
     futures.reserve(num_pq_chunks);
@@ -1112,10 +1167,13 @@ template DISKANN_DLLEXPORT int retrieve_shard_data_from_ids<int8_t>(
 
 template DISKANN_DLLEXPORT int generate_pq_data_from_pivots<int8_t>(
     const std::string data_file, unsigned num_centers, unsigned num_pq_chunks,
-    std::string pq_pivots_path, std::string pq_compressed_vectors_path);
+    std::string pq_pivots_path, std::string pq_compressed_vectors_path,
+    size_t max_block_size);
 template DISKANN_DLLEXPORT int generate_pq_data_from_pivots<uint8_t>(
     const std::string data_file, unsigned num_centers, unsigned num_pq_chunks,
-    std::string pq_pivots_path, std::string pq_compressed_vectors_path);
+    std::string pq_pivots_path, std::string pq_compressed_vectors_path,
+    size_t max_block_size);
 template DISKANN_DLLEXPORT int generate_pq_data_from_pivots<float>(
     const std::string data_file, unsigned num_centers, unsigned num_pq_chunks,
-    std::string pq_pivots_path, std::string pq_compressed_vectors_path);
+    std::string pq_pivots_path, std::string pq_compressed_vectors_path,
+    size_t max_block_size);
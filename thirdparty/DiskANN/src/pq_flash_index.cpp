@@ -672,11 +672,47 @@ namespace diskann {
       READ_U64(index_metadata, this->reorder_data_start_sector);
       READ_U64(index_metadata, this->ndims_reorder_vecs);
       READ_U64(index_metadata, this->nvecs_per_sector);
+    } else {
+      _u64 unused_reorder_field;
+      for (int i = 0; i < 3; ++i) {
+        READ_U64(index_metadata, unused_reorder_field);
+      }
+    }
+
+    // zero for indexes laid out in id order, including files written before
+    // the field existed since the metadata sector is zero padded
+    _u64 node_locations_start_sector = 0;
+    READ_U64(index_metadata, node_locations_start_sector);
+    if (node_locations_start_sector != 0) {
+#ifdef EXEC_ENV_OLS
+      throw ANNException("Reordered disk layout is not supported", -1,
+                         __FUNCSIG__, __FILE__, __LINE__);
+#else
+      std::ifstream locations_reader(disk_index_file, std::ios::binary);
+      locations_reader.seekg(node_locations_start_sector * SECTOR_LEN,
+                             locations_reader.beg);
+      this->node_locations.resize(num_points);
+      locations_reader.read((char *) this->node_locations.data(),
+                            num_points * sizeof(_u32));
+      if (!locations_reader) {
+        throw ANNException("Failed to read node locations from " +
+                               disk_index_file,
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+      }
+      for (const auto loc : this->node_locations) {
+        if (loc >= num_points) {
+          throw ANNException("Node location out of range in " +
+                                 disk_index_file,
+                             -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+      }
+#endif
     }
     LOG(INFO) << "Disk-Index File Meta-data: "
               << "# nodes per sector: " << nnodes_per_sector
               << ", max node len (bytes): " << max_node_len
-              << ", max node degree: " << max_degree;
+              << ", max node degree: " << max_degree
+              << ", reordered layout: " << !this->node_locations.empty();
 
 #ifdef EXEC_ENV_OLS
     delete[] bytes;
@@ -1030,8 +1066,9 @@ namespace diskann {
     T *data_buf = query_scratch->coord_scratch;
 
     // sector scratch
-    char *sector_scratch = query_scratch->sector_scratch;
-    _u64 &sector_scratch_idx = query_scratch->sector_idx;
+    char              *sector_scratch = query_scratch->sector_scratch;
+    SectorScratchCache sectors(sector_scratch, MAX_N_SECTOR_READS,
+                               read_len_for_node);
 
     Timer io_timer, query_timer;
     // cleared every iteration
@@ -1107,7 +1144,7 @@ namespace diskann {
       frontier_nhoods.clear();
       frontier_read_reqs.clear();
       cached_nhoods.clear();
-      sector_scratch_idx = 0;
+      sectors.next_hop();
       // find new beam
       _u32 marker = k;
       _u32 num_seen = 0;
@@ -1147,30 +1184,33 @@ namespace diskann {
       if (!frontier.empty()) {
         if (stats != nullptr)
           stats->n_hops++;
+        // one read per sector, shared by the frontier nodes packed in it and
+        // skipped for the sectors this query read before
         for (_u64 i = 0; i < frontier.size(); i++) {
-          auto                    id = frontier[i];
-          std::pair<_u32, char *> fnhood;
-          fnhood.first = id;
-          fnhood.second =
-              sector_scratch + sector_scratch_idx * read_len_for_node;
-          sector_scratch_idx++;
-          frontier_nhoods.push_back(fnhood);
-          frontier_read_reqs.emplace_back(get_node_sector_offset(((size_t) id)),
-                                          read_len_for_node, fnhood.second);
-          if (stats != nullptr) {
-            stats->n_4k++;
-            stats->n_ios++;
+          auto       id = frontier[i];
+          const _u64 offset = get_node_sector_offset(((size_t) id));
+          char      *buf = sectors.find(offset);
+          if (buf == nullptr) {
+            buf = sectors.assign(offset);
+            frontier_read_reqs.emplace_back(offset, read_len_for_node, buf);
+            if (stats != nullptr) {
+              stats->n_4k++;
+              stats->n_ios++;
+            }
+            num_ios++;
           }
-          num_ios++;
+          frontier_nhoods.emplace_back(id, buf);
         }
-        io_timer.reset();
+        if (!frontier_read_reqs.empty()) {
+          io_timer.reset();
 #ifdef USE_BING_INFRA
-        reader->read(frontier_read_reqs, ctx, true);  // async reader windows.
+          reader->read(frontier_read_reqs, ctx, true);  // async reader windows.
 #else
-        reader->read(frontier_read_reqs, ctx);  // synchronous IO linux
+          reader->read(frontier_read_reqs, ctx);  // synchronous IO linux
 #endif
-        if (stats != nullptr) {
-          stats->io_us += (double) io_timer.elapsed();
+          if (stats != nullptr) {
+            stats->io_us += (double) io_timer.elapsed();
+          }
         }
       }
 
@@ -1450,6 +1490,348 @@ namespace diskann {
     }
   }
 
+  template<typename T>
+  void PQFlashIndex<T>::pipelined_beam_search(
+      const T *queries, const _u64 nq, const _u64 query_dim,
+      const _u64 k_search, const _u64 l_search, _s64 *res_ids,
+      float *res_dists, const _u64 beam_width, const _u64 pipeline_width,
+      knowhere::BitsetView bitset_view, const float filter_ratio_in,
+      const bool for_tuning) {
+    if (beam_width > MAX_N_SECTOR_READS)
+      throw ANNException("Beamwidth can not be higher than MAX_N_SECTOR_READS",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+
+    bool use_pipeline = pipeline_width > 1 && nq > 1 &&
+                        this->reader->support_pipelined_read();
+    if (use_pipeline && !bitset_view.empty()) {
+      const auto filter_threshold =
+          filter_ratio_in < 0 ? calcFilterThreshold(k_search) : filter_ratio_in;
+      use_pipeline =
+          bitset_view.count() < bitset_view.size() * filter_threshold;
+    }
+    if (!use_pipeline) {
+      for (_u64 q = 0; q < nq; q++) {
+        cached_beam_search(queries + q * query_dim, k_search, l_search,
+                           res_ids + q * k_search, res_dists + q * k_search,
+                           beam_width, false, nullptr, nullptr, bitset_view,
+                           filter_ratio_in, for_tuning);
+      }
+      return;
+    }
+
+    // per query search state, the loop variables of cached_beam_search
+    struct Slot {
+      ThreadData<T>                            data;
+      _u64                                     query_id = 0;
+      float                                    query_norm = 0;
+      uint64_t                                 vec_hash = 0;
+      std::vector<Neighbor>                    retset;
+      std::vector<Neighbor>                    full_retset;
+      unsigned                                 cur_list_size = 0;
+      unsigned                                 k = 0;
+      unsigned                                 nk = 0;
+      unsigned                                 pending = 0;
+      bool                                     running = false;
+      std::vector<std::pair<unsigned, char *>> frontier_nhoods;
+      std::vector<AlignedRead>                 frontier_read_reqs;
+      std::optional<SectorScratchCache>        sectors;
+    };
+
+    // the first scratch is waited for, the others are only taken if free
+    std::vector<Slot> slots(std::min(pipeline_width, nq));
+    size_t            n_slots = 0;
+    for (auto &slot : slots) {
+      slot.data = this->thread_data.pop();
+      while (n_slots == 0 && slot.data.scratch.sector_scratch == nullptr) {
+        this->thread_data.wait_for_push_notify();
+        slot.data = this->thread_data.pop();
+      }
+      if (slot.data.scratch.sector_scratch == nullptr) {
+        break;
+      }
+      slot.retset.resize(l_search + 1);
+      slot.full_retset.reserve(4096);
+      slot.frontier_nhoods.reserve(2 * beam_width);
+      slot.frontier_read_reqs.reserve(2 * beam_width);
+      slot.sectors.emplace(slot.data.scratch.sector_scratch, MAX_N_SECTOR_READS,
+                           read_len_for_node);
+      n_slots++;
+    }
+    slots.resize(n_slots);
+
+    auto compute_dists = [this](Slot &s, const unsigned *ids, const _u64 n_ids,
+                                float *dists_out) {
+      auto &scratch = s.data.scratch;
+      aggregate_coords(ids, n_ids, this->data, this->n_chunks,
+                       scratch.aligned_pq_coord_scratch);
+      pq_dist_lookup(scratch.aligned_pq_coord_scratch, n_ids, this->n_chunks,
+                     scratch.aligned_pqtable_dist_scratch, dists_out);
+    };
+
+    auto full_dist = [this](Slot &s, unsigned id, T *node_fp_coords) {
+      const T     *query = s.data.scratch.aligned_query_T;
+      const float *query_float = s.data.scratch.aligned_query_float;
+      if (!use_disk_index_pq) {
+        return (float) dist_cmp_wrap(query, node_fp_coords,
+                                     (size_t) aligned_dim, id);
+      } else if (metric == diskann::Metric::INNER_PRODUCT ||
+                 metric == diskann::Metric::COSINE) {
+        return disk_pq_table.inner_product(query_float, (_u8 *) node_fp_coords);
+      } else {
+        return disk_pq_table.l2_distance(query_float, (_u8 *) node_fp_coords);
+      }
+    };
+
+    // expands one node: its full precision distance and its neighbors
+    auto expand_node = [&](Slot &s, unsigned node_id, T *node_fp_coords,
+                           const _u64 nnbrs, const unsigned *node_nbrs) {
+      if (bitset_view.empty() || !bitset_view.test(node_id)) {
+        s.full_retset.push_back(
+            Neighbor(node_id, full_dist(s, node_id, node_fp_coords), true));
+      }
+      float *dist_scratch = s.data.scratch.aligned_dist_scratch;
+      auto  &visited = *(s.data.scratch.visited);
+      compute_dists(s, node_nbrs, nnbrs, dist_scratch);
+      for (_u64 m = 0; m < nnbrs; ++m) {
+        unsigned id = node_nbrs[m];
+        if (visited.find(id) != visited.end()) {
+          continue;
+        }
+        visited.insert(id);
+        float dist = dist_scratch[m];
+        if (s.cur_list_size > 0 &&
+            dist >= s.retset[s.cur_list_size - 1].distance &&
+            (s.cur_list_size == l_search))
+          continue;
+        Neighbor nn(id, dist, true);
+        auto     r = InsertIntoPool(s.retset.data(), s.cur_list_size, nn);
+        if (s.cur_list_size < l_search)
+          ++s.cur_list_size;
+        if (r < s.nk)
+          s.nk = r;
+      }
+    };
+
+    // returns false if there is nothing to search for the query
+    auto start_query = [&](Slot &s, _u64 query_id) {
+      s.query_id = query_id;
+      auto query_norm_opt =
+          init_thread_data(s.data, queries + query_id * query_dim);
+      if (!query_norm_opt.has_value()) {
+        // return an empty answer when calcu a zero point
+        for (_u64 i = 0; i < k_search; i++) {
+          res_ids[query_id * k_search + i] = -1;
+          res_dists[query_id * k_search + i] = -1;
+        }
+        return false;
+      }
+      s.query_norm = query_norm_opt.value();
+      const float *query_float = s.data.scratch.aligned_query_float;
+      pq_table.populate_chunk_distances(
+          query_float, s.data.scratch.aligned_pqtable_dist_scratch);
+
+      s.vec_hash = knowhere::hash_vec(query_float, data_dim);
+      _u32 best_medoid = 0;
+      // for tuning, do not use cache
+      if (for_tuning || !lru_cache.try_get(s.vec_hash, best_medoid)) {
+        float best_dist = (std::numeric_limits<float>::max)();
+        for (_u64 cur_m = 0; cur_m < num_medoids; cur_m++) {
+          float cur_expanded_dist = dist_cmp_float_wrap(
+              query_float, centroid_data + aligned_dim * cur_m,
+              (size_t) aligned_dim, medoids[cur_m]);
+          if (cur_expanded_dist < best_dist) {
+            best_medoid = medoids[cur_m];
+            best_dist = cur_expanded_dist;
+          }
+        }
+      }
+
+      float *dist_scratch = s.data.scratch.aligned_dist_scratch;
+      compute_dists(s, &best_medoid, 1, dist_scratch);
+      s.retset[0].id = best_medoid;
+      s.retset[0].flag = true;
+      s.retset[0].distance = dist_scratch[0];
+      s.data.scratch.visited->insert(best_medoid);
+      s.full_retset.clear();
+      s.sectors->reset(s.data.scratch.sector_scratch);
+      s.cur_list_size = 1;
+      s.k = 0;
+      s.pending = 0;
+      s.running = true;
+      return true;
+    };
+
+    auto finish_query = [&](Slot &s) {
+      std::sort(s.full_retset.begin(), s.full_retset.end(),
+                [](const Neighbor &left, const Neighbor &right) {
+                  return left.distance < right.distance;
+                });
+      _s64  *indices = res_ids + s.query_id * k_search;
+      float *distances = res_dists + s.query_id * k_search;
+      for (_u64 i = 0; i < k_search; i++) {
+        if (i >= s.full_retset.size()) {
+          indices[i] = -1;
+          distances[i] = -1;
+          continue;
+        }
+        indices[i] = s.full_retset[i].id;
+        distances[i] = s.full_retset[i].distance;
+        if (metric == diskann::Metric::INNER_PRODUCT) {
+          // convert l2 distance to ip distance
+          distances[i] = 1.0 - distances[i] / 2.0;
+          // rescale to revert back to original norms (cancelling the effect of
+          // base and query pre-processing)
+          if (max_base_norm != 0)
+            distances[i] *= (max_base_norm * s.query_norm);
+        } else if (metric == diskann::Metric::COSINE) {
+          distances[i] = -distances[i];
+        }
+      }
+      if (k_search > 0) {
+        lru_cache.put(s.vec_hash, indices[0]);
+      }
+    };
+
+    // selects the next beam, submits the reads of its uncached nodes and
+    // expands the cached ones while those reads are in flight
+    auto issue_hop = [&](Slot &s, uint64_t tag) {
+      s.nk = s.cur_list_size;
+      s.frontier_nhoods.clear();
+      s.frontier_read_reqs.clear();
+      s.sectors->next_hop();
+
+      std::vector<std::pair<unsigned, std::pair<unsigned, unsigned *>>>
+           cached_nhoods;
+      _u32 marker = s.k;
+      _u32 num_seen = 0;
+      while (marker < s.cur_list_size &&
+             s.frontier_nhoods.size() < beam_width && num_seen < beam_width) {
+        auto &cand = s.retset[marker];
+        if (cand.flag) {
+          num_seen++;
+          auto iter = nhood_cache.find(cand.id);
+          if (iter != nhood_cache.end()) {
+            cached_nhoods.push_back(std::make_pair(cand.id, iter->second));
+          } else {
+            // one read per sector, none for the sectors the query read before
+            const _u64 offset = get_node_sector_offset(((size_t) cand.id));
+            char      *buf = s.sectors->find(offset);
+            if (buf == nullptr) {
+              buf = s.sectors->assign(offset);
+              s.frontier_read_reqs.emplace_back(offset, read_len_for_node, buf);
+            }
+            s.frontier_nhoods.emplace_back(cand.id, buf);
+          }
+          cand.flag = false;
+          if (this->count_visited_nodes) {
+            reinterpret_cast<std::atomic<_u32> &>(
+                this->node_visit_counter[cand.id].second)
+                .fetch_add(1);
+          }
+          if (!bitset_view.empty() && bitset_view.test(cand.id)) {
+            std::memmove(&s.retset[marker], &s.retset[marker + 1],
+                         (s.cur_list_size - marker - 1) * sizeof(Neighbor));
+            s.cur_list_size--;
+          } else {
+            marker++;
+          }
+        } else {
+          marker++;
+        }
+      }
+
+      if (!s.frontier_read_reqs.empty()) {
+        s.pending = s.frontier_read_reqs.size();
+        reader->submit_tagged(s.frontier_read_reqs, tag);
+      }
+
+      for (auto &cached_nhood : cached_nhoods) {
+        auto global_cache_iter = coord_cache.find(cached_nhood.first);
+        expand_node(s, cached_nhood.first, global_cache_iter->second,
+                    cached_nhood.second.first, cached_nhood.second.second);
+      }
+    };
+
+    // expands the frontier nodes once their sectors landed
+    auto complete_hop = [&](Slot &s) {
+      T *data_buf = s.data.scratch.coord_scratch;
+      for (auto &frontier_nhood : s.frontier_nhoods) {
+        char *node_disk_buf =
+            get_offset_to_node(frontier_nhood.second, frontier_nhood.first);
+        unsigned *node_buf = OFFSET_TO_NODE_NHOOD(node_disk_buf);
+        _u64      nnbrs = (_u64) (*node_buf);
+        T        *node_fp_coords = OFFSET_TO_NODE_COORDS(node_disk_buf);
+        memcpy(data_buf, node_fp_coords, disk_bytes_per_point);
+        expand_node(s, frontier_nhood.first, data_buf, nnbrs, node_buf + 1);
+      }
+      // update best inserted position
+      if (s.nk <= s.k)
+        s.k = s.nk;
+      else
+        ++s.k;
+    };
+
+    _u64 next_query = 0;
+    // moves the slot forward until it waits on I/O, returns false once there
+    // are no queries left for it
+    auto advance = [&](size_t slot_id) {
+      auto &s = slots[slot_id];
+      while (true) {
+        if (s.pending == 0 && s.k >= s.cur_list_size) {
+          if (s.running) {
+            finish_query(s);
+            s.running = false;
+          }
+          while (next_query < nq && !start_query(s, next_query)) {
+            next_query++;
+          }
+          if (next_query >= nq) {
+            return false;
+          }
+          next_query++;
+        }
+        issue_hop(s, slot_id);
+        if (s.pending > 0) {
+          return true;
+        }
+        complete_hop(s);
+      }
+    };
+
+    auto release_slots = [&]() {
+      for (auto &s : slots) {
+        this->thread_data.push(s.data);
+      }
+      this->thread_data.push_notify_all();
+    };
+
+    try {
+      size_t n_active = 0;
+      for (size_t i = 0; i < slots.size(); i++) {
+        n_active += advance(i);
+      }
+      std::vector<uint64_t> tags;
+      while (n_active > 0) {
+        tags.clear();
+        reader->reap_tagged(tags);
+        for (auto tag : tags) {
+          auto &s = slots[tag];
+          if (--s.pending > 0) {
+            continue;
+          }
+          complete_hop(s);
+          n_active -= !advance(tag);
+        }
+      }
+    } catch (...) {
+      // the reads still in flight would land in the scratch of the slots
+      reader->cancel_tagged();
+      release_slots();
+      throw;
+    }
+    release_slots();
+  }
+
   // range search returns results of all neighbors within distance of range.
   // indices and distances need to be pre-allocated of size l_search and the
   // return value is the number of matching hits.
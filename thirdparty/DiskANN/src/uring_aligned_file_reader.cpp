@@ -0,0 +1,473 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/uring_aligned_file_reader.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "diskann/utils.h"
+
+namespace {
+  // submission queue depth, the completion queue gets twice as many entries
+  // and bounds the number of reads in flight per thread
+  static constexpr unsigned n_ring_entries = 2048;
+  static constexpr uint64_t n_retries = 10;
+  // tag of the requests issued by the blocking read()
+  static constexpr uint64_t sync_tag = std::numeric_limits<uint64_t>::max();
+  // user_data of the cancel requests, never the index of a read slot
+  static constexpr uint64_t cancel_user_data =
+      std::numeric_limits<uint64_t>::max();
+
+  int io_uring_setup(unsigned entries, io_uring_params *p) {
+    return (int) ::syscall(__NR_io_uring_setup, entries, p);
+  }
+
+  int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                     unsigned flags) {
+    return (int) ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                           flags, nullptr, 0);
+  }
+
+  int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int) ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+  }
+
+  [[noreturn]] void throw_errno(const std::string &what, int err) {
+    std::stringstream ss;
+    ss << "Unknown error occur in " << what << ", errno: " << err << ", "
+       << strerror(err);
+    throw diskann::ANNException(ss.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+
+  // A single-issuer io_uring without liburing, owned by one thread.
+  class Ring {
+   public:
+    Ring() {
+      io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      ring_fd_ = io_uring_setup(n_ring_entries, &p);
+      if (ring_fd_ < 0) {
+        throw_errno("io_uring_setup", errno);
+      }
+      sq_entries_ = p.sq_entries;
+      cq_entries_ = p.cq_entries;
+
+      sq_ring_sz_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      cq_ring_sz_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+      single_mmap_ = p.features & IORING_FEAT_SINGLE_MMAP;
+      if (single_mmap_) {
+        sq_ring_sz_ = cq_ring_sz_ = std::max(sq_ring_sz_, cq_ring_sz_);
+      }
+      sq_ptr_ = ::mmap(nullptr, sq_ring_sz_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+      cq_ptr_ = single_mmap_
+                    ? sq_ptr_
+                    : ::mmap(nullptr, cq_ring_sz_, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd_,
+                             IORING_OFF_CQ_RING);
+      sqes_sz_ = p.sq_entries * sizeof(io_uring_sqe);
+      sqes_ = (io_uring_sqe *) ::mmap(nullptr, sqes_sz_,
+                                      PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                      IORING_OFF_SQES);
+      if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED ||
+          (void *) sqes_ == MAP_FAILED) {
+        int err = errno;
+        release();
+        throw_errno("io_uring mmap", err);
+      }
+
+      auto sq = (char *) sq_ptr_;
+      sq_head_ = (unsigned *) (sq + p.sq_off.head);
+      sq_tail_ = (unsigned *) (sq + p.sq_off.tail);
+      sq_mask_ = *(unsigned *) (sq + p.sq_off.ring_mask);
+      sq_array_ = (unsigned *) (sq + p.sq_off.array);
+      auto cq = (char *) cq_ptr_;
+      cq_head_ = (unsigned *) (cq + p.cq_off.head);
+      cq_tail_ = (unsigned *) (cq + p.cq_off.tail);
+      cq_mask_ = *(unsigned *) (cq + p.cq_off.ring_mask);
+      cqes_ = (io_uring_cqe *) (cq + p.cq_off.cqes);
+    }
+
+    ~Ring() {
+      release();
+    }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    uint64_t capacity() const {
+      return cq_entries_;
+    }
+
+    uint64_t inflight() const {
+      return inflight_;
+    }
+
+    // queue one read, the submission queue is flushed when it is full
+    void push(int fd, const AlignedRead &req, uint64_t tag) {
+      uint32_t slot;
+      if (free_slots_.empty()) {
+        slot = (uint32_t) pending_.size();
+        pending_.emplace_back();
+      } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      }
+      pending_[slot] = {fd, (char *) req.buf, req.len, req.offset, tag, true};
+      queue(slot);
+      inflight_++;
+    }
+
+    // submit the queued reads, then block until `wait_nr` completions are
+    // available
+    void enter(unsigned wait_nr) {
+      uint64_t retry = 0;
+      while (true) {
+        int ret = io_uring_enter(ring_fd_, to_submit_, wait_nr,
+                                 wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (ret < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          if ((errno == EAGAIN || errno == EBUSY) && ++retry <= n_retries) {
+            LOG(WARNING) << "io_uring_enter() busy, retry: " << retry;
+            continue;
+          }
+          throw_errno("io_uring_enter", errno);
+        }
+        to_submit_ -= ret;
+        if (to_submit_ == 0) {
+          return;
+        }
+      }
+    }
+
+    // calls f(tag) for every read that completed in full, returns their
+    // number; the remainder of a short read is queued again
+    template<typename F>
+    unsigned reap(F &&f) {
+      unsigned head = *cq_head_;
+      unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      unsigned n = 0;
+      bool     requeued = false;
+      for (; head != tail; ++head) {
+        const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        const uint32_t      slot = (uint32_t) cqe.user_data;
+        Pending            &req = pending_[slot];
+        if (cqe.res <= 0) {
+          __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+          release_slot(slot);
+          inflight_ -= n + 1;
+          if (cqe.res < 0) {
+            throw_errno("io_uring read", -cqe.res);
+          }
+          std::stringstream err;
+          err << "io_uring read hit end of file at offset " << req.offset
+              << ", " << req.len << " bytes missing";
+          throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                      __LINE__);
+        }
+        if ((uint64_t) cqe.res < req.len) {
+          req.buf += cqe.res;
+          req.len -= cqe.res;
+          req.offset += cqe.res;
+          queue(slot);
+          requeued = true;
+          continue;
+        }
+        release_slot(slot);
+        f(req.tag);
+        ++n;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      inflight_ -= n;
+      if (requeued) {
+        enter(0);
+      }
+      return n;
+    }
+
+    // Cancels every read in flight, then waits until the kernel is done with
+    // all of them, so that no completion and no stashed tag outlives the
+    // buffers of a search that failed. The remainder of a short read is not
+    // queued again.
+    void cancel_all() {
+      stash.clear();
+      uint64_t n_cancels = 0;
+      // consumes the completions available, of reads and cancels alike
+      auto drop = [&]() {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+          const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+          if (cqe.user_data == cancel_user_data) {
+            n_cancels--;
+          } else {
+            release_slot((uint32_t) cqe.user_data);
+            inflight_--;
+          }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      };
+      for (uint32_t slot = 0; slot < pending_.size(); slot++) {
+        if (!pending_[slot].busy) {
+          continue;
+        }
+        // reads and cancels together must not overflow the completion queue
+        while (inflight_ + n_cancels >= cq_entries_) {
+          enter(1);
+          drop();
+        }
+        queue_cancel(slot);
+        n_cancels++;
+      }
+      while (inflight_ + n_cancels > 0) {
+        enter(1);
+        drop();
+      }
+    }
+
+    // tags of pipelined reads that completed while a blocking read waited
+    std::vector<uint64_t> stash;
+
+   private:
+    // a read in flight, the user_data of its sqe is the index of its slot
+    struct Pending {
+      int      fd;
+      char    *buf;
+      uint64_t len;
+      uint64_t offset;
+      uint64_t tag;
+      bool     busy;
+    };
+
+    void release_slot(uint32_t slot) {
+      pending_[slot].busy = false;
+      free_slots_.push_back(slot);
+    }
+
+    // the sqe at the tail of the submission queue, flushed first if full
+    io_uring_sqe *next_sqe() {
+      unsigned tail = *sq_tail_;
+      if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        enter(0);
+      }
+      unsigned      idx = tail & sq_mask_;
+      io_uring_sqe *sqe = sqes_ + idx;
+      memset(sqe, 0, sizeof(*sqe));
+      sq_array_[idx] = idx;
+      return sqe;
+    }
+
+    void commit_sqe() {
+      __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+      to_submit_++;
+    }
+
+    void queue(uint32_t slot) {
+      const Pending &req = pending_[slot];
+      io_uring_sqe  *sqe = next_sqe();
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = req.fd;
+      sqe->addr = (uint64_t) req.buf;
+      sqe->len = (uint32_t) req.len;
+      sqe->off = req.offset;
+      sqe->user_data = slot;
+      commit_sqe();
+    }
+
+    // asks the kernel to cancel the read of a slot, its completion still comes
+    void queue_cancel(uint32_t slot) {
+      io_uring_sqe *sqe = next_sqe();
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->fd = -1;
+      sqe->addr = slot;
+      sqe->user_data = cancel_user_data;
+      commit_sqe();
+    }
+
+    void release() {
+      if (sqes_ != nullptr && (void *) sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqes_sz_);
+      }
+      if (cq_ptr_ != nullptr && cq_ptr_ != MAP_FAILED && !single_mmap_) {
+        ::munmap(cq_ptr_, cq_ring_sz_);
+      }
+      if (sq_ptr_ != nullptr && sq_ptr_ != MAP_FAILED) {
+        ::munmap(sq_ptr_, sq_ring_sz_);
+      }
+      ::close(ring_fd_);
+    }
+
+    int           ring_fd_ = -1;
+    unsigned      sq_entries_ = 0, cq_entries_ = 0;
+    bool          single_mmap_ = false;
+    size_t        sq_ring_sz_ = 0, cq_ring_sz_ = 0, sqes_sz_ = 0;
+    void         *sq_ptr_ = nullptr;
+    void         *cq_ptr_ = nullptr;
+    io_uring_sqe *sqes_ = nullptr;
+    unsigned     *sq_head_, *sq_tail_, *sq_array_, sq_mask_;
+    unsigned     *cq_head_, *cq_tail_, cq_mask_;
+    io_uring_cqe *cqes_;
+    unsigned      to_submit_ = 0;
+    uint64_t      inflight_ = 0;
+    std::vector<Pending>  pending_;
+    std::vector<uint32_t> free_slots_;
+  };
+
+  Ring &local_ring() {
+    static thread_local Ring ring;
+    return ring;
+  }
+}  // namespace
+
+UringAlignedFileReader::UringAlignedFileReader() {
+  this->file_desc = -1;
+}
+
+UringAlignedFileReader::~UringAlignedFileReader() {
+  if (this->file_desc != -1 && ::fcntl(this->file_desc, F_GETFD) != -1) {
+    std::cerr << "close() not called" << std::endl;
+    ::close(this->file_desc);
+  }
+}
+
+bool UringAlignedFileReader::is_supported() {
+  io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = io_uring_setup(1, &p);
+  if (fd < 0) {
+    LOG(WARNING) << "io_uring_setup() failed, errno: " << errno << ", "
+                 << strerror(errno);
+    return false;
+  }
+  // IORING_OP_READ needs linux 5.6, which is also the first to support probing
+  constexpr unsigned n_ops = 256;
+  std::vector<char>  buf(sizeof(io_uring_probe) +
+                        n_ops * sizeof(io_uring_probe_op));
+  auto               probe = (io_uring_probe *) buf.data();
+  bool               supported =
+      io_uring_register(fd, IORING_REGISTER_PROBE, probe, n_ops) == 0 &&
+      probe->last_op >= IORING_OP_READ &&
+      (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+  ::close(fd);
+  if (!supported) {
+    LOG(WARNING) << "io_uring does not support IORING_OP_READ";
+  }
+  return supported;
+}
+
+void UringAlignedFileReader::open(const std::string &fname) {
+  int flags = O_DIRECT | O_RDONLY | O_LARGEFILE;
+  this->file_desc = ::open(fname.c_str(), flags);
+  // error checks
+  assert(this->file_desc != -1);
+  LOG_KNOWHERE_DEBUG_ << "Opened file : " << fname;
+}
+
+void UringAlignedFileReader::close() {
+  ::close(this->file_desc);
+  this->file_desc = -1;
+}
+
+void UringAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
+                                  io_context_t &ctx, bool async) {
+  if (async == true) {
+    diskann::cout << "Async currently not supported in linux." << std::endl;
+  }
+  assert(this->file_desc != -1);
+
+  auto &ring = local_ring();
+  // break-up requests so that completions never outnumber the ring
+  const uint64_t maxnr =
+      std::max<uint64_t>(1, ring.capacity() - ring.inflight());
+  for (size_t begin = 0; begin < read_reqs.size(); begin += maxnr) {
+    const size_t end = std::min(read_reqs.size(), begin + maxnr);
+    for (size_t j = begin; j < end; j++) {
+      ring.push(this->file_desc, read_reqs[j], sync_tag);
+    }
+    uint64_t remaining = end - begin;
+    while (remaining > 0) {
+      ring.enter(1);
+      ring.reap([&](uint64_t tag) {
+        if (tag == sync_tag) {
+          remaining--;
+        } else {
+          ring.stash.push_back(tag);
+        }
+      });
+    }
+  }
+}
+
+void UringAlignedFileReader::submit_req(io_context_t             &ctx,
+                                        std::vector<AlignedRead> &read_reqs) {
+  auto &ring = local_ring();
+  if (ring.inflight() + read_reqs.size() > ring.capacity()) {
+    std::stringstream err;
+    err << "Async does not support number of read requests ("
+        << read_reqs.size() << ") exceeds the free ring entries ("
+        << ring.capacity() - ring.inflight() << ")";
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+  for (auto &req : read_reqs) {
+    ring.push(this->file_desc, req, sync_tag);
+  }
+  ring.enter(0);
+}
+
+void UringAlignedFileReader::get_submitted_req(io_context_t &ctx,
+                                               size_t        n_ops) {
+  auto &ring = local_ring();
+  while (n_ops > 0) {
+    ring.enter(1);
+    ring.reap([&](uint64_t tag) {
+      if (tag == sync_tag) {
+        n_ops--;
+      } else {
+        ring.stash.push_back(tag);
+      }
+    });
+  }
+}
+
+void UringAlignedFileReader::submit_tagged(std::vector<AlignedRead> &read_reqs,
+                                           uint64_t                  tag) {
+  assert(tag != sync_tag);
+  auto &ring = local_ring();
+  if (ring.inflight() + read_reqs.size() > ring.capacity()) {
+    std::stringstream err;
+    err << "Pipelined read requests (" << read_reqs.size()
+        << ") exceed the free ring entries ("
+        << ring.capacity() - ring.inflight() << ")";
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+  for (auto &req : read_reqs) {
+    ring.push(this->file_desc, req, tag);
+  }
+  ring.enter(0);
+}
+
+void UringAlignedFileReader::cancel_tagged() {
+  local_ring().cancel_all();
+}
+
+void UringAlignedFileReader::reap_tagged(std::vector<uint64_t> &tags) {
+  auto &ring = local_ring();
+  tags.insert(tags.end(), ring.stash.begin(), ring.stash.end());
+  ring.stash.clear();
+  auto collect = [&](uint64_t tag) { tags.push_back(tag); };
+  // a completion may only queue the remainder of a short read
+  while (ring.reap(collect) == 0 && tags.empty()) {
+    ring.enter(1);
+  }
+}
@@ -41,4 +41,12 @@ void sq_hook() {
 #endif
 }
 
+bool pq4_use_avx512 = false;
+
+void pq4_hook() {
+#ifdef __x86_64__
+    pq4_use_avx512 = use_avx512 && cpu_support_avx512();
+#endif
+}
+
 } // namespace faiss
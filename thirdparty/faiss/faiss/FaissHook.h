@@ -30,4 +30,8 @@ extern sq_get_distance_computer_func_ptr sq_get_distance_computer;
 extern sq_sel_quantizer_func_ptr sq_sel_quantizer;
 extern sq_sel_inv_list_scanner_func_ptr sq_sel_inv_list_scanner;
 void sq_hook();
+
+/// the 4-bit PQ fast-scan kernels run on 512-bit registers, set by pq4_hook()
+extern bool pq4_use_avx512;
+void pq4_hook();
 } // namespace faiss
@@ -515,13 +515,11 @@ BinaryInvertedListScanner* select_IVFBinaryScannerJaccard(size_t code_size) {
     case cs:                                                                  \
         return new IVFBinaryScannerJaccard<JaccardComputer##cs, store_pairs>( \
                 cs);
+    // longer codes go to JaccardComputerDefault, which uses the simd kernels
     switch (code_size) {
         HANDLE_CS(16)
         HANDLE_CS(32)
         HANDLE_CS(64)
-        HANDLE_CS(128)
-        HANDLE_CS(256)
-        HANDLE_CS(512)
         default:
             return new IVFBinaryScannerJaccard<
                     JaccardComputerDefault,
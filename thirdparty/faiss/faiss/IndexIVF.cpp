@@ -1224,7 +1224,7 @@ void IndexIVFStats::add(const IndexIVFStats& other) {
     search_time += other.search_time;
 }
 
-IndexIVFStats indexIVF_stats;
+thread_local IndexIVFStats indexIVF_stats;
 
 /*************************************************************************
  * InvertedListScanner
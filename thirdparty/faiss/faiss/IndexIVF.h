@@ -287,6 +287,36 @@ struct IndexIVF : Index, Level1Quantizer {
             const size_t max_codes,
             const BitsetView bitset = nullptr) const;
 
+    /** Search a batch of queries whose nprobe lists are already assigned,
+     * visiting every inverted list once for all the queries of the batch
+     * that probe it instead of once per query. Runs on the calling thread.
+     *
+     * @param assign       coarse assignment, size n * nprobe
+     * @param centroid_dis coarse distances, size n * nprobe
+     */
+    void search_preassigned_by_list(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            size_t nprobe,
+            const idx_t* assign,
+            const float* centroid_dis,
+            float* distances,
+            idx_t* labels,
+            const BitsetView bitset = nullptr) const;
+
+    /** Similar to search_preassigned_by_list, but does not store codes **/
+    void search_preassigned_by_list_without_codes(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            size_t nprobe,
+            const idx_t* assign,
+            const float* centroid_dis,
+            float* distances,
+            idx_t* labels,
+            const BitsetView bitset = nullptr) const;
+
     void range_search(
             idx_t n,
             const float* x,
@@ -548,8 +578,9 @@ struct IndexIVFStats {
     void add(const IndexIVFStats& other);
 };
 
-// global var that collects them all
-FAISS_API extern IndexIVFStats indexIVF_stats;
+// collects them all, per thread so that concurrent searches do not race on
+// it and the caller can account for the searches it ran
+FAISS_API extern thread_local IndexIVFStats indexIVF_stats;
 
 } // namespace faiss
 
@@ -0,0 +1,249 @@
+#include <faiss/IndexIVFPQFastScanRefine.h>
+
+#include <knowhere/utils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/utils/Heap.h>
+
+namespace faiss {
+
+/***************************************************
+ * IndexIVFPQFastScanRefine
+ ***************************************************/
+
+IndexIVFPQFastScanRefine::IndexIVFPQFastScanRefine(
+        IndexIVFPQFastScan* base_index,
+        Index* refine_index)
+        : IndexRefine(base_index, refine_index) {
+    is_trained = base_index->is_trained &&
+            (refine_index == nullptr || refine_index->is_trained);
+}
+
+IndexIVFPQFastScanRefine::IndexIVFPQFastScanRefine() : IndexRefine() {}
+
+namespace {
+
+typedef faiss::Index::idx_t idx_t;
+
+// the k best of the k_base refined candidates of every query, sorted
+template <class C>
+void reorder_heaps(
+        idx_t n,
+        idx_t k,
+        idx_t* labels,
+        float* distances,
+        idx_t k_base,
+        const idx_t* base_labels,
+        const float* base_distances) {
+    for (idx_t i = 0; i < n; i++) {
+        idx_t* idxo = labels + i * k;
+        float* diso = distances + i * k;
+        const idx_t* idxi = base_labels + i * k_base;
+        const float* disi = base_distances + i * k_base;
+
+        heap_heapify<C>(k, diso, idxo, disi, idxi, k);
+        if (k_base != k) { // add remaining elements
+            heap_addn<C>(k, diso, idxo, disi + k, idxi + k, k_base - k);
+        }
+        heap_reorder<C>(k, diso, idxo);
+    }
+}
+
+// a copy of x normalized when the base index is a cosine one, x otherwise
+const float* refine_input(
+        const IndexIVFPQFastScan* base,
+        idx_t n,
+        const float* x,
+        std::unique_ptr<float[]>& copy) {
+    if (!base->is_cosine_) {
+        return x;
+    }
+    copy = std::make_unique<float[]>(n * base->d);
+    std::memcpy(copy.get(), x, n * base->d * sizeof(float));
+    knowhere::NormalizeVecs(copy.get(), n, base->d);
+    return copy.get();
+}
+
+} // anonymous namespace
+
+const IndexIVFPQFastScan* IndexIVFPQFastScanRefine::fast_scan_index() const {
+    auto base = dynamic_cast<const IndexIVFPQFastScan*>(base_index);
+    FAISS_THROW_IF_NOT(base);
+    return base;
+}
+
+void IndexIVFPQFastScanRefine::train(idx_t n, const float* x) {
+    base_index->train(n, x);
+    if (has_refine()) {
+        std::unique_ptr<float[]> copy;
+        refine_index->train(n, refine_input(fast_scan_index(), n, x, copy));
+    }
+    is_trained = true;
+}
+
+void IndexIVFPQFastScanRefine::add(idx_t n, const float* x) {
+    FAISS_THROW_IF_NOT(is_trained);
+    base_index->add(n, x);
+    if (has_refine()) {
+        std::unique_ptr<float[]> copy;
+        refine_index->add(n, refine_input(fast_scan_index(), n, x, copy));
+    }
+    ntotal = base_index->ntotal;
+}
+
+void IndexIVFPQFastScanRefine::reset() {
+    base_index->reset();
+    if (has_refine()) {
+        refine_index->reset();
+    }
+    ntotal = 0;
+}
+
+void IndexIVFPQFastScanRefine::search(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const BitsetView bitset) const {
+    search_thread_safe(
+            n,
+            x,
+            k,
+            distances,
+            labels,
+            fast_scan_index()->nprobe,
+            size_t(k * k_factor),
+            bitset);
+}
+
+void IndexIVFPQFastScanRefine::reconstruct(idx_t key, float* recons) const {
+    FAISS_THROW_IF_NOT_MSG(
+            has_refine(), "reconstruct needs a refine index");
+    refine_index->reconstruct(key, recons);
+}
+
+int64_t IndexIVFPQFastScanRefine::size() const {
+    auto base = fast_scan_index();
+
+    auto nb = base->invlists->compute_ntotal();
+    auto code_size = base->code_size;
+    auto& pq = base->pq;
+    auto nlist = base->nlist;
+
+    auto capacity =
+            nb * code_size + nb * sizeof(int64_t) + nlist * d * sizeof(float);
+    auto centroid_table = pq.M * pq.ksub * pq.dsub * sizeof(float);
+    auto precomputed_table = nlist * pq.M * pq.ksub * sizeof(float);
+
+    auto refine_data =
+            has_refine() ? ntotal * refine_index->sa_code_size() : 0;
+    return (capacity + centroid_table + precomputed_table + refine_data);
+}
+
+void IndexIVFPQFastScanRefine::search_thread_safe(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels,
+        const size_t nprobe,
+        const size_t reorder_k,
+        const BitsetView bitset) const {
+    FAISS_THROW_IF_NOT(k > 0);
+    FAISS_THROW_IF_NOT(is_trained);
+
+    auto base = fast_scan_index();
+    if (!has_refine()) {
+        base->search_thread_safe(
+                n, x, k, distances, labels, nprobe, bitset);
+        return;
+    }
+
+    idx_t k_base = std::max(k, idx_t(reorder_k));
+    idx_t* base_labels = labels;
+    float* base_distances = distances;
+    ScopeDeleter<idx_t> del1;
+    ScopeDeleter<float> del2;
+
+    if (k != k_base) {
+        base_labels = new idx_t[n * k_base];
+        del1.set(base_labels);
+        base_distances = new float[n * k_base];
+        del2.set(base_distances);
+    }
+
+    base->search_thread_safe(
+            n, x, k_base, base_distances, base_labels, nprobe, bitset);
+
+    // the queries are already normalized for a cosine index
+    std::unique_ptr<DistanceComputer> dc(refine_index->get_distance_computer());
+    for (idx_t i = 0; i < n; i++) {
+        dc->set_query(x + i * d);
+        for (idx_t j = i * k_base; j < (i + 1) * k_base; j++) {
+            if (base_labels[j] < 0) {
+                break;
+            }
+            base_distances[j] = (*dc)(base_labels[j]);
+        }
+    }
+
+    if (metric_type == METRIC_L2) {
+        typedef CMax<float, idx_t> C;
+        reorder_heaps<C>(
+                n, k, labels, distances, k_base, base_labels, base_distances);
+    } else if (metric_type == METRIC_INNER_PRODUCT) {
+        typedef CMin<float, idx_t> C;
+        reorder_heaps<C>(
+                n, k, labels, distances, k_base, base_labels, base_distances);
+    } else {
+        FAISS_THROW_MSG("Metric type not supported");
+    }
+}
+
+void IndexIVFPQFastScanRefine::range_search_thread_safe(
+        idx_t n,
+        const float* x,
+        float radius,
+        RangeSearchResult* result,
+        const size_t nprobe,
+        const BitsetView bitset) const {
+    FAISS_THROW_IF_NOT(is_trained);
+    FAISS_THROW_IF_NOT(
+            metric_type == METRIC_L2 || metric_type == METRIC_INNER_PRODUCT);
+
+    fast_scan_index()->range_search_thread_safe(
+            n, x, radius, result, nprobe, bitset);
+    if (!has_refine()) {
+        return;
+    }
+
+    // refine the matches of every query, drop the ones that fall out of the
+    // radius and compact the results
+    std::unique_ptr<DistanceComputer> dc(refine_index->get_distance_computer());
+    size_t current = 0;
+    for (idx_t i = 0; i < n; i++) {
+        const size_t begin = result->lims[i];
+        const size_t end = result->lims[i + 1];
+        result->lims[i] = current;
+        dc->set_query(x + i * d);
+        for (size_t j = begin; j < end; j++) {
+            const float dis = (*dc)(result->labels[j]);
+            const bool in_range = metric_type == METRIC_L2 ? dis < radius
+                                                           : dis > radius;
+            if (in_range) {
+                result->distances[current] = dis;
+                result->labels[current] = result->labels[j];
+                current++;
+            }
+        }
+    }
+    result->lims[n] = current;
+}
+
+} // namespace faiss
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <faiss/IndexIVFPQFastScan.h>
+#include <faiss/IndexRefine.h>
+
+namespace faiss {
+
+/** An IndexIVFPQFastScan whose candidates are optionally re-ranked with a
+ * second, more accurate index holding the same vectors (an IndexFlat or an
+ * IndexScalarQuantizer). Without a refine index the fast-scan distances are
+ * returned as they are.
+ *
+ * For a cosine base index, the refine index stores the normalized vectors, so
+ * that the refined distances are cosine similarities of normalized queries.
+ */
+struct IndexIVFPQFastScanRefine : IndexRefine {
+    explicit IndexIVFPQFastScanRefine(
+            IndexIVFPQFastScan* base_index,
+            Index* refine_index = nullptr);
+
+    IndexIVFPQFastScanRefine();
+
+    const IndexIVFPQFastScan* fast_scan_index() const;
+
+    bool has_refine() const {
+        return refine_index != nullptr;
+    }
+
+    void train(idx_t n, const float* x) override;
+
+    void add(idx_t n, const float* x) override;
+
+    void reset() override;
+
+    void search(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels,
+            const BitsetView bitset = nullptr) const override;
+
+    void reconstruct(idx_t key, float* recons) const override;
+
+    int64_t size() const;
+
+    /// reorder_k candidates are taken from the base index and refined, it is
+    /// ignored without a refine index
+    void search_thread_safe(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels,
+            const size_t nprobe,
+            const size_t reorder_k,
+            const BitsetView bitset = nullptr) const;
+
+    void range_search_thread_safe(
+            idx_t n,
+            const float* x,
+            float radius,
+            RangeSearchResult* result,
+            const size_t nprobe,
+            const BitsetView bitset = nullptr) const;
+};
+
+} // namespace faiss
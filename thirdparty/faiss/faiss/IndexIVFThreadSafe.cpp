@@ -20,6 +20,8 @@
 #include <faiss/impl/FaissAssert.h>
 #include <omp.h>
 #include <cinttypes>
+#include <memory>
+#include <vector>
 namespace faiss {
 
 namespace {
@@ -33,6 +35,148 @@ IVFSearchParameters gen_search_param(
     params.parallel_mode = parallel_mode;
     return params;
 }
+
+// list-major scan shared by search_preassigned_by_list(_without_codes): the
+// (query, probe) pairs are bucketed by list with a counting sort, then every
+// probed list is fetched once and scanned for each query of its bucket while
+// its codes are still in cache
+template <bool without_codes>
+void search_preassigned_by_list_impl(
+        const IndexIVF& ivf,
+        Index::idx_t n,
+        const float* x,
+        Index::idx_t k,
+        size_t nprobe,
+        const Index::idx_t* assign,
+        const float* centroid_dis,
+        float* distances,
+        Index::idx_t* labels,
+        const BitsetView bitset) {
+    using idx_t = Index::idx_t;
+    using HeapForIP = CMin<float, idx_t>;
+    using HeapForL2 = CMax<float, idx_t>;
+    const bool is_ip = ivf.metric_type == METRIC_INNER_PRODUCT;
+    const size_t nlist = ivf.nlist;
+    const InvertedLists* invlists = ivf.invlists;
+
+    for (idx_t i = 0; i < n; i++) {
+        if (is_ip) {
+            heap_heapify<HeapForIP>(k, distances + i * k, labels + i * k);
+        } else {
+            heap_heapify<HeapForL2>(k, distances + i * k, labels + i * k);
+        }
+    }
+
+    const size_t npairs = n * nprobe;
+    std::vector<size_t> list_begin(nlist + 1, 0);
+    for (size_t j = 0; j < npairs; j++) {
+        const idx_t key = assign[j];
+        if (key < 0) {
+            // not enough centroids for multiprobe
+            continue;
+        }
+        FAISS_THROW_IF_NOT_FMT(
+                key < (idx_t)nlist,
+                "Invalid key=%" PRId64 " nlist=%zd\n",
+                key,
+                nlist);
+        list_begin[key + 1]++;
+    }
+    for (size_t key = 0; key < nlist; key++) {
+        list_begin[key + 1] += list_begin[key];
+    }
+    std::vector<size_t> pairs(list_begin[nlist]);
+    {
+        std::vector<size_t> cursor(list_begin.begin(), list_begin.end() - 1);
+        for (size_t j = 0; j < npairs; j++) {
+            if (assign[j] >= 0) {
+                pairs[cursor[assign[j]]++] = j;
+            }
+        }
+    }
+
+    std::unique_ptr<InvertedListScanner> scanner(
+            ivf.get_InvertedListScanner(false));
+    auto scan_bucket = [&](size_t key,
+                           size_t size,
+                           const uint8_t* codes,
+                           const float* code_norms,
+                           const idx_t* ids) {
+        for (size_t p = list_begin[key]; p < list_begin[key + 1]; p++) {
+            const size_t j = pairs[p];
+            const idx_t q = j / nprobe;
+            scanner->set_query(x + q * ivf.d);
+            scanner->set_list(key, centroid_dis[j]);
+            scanner->scan_codes(
+                    size,
+                    codes,
+                    code_norms,
+                    ids,
+                    distances + q * k,
+                    labels + q * k,
+                    k,
+                    bitset);
+        }
+    };
+
+    for (size_t key = 0; key < nlist; key++) {
+        if (list_begin[key] == list_begin[key + 1]) {
+            continue;
+        }
+        const size_t list_size = invlists->list_size(key);
+        // don't waste time on empty lists
+        if (list_size == 0) {
+            continue;
+        }
+        if constexpr (without_codes) {
+#ifdef USE_GPU
+            auto rol = dynamic_cast<const ReadOnlyArrayInvertedLists*>(
+                    invlists);
+            auto arranged_data =
+                    reinterpret_cast<uint8_t*>(rol->pin_readonly_codes->data);
+            InvertedLists::ScopedCodes scodes(invlists, key, arranged_data);
+#else
+            InvertedLists::ScopedCodes scodes(
+                    invlists, key, ivf.arranged_codes.data());
+#endif
+            InvertedLists::ScopedIds sids(invlists, key);
+            scan_bucket(
+                    key,
+                    list_size,
+                    scodes.get() + ivf.code_size * ivf.prefix_sum[key],
+                    nullptr,
+                    sids.get());
+        } else {
+            const size_t segment_num = invlists->get_segment_num(key);
+            for (size_t segment_idx = 0; segment_idx < segment_num;
+                 segment_idx++) {
+                const size_t segment_size =
+                        invlists->get_segment_size(key, segment_idx);
+                const size_t segment_offset =
+                        invlists->get_segment_offset(key, segment_idx);
+                InvertedLists::ScopedCodes scodes(
+                        invlists, key, segment_offset);
+                InvertedLists::ScopedCodeNorms scode_norms(
+                        invlists, key, segment_offset);
+                InvertedLists::ScopedIds sids(invlists, key, segment_offset);
+                scan_bucket(
+                        key,
+                        segment_size,
+                        scodes.get(),
+                        scode_norms.get(),
+                        sids.get());
+            }
+        }
+    }
+
+    for (idx_t i = 0; i < n; i++) {
+        if (is_ip) {
+            heap_reorder<HeapForIP>(k, distances + i * k, labels + i * k);
+        } else {
+            heap_reorder<HeapForL2>(k, distances + i * k, labels + i * k);
+        }
+    }
+}
 } // namespace
 
 void IndexIVF::search_thread_safe(
@@ -211,6 +355,54 @@ void IndexIVF::search_without_codes_thread_safe(
     }
 }
 
+void IndexIVF::search_preassigned_by_list(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        size_t nprobe,
+        const idx_t* assign,
+        const float* centroid_dis,
+        float* distances,
+        idx_t* labels,
+        const BitsetView bitset) const {
+    FAISS_THROW_IF_NOT(k > 0);
+    search_preassigned_by_list_impl<false>(
+            *this,
+            n,
+            x,
+            k,
+            nprobe,
+            assign,
+            centroid_dis,
+            distances,
+            labels,
+            bitset);
+}
+
+void IndexIVF::search_preassigned_by_list_without_codes(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        size_t nprobe,
+        const idx_t* assign,
+        const float* centroid_dis,
+        float* distances,
+        idx_t* labels,
+        const BitsetView bitset) const {
+    FAISS_THROW_IF_NOT(k > 0);
+    search_preassigned_by_list_impl<true>(
+            *this,
+            n,
+            x,
+            k,
+            nprobe,
+            assign,
+            centroid_dis,
+            distances,
+            labels,
+            bitset);
+}
+
 void IndexIVF::search_preassigned_without_codes(
         idx_t n,
         const float* x,
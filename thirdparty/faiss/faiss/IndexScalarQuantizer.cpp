@@ -32,6 +32,7 @@ IndexScalarQuantizer::IndexScalarQuantizer(
         : IndexFlatCodes(0, d, metric), sq(d, qtype) {
     is_trained =
             qtype == QuantizerType::QT_fp16 ||
+            qtype == QuantizerType::QT_bf16 ||
             qtype == QuantizerType::QT_8bit_direct;
     code_size = sq.code_size;
 }
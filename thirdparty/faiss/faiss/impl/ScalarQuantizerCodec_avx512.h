@@ -64,25 +64,18 @@ struct Codec4bit_avx512 : public Codec4bit_avx {
 };
 
 struct Codec6bit_avx512 : public Codec6bit_avx {
-    // TODO: can be optimized
+    // 16 components are two groups of 8 packed in 6 bytes each
     static __m512 decode_16_components(const uint8_t* code, int i) {
-        return _mm512_set_ps
-            (decode_component(code, i + 15),
-             decode_component(code, i + 14),
-             decode_component(code, i + 13),
-             decode_component(code, i + 12),
-             decode_component(code, i + 11),
-             decode_component(code, i + 10),
-             decode_component(code, i + 9),
-             decode_component(code, i + 8),
-             decode_component(code, i + 7),
-             decode_component(code, i + 6),
-             decode_component(code, i + 5),
-             decode_component(code, i + 4),
-             decode_component(code, i + 3),
-             decode_component(code, i + 2),
-             decode_component(code, i + 1),
-             decode_component(code, i + 0));
+        const uint16_t* code16 = (const uint16_t*)(code + (i >> 2) * 3);
+        __m256i c8lo = load6(code16);
+        __m256i c8hi = load6(code16 + 3);
+        __m512i i16 = _mm512_castsi256_si512(c8lo);
+        i16 = _mm512_inserti32x8(i16, c8hi, 1);
+        __m512 f16 = _mm512_cvtepi32_ps(i16);
+        __m512 half = _mm512_set1_ps(0.5f);
+        f16 = _mm512_add_ps(f16, half);
+        __m512 one_63 = _mm512_set1_ps(1.f / 63.f);
+        return _mm512_mul_ps(f16, one_63);
     }
 };
 
@@ -180,6 +173,37 @@ struct QuantizerFP16_avx512<16> : public QuantizerFP16_avx<8> {
     }
 };
 
+/*******************************************************************
+ * BF16 quantizer
+ *******************************************************************/
+
+template <int SIMDWIDTH>
+struct QuantizerBF16_avx512 {};
+
+template <>
+struct QuantizerBF16_avx512<1> : public QuantizerBF16_avx<1> {
+    QuantizerBF16_avx512(size_t d, const std::vector<float>& unused)
+            : QuantizerBF16_avx<1>(d, unused) {}
+};
+
+template <>
+struct QuantizerBF16_avx512<8> : public QuantizerBF16_avx<8> {
+    QuantizerBF16_avx512(size_t d, const std::vector<float>& trained)
+            : QuantizerBF16_avx<8>(d, trained) {}
+};
+
+template <>
+struct QuantizerBF16_avx512<16> : public QuantizerBF16_avx<8> {
+    QuantizerBF16_avx512(size_t d, const std::vector<float>& trained)
+            : QuantizerBF16_avx<8>(d, trained) {}
+
+    __m512 reconstruct_16_components(const uint8_t* code, int i) const {
+        __m256i codei = _mm256_loadu_si256((const __m256i*)(code + 2 * i));
+        __m512i xi = _mm512_slli_epi32(_mm512_cvtepu16_epi32(codei), 16);
+        return _mm512_castsi512_ps(xi);
+    }
+};
+
 /*******************************************************************
  * 8bit_direct quantizer
  *******************************************************************/
@@ -205,9 +229,9 @@ struct Quantizer8bitDirect_avx512<16> : public Quantizer8bitDirect_avx<8> {
             : Quantizer8bitDirect_avx<8>(d, trained) {}
 
     __m512 reconstruct_16_components(const uint8_t* code, int i) const {
-        __m256i x16 = _mm256_loadu_si256((__m256i*)(code + i)); // 16 * int8
-        __m512i y16 = _mm512_cvtepu8_epi16(x16);                // 16 * int32
-        return _mm512_cvtepi32_ps(y16);                         // 16 * float32
+        __m128i x16 = _mm_loadu_si128((__m128i*)(code + i)); // 16 * int8
+        __m512i y16 = _mm512_cvtepu8_epi32(x16);             // 16 * int32
+        return _mm512_cvtepi32_ps(y16);                      // 16 * float32
     }
 };
 
@@ -234,6 +258,8 @@ Quantizer* select_quantizer_1_avx512(
                     d, trained);
         case QuantizerType::QT_fp16:
             return new QuantizerFP16_avx512<SIMDWIDTH>(d, trained);
+        case QuantizerType::QT_bf16:
+            return new QuantizerBF16_avx512<SIMDWIDTH>(d, trained);
         case QuantizerType::QT_8bit_direct:
             return new Quantizer8bitDirect_avx512<SIMDWIDTH>(d, trained);
     }
@@ -567,6 +593,12 @@ SQDistanceComputer* select_distance_computer_avx512(
                     Sim,
                     SIMDWIDTH>(d, trained);
 
+        case QuantizerType::QT_bf16:
+            return new DCTemplate_avx512<
+                    QuantizerBF16_avx512<SIMDWIDTH>,
+                    Sim,
+                    SIMDWIDTH>(d, trained);
+
         case QuantizerType::QT_8bit_direct:
             if (d % 16 == 0) {
                 return new DistanceComputerByte_avx512<Sim, SIMDWIDTH>(d, trained);
@@ -630,6 +662,11 @@ InvertedListScanner* sel1_InvertedListScanner_avx512(
                     QuantizerFP16_avx512<SIMDWIDTH>,
                     Similarity,
                     SIMDWIDTH>>(sq, quantizer, store_pairs, r);
+        case QuantizerType::QT_bf16:
+            return sel2_InvertedListScanner_avx512<DCTemplate_avx512<
+                    QuantizerBF16_avx512<SIMDWIDTH>,
+                    Similarity,
+                    SIMDWIDTH>>(sq, quantizer, store_pairs, r);
         case QuantizerType::QT_8bit_direct:
             if (sq->d % 16 == 0) {
                 return sel2_InvertedListScanner_avx512<
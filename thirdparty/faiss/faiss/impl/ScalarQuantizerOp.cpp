@@ -6,6 +6,7 @@
  */
 
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
 
 #ifdef __SSE__
@@ -126,6 +127,25 @@ float decode_fp16(uint16_t h) {
 
 #endif
 
+// bf16 keeps the upper half of the float, rounded to nearest even; NaNs
+// stay quiet NaNs instead of rounding over into infinity
+uint16_t encode_bf16(float x) {
+    uint32_t xi;
+    memcpy(&xi, &x, sizeof(xi));
+    if ((xi & 0x7fffffffu) > 0x7f800000u) {
+        return (xi >> 16) | 0x40;
+    }
+    xi += 0x7fffu + ((xi >> 16) & 1);
+    return xi >> 16;
+}
+
+float decode_bf16(uint16_t x) {
+    uint32_t xi = (uint32_t)x << 16;
+    float f;
+    memcpy(&f, &xi, sizeof(f));
+    return f;
+}
+
 /*******************************************************************
  * Quantizer range training
  */
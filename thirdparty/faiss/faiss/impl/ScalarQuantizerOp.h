@@ -21,6 +21,7 @@ enum QuantizerType {
     QT_fp16,
     QT_8bit_direct, ///< fast indexing of uint8s
     QT_6bit,        ///< 6 bits per component
+    QT_bf16,        ///< bfloat16, the upper half of a float
 };
 
 /** The uniform encoder can estimate the range of representable
@@ -57,6 +58,10 @@ extern uint16_t encode_fp16(float x);
 
 extern float decode_fp16(uint16_t x);
 
+extern uint16_t encode_bf16(float x);
+
+extern float decode_bf16(uint16_t x);
+
 extern void train_Uniform(
         RangeStat rs,
         float rs_arg,
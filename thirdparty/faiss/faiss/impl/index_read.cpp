@@ -35,6 +35,7 @@
 #include <faiss/IndexIVFFlat.h>
 #include <faiss/IndexIVFPQ.h>
 #include <faiss/IndexIVFPQFastScan.h>
+#include <faiss/IndexIVFPQFastScanRefine.h>
 #include <faiss/IndexIVFPQR.h>
 #include <faiss/IndexIVFSpectralHash.h>
 #include <faiss/IndexLSH.h>
@@ -836,6 +837,21 @@ Index* read_index(IOReader* f, int io_flags) {
         read_index_header(imiq, f);
         read_ProductQuantizer(&imiq->pq, f);
         idx = imiq;
+    } else if (h == fourcc("IwPr")) {
+        IndexIVFPQFastScanRefine* idxfr = new IndexIVFPQFastScanRefine();
+        read_index_header(idxfr, f);
+        idxfr->own_fields = true;
+        idxfr->own_refine_index = true;
+        idxfr->base_index = read_index(f, io_flags);
+        FAISS_THROW_IF_NOT(
+                dynamic_cast<IndexIVFPQFastScan*>(idxfr->base_index));
+        bool has_refine;
+        READ1(has_refine);
+        if (has_refine) {
+            idxfr->refine_index = read_index(f, io_flags);
+        }
+        READ1(idxfr->k_factor);
+        idx = idxfr;
     } else if (h == fourcc("IxRF")) {
         IndexRefine* idxrf = new IndexRefine();
         read_index_header(idxrf, f);
@@ -35,6 +35,7 @@
 #include <faiss/IndexIVFFlat.h>
 #include <faiss/IndexIVFPQ.h>
 #include <faiss/IndexIVFPQFastScan.h>
+#include <faiss/IndexIVFPQFastScanRefine.h>
 #include <faiss/IndexIVFPQR.h>
 #include <faiss/IndexIVFSpectralHash.h>
 #include <faiss/IndexLSH.h>
@@ -666,6 +667,20 @@ void write_index(const Index* idx, IOWriter* f) {
         WRITE1(h);
         write_index_header(imiq, f);
         write_ProductQuantizer(&imiq->pq, f);
+    } else if (
+            const IndexIVFPQFastScanRefine* idxfr =
+                    dynamic_cast<const IndexIVFPQFastScanRefine*>(idx)) {
+        // the refine index is optional, so it can not be stored as an IxRF
+        uint32_t h = fourcc("IwPr");
+        WRITE1(h);
+        write_index_header(idxfr, f);
+        write_index(idxfr->base_index, f);
+        bool has_refine = idxfr->has_refine();
+        WRITE1(has_refine);
+        if (has_refine) {
+            write_index(idxfr->refine_index, f);
+        }
+        WRITE1(idxfr->k_factor);
     } else if (
             const IndexRefine* idxrf = dynamic_cast<const IndexRefine*>(idx)) {
         uint32_t h = fourcc("IxRF");
@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace faiss {
+
+/** AVX-512 version of the qbs accumulation kernel.
+ *
+ * Accumulates the distances of nq (1 to 6) queries to a block of 32 database
+ * codes, 4 sub-quantizers per 512-bit step. The result is written to dis
+ * (nq * 32 uint16, 32-byte aligned) as the two simd16uint16 the AVX2 kernel
+ * hands to ResultHandler::handle for every query, so that the result handlers
+ * are never compiled with the AVX-512 flags.
+ *
+ * @param nq      number of queries of the block
+ * @param nsq     number of sub-quantizers (multiple of 2)
+ * @param codes   packed codes of the 32 database vectors
+ * @param LUT     packed look-up tables of the nq queries
+ * @param dis     output distances
+ */
+void pq4_kernel_accumulate_block_avx512(
+        int nq,
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT,
+        uint16_t* dis);
+
+} // namespace faiss
@@ -7,7 +7,9 @@
 
 #include <faiss/impl/pq4_fast_scan.h>
 
+#include <faiss/FaissHook.h>
 #include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/pq4_fast_scan_avx512.h>
 #include <faiss/impl/simd_result_handlers.h>
 #include <faiss/utils/simdlib.h>
 
@@ -80,8 +82,46 @@ void kernel_accumulate_block(
     }
 }
 
+#ifdef __x86_64__
+
+// the AVX-512 kernel, its distances are handed to the handler from here
+template <int NQ, class ResultHandler>
+void kernel_accumulate_block_avx512(
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT,
+        ResultHandler& res) {
+    constexpr int NQA = NQ > 0 ? NQ : 1;
+    ALIGNED(32) uint16_t dis[NQA * 32];
+    pq4_kernel_accumulate_block_avx512(NQ, nsq, codes, LUT, dis);
+    for (int q = 0; q < NQ; q++) {
+        res.handle(
+                q,
+                0,
+                simd16uint16(dis + q * 32),
+                simd16uint16(dis + q * 32 + 16));
+    }
+}
+
+#endif
+
+template <int NQ, bool AVX512, class ResultHandler>
+void accumulate_block(
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT,
+        ResultHandler& res) {
+#ifdef __x86_64__
+    if (AVX512) {
+        kernel_accumulate_block_avx512<NQ>(nsq, codes, LUT, res);
+        return;
+    }
+#endif
+    kernel_accumulate_block<NQ>(nsq, codes, LUT, res);
+}
+
 // handle at most 4 blocks of queries
-template <int QBS, class ResultHandler>
+template <int QBS, bool AVX512, class ResultHandler>
 void accumulate_q_4step(
         size_t ntotal2,
         int nsq,
@@ -117,21 +157,21 @@ void accumulate_q_4step(
 
         FixedStorageHandler<SQ, 2> res2;        
         const uint8_t* LUT = LUT0;
-        kernel_accumulate_block<Q1>(nsq, codes, LUT, res2);
+        accumulate_block<Q1, AVX512>(nsq, codes, LUT, res2);
         LUT += Q1 * nsq * 16;
         if (Q2 > 0) {
             res2.set_block_origin(Q1, 0);
-            kernel_accumulate_block<Q2>(nsq, codes, LUT, res2);
+            accumulate_block<Q2, AVX512>(nsq, codes, LUT, res2);
             LUT += Q2 * nsq * 16;
         }
         if (Q3 > 0) {
             res2.set_block_origin(Q1 + Q2, 0);
-            kernel_accumulate_block<Q3>(nsq, codes, LUT, res2);
+            accumulate_block<Q3, AVX512>(nsq, codes, LUT, res2);
             LUT += Q3 * nsq * 16;
         }
         if (Q4 > 0) {
             res2.set_block_origin(Q1 + Q2 + Q3, 0);
-            kernel_accumulate_block<Q4>(nsq, codes, LUT, res2);
+            accumulate_block<Q4, AVX512>(nsq, codes, LUT, res2);
         }
         res2.to_other_handler(res);
         codes += 32 * nsq / 2;
@@ -182,25 +222,19 @@ void accumulate(
 #undef DISPATCH
 }
 
-} // namespace
-
-template <class ResultHandler>
-void pq4_accumulate_loop_qbs(
+template <bool AVX512, class ResultHandler>
+void accumulate_loop_qbs(
         int qbs,
         size_t ntotal2,
         int nsq,
         const uint8_t* codes,
         const uint8_t* LUT0,
         ResultHandler& res) {
-    assert(nsq % 2 == 0);
-    assert(is_aligned_pointer(codes));
-    assert(is_aligned_pointer(LUT0));
-
     // try out optimized versions
     switch (qbs) {
-#define DISPATCH(QBS)                                            \
-    case QBS:                                                    \
-        accumulate_q_4step<QBS>(ntotal2, nsq, codes, LUT0, res); \
+#define DISPATCH(QBS)                                                    \
+    case QBS:                                                            \
+        accumulate_q_4step<QBS, AVX512>(ntotal2, nsq, codes, LUT0, res); \
         return;
         DISPATCH(0x3333); // 12
         DISPATCH(0x2333); // 11
@@ -238,9 +272,9 @@ void pq4_accumulate_loop_qbs(
             int nq = qi & 15;
             qi >>= 4;
             res.set_block_origin(i0, j0);
-#define DISPATCH(NQ)                                                      \
-    case NQ:                                                              \
-        kernel_accumulate_block<NQ, ResultHandler>(nsq, codes, LUT, res); \
+#define DISPATCH(NQ)                                        \
+    case NQ:                                                \
+        accumulate_block<NQ, AVX512>(nsq, codes, LUT, res); \
         break
             switch (nq) {
                 DISPATCH(1);
@@ -258,6 +292,27 @@ void pq4_accumulate_loop_qbs(
     }
 }
 
+} // namespace
+
+template <class ResultHandler>
+void pq4_accumulate_loop_qbs(
+        int qbs,
+        size_t ntotal2,
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT0,
+        ResultHandler& res) {
+    assert(nsq % 2 == 0);
+    assert(is_aligned_pointer(codes));
+    assert(is_aligned_pointer(LUT0));
+
+    if (pq4_use_avx512) {
+        accumulate_loop_qbs<true>(qbs, ntotal2, nsq, codes, LUT0, res);
+    } else {
+        accumulate_loop_qbs<false>(qbs, ntotal2, nsq, codes, LUT0, res);
+    }
+}
+
 // explicit template instantiations
 
 #define INSTANTIATE_ACCUMULATE_Q(RH)           \
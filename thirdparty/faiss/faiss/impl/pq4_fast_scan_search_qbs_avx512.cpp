@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <faiss/impl/pq4_fast_scan_avx512.h>
+
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/utils/simdlib.h>
+
+namespace faiss {
+
+namespace {
+
+/*
+ * Same computation as kernel_accumulate_block in pq4_fast_scan_search_qbs.cpp,
+ * on 512-bit registers. The codes of 2 consecutive pairs of sub-quantizers are
+ * contiguous, so one 64-byte load covers 4 sub-quantizers and each 128-bit lane
+ * of the LUT register holds the 16 entries of one of them. The LUTs of the
+ * 2 pairs are NQ * 32 bytes apart and are loaded as the 2 halves of the
+ * register.
+ */
+template <int NQ>
+void kernel_accumulate_block(
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT,
+        uint16_t* dis) {
+    // distance accumulators
+    simd32uint16 accu[NQ][4];
+
+    for (int q = 0; q < NQ; q++) {
+        for (int b = 0; b < 4; b++) {
+            accu[q][b].clear();
+        }
+    }
+
+    int sq = 0;
+    for (; sq + 4 <= nsq; sq += 4) {
+        simd64uint8 c(codes);
+        codes += 64;
+
+        simd64uint8 mask(0xf);
+        // shift op does not exist for int8...
+        simd64uint8 chi = simd64uint8(simd32uint16(c) >> 4) & mask;
+        simd64uint8 clo = c & mask;
+
+        for (int q = 0; q < NQ; q++) {
+            // load LUTs for 4 quantizers
+            simd64uint8 lut(
+                    simd32uint8(LUT + q * 32),
+                    simd32uint8(LUT + (NQ + q) * 32));
+
+            simd64uint8 res0 = lut.lookup_4_lanes(clo);
+            simd64uint8 res1 = lut.lookup_4_lanes(chi);
+
+            accu[q][0] += simd32uint16(res0);
+            accu[q][1] += simd32uint16(res0) >> 8;
+
+            accu[q][2] += simd32uint16(res1);
+            accu[q][3] += simd32uint16(res1) >> 8;
+        }
+        LUT += NQ * 64;
+    }
+
+    // the halves hold the same lanes of different sub-quantizers, fold them
+    // into the layout of the AVX2 accumulators. The sums are modulo 2^16 on
+    // both sides, so folding before the correction below is exact
+    simd16uint16 accu2[NQ][4];
+    for (int q = 0; q < NQ; q++) {
+        for (int b = 0; b < 4; b++) {
+            accu2[q][b] = accu[q][b].low() + accu[q][b].high();
+        }
+    }
+
+    // nsq % 4 == 2: the last pair
+    if (sq < nsq) {
+        simd32uint8 c(codes);
+
+        simd32uint8 mask(0xf);
+        simd32uint8 chi = simd32uint8(simd16uint16(c) >> 4) & mask;
+        simd32uint8 clo = c & mask;
+
+        for (int q = 0; q < NQ; q++) {
+            simd32uint8 lut(LUT + q * 32);
+
+            simd32uint8 res0 = lut.lookup_2_lanes(clo);
+            simd32uint8 res1 = lut.lookup_2_lanes(chi);
+
+            accu2[q][0] += simd16uint16(res0);
+            accu2[q][1] += simd16uint16(res0) >> 8;
+
+            accu2[q][2] += simd16uint16(res1);
+            accu2[q][3] += simd16uint16(res1) >> 8;
+        }
+    }
+
+    for (int q = 0; q < NQ; q++) {
+        accu2[q][0] -= accu2[q][1] << 8;
+        simd16uint16 dis0 = combine2x2(accu2[q][0], accu2[q][1]);
+        accu2[q][2] -= accu2[q][3] << 8;
+        simd16uint16 dis1 = combine2x2(accu2[q][2], accu2[q][3]);
+        dis0.store(dis + q * 32);
+        dis1.store(dis + q * 32 + 16);
+    }
+}
+
+} // anonymous namespace
+
+void pq4_kernel_accumulate_block_avx512(
+        int nq,
+        int nsq,
+        const uint8_t* codes,
+        const uint8_t* LUT,
+        uint16_t* dis) {
+#define DISPATCH(NQ)                                       \
+    case NQ:                                               \
+        kernel_accumulate_block<NQ>(nsq, codes, LUT, dis); \
+        return
+
+    switch (nq) {
+        DISPATCH(1);
+        DISPATCH(2);
+        DISPATCH(3);
+        DISPATCH(4);
+        DISPATCH(5);
+        DISPATCH(6);
+    }
+    FAISS_THROW_FMT("accumulate nq=%d not instanciated", nq);
+
+#undef DISPATCH
+}
+
+} // namespace faiss
@@ -349,6 +349,96 @@ void binary_knn_mc(
     }
 }
 
+namespace {
+
+/* Hands the distances of the query of mc to the codes j0 to j1 of b that pass
+ * the bitset to add(j, dis), in order. Without a bitset, the default hamming
+ * and jaccard computers go through the one-to-many simd kernels by batches. */
+template <typename T, class MetricComputer, class Add>
+inline void scan_codes_one_by_one(
+        const MetricComputer& mc,
+        const uint8_t* b,
+        size_t code_size,
+        size_t j0,
+        size_t j1,
+        const BitsetView bitset,
+        Add& add) {
+    for (size_t j = j0; j < j1; j++) {
+        if (bitset.empty() || !bitset.test(j)) {
+            add(j, T(mc.compute(b + j * code_size)));
+        }
+    }
+}
+
+constexpr size_t kScanBatchSize = 256;
+
+template <typename T, typename D, class Add>
+inline void scan_codes_by_batches(
+        void (*dis_ny)(D*, const uint8_t*, const uint8_t*, size_t, size_t),
+        const uint8_t* x,
+        const uint8_t* b,
+        size_t code_size,
+        size_t j0,
+        size_t j1,
+        Add& add) {
+    D dis[kScanBatchSize];
+    for (size_t j = j0; j < j1; j += kScanBatchSize) {
+        const size_t ny = std::min(j1 - j, kScanBatchSize);
+        dis_ny(dis, x, b + j * code_size, code_size, ny);
+        for (size_t t = 0; t < ny; t++) {
+            add(j + t, T(dis[t]));
+        }
+    }
+}
+
+template <typename T, class MetricComputer, class Add>
+inline void scan_codes(
+        const MetricComputer& mc,
+        const uint8_t* b,
+        size_t code_size,
+        size_t j0,
+        size_t j1,
+        const BitsetView bitset,
+        Add& add) {
+    scan_codes_one_by_one<T>(mc, b, code_size, j0, j1, bitset, add);
+}
+
+template <typename T, class Add>
+inline void scan_codes(
+        const HammingComputerDefault& mc,
+        const uint8_t* b,
+        size_t code_size,
+        size_t j0,
+        size_t j1,
+        const BitsetView bitset,
+        Add& add) {
+    if (bitset.empty()) {
+        scan_codes_by_batches<T>(
+                bin_vec_hamming_ny, mc.a8, b, code_size, j0, j1, add);
+    } else {
+        scan_codes_one_by_one<T>(mc, b, code_size, j0, j1, bitset, add);
+    }
+}
+
+template <typename T, class Add>
+inline void scan_codes(
+        const JaccardComputerDefault& mc,
+        const uint8_t* b,
+        size_t code_size,
+        size_t j0,
+        size_t j1,
+        const BitsetView bitset,
+        Add& add) {
+    if (bitset.empty()) {
+        scan_codes_by_batches<T>(
+                bin_vec_jaccard_ny, mc.a, b, code_size, j0, j1, add);
+    } else {
+        scan_codes_one_by_one<T>(mc, b, code_size, j0, j1, bitset, add);
+    }
+}
+
+} // anonymous namespace
+
 template <class C, class MetricComputer>
 void binary_knn_hc(
         int bytes_per_code,
@@ -444,19 +534,14 @@ void binary_knn_hc(
             for (size_t i = 0; i < ha->nh; i++) {
                 MetricComputer hc(bs1 + i * bytes_per_code, bytes_per_code);
 
-                const uint8_t* bs2_ = bs2 + j0 * bytes_per_code;
-                T dis;
                 T* __restrict bh_val_ = ha->val + i * k;
                 int64_t* __restrict bh_ids_ = ha->ids + i * k;
-                for (size_t j = j0; j < j1; j++, bs2_ += bytes_per_code) {
-                    if (bitset.empty() || !bitset.test(j)) {
-                        dis = hc.compute(bs2_);
-                        if (C::cmp(bh_val_[0], dis)) {
-                            faiss::heap_replace_top<C>(
-                                    k, bh_val_, bh_ids_, dis, j);
-                        }
+                auto add = [&](size_t j, T dis) {
+                    if (C::cmp(bh_val_[0], dis)) {
+                        faiss::heap_replace_top<C>(k, bh_val_, bh_ids_, dis, j);
                     }
-                }
+                };
+                scan_codes<T>(hc, bs2, bytes_per_code, j0, j1, bitset, add);
             }
         }
     }
@@ -475,6 +560,8 @@ void binary_knn_hc(
     switch (metric_type) {
         case METRIC_Jaccard: {
             {
+                // longer codes go to JaccardComputerDefault, which uses the
+                // simd kernels
                 switch (ncodes) {
 #define binary_knn_hc_jaccard(ncodes)                     \
     case ncodes:                                          \
@@ -485,9 +572,6 @@ void binary_knn_hc(
                     binary_knn_hc_jaccard(16);
                     binary_knn_hc_jaccard(32);
                     binary_knn_hc_jaccard(64);
-                    binary_knn_hc_jaccard(128);
-                    binary_knn_hc_jaccard(256);
-                    binary_knn_hc_jaccard(512);
 #undef binary_knn_hc_jaccard
                     default:
                         binary_knn_hc<C, faiss::JaccardComputerDefault>(
@@ -562,14 +646,12 @@ void binary_range_search(
         for (int64_t i = 0; i < na; i++) {
             MetricComputer mc(a + i * code_size, code_size);
             RangeQueryResult& qres = pres.new_result(i);
-            for (size_t j = 0; j < nb; j++) {
-                if (bitset.empty() || !bitset.test(j)) {
-                    T dis = mc.compute(b + j * code_size);
-                    if (C::cmp(dis, radius)) {
-                        qres.add(dis, j);
-                    }
+            auto add = [&](size_t j, T dis) {
+                if (C::cmp(dis, radius)) {
+                    qres.add(dis, j);
                 }
-            }
+            };
+            scan_codes<T>(mc, b, code_size, 0, nb, bitset, add);
         }
         pres.finalize();
     }
@@ -589,6 +671,8 @@ void binary_range_search(
     switch (metric_type) {
         case METRIC_Jaccard: {
             {
+                // longer codes go to JaccardComputerDefault, which uses the
+                // simd kernels
                 switch (code_size) {
 #define binary_range_search_jaccard(ncodes)                        \
     case ncodes:                                                   \
@@ -599,9 +683,6 @@ void binary_range_search(
                     binary_range_search_jaccard(16);
                     binary_range_search_jaccard(32);
                     binary_range_search_jaccard(64);
-                    binary_range_search_jaccard(128);
-                    binary_range_search_jaccard(256);
-                    binary_range_search_jaccard(512);
 #undef binary_range_search_jaccard
                     default:
                         binary_range_search<
@@ -7,6 +7,7 @@
 
 #include <faiss/utils/binary_distances.h>
 #include <faiss/utils/simdlib.h>
+#include <simd/hook.h>
 namespace faiss {
 
 extern const uint8_t hamdis_tab_ham_bytes[256];
@@ -234,7 +235,7 @@ struct HammingComputerDefault {
     }
 
     int compute(const uint8_t* b8) const {
-        return xor_popcnt(a8, b8, n);
+        return bin_vec_hamming(a8, b8, n);
     }
 };
 
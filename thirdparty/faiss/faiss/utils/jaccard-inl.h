@@ -17,6 +17,7 @@
 
 #include <faiss/utils/binary_distances.h>
 #include <faiss/utils/simdlib.h>
+#include <simd/hook.h>
 namespace faiss {
 
 struct JaccardComputer8 {
@@ -451,7 +452,7 @@ struct JaccardComputerDefault {
     }
 
     float compute(const uint8_t* b8) const {
-        return bvec_jaccard(a, b8, n);
+        return bin_vec_jaccard(a, b8, n);
     }
 };
 
@@ -14,7 +14,13 @@
  * functions.
  */
 
-#ifdef __AVX2__
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+
+// the 256-bit types, plus the 512-bit ones
+#include <faiss/utils/simdlib_avx2.h>
+#include <faiss/utils/simdlib_avx512.h>
+
+#elif defined(__AVX2__)
 
 #include <faiss/utils/simdlib_avx2.h>
 
@@ -6,7 +6,7 @@
 #include <cstdio>
 #include <stdexcept>
 
-#include "common/lru_cache.h"
+#include "common/clock_cache.h"
 #include "io/fileIO.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/utils.h"
@@ -29,6 +29,7 @@
 #include "knowhere/config.h"
 #include "knowhere/heap.h"
 #include "neighbor.h"
+#include "scalar_quantizer.h"
 #include "visited_list_pool.h"
 
 #if defined(__SSE__)
@@ -42,6 +43,10 @@ typedef unsigned int linklistsizeint;
 constexpr float kHnswSearchKnnBFThreshold = 0.93f;
 constexpr float kHnswSearchRangeBFThreshold = 0.97f;
 constexpr float kAlpha = 0.15f;
+// an index binary may end with a trailer after the link lists: this magic, a word of kTrailer* flags and the sections
+// the flags announce, in the order of their bits; a binary without any such section ends with the link lists
+constexpr uint32_t kTrailerMagic = 0x544c4e48;  // "HNLT"
+constexpr uint32_t kTrailerLabelMap = 0x1;
 
 enum Metric {
     L2 = 0,
@@ -56,7 +61,10 @@ template <typename dist_t>
 class HierarchicalNSW : public AlgorithmInterface<dist_t> {
  public:
     static const tableint max_update_element_locks = 65536;
-    HierarchicalNSW(SpaceInterface<dist_t>* s) {
+    // an empty index for loadIndex(), which rebuilds the space for the given data type and expects the level 0 codes
+    // of quantizeLevel0() when sq8 is set
+    HierarchicalNSW(SpaceInterface<dist_t>* s, DataType data_type = DataType::FLOAT, bool sq8 = false)
+        : data_type_(data_type), sq8_enabled_(sq8) {
     }
 
     HierarchicalNSW(SpaceInterface<dist_t>* s, const std::string& location, bool nmslib = false,
@@ -88,6 +96,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 
         num_deleted_ = 0;
         data_size_ = s->get_data_size();
+        data_type_ = s->get_data_type();
         fstdistfunc_ = s->get_dist_func();
         dist_func_param_ = s->get_dist_func_param();
         M_ = M;
@@ -141,11 +150,12 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     ~HierarchicalNSW() {
         if (mmap_enabled_) {
             munmap(map_, map_size_);
-        } else {
+        } else if (!zero_copy_enabled_) {
             free(data_level0_memory_);
             if (metric_type_ == Metric::COSINE) {
                 free(data_norm_l2_);
             }
+            free(raw_data_);
         }
 
         for (tableint i = 0; i < cur_element_count; i++) {
@@ -161,6 +171,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     // used for free resource
     SpaceInterface<dist_t>* space_;
     size_t metric_type_;  // 0:L2, 1:IP, 2:COSINE
+    DataType data_type_ = DataType::FLOAT;
 
     size_t max_elements_;
     size_t cur_element_count;
@@ -205,16 +216,47 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     std::default_random_engine update_probability_generator_;
 
     bool mmap_enabled_{false};
+    // level 0 and the norms point into the buffer given to loadIndex(), which the caller keeps alive
+    bool zero_copy_enabled_{false};
     char* map_;
     size_t map_size_;
 
-    mutable knowhere::lru_cache<uint64_t, tableint> lru_cache;
+    // query hash -> the level 0 entry point found for it, capacity 0 disables it; allocated by the first search
+    mutable knowhere::clock_cache<uint64_t, tableint> entry_cache_;
+
+    // set by optimizeLayout(), internal ids are the labels when empty
+    std::vector<tableint> internal_to_external_;
+    std::vector<tableint> external_to_internal_;
+
+    // set by quantizeLevel0(): level 0 holds the SQ8 codes the level 0 search runs on, and the vectors, which only
+    // rerank its candidates, move to raw_data_
+    bool sq8_enabled_{false};
+    UniformSQ8 sq8_;
+    char* raw_data_{nullptr};
 
     inline char*
     getDataByInternalId(tableint internal_id) const {
+        if (raw_data_ != nullptr) {
+            return raw_data_ + internal_id * data_size_;
+        }
         return (data_level0_memory_ + internal_id * size_data_per_element_ + offsetData_);
     }
 
+    inline const char*
+    getCodeByInternalId(tableint internal_id) const {
+        return data_level0_memory_ + internal_id * size_data_per_element_ + offsetData_;
+    }
+
+    inline labeltype
+    getExternalLabel(tableint internal_id) const {
+        return internal_to_external_.empty() ? internal_id : internal_to_external_[internal_id];
+    }
+
+    inline tableint
+    getInternalId(labeltype label) const {
+        return external_to_internal_.empty() ? label : external_to_internal_[label];
+    }
+
     int
     getRandomLevel(double reverse_size) {
         std::uniform_real_distribution<double> distribution(0.0, 1.0);
@@ -240,9 +282,24 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return dist;
     }
 
+    // the distance of calcDistance() approximated from the level 0 code of id
+    inline dist_t
+    calcCodeDistance(const UniformSQ8::Query& query, const tableint id) const {
+        dist_t dist = sq8_.distance(query, getCodeByInternalId(id));
+        if (metric_type_ == Metric::L2) {
+            return dist;
+        }
+        dist = -dist;
+        if (metric_type_ == Metric::COSINE) {
+            dist /= data_norm_l2_[id];
+        }
+        return dist;
+    }
+
     std::priority_queue<std::pair<dist_t, tableint>, std::vector<std::pair<dist_t, tableint>>, CompareByFirst>
     searchBaseLayer(tableint ep_id, tableint cur_c, int layer) {
-        auto& visited = visited_list_pool_->getFreeVisitedList();
+        auto visited_handle = visited_list_pool_->getFreeVisitedList(ef_construction_ * maxM0_);
+        auto& visited = *visited_handle;
 
         std::priority_queue<std::pair<dist_t, tableint>, std::vector<std::pair<dist_t, tableint>>, CompareByFirst>
             top_candidates;
@@ -254,7 +311,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         top_candidates.emplace(dist, ep_id);
         lowerBound = dist;
         candidateSet.emplace(-dist, ep_id);
-        visited[ep_id] = true;
+        visited.set(ep_id);
 
         while (!candidateSet.empty()) {
             std::pair<dist_t, tableint> curr_el_pair = candidateSet.top();
@@ -284,10 +341,10 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             for (size_t j = 0; j < size; j++) {
                 tableint candidate_id = *(datal + j);
                 // if (candidate_id == 0) continue;
-                if (visited[candidate_id]) {
+                if (visited.get(candidate_id)) {
                     continue;
                 }
-                visited[candidate_id] = true;
+                visited.set(candidate_id);
 
                 dist_t dist1 = calcDistance(cur_c, candidate_id);
                 if (top_candidates.size() < ef_construction_ || lowerBound > dist1) {
@@ -310,55 +367,79 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return top_candidates;
     }
 
-    mutable std::atomic<long> metric_distance_computations;
-    mutable std::atomic<long> metric_hops;
+    void
+    addFederVisitRecord(const knowhere::feder::hnsw::FederResultUniq& feder_result, int level, tableint from,
+                        tableint to, dist_t dist) const {
+        auto from_label = getExternalLabel(from);
+        auto to_label = getExternalLabel(to);
+        feder_result->visit_info_.AddVisitRecord(level, from_label, to_label, dist);
+        feder_result->id_set_.insert(from_label);
+        feder_result->id_set_.insert(to_label);
+    }
 
-    template <bool has_deletions, bool collect_metrics = false>
+    // with quantized set, the distances are the ones of calcCodeDistance() to query_code
+    template <bool has_deletions, bool collect_metrics = false, bool quantized = false>
     std::vector<std::pair<dist_t, tableint>>
     searchBaseLayerST(tableint ep_id, const void* data_point, size_t ef, const knowhere::BitsetView bitset,
-                      const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
+                      const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr,
+                      const UniformSQ8::Query* query_code = nullptr) const {
         if (feder_result != nullptr) {
             feder_result->visit_info_.AddLevelVisitRecord(0);
         }
-        auto& visited = visited_list_pool_->getFreeVisitedList();
+        auto visited_handle = visited_list_pool_->getFreeVisitedList(ef * maxM0_);
+        auto& visited = *visited_handle;
         NeighborSet retset(ef);
 
-        if (!has_deletions || !bitset.test((int64_t)ep_id)) {
-            dist_t dist = calcDistance(data_point, ep_id);
+        auto distance = [&](tableint id) {
+            if constexpr (quantized) {
+                return calcCodeDistance(*query_code, id);
+            } else {
+                return calcDistance(data_point, id);
+            }
+        };
+        auto vector_of = [&](tableint id) -> const char* {
+            if constexpr (quantized) {
+                return getCodeByInternalId(id);
+            } else {
+                return getDataByInternalId(id);
+            }
+        };
+
+        if (!has_deletions || !bitset.test((int64_t)getExternalLabel(ep_id))) {
+            dist_t dist = distance(ep_id);
             retset.insert(Neighbor(ep_id, dist, Neighbor::kValid));
         } else {
             retset.insert(Neighbor(ep_id, std::numeric_limits<dist_t>::max(), Neighbor::kInvalid));
         }
 
-        visited[ep_id] = true;
+        visited.set(ep_id);
         float accumulative_alpha = 0.0f;
+        auto& metrics = thread_search_metrics();
         while (retset.has_next()) {
             auto [u, d, s] = retset.pop();
             tableint* list = (tableint*)get_linklist0(u);
             int size = list[0];
 
             if constexpr (collect_metrics) {
-                metric_hops++;
-                metric_distance_computations += size;
+                metrics.hops++;
+                metrics.distance_computations += size;
             }
             for (size_t i = 1; i <= size; ++i) {
 #if defined(USE_PREFETCH)
                 if (i + 1 <= size) {
-                    _mm_prefetch(getDataByInternalId(list[i + 1]), _MM_HINT_T0);
+                    _mm_prefetch(vector_of(list[i + 1]), _MM_HINT_T0);
                 }
 #endif
                 tableint v = list[i];
-                if (visited[v]) {
+                if (visited.get(v)) {
                     if (feder_result != nullptr) {
-                        feder_result->visit_info_.AddVisitRecord(0, u, v, -1.0);
-                        feder_result->id_set_.insert(u);
-                        feder_result->id_set_.insert(v);
+                        addFederVisitRecord(feder_result, 0, u, v, -1.0);
                     }
                     continue;
                 }
-                visited[v] = true;
+                visited.set(v);
                 int status = Neighbor::kValid;
-                if (has_deletions && bitset.test((int64_t)v)) {
+                if (has_deletions && bitset.test((int64_t)getExternalLabel(v))) {
                     status = Neighbor::kInvalid;
 
                     accumulative_alpha += kAlpha;
@@ -367,11 +448,9 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                     }
                     accumulative_alpha -= 1.0f;
                 }
-                dist_t dist = calcDistance(data_point, v);
+                dist_t dist = distance(v);
                 if (feder_result != nullptr) {
-                    feder_result->visit_info_.AddVisitRecord(0, u, v, dist);
-                    feder_result->id_set_.insert(u);
-                    feder_result->id_set_.insert(v);
+                    addFederVisitRecord(feder_result, 0, u, v, dist);
                 }
 
                 Neighbor nn(v, dist, status);
@@ -390,6 +469,117 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return ans;
     }
 
+    // brings whole vectors in, not just their first line, so that long vectors do not stall half way through
+    void
+    prefetchVectors(const std::vector<std::pair<tableint, int>>& ids) const {
+#if defined(USE_PREFETCH)
+        for (const auto& id : ids) {
+            const char* data = getDataByInternalId(id.first);
+            for (size_t offset = 0; offset < data_size_; offset += 64) {
+                _mm_prefetch(data + offset, _MM_HINT_T0);
+            }
+        }
+#endif
+    }
+
+    // Level 0 search of a group of queries advanced in lockstep. Every round pops the next candidate of each query and
+    // prefetches the unvisited neighbors of all of them before computing any distance, so the memory latency of one
+    // query's neighbors hides behind the distance computations of the others.
+    template <bool has_deletions>
+    std::vector<std::vector<std::pair<dist_t, tableint>>>
+    searchBaseLayerGroup(const void* const* data_points, const tableint* ep_ids, size_t nq, size_t ef,
+                         const knowhere::BitsetView bitset) const {
+        struct QueryState {
+            std::unique_ptr<VisitedListPool::Handle> visited;
+            NeighborSet retset;
+            float accumulative_alpha = 0.0f;
+            // neighbors of the popped candidate that need a distance, with their status
+            std::vector<std::pair<tableint, int>> pending;
+        };
+        std::vector<QueryState> states(nq);
+        std::vector<size_t> active;
+        active.reserve(nq);
+        for (size_t q = 0; q < nq; ++q) {
+            auto& st = states[q];
+            st.visited.reset(new VisitedListPool::Handle(visited_list_pool_->getFreeVisitedList(ef * maxM0_)));
+            st.retset = NeighborSet(ef);
+            st.pending.reserve(maxM0_);
+            const tableint ep_id = ep_ids[q];
+            if (!has_deletions || !bitset.test((int64_t)getExternalLabel(ep_id))) {
+                st.retset.insert(Neighbor(ep_id, calcDistance(data_points[q], ep_id), Neighbor::kValid));
+            } else {
+                st.retset.insert(Neighbor(ep_id, std::numeric_limits<dist_t>::max(), Neighbor::kInvalid));
+            }
+            (**st.visited).set(ep_id);
+            active.push_back(q);
+        }
+
+        long hops = 0, distance_computations = 0;
+        while (!active.empty()) {
+            for (size_t q : active) {
+                auto& st = states[q];
+                auto& visited = **st.visited;
+                const tableint u = st.retset.pop().id;
+                tableint* list = (tableint*)get_linklist0(u);
+                int size = list[0];
+                hops++;
+                distance_computations += size;
+                st.pending.clear();
+                for (size_t i = 1; i <= size; ++i) {
+                    tableint v = list[i];
+                    if (visited.get(v)) {
+                        continue;
+                    }
+                    visited.set(v);
+                    int status = Neighbor::kValid;
+                    if (has_deletions && bitset.test((int64_t)getExternalLabel(v))) {
+                        status = Neighbor::kInvalid;
+                        st.accumulative_alpha += kAlpha;
+                        if (st.accumulative_alpha < 1.0f) {
+                            continue;
+                        }
+                        st.accumulative_alpha -= 1.0f;
+                    }
+                    st.pending.emplace_back(v, status);
+                }
+            }
+            // the vectors of the next query are on their way while the distances of this one are computed
+            size_t n_active = 0;
+            prefetchVectors(states[active[0]].pending);
+            for (size_t a = 0; a < active.size(); ++a) {
+                const size_t q = active[a];
+                auto& st = states[q];
+                if (a + 1 < active.size()) {
+                    prefetchVectors(states[active[a + 1]].pending);
+                }
+                for (const auto& [v, status] : st.pending) {
+                    if (st.retset.insert(Neighbor(v, calcDistance(data_points[q], v), status))) {
+#if defined(USE_PREFETCH)
+                        _mm_prefetch(get_linklist0(v), _MM_HINT_T0);
+#endif
+                    }
+                }
+                if (st.retset.has_next()) {
+                    active[n_active++] = q;
+                }
+            }
+            active.resize(n_active);
+        }
+        auto& metrics = thread_search_metrics();
+        metrics.hops += hops;
+        metrics.distance_computations += distance_computations;
+
+        std::vector<std::vector<std::pair<dist_t, tableint>>> ans(nq);
+        for (size_t q = 0; q < nq; ++q) {
+            const auto& retset = states[q].retset;
+            ans[q].resize(retset.size());
+            for (size_t i = 0; i < retset.size(); ++i) {
+                ans[q][i] = {retset[i].distance, retset[i].id};
+            }
+        }
+        return ans;
+    }
+
     std::vector<tableint>
     getNeighborsByHeuristic2(std::priority_queue<std::pair<dist_t, tableint>, std::vector<std::pair<dist_t, tableint>>,
                                                  CompareByFirst>& top_candidates,
@@ -436,7 +626,9 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     getNeighboursWithinRadius(std::vector<std::pair<dist_t, tableint>>& top_candidates, const void* data_point,
                               float radius, const knowhere::BitsetView bitset) const {
         std::vector<std::pair<dist_t, labeltype>> result;
-        auto& visited = visited_list_pool_->getFreeVisitedList();
+        // the number of elements within radius is unbounded, always use the dense mode
+        auto visited_handle = visited_list_pool_->getFreeVisitedList();
+        auto& visited = *visited_handle;
 
         std::queue<std::pair<dist_t, tableint>> radius_queue;
         while (!top_candidates.empty()) {
@@ -444,9 +636,9 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             top_candidates.pop_back();
             if (cand.first < radius) {
                 radius_queue.push(cand);
-                result.emplace_back(cand.first, cand.second);
+                result.emplace_back(cand.first, getExternalLabel(cand.second));
             }
-            visited[cand.second] = true;
+            visited.set(cand.second);
         }
 
         while (!radius_queue.empty()) {
@@ -464,13 +656,13 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 #endif
             for (size_t j = 1; j <= size; j++) {
                 int candidate_id = *(data + j);
-                if (!visited[candidate_id]) {
-                    visited[candidate_id] = true;
-                    if (bitset.empty() || !bitset.test((int64_t)candidate_id)) {
+                if (!visited.get(candidate_id)) {
+                    visited.set(candidate_id);
+                    if (bitset.empty() || !bitset.test((int64_t)getExternalLabel(candidate_id))) {
                         dist_t dist = calcDistance(data_point, candidate_id);
                         if (dist < radius) {
                             radius_queue.push({dist, candidate_id});
-                            result.emplace_back(dist, candidate_id);
+                            result.emplace_back(dist, getExternalLabel(candidate_id));
                         }
                     }
                 }
@@ -617,6 +809,12 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 
     void
     resizeIndex(size_t new_max_elements) {
+        if (mmap_enabled_ || zero_copy_enabled_) {
+            throw std::runtime_error("Cannot resize an index whose level 0 is not owned");
+        }
+        if (sq8_enabled_) {
+            throw std::runtime_error("Cannot resize a quantized index");
+        }
         if (new_max_elements < cur_element_count)
             throw std::runtime_error("Cannot resize, max element is less than the current number of elements");
 
@@ -663,18 +861,23 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         readBinaryPOD(input, data_size_);
         readBinaryPOD(input, dim);
         if (metric_type_ == Metric::L2) {
-            space_ = new hnswlib::L2Space(dim);
+            space_ = new hnswlib::L2Space(dim, data_type_);
         } else if (metric_type_ == Metric::INNER_PRODUCT) {
-            space_ = new hnswlib::InnerProductSpace(dim);
+            space_ = new hnswlib::InnerProductSpace(dim, data_type_);
         } else if (metric_type_ == Metric::COSINE) {
-            space_ = new hnswlib::CosineSpace(dim);
-        } else if (metric_type_ == Metric::HAMMING) {
+            space_ = new hnswlib::CosineSpace(dim, data_type_);
+        } else if (metric_type_ == Metric::HAMMING && data_type_ == DataType::FLOAT) {
             space_ = new hnswlib::HammingSpace(dim);
-        } else if (metric_type_ == Metric::JACCARD) {
+        } else if (metric_type_ == Metric::JACCARD && data_type_ == DataType::FLOAT) {
             space_ = new hnswlib::JaccardSpace(dim);
         } else {
             throw std::runtime_error("Invalid metric type " + std::to_string(metric_type_));
         }
+        // the binary does not record the component type, a float index loaded as a half one shows here
+        if (space_->get_data_size() != data_size_) {
+            throw std::runtime_error("Invalid binary: data size " + std::to_string(data_size_) +
+                                     " does not match the data type");
+        }
         fstdistfunc_ = space_->get_dist_func();
         dist_func_param_ = space_->get_dist_func_param();
 
@@ -698,6 +901,10 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         readBinaryPOD(input, M_);
         readBinaryPOD(input, mult_);
         readBinaryPOD(input, ef_construction_);
+        checkElementSize(dim);
+        if (sq8_enabled_) {
+            max_elements = max_elements_ = cur_element_count;
+        }
 
         if (cfg.enable_mmap.has_value() && cfg.enable_mmap.value()) {
             mmap_enabled_ = true;
@@ -711,6 +918,11 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 data_norm_l2_ = reinterpret_cast<float*>(map_ + input.offset());
                 input.advance(cur_element_count * sizeof(float));
             }
+            if (sq8_enabled_) {
+                sq8_.load(input, dim);
+                raw_data_ = map_ + input.offset();
+                input.advance(cur_element_count * data_size_);
+            }
         } else {
             data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
             input.read(data_level0_memory_, cur_element_count * size_data_per_element_);
@@ -720,6 +932,14 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 data_norm_l2_ = (float*)malloc(max_elements * sizeof(float));  // NOLINT
                 input.read((char*)data_norm_l2_, cur_element_count * sizeof(float));
             }
+            if (sq8_enabled_) {
+                sq8_.load(input, dim);
+                raw_data_ = (char*)malloc(std::max<size_t>(cur_element_count, 1) * data_size_);  // NOLINT
+                if (raw_data_ == nullptr) {
+                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate the vectors");
+                }
+                input.read(raw_data_, cur_element_count * data_size_);
+            }
         }
 
         size_links_per_element_ = maxM_ * sizeof(tableint) + sizeof(linklistsizeint);
@@ -752,9 +972,217 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             }
         }
 
+        loadTrailer(input, input.size() - (size_t)input.offset());
+
         input.close();
     }
 
+    // A level 0 element holds the links and either the vector or its SQ8 code, which tells a quantized binary from a
+    // plain one
+    void
+    checkElementSize(size_t dim) {
+        size_links_level0_ = maxM0_ * sizeof(tableint) + sizeof(linklistsizeint);
+        const size_t element_data_size = sq8_enabled_ ? UniformSQ8::code_size(dim) : data_size_;
+        if (size_data_per_element_ != size_links_level0_ + element_data_size) {
+            throw std::runtime_error("Invalid binary: level 0 element size " + std::to_string(size_data_per_element_) +
+                                     (sq8_enabled_ ? " does not match a quantized index"
+                                                   : " does not match an index that is not quantized"));
+        }
+    }
+
+    // reads the sections that follow the link lists, `remaining` is the number of bytes left in the binary
+    template <typename R>
+    void
+    loadTrailer(R& input, size_t remaining) {
+        if (remaining == 0) {
+            return;
+        }
+        uint32_t magic = 0;
+        uint32_t flags = 0;
+        if (remaining < sizeof(magic) + sizeof(flags)) {
+            throw std::runtime_error("Invalid binary: " + std::to_string(remaining) + " bytes after the link lists");
+        }
+        readBinaryPOD(input, magic);
+        readBinaryPOD(input, flags);
+        if (magic != kTrailerMagic) {
+            throw std::runtime_error("Invalid binary: unknown data after the link lists");
+        }
+        if ((flags & ~kTrailerLabelMap) != 0) {
+            throw std::runtime_error("Invalid binary: unsupported trailer flags " + std::to_string(flags));
+        }
+        remaining -= sizeof(magic) + sizeof(flags);
+        if (flags & kTrailerLabelMap) {
+            size_t label_count;
+            if (remaining < sizeof(label_count)) {
+                throw std::runtime_error("Invalid binary: truncated label map");
+            }
+            readBinaryPOD(input, label_count);
+            if (label_count * sizeof(tableint) > remaining - sizeof(label_count)) {
+                throw std::runtime_error("Invalid binary: truncated label map");
+            }
+            loadLabels(input, label_count);
+        }
+    }
+
+    template <typename R>
+    void
+    loadLabels(R& input, size_t label_count) {
+        if (label_count != cur_element_count) {
+            throw std::runtime_error("Invalid label map size " + std::to_string(label_count));
+        }
+        internal_to_external_.resize(label_count);
+        input.read((char*)internal_to_external_.data(), label_count * sizeof(tableint));
+        external_to_internal_.resize(label_count);
+        for (tableint i = 0; i < label_count; i++) {
+            if (internal_to_external_[i] >= label_count) {
+                throw std::runtime_error("Invalid label " + std::to_string(internal_to_external_[i]));
+            }
+            external_to_internal_[internal_to_external_[i]] = i;
+        }
+    }
+
+    // Renumbers the elements in the BFS order of the level-0 graph, starting from the entry point, so that the
+    // neighbors of an element are mostly stored next to it and a search touches fewer cache lines and pages per hop.
+    // The labels follow their elements through internal_to_external_. It has to be called after all the points are
+    // added, as addPoint() uses the label as the internal id.
+    void
+    optimizeLayout() {
+        if (mmap_enabled_ || zero_copy_enabled_) {
+            throw std::runtime_error("optimizeLayout is not supported on a mmaped or zero-copy loaded index");
+        }
+        if (sq8_enabled_) {
+            throw std::runtime_error("optimizeLayout has to be called before quantizeLevel0");
+        }
+        const size_t n = cur_element_count;
+        if (n == 0) {
+            return;
+        }
+
+        constexpr tableint kUnvisited = std::numeric_limits<tableint>::max();
+        std::vector<tableint> old_to_new(n, kUnvisited);
+        std::vector<tableint> order;
+        order.reserve(n);
+        auto bfs = [&](tableint seed) {
+            size_t head = order.size();
+            old_to_new[seed] = order.size();
+            order.push_back(seed);
+            while (head < order.size()) {
+                auto* list = (tableint*)get_linklist0(order[head++]);
+                size_t size = getListCount((linklistsizeint*)list);
+                for (size_t j = 1; j <= size; j++) {
+                    tableint v = list[j];
+                    if (old_to_new[v] == kUnvisited) {
+                        old_to_new[v] = order.size();
+                        order.push_back(v);
+                    }
+                }
+            }
+        };
+        bfs(enterpoint_node_);
+        // elements unreachable from the entry point (rare, e.g. after heavy pruning) go after the others
+        for (tableint i = 0; i < n; i++) {
+            if (old_to_new[i] == kUnvisited) {
+                bfs(i);
+            }
+        }
+
+        char* level0 = (char*)malloc(max_elements_ * size_data_per_element_);  // NOLINT
+        if (level0 == nullptr) {
+            throw std::runtime_error("Not enough memory: optimizeLayout failed to allocate level0");
+        }
+        std::vector<char*> link_lists(n);
+        std::vector<int> levels(n);
+        std::vector<float> norms(metric_type_ == Metric::COSINE ? n : 0);
+        std::vector<tableint> labels(n);
+        for (tableint i = 0; i < n; i++) {
+            const tableint old_id = order[i];
+            memcpy(level0 + i * size_data_per_element_, data_level0_memory_ + old_id * size_data_per_element_,
+                   size_data_per_element_);
+            link_lists[i] = element_levels_[old_id] > 0 ? linkLists_[old_id] : nullptr;
+            levels[i] = element_levels_[old_id];
+            if (metric_type_ == Metric::COSINE) {
+                norms[i] = data_norm_l2_[old_id];
+            }
+            labels[i] = getExternalLabel(old_id);
+        }
+        free(data_level0_memory_);
+        data_level0_memory_ = level0;
+
+        auto remap = [&](linklistsizeint* ll) {
+            size_t size = getListCount(ll);
+            tableint* data = (tableint*)(ll + 1);
+            for (size_t j = 0; j < size; j++) {
+                data[j] = old_to_new[data[j]];
+            }
+        };
+        for (tableint i = 0; i < n; i++) {
+            remap(get_linklist0(i));
+            linkLists_[i] = link_lists[i];
+            element_levels_[i] = levels[i];
+            for (int level = 1; level <= levels[i]; level++) {
+                remap(get_linklist(i, level));
+            }
+        }
+        if (metric_type_ == Metric::COSINE) {
+            std::copy(norms.begin(), norms.end(), data_norm_l2_);
+        }
+        enterpoint_node_ = old_to_new[enterpoint_node_];
+
+        external_to_internal_.resize(n);
+        for (tableint i = 0; i < n; i++) {
+            external_to_internal_[labels[i]] = i;
+        }
+        internal_to_external_ = std::move(labels);
+        // cached entry points are internal ids
+        entry_cache_.clear();
+    }
+
+    // Replaces the vectors in level 0 with their SQ8 codes and moves the vectors to raw_data_. The level 0 search then
+    // reads the links and the code of an element from a quarter of the bytes, and only touches the vectors of its last
+    // ef candidates to rerank them. The index is static afterwards: nothing can be added to it.
+    void
+    quantizeLevel0() {
+        if (mmap_enabled_ || zero_copy_enabled_) {
+            throw std::runtime_error("quantizeLevel0 is not supported on a mmaped or zero-copy loaded index");
+        }
+        if (data_type_ != DataType::FLOAT ||
+            (metric_type_ != Metric::L2 && metric_type_ != Metric::INNER_PRODUCT && metric_type_ != Metric::COSINE)) {
+            throw std::runtime_error("quantizeLevel0 only supports float vectors with L2, IP or COSINE");
+        }
+        if (raw_data_ != nullptr) {
+            return;
+        }
+        const size_t n = cur_element_count;
+        const size_t dim = *(size_t*)dist_func_param_;
+        char* raw_data = (char*)malloc(std::max<size_t>(n, 1) * data_size_);  // NOLINT
+        if (raw_data == nullptr) {
+            throw std::runtime_error("Not enough memory: quantizeLevel0 failed to allocate the vectors");
+        }
+        for (tableint i = 0; i < n; i++) {
+            memcpy(raw_data + i * data_size_, getDataByInternalId(i), data_size_);
+        }
+        sq8_.train((const float*)raw_data, n, dim);
+
+        const size_t size_data_per_element = size_links_level0_ + sq8_.code_size();
+        char* level0 = (char*)malloc(std::max<size_t>(n, 1) * size_data_per_element);  // NOLINT
+        if (level0 == nullptr) {
+            free(raw_data);
+            throw std::runtime_error("Not enough memory: quantizeLevel0 failed to allocate level0");
+        }
+        for (tableint i = 0; i < n; i++) {
+            char* element = level0 + i * size_data_per_element;
+            memcpy(element, get_linklist0(i), size_links_level0_);
+            sq8_.encode((const float*)(raw_data + i * data_size_), element + size_links_level0_);
+        }
+        free(data_level0_memory_);
+        data_level0_memory_ = level0;
+        size_data_per_element_ = size_data_per_element;
+        offsetData_ = size_links_level0_;
+        raw_data_ = raw_data;
+        max_elements_ = n;
+        sq8_enabled_ = true;
+    }
+
     void
     saveIndex(knowhere::MemoryIOWriter& output) {
         // write l2/ip calculator
@@ -777,11 +1205,18 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         writeBinaryPOD(output, mult_);
         writeBinaryPOD(output, ef_construction_);
 
+        // the header above is 120 bytes, so level 0 and the norms stay 8-byte aligned within the buffer, which is
+        // what lets loadIndex() use them in place
         output.write(data_level0_memory_, cur_element_count * size_data_per_element_);
         // for COSINE, need save data_norm_l2_
         if (metric_type_ == Metric::COSINE) {
             output.write(data_norm_l2_, cur_element_count * sizeof(float));
         }
+        // the grid and the vectors of a quantized index, 4-byte aligned like level 0
+        if (sq8_enabled_) {
+            sq8_.save(output);
+            output.write(raw_data_, cur_element_count * data_size_);
+        }
 
         for (size_t i = 0; i < cur_element_count; i++) {
             unsigned int linkListSize = element_levels_[i] > 0 ? size_links_per_element_ * element_levels_[i] : 0;
@@ -789,29 +1224,42 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             if (linkListSize)
                 output.write(linkLists_[i], linkListSize);
         }
+
+        // written only by optimized indexes, so the format of the others does not change
+        if (!internal_to_external_.empty()) {
+            writeBinaryPOD(output, kTrailerMagic);
+            writeBinaryPOD(output, kTrailerLabelMap);
+            writeBinaryPOD(output, internal_to_external_.size());
+            output.write(internal_to_external_.data(), internal_to_external_.size() * sizeof(tableint));
+        }
         // output.close();
     }
 
     void
-    loadIndex(knowhere::MemoryIOReader& input, size_t max_elements_i = 0) {
+    loadIndex(knowhere::MemoryIOReader& input, size_t max_elements_i = 0, bool zero_copy = false) {
         // linxj: init with metrictype
         size_t dim;
         readBinaryPOD(input, metric_type_);
         readBinaryPOD(input, data_size_);
         readBinaryPOD(input, dim);
         if (metric_type_ == Metric::L2) {
-            space_ = new hnswlib::L2Space(dim);
+            space_ = new hnswlib::L2Space(dim, data_type_);
         } else if (metric_type_ == Metric::INNER_PRODUCT) {
-            space_ = new hnswlib::InnerProductSpace(dim);
+            space_ = new hnswlib::InnerProductSpace(dim, data_type_);
         } else if (metric_type_ == Metric::COSINE) {
-            space_ = new hnswlib::CosineSpace(dim);
-        } else if (metric_type_ == Metric::HAMMING) {
+            space_ = new hnswlib::CosineSpace(dim, data_type_);
+        } else if (metric_type_ == Metric::HAMMING && data_type_ == DataType::FLOAT) {
             space_ = new hnswlib::HammingSpace(dim);
-        } else if (metric_type_ == Metric::JACCARD) {
+        } else if (metric_type_ == Metric::JACCARD && data_type_ == DataType::FLOAT) {
             space_ = new hnswlib::JaccardSpace(dim);
         } else {
             throw std::runtime_error("Invalid metric type " + std::to_string(metric_type_));
         }
+        // the binary does not record the component type, a float index loaded as a half one shows here
+        if (space_->get_data_size() != data_size_) {
+            throw std::runtime_error("Invalid binary: data size " + std::to_string(data_size_) +
+                                     " does not match the data type");
+        }
         fstdistfunc_ = space_->get_dist_func();
         dist_func_param_ = space_->get_dist_func_param();
 
@@ -835,18 +1283,52 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         readBinaryPOD(input, M_);
         readBinaryPOD(input, mult_);
         readBinaryPOD(input, ef_construction_);
+        checkElementSize(dim);
+        if (sq8_enabled_) {
+            max_elements = max_elements_ = cur_element_count;
+        }
 
-        data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
-        if (data_level0_memory_ == nullptr)
-            throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
-        input.read(data_level0_memory_, cur_element_count * size_data_per_element_);
-
-        // for COSINE, need load data_norm_l2_
-        if (metric_type_ == Metric::COSINE) {
-            data_norm_l2_ = (float*)malloc(max_elements * sizeof(float));  // NOLINT
-            if (data_norm_l2_ == nullptr)
+        const size_t level0_bytes = cur_element_count * size_data_per_element_;
+        const size_t norm_bytes = metric_type_ == Metric::COSINE ? cur_element_count * sizeof(float) : 0;
+        const size_t raw_bytes = sq8_enabled_ ? cur_element_count * data_size_ : 0;
+        if (zero_copy && reinterpret_cast<uintptr_t>(input.data_ + input.rp) % sizeof(float) == 0) {
+            if (input.rp + level0_bytes + norm_bytes + raw_bytes > input.total) {
+                throw std::runtime_error("Invalid binary: loadIndex found a truncated level0");
+            }
+            zero_copy_enabled_ = true;
+            // nothing can be added to a borrowed level 0
+            max_elements = max_elements_ = cur_element_count;
+            data_level0_memory_ = reinterpret_cast<char*>(input.data_ + input.rp);
+            input.rp += level0_bytes;
+            if (metric_type_ == Metric::COSINE) {
+                data_norm_l2_ = reinterpret_cast<float*>(input.data_ + input.rp);
+                input.rp += norm_bytes;
+            }
+            if (sq8_enabled_) {
+                sq8_.load(input, dim);
+                raw_data_ = reinterpret_cast<char*>(input.data_ + input.rp);
+                input.rp += raw_bytes;
+            }
+        } else {
+            data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
+            if (data_level0_memory_ == nullptr)
                 throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
-            input.read(data_norm_l2_, cur_element_count * sizeof(float));
+            input.read(data_level0_memory_, level0_bytes);
+
+            // for COSINE, need load data_norm_l2_
+            if (metric_type_ == Metric::COSINE) {
+                data_norm_l2_ = (float*)malloc(max_elements * sizeof(float));  // NOLINT
+                if (data_norm_l2_ == nullptr)
+                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
+                input.read(data_norm_l2_, norm_bytes);
+            }
+            if (sq8_enabled_) {
+                sq8_.load(input, dim);
+                raw_data_ = (char*)malloc(std::max<size_t>(raw_bytes, 1));  // NOLINT
+                if (raw_data_ == nullptr)
+                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate the vectors");
+                input.read(raw_data_, raw_bytes);
+            }
         }
 
         size_links_per_element_ = maxM_ * sizeof(tableint) + sizeof(linklistsizeint);
@@ -876,6 +1358,8 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 input.read(linkLists_[i], linkListSize);
             }
         }
+
+        loadTrailer(input, input.total - input.rp);
     }
 
     unsigned short int
@@ -1045,6 +1529,19 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return result;
     };
 
+    // Draws the levels of the next n elements. Passing them to addPoint() lets a parallel build insert the elements
+    // of the upper levels first, so that the max level is settled early, and keeps the levels independent of the
+    // order of the inserts, as level_generator_ is not thread safe.
+    std::vector<int>
+    drawLevels(size_t n) {
+        std::vector<int> levels(n);
+        for (auto& level : levels) {
+            level = getRandomLevel(mult_);
+        }
+        return levels;
+    }
+
+    // a negative level draws a random one
     tableint
     addPoint(const void* data_point, labeltype label, int level) {
         tableint cur_c = label;
@@ -1057,7 +1554,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         }
 
         std::unique_lock<std::mutex> lock_el(link_list_locks_[cur_c]);
-        int curlevel = (level > 0) ? level : getRandomLevel(mult_);
+        int curlevel = (level >= 0) ? level : getRandomLevel(mult_);
 
         element_levels_[cur_c] = curlevel;
 
@@ -1072,8 +1569,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         memcpy(getDataByInternalId(cur_c), data_point, data_size_);
 
         if (metric_type_ == Metric::COSINE) {
-            data_norm_l2_[cur_c] =
-                std::sqrt(faiss::fvec_norm_L2sqr((const float*)data_point, *(size_t*)(dist_func_param_)));
+            data_norm_l2_[cur_c] = std::sqrt(normL2sqr(data_point));
         }
 
         if (curlevel) {
@@ -1135,15 +1631,34 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return cur_c;
     };
 
+    // calls f(label) for every element the bitset keeps, walking the id list or the zero bits of the bitset instead of
+    // testing the bit of every element
+    template <typename F>
+    void
+    forEachUnfiltered(const knowhere::BitsetView& bitset, F&& f) const {
+        const size_t n = cur_element_count;
+        if (bitset.size() < n) {
+            for (labeltype label = 0; label < n; ++label) {
+                if (label >= bitset.size() || !bitset.test(label)) {
+                    f(label);
+                }
+            }
+            return;
+        }
+        bitset.for_each_unset([&](int64_t label) {
+            if ((size_t)label < n) {
+                f((labeltype)label);
+            }
+        });
+    }
+
     std::vector<std::pair<dist_t, labeltype>>
     searchKnnBF(const void* query_data, size_t k, const knowhere::BitsetView bitset) const {
         knowhere::ResultMaxHeap<dist_t, labeltype> max_heap(k);
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (!bitset.test(id)) {
-                dist_t dist = calcDistance(query_data, id);
-                max_heap.Push(dist, id);
-            }
-        }
+        forEachUnfiltered(bitset, [&](labeltype label) {
+            dist_t dist = calcDistance(query_data, getInternalId(label));
+            max_heap.Push(dist, label);
+        });
         const size_t len = std::min(max_heap.Size(), k);
         std::vector<std::pair<dist_t, labeltype>> result(len);
         for (int64_t i = len - 1; i >= 0; --i) {
@@ -1153,41 +1668,55 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return result;
     }
 
-    std::vector<std::pair<dist_t, labeltype>>
-    searchKnn(const void* query_data, size_t k, const knowhere::BitsetView bitset, const SearchParam* param = nullptr,
-              const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
-        if (cur_element_count == 0)
-            return {};
-
+    // the entry point cache key of a query
+    uint64_t
+    hashQuery(const void* query_data) const {
         size_t dim = *(size_t*)dist_func_param_;
+        if (metric_type_ == Metric::HAMMING || metric_type_ == Metric::JACCARD) {
+            return knowhere::hash_binary_vec((const uint8_t*)query_data, dim);
+        }
+        if (data_type_ != DataType::FLOAT) {
+            return knowhere::hash_binary_vec((const uint8_t*)query_data, data_size_ * 8);
+        }
+        return knowhere::hash_vec((const float*)query_data, dim);
+    }
 
-        // do normalize for COSINE metric type
-        std::unique_ptr<float[]> query_data_norm;
-        if (metric_type_ == Metric::COSINE) {
-            query_data_norm = knowhere::CopyAndNormalizeFloatVec((const float*)query_data, dim);
-            query_data = query_data_norm.get();
+    float
+    normL2sqr(const void* data) const {
+        size_t dim = *(size_t*)dist_func_param_;
+        switch (data_type_) {
+            case DataType::FP16:
+                return faiss::fp16_vec_norm_L2sqr((const uint16_t*)data, dim);
+            case DataType::BF16:
+                return faiss::bf16_vec_norm_L2sqr((const uint16_t*)data, dim);
+            default:
+                return faiss::fvec_norm_L2sqr((const float*)data, dim);
         }
+    }
 
-        // do bruteforce search when delete rate high
-        if (!bitset.empty()) {
-            const auto bs_cnt = bitset.count();
-            if (bs_cnt == cur_element_count)
-                return {};
-            if (bs_cnt >= (cur_element_count * kHnswSearchKnnBFThreshold)) {
-                return searchKnnBF(query_data, k, bitset);
-            }
+    // a normalized copy of a COSINE query, in the data type of the index
+    std::unique_ptr<float[]>
+    copyAndNormalizeQuery(const void* query_data) const {
+        size_t dim = *(size_t*)dist_func_param_;
+        if (data_type_ == DataType::FLOAT) {
+            return knowhere::CopyAndNormalizeFloatVec((const float*)query_data, dim);
         }
+        // the halves are packed at the front of the float buffer
+        auto normalized = std::make_unique<float[]>((dim + 1) / 2);
+        memcpy(normalized.get(), query_data, data_size_);
+        knowhere::NormalizeHalfVec((uint16_t*)normalized.get(), dim, data_type_ == DataType::BF16);
+        return normalized;
+    }
 
+    // greedy descent through the upper levels to the level 0 entry point, served from the cache when possible
+    tableint
+    searchUpperLayers(const void* query_data, uint64_t vec_hash, const SearchParam* param,
+                      const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
         tableint currObj = enterpoint_node_;
-        uint64_t vec_hash;
-        if (metric_type_ == Metric::HAMMING || metric_type_ == Metric::JACCARD) {
-            vec_hash = knowhere::hash_binary_vec((const uint8_t*)query_data, dim);
-        } else {
-            vec_hash = knowhere::hash_vec((const float*)query_data, dim);
-        }
         // for tuning, do not use cache
-        if (param->for_tuning || !lru_cache.try_get(vec_hash, currObj)) {
+        if (param->for_tuning || !entry_cache_.try_get(vec_hash, currObj)) {
             dist_t curdist = calcDistance(query_data, enterpoint_node_);
+            auto& metrics = thread_search_metrics();
 
             for (int level = maxlevel_; level > 0; level--) {
                 bool changed = true;
@@ -1200,8 +1729,8 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 
                     data = (unsigned int*)get_linklist(currObj, level);
                     int size = getListCount(data);
-                    metric_hops++;
-                    metric_distance_computations += size;
+                    metrics.hops++;
+                    metrics.distance_computations += size;
                     tableint* datal = (tableint*)(data + 1);
 #if defined(USE_PREFETCH)
                     for (int i = 0; i < size; ++i) {
@@ -1214,9 +1743,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                             throw std::runtime_error("cand error");
                         dist_t d = calcDistance(query_data, cand);
                         if (feder_result != nullptr) {
-                            feder_result->visit_info_.AddVisitRecord(level, currObj, cand, d);
-                            feder_result->id_set_.insert(currObj);
-                            feder_result->id_set_.insert(cand);
+                            addFederVisitRecord(feder_result, level, currObj, cand, d);
                         }
 
                         if (d < curdist) {
@@ -1228,36 +1755,150 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 }
             }
         }
-        std::vector<std::pair<dist_t, tableint>> top_candidates;
-        size_t ef = param ? param->ef_ : this->ef_;
+        return currObj;
+    }
+
+    // The level 0 search from ep_id, its candidates sorted by their exact distance. A quantized index traverses the
+    // codes and computes the distances of the ef candidates it ends with on the vectors.
+    std::vector<std::pair<dist_t, tableint>>
+    searchLevel0(tableint ep_id, const void* query_data, size_t ef, const knowhere::BitsetView bitset,
+                 const knowhere::feder::hnsw::FederResultUniq& feder_result) const {
+        if (!sq8_enabled_) {
+            if (!bitset.empty()) {
+                return searchBaseLayerST<true, true>(ep_id, query_data, ef, bitset, feder_result);
+            }
+            return searchBaseLayerST<false, true>(ep_id, query_data, ef, bitset, feder_result);
+        }
+        const auto query_code = sq8_.encode_query((const float*)query_data, metric_type_ == Metric::L2);
+        auto candidates =
+            bitset.empty()
+                ? searchBaseLayerST<false, true, true>(ep_id, query_data, ef, bitset, feder_result, &query_code)
+                : searchBaseLayerST<true, true, true>(ep_id, query_data, ef, bitset, feder_result, &query_code);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+#if defined(USE_PREFETCH)
+            if (i + 1 < candidates.size()) {
+                const char* next = getDataByInternalId(candidates[i + 1].second);
+                for (size_t offset = 0; offset < data_size_; offset += 64) {
+                    _mm_prefetch(next + offset, _MM_HINT_T0);
+                }
+            }
+#endif
+            candidates[i].first = calcDistance(query_data, candidates[i].second);
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        thread_search_metrics().distance_computations += candidates.size();
+        return candidates;
+    }
+
+    std::vector<std::pair<dist_t, labeltype>>
+    searchKnn(const void* query_data, size_t k, const knowhere::BitsetView bitset, const SearchParam* param = nullptr,
+              const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
+        if (cur_element_count == 0)
+            return {};
+
+        // do normalize for COSINE metric type
+        std::unique_ptr<float[]> query_data_norm;
+        if (metric_type_ == Metric::COSINE) {
+            query_data_norm = copyAndNormalizeQuery(query_data);
+            query_data = query_data_norm.get();
+        }
+
+        // do bruteforce search when delete rate high
         if (!bitset.empty()) {
-            top_candidates = searchBaseLayerST<true, true>(currObj, query_data, std::max(ef, k), bitset, feder_result);
-        } else {
-            top_candidates = searchBaseLayerST<false, true>(currObj, query_data, std::max(ef, k), bitset, feder_result);
+            const auto bs_cnt = bitset.count();
+            if (bs_cnt == cur_element_count)
+                return {};
+            if (bs_cnt >= (cur_element_count * kHnswSearchKnnBFThreshold)) {
+                return searchKnnBF(query_data, k, bitset);
+            }
         }
+
+        const uint64_t vec_hash = hashQuery(query_data);
+        const tableint currObj = searchUpperLayers(query_data, vec_hash, param, feder_result);
+
+        size_t ef = param ? param->ef_ : this->ef_;
+        auto top_candidates = searchLevel0(currObj, query_data, std::max(ef, k), bitset, feder_result);
         std::vector<std::pair<dist_t, labeltype>> result;
         size_t len = std::min(k, top_candidates.size());
         result.reserve(len);
         for (int i = 0; i < len; ++i) {
-            result.emplace_back(top_candidates[i].first, (labeltype)top_candidates[i].second);
+            result.emplace_back(top_candidates[i].first, getExternalLabel(top_candidates[i].second));
         }
         if (len > 0) {
-            lru_cache.put(vec_hash, result[0].second);
+            entry_cache_.put(vec_hash, top_candidates[0].second);
         }
         return result;
     };
 
+    // searchKnn of nq queries stored back to back, the level 0 traversals of all of them advanced in lockstep
+    std::vector<std::vector<std::pair<dist_t, labeltype>>>
+    searchKnnGroup(const void* query_data, size_t nq, size_t k, const knowhere::BitsetView bitset,
+                   const SearchParam* param) const {
+        std::vector<std::vector<std::pair<dist_t, labeltype>>> results(nq);
+        if (cur_element_count == 0) {
+            return results;
+        }
+        if (!bitset.empty()) {
+            const auto bs_cnt = bitset.count();
+            if (bs_cnt == cur_element_count) {
+                return results;
+            }
+            if (bs_cnt >= (cur_element_count * kHnswSearchKnnBFThreshold)) {
+                for (size_t q = 0; q < nq; ++q) {
+                    results[q] = searchKnn((const char*)query_data + q * data_size_, k, bitset, param);
+                }
+                return results;
+            }
+        }
+        // the lockstep traversal computes full distances, a quantized index searches the queries one by one
+        if (sq8_enabled_) {
+            for (size_t q = 0; q < nq; ++q) {
+                results[q] = searchKnn((const char*)query_data + q * data_size_, k, bitset, param);
+            }
+            return results;
+        }
+
+        std::vector<const void*> queries(nq);
+        std::vector<std::unique_ptr<float[]>> queries_norm(nq);
+        std::vector<uint64_t> vec_hashes(nq);
+        std::vector<tableint> ep_ids(nq);
+        for (size_t q = 0; q < nq; ++q) {
+            queries[q] = (const char*)query_data + q * data_size_;
+            if (metric_type_ == Metric::COSINE) {
+                queries_norm[q] = copyAndNormalizeQuery(queries[q]);
+                queries[q] = queries_norm[q].get();
+            }
+            vec_hashes[q] = hashQuery(queries[q]);
+            ep_ids[q] = searchUpperLayers(queries[q], vec_hashes[q], param);
+        }
+
+        size_t ef = std::max(param ? param->ef_ : this->ef_, k);
+        auto top_candidates = bitset.empty()
+                                  ? searchBaseLayerGroup<false>(queries.data(), ep_ids.data(), nq, ef, bitset)
+                                  : searchBaseLayerGroup<true>(queries.data(), ep_ids.data(), nq, ef, bitset);
+        for (size_t q = 0; q < nq; ++q) {
+            size_t len = std::min(k, top_candidates[q].size());
+            results[q].reserve(len);
+            for (size_t i = 0; i < len; ++i) {
+                results[q].emplace_back(top_candidates[q][i].first, getExternalLabel(top_candidates[q][i].second));
+            }
+            if (len > 0) {
+                entry_cache_.put(vec_hashes[q], top_candidates[q][0].second);
+            }
+        }
+        return results;
+    }
+
     std::vector<std::pair<dist_t, labeltype>>
     searchRangeBF(const void* query_data, float radius, const knowhere::BitsetView bitset) const {
         std::vector<std::pair<dist_t, labeltype>> result;
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (!bitset.test(id)) {
-                dist_t dist = calcDistance(query_data, id);
-                if (dist < radius) {
-                    result.emplace_back(dist, id);
-                }
+        forEachUnfiltered(bitset, [&](labeltype label) {
+            dist_t dist = calcDistance(query_data, getInternalId(label));
+            if (dist < radius) {
+                result.emplace_back(dist, label);
             }
-        }
+        });
         return result;
     }
 
@@ -1269,12 +1910,10 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             return {};
         }
 
-        size_t dim = *((size_t*)dist_func_param_);
-
         // do normalize for COSINE metric type
         std::unique_ptr<float[]> query_data_norm;
         if (metric_type_ == Metric::COSINE) {
-            query_data_norm = knowhere::CopyAndNormalizeFloatVec((const float*)query_data, dim);
+            query_data_norm = copyAndNormalizeQuery(query_data);
             query_data = query_data_norm.get();
         }
 
@@ -1288,64 +1927,16 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             }
         }
 
-        tableint currObj = enterpoint_node_;
-        uint64_t vec_hash;
-        if (metric_type_ == Metric::HAMMING || metric_type_ == Metric::JACCARD) {
-            vec_hash = knowhere::hash_binary_vec((const uint8_t*)query_data, dim);
-        } else {
-            vec_hash = knowhere::hash_vec((const float*)query_data, dim);
-        }
-        // for tuning, do not use cache
-        if (param->for_tuning || !lru_cache.try_get(vec_hash, currObj)) {
-            dist_t curdist = calcDistance(query_data, enterpoint_node_);
-
-            for (int level = maxlevel_; level > 0; level--) {
-                bool changed = true;
-                if (feder_result != nullptr) {
-                    feder_result->visit_info_.AddLevelVisitRecord(level);
-                }
-                while (changed) {
-                    changed = false;
-                    unsigned int* data;
-
-                    data = (unsigned int*)get_linklist(currObj, level);
-                    int size = getListCount(data);
-                    metric_hops++;
-                    metric_distance_computations += size;
-
-                    tableint* datal = (tableint*)(data + 1);
-                    for (int i = 0; i < size; i++) {
-                        tableint cand = datal[i];
-                        if (cand < 0 || cand > max_elements_)
-                            throw std::runtime_error("cand error");
-                        dist_t d = calcDistance(query_data, cand);
-                        if (feder_result != nullptr) {
-                            feder_result->visit_info_.AddVisitRecord(level, currObj, cand, d);
-                            feder_result->id_set_.insert(currObj);
-                            feder_result->id_set_.insert(cand);
-                        }
-                        if (d < curdist) {
-                            curdist = d;
-                            currObj = cand;
-                            changed = true;
-                        }
-                    }
-                }
-            }
-        }
+        const uint64_t vec_hash = hashQuery(query_data);
+        const tableint currObj = searchUpperLayers(query_data, vec_hash, param, feder_result);
 
-        std::vector<std::pair<dist_t, tableint>> top_candidates;
         size_t ef = param ? param->ef_ : this->ef_;
-        if (!bitset.empty()) {
-            top_candidates = searchBaseLayerST<true, true>(currObj, query_data, ef, bitset, feder_result);
-        } else {
-            top_candidates = searchBaseLayerST<false, true>(currObj, query_data, ef, bitset, feder_result);
-        }
+        auto top_candidates = searchLevel0(currObj, query_data, ef, bitset, feder_result);
 
         if (top_candidates.size() == 0) {
             return {};
         } else {
-            lru_cache.put(vec_hash, top_candidates[0].second);
+            entry_cache_.put(vec_hash, top_candidates[0].second);
         }
 
         return getNeighboursWithinRadius(top_candidates, query_data, radius, bitset);
@@ -1393,7 +1984,11 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         ret += link_list_locks_.size() * sizeof(std::mutex);
         ret += element_levels_.size() * sizeof(int);
         ret += max_elements_ * size_data_per_element_;
+        if (raw_data_ != nullptr) {
+            ret += cur_element_count * data_size_;
+        }
         ret += max_elements_ * sizeof(void*);
+        ret += (internal_to_external_.size() + external_to_internal_.size()) * sizeof(tableint);
         for (auto i = 0; i < max_elements_; ++i) {
             if (element_levels_[i] > 0) {
                 ret += size_links_per_element_ * element_levels_[i];
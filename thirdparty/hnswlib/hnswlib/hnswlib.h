@@ -173,6 +173,14 @@ readBinaryPOD(R& in, T& podRef) {
 template <typename MTYPE>
 using DISTFUNC = MTYPE (*)(const void*, const void*, const void*);
 
+// the component type of the stored and queried vectors of a float space
+enum class DataType { FLOAT, FP16, BF16 };
+
+inline size_t
+data_type_size(DataType data_type) {
+    return data_type == DataType::FLOAT ? sizeof(float) : sizeof(uint16_t);
+}
+
 template <typename MTYPE>
 class SpaceInterface {
  public:
@@ -180,6 +188,11 @@ class SpaceInterface {
     virtual size_t
     get_data_size() = 0;
 
+    virtual DataType
+    get_data_type() {
+        return DataType::FLOAT;
+    }
+
     virtual DISTFUNC<MTYPE>
     get_dist_func() = 0;
 
@@ -195,6 +208,19 @@ struct SearchParam {
     bool for_tuning;
 };
 
+// Search work done by the calling thread. Searches add to it without synchronization, callers take the difference
+// around the queries they want to account for.
+struct SearchMetrics {
+    size_t hops = 0;
+    size_t distance_computations = 0;
+};
+
+inline SearchMetrics&
+thread_search_metrics() {
+    thread_local SearchMetrics metrics;
+    return metrics;
+}
+
 template <typename dist_t>
 class AlgorithmInterface {
  public:
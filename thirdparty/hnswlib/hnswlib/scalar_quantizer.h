@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "simd/hook.h"
+
+namespace hnswlib {
+
+// 8-bit codes of float vectors on a single grid shared by all the components, so that the distances between two codes
+// are sums of integer products that the u8 SIMD kernels compute exactly. The code of an element starts with the sum of
+// its components, which the inner product needs, followed by the components padded to 4 bytes.
+class UniformSQ8 {
+ public:
+    // a query encoded for the distances to the codes
+    struct Query {
+        std::unique_ptr<uint8_t[]> code;
+        bool l2 = true;
+        // ip = bias + sum_scale * code sum of the element + dot_scale * integer inner product
+        float bias = 0;
+        float sum_scale = 0;
+        float dot_scale = 1;
+    };
+
+    static size_t
+    code_size(size_t dim) {
+        return sizeof(int32_t) + (dim + 3) / 4 * 4;
+    }
+
+    size_t
+    code_size() const {
+        return code_size(dim_);
+    }
+
+    // the grid covering every component of the n vectors
+    void
+    train(const float* x, size_t n, size_t dim) {
+        dim_ = dim;
+        if (n * dim == 0) {
+            set_grid(0, 0);
+            return;
+        }
+        const auto [lo, hi] = std::minmax_element(x, x + n * dim);
+        set_grid(*lo, *hi);
+    }
+
+    void
+    encode(const float* x, char* code) const {
+        uint8_t* components = (uint8_t*)(code + sizeof(int32_t));
+        memset(components, 0, code_size() - sizeof(int32_t));
+        int32_t sum = encode(x, vmin_, step_, components);
+        memcpy(code, &sum, sizeof(sum));
+    }
+
+    // An L2 query is encoded on the grid of the data, so that the distance is the integer L2 distance of the codes
+    // scaled back. An inner product query gets a grid of its own, as its scale can differ from the one of the data.
+    Query
+    encode_query(const float* x, bool l2) const {
+        Query query;
+        query.l2 = l2;
+        query.code = std::make_unique<uint8_t[]>(dim_);
+        if (l2) {
+            encode(x, vmin_, step_, query.code.get());
+            query.dot_scale = step_ * step_;
+            return query;
+        }
+        float qmin = 0, qstep = 1;
+        if (dim_ > 0) {
+            const auto [lo, hi] = std::minmax_element(x, x + dim_);
+            qmin = *lo;
+            qstep = *hi > *lo ? (*hi - *lo) / 255.0f : 1.0f;
+        }
+        const int32_t qsum = encode(x, qmin, qstep, query.code.get());
+        query.bias = dim_ * qmin * vmin_ + vmin_ * qstep * qsum;
+        query.sum_scale = qmin * step_;
+        query.dot_scale = qstep * step_;
+        return query;
+    }
+
+    // the squared L2 distance, or the inner product, of a query and a code
+    float
+    distance(const Query& query, const char* code) const {
+        const uint8_t* components = (const uint8_t*)(code + sizeof(int32_t));
+        if (query.l2) {
+            return query.dot_scale * faiss::u8_vec_L2sqr(query.code.get(), components, dim_);
+        }
+        int32_t sum;
+        memcpy(&sum, code, sizeof(sum));
+        return query.bias + query.sum_scale * sum +
+               query.dot_scale * faiss::u8_vec_inner_product(query.code.get(), components, dim_);
+    }
+
+    template <typename W>
+    void
+    save(W& output) const {
+        output.write((char*)&vmin_, sizeof(vmin_));
+        output.write((char*)&step_, sizeof(step_));
+    }
+
+    template <typename R>
+    void
+    load(R& input, size_t dim) {
+        dim_ = dim;
+        input.read((char*)&vmin_, sizeof(vmin_));
+        input.read((char*)&step_, sizeof(step_));
+    }
+
+ private:
+    void
+    set_grid(float vmin, float vmax) {
+        vmin_ = vmin;
+        step_ = vmax > vmin ? (vmax - vmin) / 255.0f : 1.0f;
+    }
+
+    // the components of x rounded to the grid, out of range ones clamped, returns their sum
+    int32_t
+    encode(const float* x, float vmin, float step, uint8_t* components) const {
+        const float inv_step = 1.0f / step;
+        int32_t sum = 0;
+        for (size_t i = 0; i < dim_; i++) {
+            const float c = std::nearbyint((x[i] - vmin) * inv_step);
+            components[i] = (uint8_t)std::clamp(c, 0.0f, 255.0f);
+            sum += components[i];
+        }
+        return sum;
+    }
+
+    size_t dim_ = 0;
+    float vmin_ = 0;
+    float step_ = 1;
+};
+
+}  // namespace hnswlib
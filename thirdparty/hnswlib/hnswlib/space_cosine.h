@@ -15,16 +15,33 @@ CosineDistance(const void* pVect1, const void* pVect2, const void* qty_ptr) {
     return -1.0f * Cosine(pVect1, pVect2, qty_ptr);
 }
 
+static float
+CosineDistanceFp16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return -1.0f * faiss::fp16_vec_inner_product((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
+static float
+CosineDistanceBf16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return -1.0f * faiss::bf16_vec_inner_product((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
 class CosineSpace : public SpaceInterface<float> {
     DISTFUNC<float> fstdistfunc_;
     size_t data_size_;
     size_t dim_;
+    DataType data_type_;
 
  public:
-    CosineSpace(size_t dim) {
+    CosineSpace(size_t dim, DataType data_type = DataType::FLOAT) {
         fstdistfunc_ = CosineDistance;
+        if (data_type == DataType::FP16) {
+            fstdistfunc_ = CosineDistanceFp16;
+        } else if (data_type == DataType::BF16) {
+            fstdistfunc_ = CosineDistanceBf16;
+        }
         dim_ = dim;
-        data_size_ = dim * sizeof(float);
+        data_type_ = data_type;
+        data_size_ = dim * data_type_size(data_type);
     }
 
     size_t
@@ -32,6 +49,11 @@ class CosineSpace : public SpaceInterface<float> {
         return data_size_;
     }
 
+    DataType
+    get_data_type() {
+        return data_type_;
+    }
+
     DISTFUNC<float>
     get_dist_func() {
         return fstdistfunc_;
@@ -3,12 +3,13 @@
 #include <faiss/utils/binary_distances.h>
 
 #include "hnswlib.h"
+#include "simd/hook.h"
 
 namespace hnswlib {
 
 static float
 Hamming(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    return faiss::xor_popcnt((const uint8_t*)pVect1v, (const uint8_t*)pVect2v, *((size_t*)qty_ptr) / 8);
+    return faiss::bin_vec_hamming((const uint8_t*)pVect1v, (const uint8_t*)pVect2v, *((size_t*)qty_ptr) / 8);
 }
 
 class HammingSpace : public SpaceInterface<float> {
@@ -24,6 +24,16 @@ InnerProductDistance(const void* pVect1, const void* pVect2, const void* qty_ptr
     return -1.0f * InnerProduct(pVect1, pVect2, qty_ptr);
 }
 
+static float
+InnerProductDistanceFp16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return -1.0f * faiss::fp16_vec_inner_product((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
+static float
+InnerProductDistanceBf16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return -1.0f * faiss::bf16_vec_inner_product((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
 #if defined(USE_AVX)
 
 // Favor using AVX if available.
@@ -323,10 +333,16 @@ class InnerProductSpace : public SpaceInterface<float> {
     DISTFUNC<float> fstdistfunc_;
     size_t data_size_;
     size_t dim_;
+    DataType data_type_;
 
  public:
-    InnerProductSpace(size_t dim) {
+    InnerProductSpace(size_t dim, DataType data_type = DataType::FLOAT) {
         fstdistfunc_ = InnerProductDistance;
+        if (data_type == DataType::FP16) {
+            fstdistfunc_ = InnerProductDistanceFp16;
+        } else if (data_type == DataType::BF16) {
+            fstdistfunc_ = InnerProductDistanceBf16;
+        }
 #if 0 /* use FAISS distance calculation algorithm instead */
 #if defined(USE_AVX) || defined(USE_SSE) || defined(USE_AVX512)
 #if defined(USE_AVX512)
@@ -361,7 +377,8 @@ class InnerProductSpace : public SpaceInterface<float> {
 #endif
 #endif
         dim_ = dim;
-        data_size_ = dim * sizeof(float);
+        data_type_ = data_type;
+        data_size_ = dim * data_type_size(data_type);
     }
 
     size_t
@@ -369,6 +386,11 @@ class InnerProductSpace : public SpaceInterface<float> {
         return data_size_;
     }
 
+    DataType
+    get_data_type() {
+        return data_type_;
+    }
+
     DISTFUNC<float>
     get_dist_func() {
         return fstdistfunc_;
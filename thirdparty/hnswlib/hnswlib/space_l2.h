@@ -25,6 +25,16 @@ L2Sqr(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
 #endif
 }
 
+static float
+L2SqrFp16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return faiss::fp16_vec_L2sqr((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
+static float
+L2SqrBf16(const void* pVect1, const void* pVect2, const void* qty_ptr) {
+    return faiss::bf16_vec_L2sqr((const uint16_t*)pVect1, (const uint16_t*)pVect2, *((size_t*)qty_ptr));
+}
+
 #if defined(USE_AVX512)
 
 // Favor using AVX512 if available.
@@ -212,10 +222,16 @@ class L2Space : public SpaceInterface<float> {
     DISTFUNC<float> fstdistfunc_;
     size_t data_size_;
     size_t dim_;
+    DataType data_type_;
 
  public:
-    L2Space(size_t dim) {
+    L2Space(size_t dim, DataType data_type = DataType::FLOAT) {
         fstdistfunc_ = L2Sqr;
+        if (data_type == DataType::FP16) {
+            fstdistfunc_ = L2SqrFp16;
+        } else if (data_type == DataType::BF16) {
+            fstdistfunc_ = L2SqrBf16;
+        }
 #if 0 /* use FAISS distance calculation algorithm instead */
 #if defined(USE_SSE) || defined(USE_AVX) || defined(USE_AVX512)
 #if defined(USE_AVX512)
@@ -239,7 +255,8 @@ class L2Space : public SpaceInterface<float> {
 #endif
 #endif
         dim_ = dim;
-        data_size_ = dim * sizeof(float);
+        data_type_ = data_type;
+        data_size_ = dim * data_type_size(data_type);
     }
 
     size_t
@@ -247,6 +264,11 @@ class L2Space : public SpaceInterface<float> {
         return data_size_;
     }
 
+    DataType
+    get_data_type() {
+        return data_type_;
+    }
+
     DISTFUNC<float>
     get_dist_func() {
         return fstdistfunc_;
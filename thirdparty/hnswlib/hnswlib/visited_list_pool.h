@@ -1,13 +1,158 @@
 #pragma once
 
 #include <algorithm>
-#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
 namespace hnswlib {
 
+typedef uint16_t vl_type;
+
+///////////////////////////////////////////////////////////
+//
+// Visited set of a single search, reset in O(1)
+//
+///////////////////////////////////////////////////////////
+
+// Dense mode keeps one epoch tag per element: an element is visited when its tag equals the current epoch, so a
+// reset only bumps the epoch and the tags are physically cleared once every 65535 resets.
+// Sparse mode is an open addressing set of the visited ids, used when a search is expected to touch a tiny
+// fraction of the elements; its cost is proportional to the number of visits instead of the number of elements.
+class VisitedList {
+ public:
+    VisitedList(size_t numelements, std::atomic<int64_t>* bytes) : numelements_(numelements), bytes_(bytes) {
+    }
+
+    ~VisitedList() {
+        *bytes_ -= memory();
+    }
+
+    VisitedList(const VisitedList&) = delete;
+
+    VisitedList&
+    operator=(const VisitedList&) = delete;
+
+    void
+    reset(bool sparse) {
+        sparse_ = sparse;
+        if (sparse_) {
+            if (slots_.empty()) {
+                resizeSlots(kSparseInitCapacity);
+            } else if (used_ > 0) {
+                std::fill(slots_.begin(), slots_.end(), kEmptySlot);
+            }
+            used_ = 0;
+            return;
+        }
+        if (mass_ == nullptr) {
+            mass_ = std::make_unique<vl_type[]>(numelements_);
+            *bytes_ += numelements_ * sizeof(vl_type);
+            cur_v_ = 0;
+        }
+        if (++cur_v_ == 0) {
+            memset(mass_.get(), 0, numelements_ * sizeof(vl_type));
+            cur_v_ = 1;
+        }
+    }
+
+    bool
+    get(uint32_t id) const {
+        if (!sparse_) {
+            return mass_[id] == cur_v_;
+        }
+        for (size_t pos = slotOf(id);; pos = (pos + 1) & mask_) {
+            if (slots_[pos] == id) {
+                return true;
+            }
+            if (slots_[pos] == kEmptySlot) {
+                return false;
+            }
+        }
+    }
+
+    void
+    set(uint32_t id) {
+        if (!sparse_) {
+            mass_[id] = cur_v_;
+            return;
+        }
+        if ((used_ + 1) * 2 > slots_.size()) {
+            rehash();
+        }
+        insert(id);
+    }
+
+    int64_t
+    memory() const {
+        return (mass_ ? numelements_ * sizeof(vl_type) : 0) + slots_.size() * sizeof(uint32_t);
+    }
+
+ private:
+    static constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t kSparseInitCapacity = 4096;
+
+    size_t
+    slotOf(uint32_t id) const {
+        // fibonacci hashing, ids of neighbors are often close to each other
+        return (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> shift_;
+    }
+
+    void
+    insert(uint32_t id) {
+        for (size_t pos = slotOf(id);; pos = (pos + 1) & mask_) {
+            if (slots_[pos] == id) {
+                return;
+            }
+            if (slots_[pos] == kEmptySlot) {
+                slots_[pos] = id;
+                used_++;
+                return;
+            }
+        }
+    }
+
+    void
+    resizeSlots(size_t capacity) {
+        *bytes_ += (static_cast<int64_t>(capacity) - static_cast<int64_t>(slots_.size())) *
+                   static_cast<int64_t>(sizeof(uint32_t));
+        slots_.assign(capacity, kEmptySlot);
+        mask_ = capacity - 1;
+        shift_ = 64 - __builtin_ctzll(capacity);
+    }
+
+    void
+    rehash() {
+        std::vector<uint32_t> old(slots_);
+        resizeSlots(old.size() * 2);
+        used_ = 0;
+        for (auto id : old) {
+            if (id != kEmptySlot) {
+                insert(id);
+            }
+        }
+    }
+
+    const size_t numelements_;
+    std::atomic<int64_t>* bytes_;
+    bool sparse_ = false;
+
+    // dense mode
+    std::unique_ptr<vl_type[]> mass_ = nullptr;
+    vl_type cur_v_ = 0;
+
+    // sparse mode
+    std::vector<uint32_t> slots_;
+    size_t used_ = 0;
+    size_t mask_ = 0;
+    int shift_ = 64;
+};
+
 ///////////////////////////////////////////////////////////
 //
 // Class for multi-threaded pool-management of VisitedLists
@@ -15,31 +160,94 @@ namespace hnswlib {
 /////////////////////////////////////////////////////////
 
 class VisitedListPool {
-    int numelements;
-    std::unordered_map<std::thread::id, std::vector<bool>> map;
-    std::mutex mtx;
-
  public:
-    VisitedListPool(int numelements1) {
-        numelements = numelements1;
+    // a search that expects to visit fewer than numelements / kSparseVisitedRatio elements uses the sparse mode
+    static constexpr size_t kSparseVisitedRatio = 512;
+    // idle lists kept for reuse, the ones released while the pool is full are freed
+    static constexpr size_t kMaxPooledLists = 256;
+
+    // returns the checked out list to its pool when it goes out of scope
+    class Handle {
+     public:
+        Handle(VisitedListPool* pool, VisitedList* list) : pool_(pool), list_(list) {
+        }
+
+        Handle(const Handle&) = delete;
+
+        Handle&
+        operator=(const Handle&) = delete;
+
+        ~Handle() {
+            pool_->releaseVisitedList(list_);
+        }
+
+        VisitedList&
+        operator*() const {
+            return *list_;
+        }
+
+     private:
+        VisitedListPool* pool_;
+        VisitedList* list_;
+    };
+
+    VisitedListPool(int numelements1) : numelements(numelements1) {
+        for (auto& slot : lists_) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~VisitedListPool() {
+        for (auto& slot : lists_) {
+            delete slot.exchange(nullptr);
+        }
     }
 
-    std::vector<bool>&
-    getFreeVisitedList() {
-        std::unique_lock lk(mtx);
-        auto& res = map[std::this_thread::get_id()];
-        lk.unlock();
-        if (res.size() != numelements) {
-            res.assign(numelements, false);
-        } else {
-            std::fill(res.begin(), res.end(), false);
+    // lock-free: a thread first probes the slot it released its last list to, so it usually gets the same list back
+    Handle
+    getFreeVisitedList(size_t expected_visits = std::numeric_limits<size_t>::max()) {
+        VisitedList* list = nullptr;
+        const size_t start = homeSlot();
+        for (size_t i = 0; i < kMaxPooledLists && list == nullptr; ++i) {
+            auto& slot = lists_[(start + i) % kMaxPooledLists];
+            if (slot.load(std::memory_order_relaxed) != nullptr) {
+                list = slot.exchange(nullptr, std::memory_order_acquire);
+            }
+        }
+        if (list == nullptr) {
+            list = new VisitedList(numelements, &bytes_);
         }
-        return res;
+        list->reset(expected_visits < numelements / kSparseVisitedRatio);
+        return Handle(this, list);
     };
 
     int64_t
     size() {
-        return numelements * (sizeof(std::thread::id) + numelements / 8) + sizeof(*this);
+        return sizeof(*this) + bytes_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    size_t
+    homeSlot() const {
+        return std::hash<std::thread::id>{}(std::this_thread::get_id()) % kMaxPooledLists;
     }
+
+    void
+    releaseVisitedList(VisitedList* list) {
+        const size_t start = homeSlot();
+        for (size_t i = 0; i < kMaxPooledLists; ++i) {
+            auto& slot = lists_[(start + i) % kMaxPooledLists];
+            VisitedList* expected = nullptr;
+            if (slot.load(std::memory_order_relaxed) == nullptr &&
+                slot.compare_exchange_strong(expected, list, std::memory_order_release)) {
+                return;
+            }
+        }
+        delete list;
+    }
+
+    size_t numelements;
+    std::atomic<int64_t> bytes_{0};
+    std::atomic<VisitedList*> lists_[kMaxPooledLists];
 };
 }  // namespace hnswlib